@@ -44,6 +44,7 @@
 #define TIFF_FIELD_YRESOLUTION 283
 #define TIFF_FIELD_PLANARCONFIG 284
 #define TIFF_FIELD_RESOLUTIONUNIT 296
+#define TIFF_FIELD_PREDICTOR 317
 #define TIFF_FIELD_TILE_WIDTH 322
 #define TIFF_FIELD_TILE_LENGTH 323
 #define TIFF_FIELD_TILE_OFFSETS 324
@@ -56,11 +57,21 @@
 #define TIFF_TYPE_SHORT 3
 #define TIFF_TYPE_LONG 4
 #define TIFF_TYPE_RATIONAL 5
+#define TIFF_TYPE_LONG8 16
+#define TIFF_TYPE_SLONG8 17
+#define TIFF_TYPE_IFD8 18
 
 #define TIFF_COMPRESSION_NONE 1
 #define TIFF_COMPRESSION_CCITT 2
+#define TIFF_COMPRESSION_LZW 5
+#define TIFF_COMPRESSION_ADOBE_DEFLATE 8
+#define TIFF_COMPRESSION_DEFLATE 32946
 #define TIFF_COMPRESSION_PACKBITS 32773
 
+#define TIFF_PREDICTOR_NONE 1
+#define TIFF_PREDICTOR_HORIZONTAL 2
+#define TIFF_PREDICTOR_FLOATINGPOINT 3
+
 #define TIFF_PLANARCONFIG_CHUNKY 1
 #define TIFF_PLANARCONFIG_PLANAR 2
 
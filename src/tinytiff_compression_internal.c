@@ -0,0 +1,487 @@
+/*
+    Copyright (c) 2008-2024 Jan W. Krieger (<jan@jkrieger.de>), German Cancer Research Center (DKFZ) & IWR, University of Heidelberg
+
+    This software is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License (LGPL) as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+*/
+
+#include "tinytiff_compression_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#if defined(TINYTIFF_HAVE_LIBDEFLATE)
+#  include <libdeflate.h>
+#elif defined(TINYTIFF_HAVE_ZLIB)
+#  include <zlib.h>
+#endif
+
+size_t TinyTIFF_packBitsMaxEncodedSize(size_t size) {
+    // worst case: only literal blocks, i.e. one header byte per 128 bytes
+    return size+(size+127)/128;
+}
+
+size_t TinyTIFF_packBitsEncode(const uint8_t* src, size_t size, uint8_t* dst) {
+    size_t i=0, o=0;
+    while (i<size) {
+        size_t run=1;
+        while (i+run<size && run<128 && src[i+run]==src[i]) run++;
+        if (run>=3) {
+            dst[o++]=(uint8_t)(257-run);
+            dst[o++]=src[i];
+            i+=run;
+        } else {
+            // collect literal bytes, until a run of at least 3 bytes starts
+            const size_t start=i;
+            size_t len=0;
+            while (i<size && len<128) {
+                if (len>0 && i+2<size && src[i]==src[i+1] && src[i]==src[i+2]) break;
+                i++;
+                len++;
+            }
+            dst[o++]=(uint8_t)(len-1);
+            memcpy(dst+o, src+start, len);
+            o+=len;
+        }
+    }
+    return o;
+}
+
+size_t TinyTIFF_packBitsDecode(const uint8_t* src, size_t srcsize, uint8_t* dst, size_t dstsize) {
+    size_t i=0, o=0;
+    while (i<srcsize && o<dstsize) {
+        const int8_t n=(int8_t)src[i++];
+        if (n>=0) {
+            size_t len=(size_t)n+1;
+            if (len>srcsize-i) len=srcsize-i;
+            if (len>dstsize-o) len=dstsize-o;
+            memcpy(dst+o, src+i, len);
+            i+=(size_t)n+1;
+            o+=len;
+        } else if (n!=-128) {
+            size_t len=(size_t)(1-n);
+            if (i>=srcsize) break;
+            if (len>dstsize-o) len=dstsize-o;
+            memset(dst+o, src[i], len);
+            i++;
+            o+=len;
+        }
+    }
+    return o;
+}
+
+/** \brief the LZW code to clear the string table */
+#define TINYTIFF_LZW_CLEAR 256
+/** \brief the LZW code marking the end of the data */
+#define TINYTIFF_LZW_EOI 257
+/** \brief the first LZW code, used for strings of more than one byte */
+#define TINYTIFF_LZW_FIRSTCODE 258
+/** \brief the number of LZW codes (12 bits) */
+#define TINYTIFF_LZW_MAXCODES 4096
+
+size_t TinyTIFF_lzwDecode(const uint8_t* src, size_t srcsize, uint8_t* dst, size_t dstsize) {
+    uint16_t prefix[TINYTIFF_LZW_MAXCODES];
+    uint16_t length[TINYTIFF_LZW_MAXCODES];
+    uint8_t suffix[TINYTIFF_LZW_MAXCODES];
+    uint8_t first[TINYTIFF_LZW_MAXCODES];
+    size_t i=0, o=0;
+    uint64_t bitbuf=0;
+    unsigned bitcount=0;
+    unsigned width=9;
+    uint32_t next=TINYTIFF_LZW_FIRSTCODE;
+    int32_t prev=-1;
+    uint32_t c;
+    for (c=0; c<256; c++) {
+        prefix[c]=0;
+        length[c]=1;
+        suffix[c]=(uint8_t)c;
+        first[c]=(uint8_t)c;
+    }
+    while (o<dstsize) {
+        if (bitcount<width) {
+            // refill up to 8 bytes at once, so the bit buffer is only touched every few codes
+            while (bitcount<=56 && i<srcsize) {
+                bitbuf=(bitbuf<<8)|src[i++];
+                bitcount+=8;
+            }
+            if (bitcount<width) break;
+        }
+        bitcount-=width;
+        const uint32_t code=(uint32_t)(bitbuf>>bitcount)&((1u<<width)-1u);
+        if (code==TINYTIFF_LZW_EOI) break;
+        if (code==TINYTIFF_LZW_CLEAR) {
+            width=9;
+            next=TINYTIFF_LZW_FIRSTCODE;
+            prev=-1;
+            continue;
+        }
+        if (code<256) {
+            dst[o++]=(uint8_t)code;
+        } else if (code>next || (code==next && prev<0)) {
+            break;
+        }
+        if (prev>=0 && next<TINYTIFF_LZW_MAXCODES) {
+            // for code==next (KwKwK case) the code is defined by the entry, which is added in this step
+            prefix[next]=(uint16_t)prev;
+            length[next]=(uint16_t)(length[prev]+1);
+            suffix[next]=(code==next)?first[prev]:first[code];
+            first[next]=first[prev];
+            next++;
+            if (next==(1u<<width)-1u && width<12) width++;
+        }
+        if (code>=256) {
+            // write the string back-to-front, following the prefix chain
+            size_t len=length[code];
+            c=code;
+            if (len>dstsize-o) {
+                size_t skip=len-(dstsize-o);
+                while (skip>0) {
+                    c=prefix[c];
+                    skip--;
+                }
+                len=dstsize-o;
+            }
+            uint8_t* p=dst+o+len;
+            o+=len;
+            while (p>dst+o-len) {
+                *(--p)=suffix[c];
+                c=prefix[c];
+            }
+        }
+        prev=(int32_t)code;
+    }
+    return o;
+}
+
+size_t TinyTIFF_lzwMaxEncodedSize(size_t size) {
+    // worst case: one 12-bit code per input byte, plus a Clear code for each table reset (at least every 3836 codes),
+    // the initial Clear and the final EndOfInformation code
+    const size_t codes=size+size/(TINYTIFF_LZW_MAXCODES-2-TINYTIFF_LZW_FIRSTCODE)+3;
+    return (codes*12+7)/8;
+}
+
+/** \brief number of slots in the hash table of the LZW encoder (a power of 2, so at most half of the slots are used) */
+#define TINYTIFF_LZW_HASHSIZE 8192
+
+size_t TinyTIFF_lzwEncode(const uint8_t* src, size_t size, uint8_t* dst) {
+    // each slot stores the key (prefix<<8 | byte)+1 (0 marks an empty slot) and the code of the string
+    uint32_t hashkeys[TINYTIFF_LZW_HASHSIZE];
+    uint16_t hashcodes[TINYTIFF_LZW_HASHSIZE];
+    size_t i, o=0;
+    uint64_t bitbuf=0;
+    unsigned bitcount=0;
+    unsigned width=9;
+    uint32_t next=TINYTIFF_LZW_FIRSTCODE;
+    uint32_t prefix;
+    memset(hashkeys, 0, sizeof(hashkeys));
+    bitbuf=TINYTIFF_LZW_CLEAR;
+    bitcount=width;
+    if (size==0) {
+        bitbuf=(bitbuf<<width)|TINYTIFF_LZW_EOI;
+        bitcount+=width;
+    } else {
+        prefix=src[0];
+        for (i=1; i<size; i++) {
+            const uint8_t c=src[i];
+            const uint32_t key=((prefix<<8)|c)+1u;
+            uint32_t h=(key*2654435761u)>>19; // multiplicative hashing, the upper 13 bits index TINYTIFF_LZW_HASHSIZE slots
+            while (hashkeys[h]!=0 && hashkeys[h]!=key) h=(h+1)&(TINYTIFF_LZW_HASHSIZE-1);
+            if (hashkeys[h]==key) {
+                prefix=hashcodes[h];
+                continue;
+            }
+            // emit the longest known string and add it, extended by c, to the table
+            bitbuf=(bitbuf<<width)|prefix;
+            bitcount+=width;
+            hashkeys[h]=key;
+            hashcodes[h]=(uint16_t)next;
+            next++;
+            if (next==TINYTIFF_LZW_MAXCODES-2) {
+                bitbuf=(bitbuf<<width)|TINYTIFF_LZW_CLEAR;
+                bitcount+=width;
+                memset(hashkeys, 0, sizeof(hashkeys));
+                next=TINYTIFF_LZW_FIRSTCODE;
+                width=9;
+            } else if (next==(1u<<width)) {
+                width++;
+            }
+            while (bitcount>=8) {
+                bitcount-=8;
+                dst[o++]=(uint8_t)(bitbuf>>bitcount);
+            }
+            prefix=c;
+        }
+        bitbuf=(bitbuf<<width)|prefix;
+        bitcount+=width;
+        next++;
+        if (next==(1u<<width) && width<12) width++;
+        bitbuf=(bitbuf<<width)|TINYTIFF_LZW_EOI;
+        bitcount+=width;
+    }
+    while (bitcount>=8) {
+        bitcount-=8;
+        dst[o++]=(uint8_t)(bitbuf>>bitcount);
+    }
+    if (bitcount>0) dst[o++]=(uint8_t)(bitbuf<<(8-bitcount));
+    return o;
+}
+
+void TinyTIFF_deflateCodecRelease(TinyTIFF_DeflateCodec* codec) {
+#if defined(TINYTIFF_HAVE_LIBDEFLATE)
+    if (codec->encoder) libdeflate_free_compressor((struct libdeflate_compressor*)codec->encoder);
+    if (codec->decoder) libdeflate_free_decompressor((struct libdeflate_decompressor*)codec->decoder);
+#elif defined(TINYTIFF_HAVE_ZLIB)
+    if (codec->encoder) deflateEnd((z_stream*)codec->encoder);
+    if (codec->decoder) inflateEnd((z_stream*)codec->decoder);
+    free(codec->encoder);
+    free(codec->decoder);
+#endif
+    codec->encoder=NULL;
+    codec->level=0;
+    codec->decoder=NULL;
+}
+
+#ifdef TINYTIFF_HAVE_DEFLATE
+size_t TinyTIFF_deflateMaxEncodedSize(size_t size) {
+#ifdef TINYTIFF_HAVE_LIBDEFLATE
+    // libdeflate needs at most 5 bytes per block of at least 5000 bytes, plus some padding and the zlib header and checksum
+    return size+5*(size/5000+1)+32;
+#else
+    return (size_t)compressBound((uLong)size);
+#endif
+}
+
+size_t TinyTIFF_deflateEncode(TinyTIFF_DeflateCodec* codec, const uint8_t* src, size_t size, uint8_t* dst, int level) {
+#ifdef TINYTIFF_HAVE_LIBDEFLATE
+    if (level<1) level=1;
+    if (level>12) level=12;
+    if (codec->encoder && codec->level!=level) {
+        libdeflate_free_compressor((struct libdeflate_compressor*)codec->encoder);
+        codec->encoder=NULL;
+    }
+    if (!codec->encoder) {
+        codec->encoder=libdeflate_alloc_compressor(level);
+        if (!codec->encoder) return 0;
+        codec->level=level;
+    }
+    return libdeflate_zlib_compress((struct libdeflate_compressor*)codec->encoder, src, size, dst, TinyTIFF_deflateMaxEncodedSize(size));
+#else
+    if (level<1) level=1;
+    if (level>9) level=9;
+    z_stream* stream=(z_stream*)codec->encoder;
+    if (stream && codec->level!=level) {
+        deflateEnd(stream);
+        free(stream);
+        stream=codec->encoder=NULL;
+    }
+    if (!stream) {
+        stream=(z_stream*)calloc(1, sizeof(z_stream));
+        if (!stream) return 0;
+        if (deflateInit(stream, level)!=Z_OK) {
+            free(stream);
+            return 0;
+        }
+        codec->encoder=stream;
+        codec->level=level;
+    } else if (deflateReset(stream)!=Z_OK) {
+        return 0;
+    }
+    stream->avail_in=0;
+    // the sizes are passed in chunks, as zlib counts in (32-bit) uInt
+    const size_t dstsize=TinyTIFF_deflateMaxEncodedSize(size);
+    size_t in=0, out=0;
+    int res=Z_OK;
+    while (res==Z_OK) {
+        if (stream->avail_in==0 && in<size) {
+            stream->next_in=(Bytef*)(src+in);
+            stream->avail_in=(uInt)((size-in>0x40000000)?0x40000000:size-in);
+            in+=stream->avail_in;
+        }
+        stream->next_out=dst+out;
+        stream->avail_out=(uInt)((dstsize-out>0x40000000)?0x40000000:dstsize-out);
+        const uInt avail_out=stream->avail_out;
+        res=deflate(stream, (in>=size)?Z_FINISH:Z_NO_FLUSH);
+        out+=avail_out-stream->avail_out;
+    }
+    if (res!=Z_STREAM_END) return 0;
+    return out;
+#endif
+}
+
+size_t TinyTIFF_deflateDecode(TinyTIFF_DeflateCodec* codec, const uint8_t* src, size_t srcsize, uint8_t* dst, size_t dstsize) {
+#ifdef TINYTIFF_HAVE_LIBDEFLATE
+    size_t decoded=0;
+    if (!codec->decoder) {
+        codec->decoder=libdeflate_alloc_decompressor();
+        if (!codec->decoder) return 0;
+    }
+    struct libdeflate_decompressor* decompressor=(struct libdeflate_decompressor*)codec->decoder;
+    enum libdeflate_result res=libdeflate_zlib_decompress(decompressor, src, srcsize, dst, dstsize, &decoded);
+    if (res==LIBDEFLATE_INSUFFICIENT_SPACE) {
+        // the stream contains more than the requested data (e.g. a padded last strip): decode it completely and keep the start
+        size_t size=dstsize;
+        uint8_t* tmp=NULL;
+        decoded=0;
+        while (res==LIBDEFLATE_INSUFFICIENT_SPACE) {
+            size=2*size+1024;
+            free(tmp);
+            tmp=(uint8_t*)malloc(size);
+            if (!tmp) break;
+            res=libdeflate_zlib_decompress(decompressor, src, srcsize, tmp, size, &decoded);
+        }
+        if (tmp && res==LIBDEFLATE_SUCCESS) {
+            if (decoded>dstsize) decoded=dstsize;
+            memcpy(dst, tmp, decoded);
+        } else {
+            decoded=0;
+        }
+        free(tmp);
+    } else if (res!=LIBDEFLATE_SUCCESS) {
+        decoded=0;
+    }
+    return decoded;
+#else
+    if (!codec->decoder) {
+        z_stream* init=(z_stream*)calloc(1, sizeof(z_stream));
+        if (!init) return 0;
+        if (inflateInit(init)!=Z_OK) {
+            free(init);
+            return 0;
+        }
+        codec->decoder=init;
+    } else if (inflateReset((z_stream*)codec->decoder)!=Z_OK) {
+        return 0;
+    }
+    z_stream* stream=(z_stream*)codec->decoder;
+    // inflateReset() keeps the input of the previous strip, which may not have been consumed completely
+    stream->avail_in=0;
+    // the sizes are passed in chunks, as zlib counts in (32-bit) uInt
+    size_t in=0, out=0;
+    int res=Z_OK;
+    while (res==Z_OK && out<dstsize) {
+        if (stream->avail_in==0 && in<srcsize) {
+            stream->next_in=(Bytef*)(src+in);
+            stream->avail_in=(uInt)((srcsize-in>0x40000000)?0x40000000:srcsize-in);
+            in+=stream->avail_in;
+        }
+        stream->next_out=dst+out;
+        stream->avail_out=(uInt)((dstsize-out>0x40000000)?0x40000000:dstsize-out);
+        const uInt avail_out=stream->avail_out;
+        res=inflate(stream, Z_NO_FLUSH);
+        out+=avail_out-stream->avail_out;
+        if (res==Z_BUF_ERROR && stream->avail_in==0 && in>=srcsize) { res=Z_OK; break; } // truncated stream: return what could be decoded
+        if (res==Z_BUF_ERROR) res=Z_OK;
+    }
+    if (res!=Z_OK && res!=Z_STREAM_END) return 0;
+    return out;
+#endif
+}
+#endif
+
+static inline uint64_t TinyTIFF_loadSample(const uint8_t* p, uint16_t bytes, int bigEndian) {
+    uint64_t v=0;
+    uint16_t b;
+    if (bigEndian) {
+        for (b=0; b<bytes; b++) v=(v<<8)|p[b];
+    } else {
+        for (b=bytes; b>0; b--) v=(v<<8)|p[b-1];
+    }
+    return v;
+}
+
+static inline void TinyTIFF_storeSample(uint8_t* p, uint64_t v, uint16_t bytes, int bigEndian) {
+    uint16_t b;
+    if (bigEndian) {
+        for (b=bytes; b>0; b--) {
+            p[b-1]=(uint8_t)v;
+            v>>=8;
+        }
+    } else {
+        for (b=0; b<bytes; b++) {
+            p[b]=(uint8_t)v;
+            v>>=8;
+        }
+    }
+}
+
+void TinyTIFF_horizontalPredictorEncode(uint8_t* data, size_t size, size_t rowsize, uint16_t bytesPerSample, uint16_t samplesPerPixel, int bigEndian) {
+    size_t rowstart;
+    if (rowsize==0 || samplesPerPixel==0) return;
+    if (bytesPerSample!=1 && bytesPerSample!=2 && bytesPerSample!=4 && bytesPerSample!=8) return;
+    for (rowstart=0; rowstart<size; rowstart+=rowsize) {
+        uint8_t* row=data+rowstart;
+        const size_t n=((size-rowstart<rowsize)?size-rowstart:rowsize)/bytesPerSample;
+        const size_t stride=(size_t)samplesPerPixel*bytesPerSample;
+        size_t i;
+        // the row is processed back-to-front, so each difference is taken to the original value of the previous pixel
+        switch (bytesPerSample) {
+            case 1:
+                for (i=n; i>samplesPerPixel; i--) row[i-1]=(uint8_t)(row[i-1]-row[i-1-samplesPerPixel]);
+                break;
+            case 2:
+                for (i=n; i>samplesPerPixel; i--) {
+                    uint8_t* p=row+(i-1)*2;
+                    TinyTIFF_storeSample(p, TinyTIFF_loadSample(p, 2, bigEndian)-TinyTIFF_loadSample(p-stride, 2, bigEndian), 2, bigEndian);
+                }
+                break;
+            case 4:
+                for (i=n; i>samplesPerPixel; i--) {
+                    uint8_t* p=row+(i-1)*4;
+                    TinyTIFF_storeSample(p, TinyTIFF_loadSample(p, 4, bigEndian)-TinyTIFF_loadSample(p-stride, 4, bigEndian), 4, bigEndian);
+                }
+                break;
+            default:
+                for (i=n; i>samplesPerPixel; i--) {
+                    uint8_t* p=row+(i-1)*8;
+                    TinyTIFF_storeSample(p, TinyTIFF_loadSample(p, 8, bigEndian)-TinyTIFF_loadSample(p-stride, 8, bigEndian), 8, bigEndian);
+                }
+                break;
+        }
+    }
+}
+
+void TinyTIFF_horizontalPredictorDecode(uint8_t* data, size_t size, size_t rowsize, uint16_t bytesPerSample, uint16_t samplesPerPixel, int bigEndian) {
+    size_t rowstart;
+    if (rowsize==0 || samplesPerPixel==0) return;
+    if (bytesPerSample!=1 && bytesPerSample!=2 && bytesPerSample!=4 && bytesPerSample!=8) return;
+    for (rowstart=0; rowstart<size; rowstart+=rowsize) {
+        uint8_t* row=data+rowstart;
+        const size_t n=((size-rowstart<rowsize)?size-rowstart:rowsize)/bytesPerSample;
+        const size_t stride=(size_t)samplesPerPixel*bytesPerSample;
+        size_t i;
+        // the sample size is passed as a constant, so the compiler can specialize the loads and stores for each case
+        switch (bytesPerSample) {
+            case 1:
+                for (i=samplesPerPixel; i<n; i++) row[i]=(uint8_t)(row[i]+row[i-samplesPerPixel]);
+                break;
+            case 2:
+                for (i=samplesPerPixel; i<n; i++) {
+                    uint8_t* p=row+i*2;
+                    TinyTIFF_storeSample(p, TinyTIFF_loadSample(p, 2, bigEndian)+TinyTIFF_loadSample(p-stride, 2, bigEndian), 2, bigEndian);
+                }
+                break;
+            case 4:
+                for (i=samplesPerPixel; i<n; i++) {
+                    uint8_t* p=row+i*4;
+                    TinyTIFF_storeSample(p, TinyTIFF_loadSample(p, 4, bigEndian)+TinyTIFF_loadSample(p-stride, 4, bigEndian), 4, bigEndian);
+                }
+                break;
+            default:
+                for (i=samplesPerPixel; i<n; i++) {
+                    uint8_t* p=row+i*8;
+                    TinyTIFF_storeSample(p, TinyTIFF_loadSample(p, 8, bigEndian)+TinyTIFF_loadSample(p-stride, 8, bigEndian), 8, bigEndian);
+                }
+                break;
+        }
+    }
+}
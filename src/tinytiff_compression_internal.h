@@ -0,0 +1,178 @@
+/*
+    Copyright (c) 2008-2024 Jan W. Krieger (<jan@jkrieger.de>), German Cancer Research Center (DKFZ) & IWR, University of Heidelberg
+
+    This software is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License (LGPL) as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+*/
+
+
+
+#ifndef TINYTIFF_COMPRESSION_INTERNAL_H
+#define TINYTIFF_COMPRESSION_INTERNAL_H
+
+/*! \file tinytiff_compression_internal.h
+    \brief encoders and decoders for the compression schemes, supported by TinyTIFFWriter and TinyTIFFReader
+    \internal
+
+    All functions work on memory buffers, i.e. on a single strip (or row) of image data at a time.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(TINYTIFF_HAVE_LIBDEFLATE) || defined(TINYTIFF_HAVE_ZLIB)
+/** \brief defined, if the library is built with support for Deflate compression (CMake option TinyTIFF_USE_DEFLATE) */
+#define TINYTIFF_HAVE_DEFLATE
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief state of the Deflate encoder and decoder, which is reused for all strips (see TinyTIFF_deflateEncode() and TinyTIFF_deflateDecode())
+    \internal
+
+    A zero-initialized codec is valid, the compressor and decompressor are allocated on first use and have to be released with
+    TinyTIFF_deflateCodecRelease(). A codec must not be used by several threads at the same time.
+ */
+typedef struct TinyTIFF_DeflateCodec {
+    /** \brief the compressor (libdeflate) or deflate stream (zlib), NULL until the first strip is encoded */
+    void* encoder;
+    /** \brief compression level of \c encoder */
+    int level;
+    /** \brief the decompressor (libdeflate) or inflate stream (zlib), NULL until the first strip is decoded */
+    void* decoder;
+} TinyTIFF_DeflateCodec;
+
+/*! \brief releases the compressor and decompressor of \a codec, which is zero-initialized afterwards (this does nothing, if the library is built without Deflate support)
+    \internal
+ */
+void TinyTIFF_deflateCodecRelease(TinyTIFF_DeflateCodec* codec);
+
+/*! \brief returns the maximum size of the PackBits encoding of \a size bytes (see TinyTIFF_packBitsEncode())
+    \internal
+ */
+size_t TinyTIFF_packBitsMaxEncodedSize(size_t size);
+
+/*! \brief encodes the \a size bytes in \a src with the PackBits scheme (TIFF compression 32773) into \a dst
+    \internal
+
+    Runs of 3 or more equal bytes are stored as a header byte <code>1-n</code> followed by the repeated byte, all other bytes are stored
+    as literal blocks of up to 128 bytes, each preceded by a header byte <code>n-1</code>. The TIFF specification requires that each
+    row of an image is encoded separately, so this function should be called once per row.
+
+    \param src the data to encode
+    \param size number of bytes in \a src
+    \param dst output buffer, has to hold at least TinyTIFF_packBitsMaxEncodedSize(\a size ) bytes
+    \return the number of bytes written to \a dst
+ */
+size_t TinyTIFF_packBitsEncode(const uint8_t* src, size_t size, uint8_t* dst);
+
+/*! \brief decodes the PackBits encoded data \a src (\a srcsize bytes) into \a dst, until \a dstsize bytes are decoded or the input ends
+    \internal
+
+    Header bytes of -128 are skipped (no-op), as required by the specification. Runs and literal blocks, which exceed \a dst or
+    \a src are truncated.
+
+    \return the number of bytes written to \a dst
+ */
+size_t TinyTIFF_packBitsDecode(const uint8_t* src, size_t srcsize, uint8_t* dst, size_t dstsize);
+
+/*! \brief decodes the LZW compressed data \a src (\a srcsize bytes, TIFF compression 5) into \a dst, until \a dstsize bytes are decoded, an EndOfInformation code is found or the input ends
+    \internal
+
+    This implements the LZW variant of the TIFF specification, i.e. codes of 9 to 12 bits, stored MSB-first, with the code width switching
+    one code early. The old-style (LSB-first) LZW of very early libtiff versions is not supported. Each strip has to be decoded separately.
+
+    The string table stores for each code its prefix code, last byte, first byte and length, so each code is written back-to-front into
+    \a dst without an intermediate stack.
+
+    \return the number of bytes written to \a dst
+ */
+size_t TinyTIFF_lzwDecode(const uint8_t* src, size_t srcsize, uint8_t* dst, size_t dstsize);
+
+/*! \brief returns the maximum size of the LZW encoding of \a size bytes (see TinyTIFF_lzwEncode())
+    \internal
+ */
+size_t TinyTIFF_lzwMaxEncodedSize(size_t size);
+
+/*! \brief encodes the \a size bytes in \a src with the LZW scheme of the TIFF specification (TIFF compression 5) into \a dst
+    \internal
+
+    The output starts with a Clear code and ends with an EndOfInformation code, so each strip has to be encoded with a separate call.
+    The codes are 9 to 12 bits wide and written MSB-first. As in libtiff, the code width is increased as soon as the next free code
+    does not fit into the current width and the string table is cleared, when it is full. The strings in the table are found with an
+    open-addressing hash table over (prefix code, next byte).
+
+    \param src the data to encode
+    \param size number of bytes in \a src
+    \param dst output buffer, has to hold at least TinyTIFF_lzwMaxEncodedSize(\a size ) bytes
+    \return the number of bytes written to \a dst
+ */
+size_t TinyTIFF_lzwEncode(const uint8_t* src, size_t size, uint8_t* dst);
+
+#ifdef TINYTIFF_HAVE_DEFLATE
+/*! \brief returns the maximum size of the Deflate encoding of \a size bytes (see TinyTIFF_deflateEncode())
+    \internal
+ */
+size_t TinyTIFF_deflateMaxEncodedSize(size_t size);
+
+/*! \brief encodes the \a size bytes in \a src as a zlib stream (TIFF compression 8, Adobe Deflate) into \a dst
+    \internal
+
+    Depending on the build, libdeflate or zlib is used. Each call compresses a complete stream, i.e. one strip. The compressor of \a codec
+    is reused, as long as \a level does not change.
+
+    \param codec the (de)compressor state of the calling thread
+    \param src the data to encode
+    \param size number of bytes in \a src
+    \param dst output buffer, has to hold at least TinyTIFF_deflateMaxEncodedSize(\a size ) bytes
+    \param level compression level from 1 (fastest) to 9 (smallest output, libdeflate also supports up to 12), values outside this range are clamped
+    \return the number of bytes written to \a dst, or 0 on failure
+ */
+size_t TinyTIFF_deflateEncode(TinyTIFF_DeflateCodec* codec, const uint8_t* src, size_t size, uint8_t* dst, int level);
+
+/*! \brief decodes the zlib stream \a src (\a srcsize bytes) into \a dst, until \a dstsize bytes are decoded or the stream ends, using the decompressor of \a codec
+    \internal
+
+    \return the number of bytes written to \a dst
+ */
+size_t TinyTIFF_deflateDecode(TinyTIFF_DeflateCodec* codec, const uint8_t* src, size_t srcsize, uint8_t* dst, size_t dstsize);
+#endif
+
+/*! \brief applies the horizontal differencing (TIFF Predictor=2) in place, i.e. replaces each sample by its difference to the same sample of the previous pixel
+    \internal
+
+    The parameters are the same as for TinyTIFF_horizontalPredictorDecode(), which reverses this operation.
+ */
+void TinyTIFF_horizontalPredictorEncode(uint8_t* data, size_t size, size_t rowsize, uint16_t bytesPerSample, uint16_t samplesPerPixel, int bigEndian);
+
+/*! \brief reverses the horizontal differencing (TIFF Predictor=2) in place
+    \internal
+
+    \param data the decoded data of a strip, consisting of rows of \a rowsize bytes (the last row may be shorter)
+    \param size number of bytes in \a data
+    \param rowsize size of a single row in bytes
+    \param bytesPerSample size of a single sample in bytes (1, 2, 4 or 8), other values leave \a data unchanged
+    \param samplesPerPixel number of interleaved samples per pixel (1 for planar data), each sample is differenced with the same sample of the previous pixel
+    \param bigEndian if !=0, the samples are stored in big-endian byte order, otherwise in little-endian byte order
+ */
+void TinyTIFF_horizontalPredictorDecode(uint8_t* data, size_t size, size_t rowsize, uint16_t bytesPerSample, uint16_t samplesPerPixel, int bigEndian);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TINYTIFF_COMPRESSION_INTERNAL_H
@@ -23,9 +23,11 @@
 
 #if defined(HAVE_FTELLI64) || defined(HAVE_FTELLO64)
 #  define TINYTIFF_MAX_FILE_SIZE (0xFFFFFFFE)
+#  define TINYTIFF_MAX_BIGTIFF_FILE_SIZE (0x7FFFFFFFFFFFFFFFLL)
 #else
 #  warning COMPILING TinyTIFFWriter without LARGE_FILE_SUPPORT ... File size is limited to 2GB!
-#  define TINYTIFF_MAX_FILE_SIZE (2*1024*1024*1024-1)
+#  define TINYTIFF_MAX_FILE_SIZE (0x7FFFFFFF)
+#  define TINYTIFF_MAX_BIGTIFF_FILE_SIZE TINYTIFF_MAX_FILE_SIZE
 #endif
 
 
@@ -0,0 +1,576 @@
+/*
+    Copyright (c) 2008-2024 Jan W. Krieger (<jan@jkrieger.de>), German Cancer Research Center (DKFZ) & IWR, University of Heidelberg
+
+    This software is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License (LGPL) as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+*/
+
+#include "tinytiff_simd_internal.h"
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#  define TINYTIFF_SIMD_SSE2
+#  include <emmintrin.h>
+#endif
+// SSSE3 and AVX2 are not part of the x86-64 baseline, so they are only used if the compiler may use them everywhere
+#if defined(TINYTIFF_SIMD_SSE2) && (defined(__SSSE3__) || defined(__AVX__))
+#  define TINYTIFF_SIMD_SSSE3
+#  include <tmmintrin.h>
+#endif
+#if defined(TINYTIFF_SIMD_SSSE3) && defined(__AVX2__)
+#  define TINYTIFF_SIMD_AVX2
+#  include <immintrin.h>
+#endif
+
+
+/*! \brief portable implementation of TinyTIFF_deinterleave() for the pixels \a start ... \a pixels-1
+    \internal
+ */
+static inline void TinyTIFF_deinterleave_generic(const uint8_t* src, uint8_t* const* dst, size_t start, size_t pixels, uint16_t samples, size_t bytesPerSample) {
+    const size_t pixelsize=(size_t)samples*bytesPerSample;
+    size_t i;
+    uint16_t s;
+    for (i=start; i<pixels; i++) {
+        const uint8_t* p=src+i*pixelsize;
+        for (s=0; s<samples; s++) {
+            memcpy(dst[s]+i*bytesPerSample, p+s*bytesPerSample, bytesPerSample);
+        }
+    }
+}
+
+/*! \brief portable implementation of TinyTIFF_deinterleave() for the pixels \a start ... \a pixels-1
+    \internal
+
+    TinyTIFF_deinterleave_generic() is instanciated for the common sample sizes and sample counts, so the compiler can
+    unroll the inner loop and replace the memcpy() calls by single loads/stores.
+ */
+static void TinyTIFF_deinterleave_scalar(const uint8_t* src, uint8_t* const* dst, size_t start, size_t pixels, uint16_t samples, uint16_t bytesPerSample) {
+#define TINYTIFF_DEINTERLEAVE_SCALAR_CASE(BYTES) \
+        case BYTES: \
+            switch(samples) { \
+                case 2: TinyTIFF_deinterleave_generic(src, dst, start, pixels, 2, BYTES); return; \
+                case 3: TinyTIFF_deinterleave_generic(src, dst, start, pixels, 3, BYTES); return; \
+                case 4: TinyTIFF_deinterleave_generic(src, dst, start, pixels, 4, BYTES); return; \
+                default: TinyTIFF_deinterleave_generic(src, dst, start, pixels, samples, BYTES); return; \
+            }
+    switch(bytesPerSample) {
+        TINYTIFF_DEINTERLEAVE_SCALAR_CASE(1)
+        TINYTIFF_DEINTERLEAVE_SCALAR_CASE(2)
+        TINYTIFF_DEINTERLEAVE_SCALAR_CASE(4)
+        TINYTIFF_DEINTERLEAVE_SCALAR_CASE(8)
+        default: TinyTIFF_deinterleave_generic(src, dst, start, pixels, samples, bytesPerSample); return;
+    }
+#undef TINYTIFF_DEINTERLEAVE_SCALAR_CASE
+}
+
+/*! \brief portable implementation of TinyTIFF_extractSample() for the pixels \a start ... \a pixels-1
+    \internal
+ */
+static inline void TinyTIFF_extractSample_generic(const uint8_t* src, uint8_t* dst, size_t start, size_t pixels, uint16_t samples, uint16_t sample, size_t bytesPerSample) {
+    const size_t pixelsize=(size_t)samples*bytesPerSample;
+    const uint8_t* p=src+start*pixelsize+sample*bytesPerSample;
+    size_t i;
+    for (i=start; i<pixels; i++) {
+        memcpy(dst+i*bytesPerSample, p, bytesPerSample);
+        p+=pixelsize;
+    }
+}
+
+/*! \brief portable implementation of TinyTIFF_extractSample() for the pixels \a start ... \a pixels-1
+    \internal
+
+    TinyTIFF_extractSample_generic() is instanciated for the common sample sizes and sample counts, see TinyTIFF_deinterleave_scalar().
+ */
+static void TinyTIFF_extractSample_scalar(const uint8_t* src, uint8_t* dst, size_t start, size_t pixels, uint16_t samples, uint16_t sample, uint16_t bytesPerSample) {
+#define TINYTIFF_EXTRACTSAMPLE_SCALAR_CASE(BYTES) \
+        case BYTES: \
+            switch(samples) { \
+                case 2: TinyTIFF_extractSample_generic(src, dst, start, pixels, 2, sample, BYTES); return; \
+                case 3: TinyTIFF_extractSample_generic(src, dst, start, pixels, 3, sample, BYTES); return; \
+                case 4: TinyTIFF_extractSample_generic(src, dst, start, pixels, 4, sample, BYTES); return; \
+                default: TinyTIFF_extractSample_generic(src, dst, start, pixels, samples, sample, BYTES); return; \
+            }
+    switch(bytesPerSample) {
+        TINYTIFF_EXTRACTSAMPLE_SCALAR_CASE(1)
+        TINYTIFF_EXTRACTSAMPLE_SCALAR_CASE(2)
+        TINYTIFF_EXTRACTSAMPLE_SCALAR_CASE(4)
+        TINYTIFF_EXTRACTSAMPLE_SCALAR_CASE(8)
+        default: TinyTIFF_extractSample_generic(src, dst, start, pixels, samples, sample, bytesPerSample); return;
+    }
+#undef TINYTIFF_EXTRACTSAMPLE_SCALAR_CASE
+}
+
+/*! \brief portable implementation of TinyTIFF_interleave() for the pixels \a start ... \a pixels-1
+    \internal
+ */
+static inline void TinyTIFF_interleave_generic(const uint8_t* const* src, uint8_t* dst, size_t start, size_t pixels, uint16_t samples, size_t bytesPerSample) {
+    const size_t pixelsize=(size_t)samples*bytesPerSample;
+    size_t i;
+    uint16_t s;
+    for (i=start; i<pixels; i++) {
+        uint8_t* p=dst+i*pixelsize;
+        for (s=0; s<samples; s++) {
+            memcpy(p+s*bytesPerSample, src[s]+i*bytesPerSample, bytesPerSample);
+        }
+    }
+}
+
+/*! \brief portable implementation of TinyTIFF_interleave() for the pixels \a start ... \a pixels-1
+    \internal
+
+    TinyTIFF_interleave_generic() is instanciated for the common sample sizes and sample counts, see TinyTIFF_deinterleave_scalar().
+ */
+static void TinyTIFF_interleave_scalar(const uint8_t* const* src, uint8_t* dst, size_t start, size_t pixels, uint16_t samples, uint16_t bytesPerSample) {
+#define TINYTIFF_INTERLEAVE_SCALAR_CASE(BYTES) \
+        case BYTES: \
+            switch(samples) { \
+                case 2: TinyTIFF_interleave_generic(src, dst, start, pixels, 2, BYTES); return; \
+                case 3: TinyTIFF_interleave_generic(src, dst, start, pixels, 3, BYTES); return; \
+                case 4: TinyTIFF_interleave_generic(src, dst, start, pixels, 4, BYTES); return; \
+                default: TinyTIFF_interleave_generic(src, dst, start, pixels, samples, BYTES); return; \
+            }
+    switch(bytesPerSample) {
+        TINYTIFF_INTERLEAVE_SCALAR_CASE(1)
+        TINYTIFF_INTERLEAVE_SCALAR_CASE(2)
+        TINYTIFF_INTERLEAVE_SCALAR_CASE(4)
+        TINYTIFF_INTERLEAVE_SCALAR_CASE(8)
+        default: TinyTIFF_interleave_generic(src, dst, start, pixels, samples, bytesPerSample); return;
+    }
+#undef TINYTIFF_INTERLEAVE_SCALAR_CASE
+}
+
+#ifdef TINYTIFF_SIMD_SSE2
+
+/*! \brief splits the elements of size \a elementsize (1,2,4,8 or 16 bytes) in the vectors \a a and \a b into the elements with an even
+           (\a even ) and an odd (\a odd ) index, i.e. <code>a=[x0 y0 x1 y1 ...], b=[... xn yn] -> even=[x0 x1 ... xn], odd=[y0 y1 ... yn]</code>
+    \internal
+
+    The 1- and 2-byte variants sign-extend each element into the upper half of its lane, so the saturating pack instructions of SSE2
+    reproduce the original bit-pattern.
+ */
+static inline void TinyTIFF_split_sse2(__m128i a, __m128i b, __m128i* even, __m128i* odd, size_t elementsize) {
+    switch(elementsize) {
+        case 1:
+            *even=_mm_packs_epi16(_mm_srai_epi16(_mm_slli_epi16(a, 8), 8), _mm_srai_epi16(_mm_slli_epi16(b, 8), 8));
+            *odd=_mm_packs_epi16(_mm_srai_epi16(a, 8), _mm_srai_epi16(b, 8));
+            break;
+        case 2:
+            *even=_mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16), _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+            *odd=_mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+            break;
+        case 4:
+            *even=_mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2,0,2,0)));
+            *odd=_mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3,1,3,1)));
+            break;
+        case 8:
+            *even=_mm_unpacklo_epi64(a, b);
+            *odd=_mm_unpackhi_epi64(a, b);
+            break;
+        default:
+            *even=a;
+            *odd=b;
+            break;
+    }
+}
+
+/*! \brief SSE2 implementation of TinyTIFF_deinterleave() for 2 samples per pixel
+    \internal
+
+    \return the number of pixels that were processed (the rest has to be processed by TinyTIFF_deinterleave_scalar())
+ */
+static inline size_t TinyTIFF_deinterleave2_sse2(const uint8_t* src, uint8_t* const* dst, size_t pixels, size_t bytesPerSample) {
+    const size_t pixelsPerBlock=16/bytesPerSample;
+    size_t i;
+    for (i=0; i+pixelsPerBlock<=pixels; i+=pixelsPerBlock) {
+        const uint8_t* p=src+i*2*bytesPerSample;
+        __m128i s0, s1;
+        TinyTIFF_split_sse2(_mm_loadu_si128((const __m128i*)p), _mm_loadu_si128((const __m128i*)(p+16)), &s0, &s1, bytesPerSample);
+        _mm_storeu_si128((__m128i*)(dst[0]+i*bytesPerSample), s0);
+        _mm_storeu_si128((__m128i*)(dst[1]+i*bytesPerSample), s1);
+    }
+    return i;
+}
+
+/*! \brief SSE2 implementation of TinyTIFF_deinterleave() for 4 samples per pixel
+    \internal
+
+    The samples are separated in two steps: first into the pairs (sample 0,1) and (sample 2,3), then into the single samples.
+
+    \return the number of pixels that were processed (the rest has to be processed by TinyTIFF_deinterleave_scalar())
+ */
+static inline size_t TinyTIFF_deinterleave4_sse2(const uint8_t* src, uint8_t* const* dst, size_t pixels, size_t bytesPerSample) {
+    const size_t pixelsPerBlock=16/bytesPerSample;
+    size_t i;
+    for (i=0; i+pixelsPerBlock<=pixels; i+=pixelsPerBlock) {
+        const uint8_t* p=src+i*4*bytesPerSample;
+        __m128i a0, b0, a1, b1, s0, s1, s2, s3;
+        TinyTIFF_split_sse2(_mm_loadu_si128((const __m128i*)p), _mm_loadu_si128((const __m128i*)(p+16)), &a0, &b0, 2*bytesPerSample);
+        TinyTIFF_split_sse2(_mm_loadu_si128((const __m128i*)(p+32)), _mm_loadu_si128((const __m128i*)(p+48)), &a1, &b1, 2*bytesPerSample);
+        TinyTIFF_split_sse2(a0, a1, &s0, &s1, bytesPerSample);
+        TinyTIFF_split_sse2(b0, b1, &s2, &s3, bytesPerSample);
+        _mm_storeu_si128((__m128i*)(dst[0]+i*bytesPerSample), s0);
+        _mm_storeu_si128((__m128i*)(dst[1]+i*bytesPerSample), s1);
+        _mm_storeu_si128((__m128i*)(dst[2]+i*bytesPerSample), s2);
+        _mm_storeu_si128((__m128i*)(dst[3]+i*bytesPerSample), s3);
+    }
+    return i;
+}
+
+/*! \brief SSE2 implementation of TinyTIFF_extractSample() for 2 samples per pixel
+    \internal
+
+    \return the number of pixels that were processed (the rest has to be processed by TinyTIFF_extractSample_scalar())
+ */
+static inline size_t TinyTIFF_extractSample2_sse2(const uint8_t* src, uint8_t* dst, size_t pixels, uint16_t sample, size_t bytesPerSample) {
+    const size_t pixelsPerBlock=16/bytesPerSample;
+    size_t i;
+    for (i=0; i+pixelsPerBlock<=pixels; i+=pixelsPerBlock) {
+        const uint8_t* p=src+i*2*bytesPerSample;
+        __m128i s0, s1;
+        TinyTIFF_split_sse2(_mm_loadu_si128((const __m128i*)p), _mm_loadu_si128((const __m128i*)(p+16)), &s0, &s1, bytesPerSample);
+        _mm_storeu_si128((__m128i*)(dst+i*bytesPerSample), (sample==0)?s0:s1);
+    }
+    return i;
+}
+
+/*! \brief SSE2 implementation of TinyTIFF_extractSample() for 4 samples per pixel
+    \internal
+
+    \return the number of pixels that were processed (the rest has to be processed by TinyTIFF_extractSample_scalar())
+ */
+static inline size_t TinyTIFF_extractSample4_sse2(const uint8_t* src, uint8_t* dst, size_t pixels, uint16_t sample, size_t bytesPerSample) {
+    const size_t pixelsPerBlock=16/bytesPerSample;
+    size_t i;
+    for (i=0; i+pixelsPerBlock<=pixels; i+=pixelsPerBlock) {
+        const uint8_t* p=src+i*4*bytesPerSample;
+        __m128i a0, b0, a1, b1, s0, s1;
+        TinyTIFF_split_sse2(_mm_loadu_si128((const __m128i*)p), _mm_loadu_si128((const __m128i*)(p+16)), &a0, &b0, 2*bytesPerSample);
+        TinyTIFF_split_sse2(_mm_loadu_si128((const __m128i*)(p+32)), _mm_loadu_si128((const __m128i*)(p+48)), &a1, &b1, 2*bytesPerSample);
+        if (sample<2) TinyTIFF_split_sse2(a0, a1, &s0, &s1, bytesPerSample);
+        else TinyTIFF_split_sse2(b0, b1, &s0, &s1, bytesPerSample);
+        _mm_storeu_si128((__m128i*)(dst+i*bytesPerSample), (sample%2==0)?s0:s1);
+    }
+    return i;
+}
+
+/*! \brief interleaves the elements of size \a elementsize (1,2,4,8 or 16 bytes) in the vectors \a a and \a b,
+           i.e. <code>a=[x0 x1 ... xn], b=[y0 y1 ... yn] -> lo=[x0 y0 x1 y1 ...], hi=[... xn yn]</code>
+    \internal
+
+    This is the inverse of TinyTIFF_split_sse2().
+ */
+static inline void TinyTIFF_zip_sse2(__m128i a, __m128i b, __m128i* lo, __m128i* hi, size_t elementsize) {
+    switch(elementsize) {
+        case 1:
+            *lo=_mm_unpacklo_epi8(a, b);
+            *hi=_mm_unpackhi_epi8(a, b);
+            break;
+        case 2:
+            *lo=_mm_unpacklo_epi16(a, b);
+            *hi=_mm_unpackhi_epi16(a, b);
+            break;
+        case 4:
+            *lo=_mm_unpacklo_epi32(a, b);
+            *hi=_mm_unpackhi_epi32(a, b);
+            break;
+        case 8:
+            *lo=_mm_unpacklo_epi64(a, b);
+            *hi=_mm_unpackhi_epi64(a, b);
+            break;
+        default:
+            *lo=a;
+            *hi=b;
+            break;
+    }
+}
+
+/*! \brief SSE2 implementation of TinyTIFF_interleave() for 2 samples per pixel
+    \internal
+
+    \return the number of pixels that were processed (the rest has to be processed by TinyTIFF_interleave_scalar())
+ */
+static inline size_t TinyTIFF_interleave2_sse2(const uint8_t* const* src, uint8_t* dst, size_t pixels, size_t bytesPerSample) {
+    const size_t pixelsPerBlock=16/bytesPerSample;
+    size_t i;
+    for (i=0; i+pixelsPerBlock<=pixels; i+=pixelsPerBlock) {
+        uint8_t* p=dst+i*2*bytesPerSample;
+        __m128i lo, hi;
+        TinyTIFF_zip_sse2(_mm_loadu_si128((const __m128i*)(src[0]+i*bytesPerSample)), _mm_loadu_si128((const __m128i*)(src[1]+i*bytesPerSample)), &lo, &hi, bytesPerSample);
+        _mm_storeu_si128((__m128i*)p, lo);
+        _mm_storeu_si128((__m128i*)(p+16), hi);
+    }
+    return i;
+}
+
+/*! \brief SSE2 implementation of TinyTIFF_interleave() for 4 samples per pixel
+    \internal
+
+    The samples are combined in two steps: first into the pairs (sample 0,1) and (sample 2,3), then into complete pixels.
+
+    \return the number of pixels that were processed (the rest has to be processed by TinyTIFF_interleave_scalar())
+ */
+static inline size_t TinyTIFF_interleave4_sse2(const uint8_t* const* src, uint8_t* dst, size_t pixels, size_t bytesPerSample) {
+    const size_t pixelsPerBlock=16/bytesPerSample;
+    size_t i;
+    for (i=0; i+pixelsPerBlock<=pixels; i+=pixelsPerBlock) {
+        uint8_t* p=dst+i*4*bytesPerSample;
+        __m128i a0, a1, b0, b1, p0, p1, p2, p3;
+        TinyTIFF_zip_sse2(_mm_loadu_si128((const __m128i*)(src[0]+i*bytesPerSample)), _mm_loadu_si128((const __m128i*)(src[1]+i*bytesPerSample)), &a0, &a1, bytesPerSample);
+        TinyTIFF_zip_sse2(_mm_loadu_si128((const __m128i*)(src[2]+i*bytesPerSample)), _mm_loadu_si128((const __m128i*)(src[3]+i*bytesPerSample)), &b0, &b1, bytesPerSample);
+        TinyTIFF_zip_sse2(a0, b0, &p0, &p1, 2*bytesPerSample);
+        TinyTIFF_zip_sse2(a1, b1, &p2, &p3, 2*bytesPerSample);
+        _mm_storeu_si128((__m128i*)p, p0);
+        _mm_storeu_si128((__m128i*)(p+16), p1);
+        _mm_storeu_si128((__m128i*)(p+32), p2);
+        _mm_storeu_si128((__m128i*)(p+48), p3);
+    }
+    return i;
+}
+
+#endif // TINYTIFF_SIMD_SSE2
+
+void TinyTIFF_deinterleave(const void* src, void* const* dst, size_t pixels, uint16_t samples, uint16_t bytesPerSample) {
+    const uint8_t* src8=(const uint8_t*)src;
+    uint8_t* const* dst8=(uint8_t* const*)dst;
+    size_t done=0;
+    if (samples==0 || bytesPerSample==0) return;
+    if (samples==1) {
+        memcpy(dst8[0], src8, pixels*bytesPerSample);
+        return;
+    }
+#ifdef TINYTIFF_SIMD_SSE2
+    if (bytesPerSample==1 || bytesPerSample==2 || bytesPerSample==4 || bytesPerSample==8) {
+        // the constant arguments allow the compiler to specialize the kernels for each sample size
+        if (samples==2) {
+            switch(bytesPerSample) {
+                case 1: done=TinyTIFF_deinterleave2_sse2(src8, dst8, pixels, 1); break;
+                case 2: done=TinyTIFF_deinterleave2_sse2(src8, dst8, pixels, 2); break;
+                case 4: done=TinyTIFF_deinterleave2_sse2(src8, dst8, pixels, 4); break;
+                case 8: done=TinyTIFF_deinterleave2_sse2(src8, dst8, pixels, 8); break;
+            }
+        } else if (samples==4) {
+            switch(bytesPerSample) {
+                case 1: done=TinyTIFF_deinterleave4_sse2(src8, dst8, pixels, 1); break;
+                case 2: done=TinyTIFF_deinterleave4_sse2(src8, dst8, pixels, 2); break;
+                case 4: done=TinyTIFF_deinterleave4_sse2(src8, dst8, pixels, 4); break;
+                case 8: done=TinyTIFF_deinterleave4_sse2(src8, dst8, pixels, 8); break;
+            }
+        }
+    }
+#endif
+    TinyTIFF_deinterleave_scalar(src8, dst8, done, pixels, samples, bytesPerSample);
+}
+
+void TinyTIFF_interleave(const void* const* src, void* dst, size_t pixels, uint16_t samples, uint16_t bytesPerSample) {
+    const uint8_t* const* src8=(const uint8_t* const*)src;
+    uint8_t* dst8=(uint8_t*)dst;
+    size_t done=0;
+    if (samples==0 || bytesPerSample==0) return;
+    if (samples==1) {
+        memcpy(dst8, src8[0], pixels*bytesPerSample);
+        return;
+    }
+#ifdef TINYTIFF_SIMD_SSE2
+    if (bytesPerSample==1 || bytesPerSample==2 || bytesPerSample==4 || bytesPerSample==8) {
+        // the constant arguments allow the compiler to specialize the kernels for each sample size
+        if (samples==2) {
+            switch(bytesPerSample) {
+                case 1: done=TinyTIFF_interleave2_sse2(src8, dst8, pixels, 1); break;
+                case 2: done=TinyTIFF_interleave2_sse2(src8, dst8, pixels, 2); break;
+                case 4: done=TinyTIFF_interleave2_sse2(src8, dst8, pixels, 4); break;
+                case 8: done=TinyTIFF_interleave2_sse2(src8, dst8, pixels, 8); break;
+            }
+        } else if (samples==4) {
+            switch(bytesPerSample) {
+                case 1: done=TinyTIFF_interleave4_sse2(src8, dst8, pixels, 1); break;
+                case 2: done=TinyTIFF_interleave4_sse2(src8, dst8, pixels, 2); break;
+                case 4: done=TinyTIFF_interleave4_sse2(src8, dst8, pixels, 4); break;
+                case 8: done=TinyTIFF_interleave4_sse2(src8, dst8, pixels, 8); break;
+            }
+        }
+    }
+#endif
+    TinyTIFF_interleave_scalar(src8, dst8, done, pixels, samples, bytesPerSample);
+}
+
+void TinyTIFF_extractSample(const void* src, void* dst, size_t pixels, uint16_t samples, uint16_t sample, uint16_t bytesPerSample) {
+    const uint8_t* src8=(const uint8_t*)src;
+    uint8_t* dst8=(uint8_t*)dst;
+    size_t done=0;
+    if (sample>=samples || bytesPerSample==0) return;
+    if (samples==1) {
+        memcpy(dst8, src8, pixels*bytesPerSample);
+        return;
+    }
+#ifdef TINYTIFF_SIMD_SSE2
+    if (bytesPerSample==1 || bytesPerSample==2 || bytesPerSample==4 || bytesPerSample==8) {
+        // the constant arguments allow the compiler to specialize the kernels for each sample size
+        if (samples==2) {
+            switch(bytesPerSample) {
+                case 1: done=TinyTIFF_extractSample2_sse2(src8, dst8, pixels, sample, 1); break;
+                case 2: done=TinyTIFF_extractSample2_sse2(src8, dst8, pixels, sample, 2); break;
+                case 4: done=TinyTIFF_extractSample2_sse2(src8, dst8, pixels, sample, 4); break;
+                case 8: done=TinyTIFF_extractSample2_sse2(src8, dst8, pixels, sample, 8); break;
+            }
+        } else if (samples==4) {
+            switch(bytesPerSample) {
+                case 1: done=TinyTIFF_extractSample4_sse2(src8, dst8, pixels, sample, 1); break;
+                case 2: done=TinyTIFF_extractSample4_sse2(src8, dst8, pixels, sample, 2); break;
+                case 4: done=TinyTIFF_extractSample4_sse2(src8, dst8, pixels, sample, 4); break;
+                case 8: done=TinyTIFF_extractSample4_sse2(src8, dst8, pixels, sample, 8); break;
+            }
+        }
+    }
+#endif
+    TinyTIFF_extractSample_scalar(src8, dst8, done, pixels, samples, sample, bytesPerSample);
+}
+
+/*! \brief portable implementation of TinyTIFF_byteswap() for the elements \a start ... \a count-1
+    \internal
+
+    The elements are accessed with memcpy(), as \a data may be unaligned. Compilers replace these calls and the shifts
+    by single loads/stores and byte-swap instructions.
+ */
+static void TinyTIFF_byteswap_scalar(uint8_t* data, size_t start, size_t count, uint16_t bytesPerElement) {
+    size_t i;
+    switch(bytesPerElement) {
+        case 2:
+            for (i=start; i<count; i++) {
+                uint16_t v;
+                memcpy(&v, data+i*2, 2);
+                v=(uint16_t)((v>>8)|(v<<8));
+                memcpy(data+i*2, &v, 2);
+            }
+            break;
+        case 4:
+            for (i=start; i<count; i++) {
+                uint32_t v;
+                memcpy(&v, data+i*4, 4);
+                v=((v>>24)&0xFF)|((v>>8)&0xFF00)|((v<<8)&0xFF0000)|(v<<24);
+                memcpy(data+i*4, &v, 4);
+            }
+            break;
+        case 8:
+            for (i=start; i<count; i++) {
+                uint64_t v;
+                memcpy(&v, data+i*8, 8);
+                v=((v>>56)&0xFFULL)|((v>>40)&0xFF00ULL)|((v>>24)&0xFF0000ULL)|((v>>8)&0xFF000000ULL)
+                 |((v<<8)&0xFF00000000ULL)|((v<<24)&0xFF0000000000ULL)|((v<<40)&0xFF000000000000ULL)|(v<<56);
+                memcpy(data+i*8, &v, 8);
+            }
+            break;
+        default:
+            for (i=start; i<count; i++) {
+                uint8_t* p=data+i*bytesPerElement;
+                uint16_t j;
+                for (j=0; j<bytesPerElement/2; j++) {
+                    const uint8_t t=p[j];
+                    p[j]=p[bytesPerElement-1-j];
+                    p[bytesPerElement-1-j]=t;
+                }
+            }
+            break;
+    }
+}
+
+#if defined(TINYTIFF_SIMD_AVX2)
+
+/*! \brief AVX2 implementation of TinyTIFF_byteswap() (VPSHUFB, 32 bytes per step)
+    \internal
+
+    \return the number of elements that were processed (the rest has to be processed by TinyTIFF_byteswap_scalar())
+ */
+static inline size_t TinyTIFF_byteswap_simd(uint8_t* data, size_t count, size_t bytesPerElement) {
+    const size_t bytes=count*bytesPerElement;
+    size_t i;
+    __m256i mask;
+    switch(bytesPerElement) {
+        case 2: mask=_mm256_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14, 1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14); break;
+        case 4: mask=_mm256_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12, 3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12); break;
+        case 8: mask=_mm256_setr_epi8(7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8, 7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8); break;
+        default: return 0;
+    }
+    for (i=0; i+32<=bytes; i+=32) {
+        _mm256_storeu_si256((__m256i*)(data+i), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(data+i)), mask));
+    }
+    return i/bytesPerElement;
+}
+
+#elif defined(TINYTIFF_SIMD_SSSE3)
+
+/*! \brief SSSE3 implementation of TinyTIFF_byteswap() (PSHUFB, 16 bytes per step)
+    \internal
+
+    \return the number of elements that were processed (the rest has to be processed by TinyTIFF_byteswap_scalar())
+ */
+static inline size_t TinyTIFF_byteswap_simd(uint8_t* data, size_t count, size_t bytesPerElement) {
+    const size_t bytes=count*bytesPerElement;
+    size_t i;
+    __m128i mask;
+    switch(bytesPerElement) {
+        case 2: mask=_mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14); break;
+        case 4: mask=_mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12); break;
+        case 8: mask=_mm_setr_epi8(7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8); break;
+        default: return 0;
+    }
+    for (i=0; i+16<=bytes; i+=16) {
+        _mm_storeu_si128((__m128i*)(data+i), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data+i)), mask));
+    }
+    return i/bytesPerElement;
+}
+
+#elif defined(TINYTIFF_SIMD_SSE2)
+
+/*! \brief SSE2 implementation of TinyTIFF_byteswap() (16 bytes per step)
+    \internal
+
+    SSE2 has no byte shuffle, so the 16-bit words of each element are reversed with PSHUFLW/PSHUFHW first, then
+    the two bytes of each word are exchanged with shifts.
+
+    \return the number of elements that were processed (the rest has to be processed by TinyTIFF_byteswap_scalar())
+ */
+static inline size_t TinyTIFF_byteswap_simd(uint8_t* data, size_t count, size_t bytesPerElement) {
+    const size_t bytes=count*bytesPerElement;
+    size_t i;
+    if (bytesPerElement!=2 && bytesPerElement!=4 && bytesPerElement!=8) return 0;
+    for (i=0; i+16<=bytes; i+=16) {
+        __m128i v=_mm_loadu_si128((const __m128i*)(data+i));
+        if (bytesPerElement==4) {
+            v=_mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2,3,0,1)), _MM_SHUFFLE(2,3,0,1));
+        } else if (bytesPerElement==8) {
+            v=_mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(0,1,2,3)), _MM_SHUFFLE(0,1,2,3));
+        }
+        v=_mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128((__m128i*)(data+i), v);
+    }
+    return i/bytesPerElement;
+}
+
+#endif
+
+void TinyTIFF_byteswap(void* data, size_t count, uint16_t bytesPerElement) {
+    uint8_t* data8=(uint8_t*)data;
+    size_t done=0;
+    if (bytesPerElement<2) return;
+#if defined(TINYTIFF_SIMD_SSE2)
+    // the constant arguments allow the compiler to specialize the kernel for each element size
+    switch(bytesPerElement) {
+        case 2: done=TinyTIFF_byteswap_simd(data8, count, 2); break;
+        case 4: done=TinyTIFF_byteswap_simd(data8, count, 4); break;
+        case 8: done=TinyTIFF_byteswap_simd(data8, count, 8); break;
+    }
+#endif
+    TinyTIFF_byteswap_scalar(data8, done, count, bytesPerElement);
+}
@@ -0,0 +1,92 @@
+/*
+    Copyright (c) 2008-2024 Jan W. Krieger (<jan@jkrieger.de>), German Cancer Research Center (DKFZ) & IWR, University of Heidelberg
+
+    This software is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License (LGPL) as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+*/
+
+
+
+#ifndef TINYTIFF_SIMD_INTERNAL_H
+#define TINYTIFF_SIMD_INTERNAL_H
+
+/*! \file tinytiff_simd_internal.h
+    \brief vectorized kernels to reorder sample data between interleaved (chunky) and planar memory layouts and to convert its byte order
+    \internal
+
+    The kernels use SSE2 on x86/x86-64 (part of the x86-64 baseline, so no runtime dispatch is required) and
+    portable C code on all other platforms. TinyTIFF_byteswap() also uses SSSE3 (PSHUFB) or AVX2, if the library
+    is compiled for a CPU that supports them (e.g. with \c -march=native or \c /arch:AVX2 ).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief copies the \a samples interleaved samples of \a pixels pixels from \a src into the separate arrays \a dst[0] ... \a dst[samples-1]
+    \internal
+
+    \param src interleaved input data, i.e. <code>pixel0sample0, pixel0sample1, ..., pixel1sample0, ...</code>
+    \param dst array of \a samples output arrays, each receives \a pixels values
+    \param pixels number of pixels to copy
+    \param samples number of samples per pixel
+    \param bytesPerSample size of a single sample in bytes (any value is supported, 1, 2, 4 and 8 use vectorized kernels)
+ */
+void TinyTIFF_deinterleave(const void* src, void* const* dst, size_t pixels, uint16_t samples, uint16_t bytesPerSample);
+
+/*! \brief copies the \a pixels values of each of the \a samples separate arrays \a src[0] ... \a src[samples-1] into the interleaved array \a dst
+    \internal
+
+    This is the inverse of TinyTIFF_deinterleave().
+
+    \param src array of \a samples input arrays, each contains \a pixels values
+    \param dst interleaved output data, i.e. <code>pixel0sample0, pixel0sample1, ..., pixel1sample0, ...</code>
+    \param pixels number of pixels to copy
+    \param samples number of samples per pixel
+    \param bytesPerSample size of a single sample in bytes (any value is supported, 1, 2, 4 and 8 use vectorized kernels)
+ */
+void TinyTIFF_interleave(const void* const* src, void* dst, size_t pixels, uint16_t samples, uint16_t bytesPerSample);
+
+/*! \brief copies the sample \a sample of \a pixels interleaved pixels from \a src into the array \a dst
+    \internal
+
+    This does the same as TinyTIFF_deinterleave() for a single of the \a samples output arrays.
+
+    \param src interleaved input data, i.e. <code>pixel0sample0, pixel0sample1, ..., pixel1sample0, ...</code>
+    \param dst output array, receives \a pixels values
+    \param pixels number of pixels to copy
+    \param samples number of samples per pixel
+    \param sample the sample to copy (0 ... \a samples-1)
+    \param bytesPerSample size of a single sample in bytes (any value is supported, 1, 2, 4 and 8 use vectorized kernels)
+ */
+void TinyTIFF_extractSample(const void* src, void* dst, size_t pixels, uint16_t samples, uint16_t sample, uint16_t bytesPerSample);
+
+/*! \brief reverses the byte order of each of the \a count elements in \a data (in-place)
+    \internal
+
+    \param data the elements to convert, does not need to be aligned
+    \param count number of elements
+    \param bytesPerElement size of a single element in bytes (any value is supported, 2, 4 and 8 use vectorized kernels)
+ */
+void TinyTIFF_byteswap(void* data, size_t count, uint16_t bytesPerElement);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TINYTIFF_SIMD_INTERNAL_H
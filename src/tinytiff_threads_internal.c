@@ -0,0 +1,121 @@
+/*
+    Copyright (c) 2008-2024 Jan W. Krieger (<jan@jkrieger.de>), German Cancer Research Center (DKFZ) & IWR, University of Heidelberg
+
+    This software is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License (LGPL) as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+*/
+#include "tinytiff_threads_internal.h"
+#include "tinytiff_defs.h"
+#include <stdlib.h>
+#ifndef TINYTIFF_THREADS_WIN32
+#  include <unistd.h>
+#endif
+
+/*! \brief function and argument of a thread, passed to the native thread entry point
+    \internal
+ */
+typedef struct TinyTIFF_ThreadStart {
+    TinyTIFF_ThreadFunction func;
+    void* arg;
+} TinyTIFF_ThreadStart;
+
+#ifdef TINYTIFF_THREADS_WIN32
+
+static DWORD WINAPI TinyTIFF_Thread_entry(LPVOID param) {
+    TinyTIFF_ThreadStart start=*((TinyTIFF_ThreadStart*)param);
+    free(param);
+    start.func(start.arg);
+    return 0;
+}
+
+int TinyTIFF_Thread_create(TinyTIFF_Thread* thread, TinyTIFF_ThreadFunction func, void* arg) {
+    TinyTIFF_ThreadStart* start=(TinyTIFF_ThreadStart*)malloc(sizeof(TinyTIFF_ThreadStart));
+    if (!start) return TINYTIFF_FALSE;
+    start->func=func;
+    start->arg=arg;
+    *thread=CreateThread(NULL, 0, TinyTIFF_Thread_entry, start, 0, NULL);
+    if (*thread==NULL) {
+        free(start);
+        return TINYTIFF_FALSE;
+    }
+    return TINYTIFF_TRUE;
+}
+
+void TinyTIFF_Thread_join(TinyTIFF_Thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+int TinyTIFF_Thread_hardwareConcurrency() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors>0)?(int)info.dwNumberOfProcessors:1;
+}
+
+void TinyTIFF_Mutex_init(TinyTIFF_Mutex* mutex) { InitializeCriticalSection(mutex); }
+void TinyTIFF_Mutex_destroy(TinyTIFF_Mutex* mutex) { DeleteCriticalSection(mutex); }
+void TinyTIFF_Mutex_lock(TinyTIFF_Mutex* mutex) { EnterCriticalSection(mutex); }
+void TinyTIFF_Mutex_unlock(TinyTIFF_Mutex* mutex) { LeaveCriticalSection(mutex); }
+
+void TinyTIFF_Cond_init(TinyTIFF_Cond* cond) { InitializeConditionVariable(cond); }
+void TinyTIFF_Cond_destroy(TinyTIFF_Cond* cond) { (void)cond; }
+void TinyTIFF_Cond_wait(TinyTIFF_Cond* cond, TinyTIFF_Mutex* mutex) { SleepConditionVariableCS(cond, mutex, INFINITE); }
+void TinyTIFF_Cond_broadcast(TinyTIFF_Cond* cond) { WakeAllConditionVariable(cond); }
+
+#else
+
+static void* TinyTIFF_Thread_entry(void* param) {
+    TinyTIFF_ThreadStart start=*((TinyTIFF_ThreadStart*)param);
+    free(param);
+    start.func(start.arg);
+    return NULL;
+}
+
+int TinyTIFF_Thread_create(TinyTIFF_Thread* thread, TinyTIFF_ThreadFunction func, void* arg) {
+    TinyTIFF_ThreadStart* start=(TinyTIFF_ThreadStart*)malloc(sizeof(TinyTIFF_ThreadStart));
+    if (!start) return TINYTIFF_FALSE;
+    start->func=func;
+    start->arg=arg;
+    if (pthread_create(thread, NULL, TinyTIFF_Thread_entry, start)!=0) {
+        free(start);
+        return TINYTIFF_FALSE;
+    }
+    return TINYTIFF_TRUE;
+}
+
+void TinyTIFF_Thread_join(TinyTIFF_Thread thread) {
+    pthread_join(thread, NULL);
+}
+
+int TinyTIFF_Thread_hardwareConcurrency() {
+#ifdef _SC_NPROCESSORS_ONLN
+    const long n=sysconf(_SC_NPROCESSORS_ONLN);
+    return (n>0)?(int)n:1;
+#else
+    return 1;
+#endif
+}
+
+void TinyTIFF_Mutex_init(TinyTIFF_Mutex* mutex) { pthread_mutex_init(mutex, NULL); }
+void TinyTIFF_Mutex_destroy(TinyTIFF_Mutex* mutex) { pthread_mutex_destroy(mutex); }
+void TinyTIFF_Mutex_lock(TinyTIFF_Mutex* mutex) { pthread_mutex_lock(mutex); }
+void TinyTIFF_Mutex_unlock(TinyTIFF_Mutex* mutex) { pthread_mutex_unlock(mutex); }
+
+void TinyTIFF_Cond_init(TinyTIFF_Cond* cond) { pthread_cond_init(cond, NULL); }
+void TinyTIFF_Cond_destroy(TinyTIFF_Cond* cond) { pthread_cond_destroy(cond); }
+void TinyTIFF_Cond_wait(TinyTIFF_Cond* cond, TinyTIFF_Mutex* mutex) { pthread_cond_wait(cond, mutex); }
+void TinyTIFF_Cond_broadcast(TinyTIFF_Cond* cond) { pthread_cond_broadcast(cond); }
+
+#endif // TINYTIFF_THREADS_WIN32
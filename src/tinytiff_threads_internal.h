@@ -0,0 +1,88 @@
+/*
+    Copyright (c) 2008-2024 Jan W. Krieger (<jan@jkrieger.de>), German Cancer Research Center (DKFZ) & IWR, University of Heidelberg
+
+    This software is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License (LGPL) as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+*/
+
+
+#ifndef TINYTIFF_THREADS_INTERNAL_H
+#define TINYTIFF_THREADS_INTERNAL_H
+
+/*! \file tinytiff_threads_internal.h
+    \brief minimal portable wrapper around the native thread API (Win32 threads or pthreads)
+    \internal
+ */
+
+#if defined(WIN32) || defined(WIN64) || defined(_MSC_VER) || defined(_WIN32)
+#  define TINYTIFF_THREADS_WIN32
+#  include <windows.h>
+typedef HANDLE TinyTIFF_Thread;
+typedef CRITICAL_SECTION TinyTIFF_Mutex;
+typedef CONDITION_VARIABLE TinyTIFF_Cond;
+#else
+#  include <pthread.h>
+typedef pthread_t TinyTIFF_Thread;
+typedef pthread_mutex_t TinyTIFF_Mutex;
+typedef pthread_cond_t TinyTIFF_Cond;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief function executed by a thread, started with TinyTIFF_Thread_create()
+    \internal
+ */
+typedef void (*TinyTIFF_ThreadFunction)(void* arg);
+
+/*! \brief starts a new thread, which executes \c func(arg)
+    \internal
+
+    \return TINYTIFF_TRUE on success
+ */
+int TinyTIFF_Thread_create(TinyTIFF_Thread* thread, TinyTIFF_ThreadFunction func, void* arg);
+/*! \brief waits until the given thread has finished and releases its resources
+    \internal
+ */
+void TinyTIFF_Thread_join(TinyTIFF_Thread thread);
+/*! \brief returns the number of processors, available to this process (at least 1)
+    \internal
+ */
+int TinyTIFF_Thread_hardwareConcurrency();
+
+/*! \brief initializes a mutex \internal */
+void TinyTIFF_Mutex_init(TinyTIFF_Mutex* mutex);
+/*! \brief releases the resources of a mutex \internal */
+void TinyTIFF_Mutex_destroy(TinyTIFF_Mutex* mutex);
+/*! \brief locks a mutex \internal */
+void TinyTIFF_Mutex_lock(TinyTIFF_Mutex* mutex);
+/*! \brief unlocks a mutex \internal */
+void TinyTIFF_Mutex_unlock(TinyTIFF_Mutex* mutex);
+
+/*! \brief initializes a condition variable \internal */
+void TinyTIFF_Cond_init(TinyTIFF_Cond* cond);
+/*! \brief releases the resources of a condition variable \internal */
+void TinyTIFF_Cond_destroy(TinyTIFF_Cond* cond);
+/*! \brief atomically unlocks \a mutex and waits for \a cond, \a mutex is locked again on return \internal */
+void TinyTIFF_Cond_wait(TinyTIFF_Cond* cond, TinyTIFF_Mutex* mutex);
+/*! \brief wakes up all threads waiting for \a cond \internal */
+void TinyTIFF_Cond_broadcast(TinyTIFF_Cond* cond);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TINYTIFF_THREADS_INTERNAL_H
@@ -19,6 +19,9 @@
 #include "tinytiffreader.h"
 #include "tiff_definitions_internal.h"
 #include "tinytiff_ctools_internal.h"
+#include "tinytiff_compression_internal.h"
+#include "tinytiff_simd_internal.h"
+#include "tinytiff_threads_internal.h"
 #include "tinytiff_version.h"
 //#define DEBUG_IFDTIMING
 #ifdef DEBUG_IFDTIMING
@@ -54,6 +57,24 @@
 #  endif
 #endif // __WINDOWS__
 
+#ifdef __WINDOWS__
+#  include <windows.h>
+#  include <io.h>
+#  define TINYTIFF_HAVE_MEMORYMAPPING
+#elif defined(HAVE_MMAP)
+#  include <sys/mman.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  define TINYTIFF_HAVE_MEMORYMAPPING
+#endif
+
+#if !defined(__WINDOWS__) && defined(HAVE_PREAD)
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <errno.h>
+#  define TINYTIFF_HAVE_PREAD
+#endif
+
 #ifdef TINYTIFF_USE_WINAPI_FOR_FILEIO
 #  include <windows.h>
 #  ifdef _MSC_VER
@@ -61,7 +82,7 @@
 #  else
 #    warning COMPILING TinyTIFFWriter with WinAPI
 #  endif // _MSC_VER
-#  define TinyTIFFReader_POSTYPE DWORD
+#  define TinyTIFFReader_POSTYPE LARGE_INTEGER
 #else
 #  define TinyTIFFReader_POSTYPE fpos_t
 #endif // TINYTIFF_USE_WINAPI_FOR_FILEIO
@@ -94,10 +115,12 @@ typedef struct TinyTIFFReaderFrame {
     uint32_t width;
     uint32_t height;
     uint16_t compression;
+    /** \brief the Predictor, applied to the data before compression (TIFF_PREDICTOR_NONE or TIFF_PREDICTOR_HORIZONTAL) */
+    uint16_t predictor;
 
     uint32_t rowsperstrip;
-    uint32_t* stripoffsets;
-    uint32_t* stripbytecounts;
+    uint64_t* stripoffsets;
+    uint64_t* stripbytecounts;
     uint32_t stripcount;
     uint16_t samplesperpixel;
     uint32_t bitspersample;
@@ -107,13 +130,23 @@ typedef struct TinyTIFFReaderFrame {
     uint8_t orientation;
     uint8_t fillorder;
     uint32_t photometric_interpretation;
+    /** \brief indicates a tiled frame, for which stripoffsets, stripbytecounts and stripcount contain the TileOffsets and TileByteCounts */
     uint8_t isTiled;
+    /** \brief width of the tiles in pixels (0 for stripped frames) */
+    uint32_t tilewidth;
+    /** \brief length (height) of the tiles in pixels (0 for stripped frames) */
+    uint32_t tilelength;
 
     float xresolution;
     float yresolution;
     uint16_t resolutionunit;
 
+    /** \brief the ImageDescription, NULL if not (yet) read, see TinyTIFFReader_loadImageDescription() */
     char* description;
+    /** \brief file offset of an ImageDescription, which was not read yet */
+    uint64_t descriptionOffset;
+    /** \brief length of an ImageDescription, which was not read yet (0 if there is none) */
+    uint64_t descriptionLength;
 } TinyTIFFReaderFrame;
 
 static TinyTIFFReaderFrame TinyTIFFReader_getEmptyFrame() {
@@ -122,6 +155,7 @@ static TinyTIFFReaderFrame TinyTIFFReader_getEmptyFrame() {
     d.height=0;
     d.stripcount=0;
     d.compression=TIFF_COMPRESSION_NONE;
+    d.predictor=TIFF_PREDICTOR_NONE;
     d.rowsperstrip=0;
     d.stripoffsets=0;
     d.stripbytecounts=0;
@@ -131,25 +165,152 @@ static TinyTIFFReaderFrame TinyTIFFReader_getEmptyFrame() {
     d.sampleformat=TINYTIFF_SAMPLEFORMAT_UINT;
     d.imagelength=0;
     d.description=0;
+    d.descriptionOffset=0;
+    d.descriptionLength=0;
     d.orientation=TIFF_ORIENTATION_STANDARD;
     d.fillorder=TIFF_FILLORDER_DEFAULT;
     d.photometric_interpretation=TIFF_PHOTOMETRICINTERPRETATION_BLACKISZERO;
     d.isTiled=TINYTIFF_FALSE;
+    d.tilewidth=0;
+    d.tilelength=0;
     d.xresolution=1.0;
     d.yresolution=1.0;
     d.resolutionunit=1;
     return d;
 }
 
-static void TinyTIFFReader_freeEmptyFrame(TinyTIFFReaderFrame f) {
-    if (f.stripoffsets) free(f.stripoffsets);
-    f.stripoffsets=NULL;
-    if (f.stripbytecounts) free(f.stripbytecounts);
-    f.stripbytecounts=NULL;
-    if (f.description) free(f.description);
-    f.description=NULL;
+/*! \brief a block of memory in a TinyTIFFReader_Arena, the usable memory directly follows this header
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+typedef struct TinyTIFFReader_ArenaBlock {
+    /** \brief the previously allocated block (or NULL) */
+    struct TinyTIFFReader_ArenaBlock* next;
+    /** \brief usable size of this block in bytes */
+    size_t size;
+    /** \brief number of bytes already handed out from this block */
+    size_t used;
+} TinyTIFFReader_ArenaBlock;
+
+/*! \brief simple bump allocator for all memory that belongs to the current frame (IFD values, strip tables, ImageDescription).
+    \ingroup tinytiffreader_internal
+    \internal
+
+    All memory is released at once with TinyTIFFReader_resetArena() when the next frame is read. If a frame needed more than one
+    block, the blocks are merged into a single block on reset, so reading a sequence of similar frames does not allocate
+    any heap memory after the first frame.
+ */
+typedef struct TinyTIFFReader_Arena {
+    /** \brief the block, memory is currently handed out from (the head of a list of all blocks) */
+    TinyTIFFReader_ArenaBlock* blocks;
+} TinyTIFFReader_Arena;
+
+/** \brief minimum size of a block in a TinyTIFFReader_Arena \internal */
+#define TINYTIFFREADER_ARENA_MINBLOCKSIZE 4096
+/** \brief alignment of all allocations from a TinyTIFFReader_Arena \internal */
+#define TINYTIFFREADER_ARENA_ALIGNMENT 8
+
+/*! \brief returns \a size bytes of zero-initialized memory from \a arena, or NULL if no memory could be allocated
+    \ingroup tinytiffreader_internal
+    \internal
+
+    The memory is valid until the next call of TinyTIFFReader_resetArena() or TinyTIFFReader_freeArena().
+ */
+static void* TinyTIFFReader_arenaAlloc(TinyTIFFReader_Arena* arena, size_t size) {
+    if (size>((size_t)-1)-TINYTIFFREADER_ARENA_ALIGNMENT-sizeof(TinyTIFFReader_ArenaBlock)) return NULL;
+    size=(size+TINYTIFFREADER_ARENA_ALIGNMENT-1)/TINYTIFFREADER_ARENA_ALIGNMENT*TINYTIFFREADER_ARENA_ALIGNMENT;
+    TinyTIFFReader_ArenaBlock* block=arena->blocks;
+    if (!block || block->size-block->used<size) {
+        size_t blocksize=TINYTIFFREADER_ARENA_MINBLOCKSIZE;
+        if (block && block->size>blocksize/2 && block->size<((size_t)-1)/4) blocksize=2*block->size;
+        if (blocksize<size) blocksize=size;
+        block=(TinyTIFFReader_ArenaBlock*)malloc(sizeof(TinyTIFFReader_ArenaBlock)+blocksize);
+        if (!block) return NULL;
+        block->next=arena->blocks;
+        block->size=blocksize;
+        block->used=0;
+        arena->blocks=block;
+    }
+    uint8_t* res=((uint8_t*)block)+sizeof(TinyTIFFReader_ArenaBlock)+block->used;
+    block->used+=size;
+    memset(res, 0, size);
+    return res;
+}
+
+/*! \brief releases all memory handed out by \a arena, but keeps (a single block of) the memory for the next frame
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static void TinyTIFFReader_resetArena(TinyTIFFReader_Arena* arena) {
+    TinyTIFFReader_ArenaBlock* block=arena->blocks;
+    if (!block) return;
+    if (block->next) {
+        // replace all blocks by a single block, that is large enough for all allocations of the last frame
+        size_t total=0;
+        while (block) {
+            TinyTIFFReader_ArenaBlock* next=block->next;
+            total+=block->size;
+            free(block);
+            block=next;
+        }
+        arena->blocks=NULL;
+        block=(TinyTIFFReader_ArenaBlock*)malloc(sizeof(TinyTIFFReader_ArenaBlock)+total);
+        if (!block) return;
+        block->next=NULL;
+        block->size=total;
+        arena->blocks=block;
+    }
+    block->used=0;
+}
+
+/*! \brief frees all memory of \a arena
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static void TinyTIFFReader_freeArena(TinyTIFFReader_Arena* arena) {
+    TinyTIFFReader_ArenaBlock* block=arena->blocks;
+    while (block) {
+        TinyTIFFReader_ArenaBlock* next=block->next;
+        free(block);
+        block=next;
+    }
+    arena->blocks=NULL;
 }
 
+struct TinyTIFFReaderSharedFile {
+#if defined(__WINDOWS__)
+    /** \brief file handle, read with positional ReadFile() calls */
+    HANDLE hFile;
+#elif defined(TINYTIFF_HAVE_PREAD)
+    /** \brief file descriptor, read with pread() */
+    int fd;
+#else
+    /** \brief file, used if no positional reads are available */
+    FILE* file;
+    /** \brief serializes the seek and read calls on \c file */
+    TinyTIFF_Mutex fileMutex;
+#endif
+    uint8_t systembyteorder;
+    uint8_t filebyteorder;
+    uint8_t bigTIFF;
+    uint64_t filesize;
+    /** \brief number of frames in \c frames */
+    uint32_t frameCount;
+    /** \brief the properties of all frames of the file. The strip tables point into \c stripTables, the ImageDescriptions are not kept */
+    TinyTIFFReaderFrame* frames;
+    /** \brief the strip (or tile) offsets and byte counts of all frames */
+    uint64_t* stripTables;
+    /** \brief memory mapping of the file, which is used instead of positional reads, if available (only for the temporary files of TinyTIFFReader_readFrames()) */
+    const uint8_t* mappedData;
+    /** \brief size of the memory mapping \c mappedData in bytes */
+    uint64_t mappedSize;
+};
+
+/*! \brief state of the prefetch mode (see TinyTIFFReader_enablePrefetch()), defined below TinyTIFFReaderFile
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+typedef struct TinyTIFFReaderPrefetch TinyTIFFReaderPrefetch;
 
 struct TinyTIFFReaderFile {
 #ifdef TINYTIFF_USE_WINAPI_FOR_FILEIO
@@ -163,30 +324,165 @@ struct TinyTIFFReaderFile {
 
     uint8_t systembyteorder;
     uint8_t filebyteorder;
-
-    uint32_t firstrecord_offset;
-    uint32_t nextifd_offset;
+    /** \brief indicates whether the file is a BigTIFF (64-bit offsets, 8-byte IFD counts, 20-byte IFD entries) */
+    uint8_t bigTIFF;
+
+    uint64_t firstrecord_offset;
+    uint64_t nextifd_offset;
+
+    /** \brief index of the current frame (0 for the first frame in the file) */
+    uint32_t currentFrameIndex;
+    /** \brief lazily populated index: file offsets of the IFDs of the frames \c 0..frameOffsetsCount-1 */
+    uint64_t* frameOffsets;
+    /** \brief number of valid entries in \c frameOffsets */
+    uint32_t frameOffsetsCount;
+    /** \brief number of entries allocated for \c frameOffsets */
+    uint32_t frameOffsetsCapacity;
+    /** \brief indicates that \c frameOffsets contains the IFDs of all frames in the file (or the layout is uniform, see \c uniformLayout ) */
+    uint8_t frameOffsetsComplete;
+    /** \brief indicates that the IFDs of all frames after the first have identical layout and follow each other at the constant distance \c uniformStride,
+     *         i.e. the offset of frame \c i>=1 is <code>frameOffsets[1]+(i-1)*uniformStride</code> */
+    uint8_t uniformLayout;
+    /** \brief indicates that the detection of a uniform layout was already tried */
+    uint8_t uniformLayoutChecked;
+    /** \brief distance between two IFDs in a uniform layout */
+    uint64_t uniformStride;
+    /** \brief number of frames in a uniform layout */
+    uint32_t uniformFrames;
+    /** \brief if set, the IFD chain is always walked completely, i.e. no uniform layout is detected (see TinyTIFFReader_setStrictFrameValidation()) */
+    uint8_t strictFrameValidation;
+    /** \brief number of frames, as given by \c images=N in the ImageDescription of the first frame (0 if not available) */
+    uint32_t descriptionFrames;
+    /** \brief number of threads used by TinyTIFFReader_readFrames() (0: one per processor) */
+    uint32_t readThreads;
 
     uint64_t filesize;
 
+    /** \brief start of a read-only memory mapping of the whole file (see TinyTIFFReader_openMemoryMapped()), NULL if the file is only accessed with read calls */
+    const uint8_t* mappedData;
+    /** \brief size of the memory mapping \c mappedData in bytes */
+    uint64_t mappedSize;
+#ifdef __WINDOWS__
+    /** \brief file handle, used for the memory mapping */
+    HANDLE hMappedFile;
+    /** \brief handle of the file mapping object */
+    HANDLE hMapping;
+#endif
+
+    /** \brief if set, all data is read with positional reads from this file and the file position of \c file is not used,
+     *         see TinyTIFFReader_readFrameAt() */
+    TinyTIFFReaderSharedFile* shared;
+    /** \brief state of the prefetch mode, NULL if frames are read synchronously, see TinyTIFFReader_enablePrefetch() */
+    TinyTIFFReaderPrefetch* prefetch;
+
     TinyTIFFReaderFrame currentFrame;
+    /** \brief memory for the current frame (strip tables, ImageDescription) and the temporary data, used while parsing its IFD */
+    TinyTIFFReader_Arena frameArena;
+    /** \brief decompressor for Deflate compressed strips, which is reused for all strips read by this reader */
+    TinyTIFF_DeflateCodec deflateCodec;
+};
+
+/*! \brief a frame, which was loaded in advance by the prefetch thread
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+typedef struct TinyTIFFReaderPrefetchSlot {
+    /** \brief properties of the frame, the strip tables point into \c tables, the ImageDescription into \c description */
+    TinyTIFFReaderFrame frame;
+    /** \brief offset of the IFD after this frame */
+    uint64_t nextifd_offset;
+    /** \brief memory for the strip (or tile) offsets and byte counts */
+    uint64_t* tables;
+    /** \brief number of entries allocated for \c tables */
+    uint64_t tablesCapacity;
+    /** \brief memory for the ImageDescription */
+    char* description;
+    /** \brief number of bytes allocated for \c description */
+    uint64_t descriptionCapacity;
+    /** \brief the data of all samples of the frame, one plane per sample, in system byte order */
+    uint8_t* data;
+    /** \brief number of bytes allocated for \c data */
+    uint64_t dataCapacity;
+    /** \brief size of a single plane in \c data in bytes, 0 if the data could not be loaded (it is then read synchronously, which also reports the error) */
+    uint64_t planeSize;
+    /** \brief set, if an error occured while parsing the IFD of the frame (the message is in \c lastError ) */
+    int wasError;
+    char lastError[TIFF_LAST_ERROR_SIZE];
+} TinyTIFFReaderPrefetchSlot;
+
+/*! \brief state of the prefetch mode (see TinyTIFFReader_enablePrefetch())
+    \ingroup tinytiffreader_internal
+    \internal
+
+    A background thread walks the IFD chain ahead of the caller with its own reader \c scout and loads the frames into a ring of
+    \c slotCount=frames+1 slots. Slot \c head is the next slot to fill, the \c queued slots before it hold loaded frames, which
+    were not yet taken by TinyTIFFReader_readNext(). The slot \c current (if not -1) holds the current frame of the caller and
+    is released, when the next frame is taken. All reads (also by the caller) are positional reads from \c file .
+ */
+struct TinyTIFFReaderPrefetch {
+    /** \brief the prefetch thread */
+    TinyTIFF_Thread thread;
+    /** \brief protects \c head, \c queued, \c queuedBytes, \c current, \c finished and \c stop */
+    TinyTIFF_Mutex mutex;
+    /** \brief signalled when a frame was loaded or the prefetch thread finished */
+    TinyTIFF_Cond frameLoaded;
+    /** \brief signalled when the caller took a frame or the thread should stop */
+    TinyTIFF_Cond frameTaken;
+    /** \brief the file of the reader, borrowed for positional reads */
+    TinyTIFFReaderSharedFile file;
+    /** \brief reader of the prefetch thread, which runs ahead of the caller */
+    TinyTIFFReaderFile scout;
+    /** \brief the ring of slots */
+    TinyTIFFReaderPrefetchSlot* slots;
+    uint32_t slotCount;
+    /** \brief maximum number of frames, loaded in advance */
+    uint32_t frames;
+    /** \brief maximum number of bytes of pixel data, loaded in advance (0: unlimited) */
+    uint64_t maxBytes;
+    /** \brief the next slot to fill */
+    uint32_t head;
+    /** \brief number of loaded frames, not yet taken by the caller */
+    uint32_t queued;
+    /** \brief number of bytes of pixel data in the \c queued slots */
+    uint64_t queuedBytes;
+    /** \brief slot of the current frame of the caller, -1 if the current frame was not prefetched */
+    int32_t current;
+    /** \brief set by the prefetch thread, when it reached the last frame (or could not parse an IFD) */
+    int finished;
+    /** \brief tells the prefetch thread to exit */
+    int stop;
 };
 
-unsigned long TinyTIFFReader_min(unsigned long a, unsigned long b) {
+/** \brief size of the buffer used to read a complete IFD with a single read call (larger IFDs are read into a temporary buffer) \internal */
+#define TINYTIFFREADER_IFDBUFFER_SIZE 512
+/** \brief maximum number of samples per pixel, for which TinyTIFFReader_getSampleDataAll() does not need to allocate its table of output pointers \internal */
+#define TINYTIFFREADER_MAXSAMPLES_SINGLEPASS 16
+/** \brief maximum number of unused bytes between two rows of a region of interest in a stripped frame, up to which both rows are read with a single read call \internal */
+#define TINYTIFFREADER_ROI_MAXGAP (64*1024)
+/** \brief maximum size of a block of rows that is read with a single read call, when reading a region of interest from a stripped frame \internal */
+#define TINYTIFFREADER_ROI_BLOCKSIZE (1024*1024)
+/** \brief size of the count field at the start of an IFD in bytes (2 for TIFF, 8 for BigTIFF) \internal */
+#define TINYTIFFREADER_IFDCOUNTSIZE(tiff) ((tiff)->bigTIFF?8:2)
+/** \brief size of a single IFD entry in bytes (12 for TIFF, 20 for BigTIFF) \internal */
+#define TINYTIFFREADER_IFDENTRYSIZE(tiff) ((tiff)->bigTIFF?20:12)
+/** \brief size of a file offset (and of the value field of an IFD entry) in bytes (4 for TIFF, 8 for BigTIFF) \internal */
+#define TINYTIFFREADER_OFFSETSIZE(tiff) ((tiff)->bigTIFF?8:4)
+
+uint64_t TinyTIFFReader_min(uint64_t a, uint64_t b) {
     if (a<b) return a;
     else return b;
 }
 
-unsigned long TinyTIFFReader_max(unsigned long a, unsigned long b) {
+uint64_t TinyTIFFReader_max(uint64_t a, uint64_t b) {
     if (a>b) return a;
     else return b;
 }
 
-unsigned long TinyTIFFReader_doRangesOverlap(unsigned long xstart, unsigned long xend, unsigned long ystart, unsigned long yend, unsigned long* overlap_start, unsigned long* overlap_end) {
+int TinyTIFFReader_doRangesOverlap(uint64_t xstart, uint64_t xend, uint64_t ystart, uint64_t yend, uint64_t* overlap_start, uint64_t* overlap_end) {
     // see: https://stackoverflow.com/questions/36035074/how-can-i-find-an-overlap-between-two-given-ranges
 
-    unsigned long totalRange = TinyTIFFReader_max(xend, yend) - TinyTIFFReader_min(xstart, ystart);
-    unsigned long sumOfRanges = (xend - xstart) + (yend - ystart);
+    uint64_t totalRange = TinyTIFFReader_max(xend, yend) - TinyTIFFReader_min(xstart, ystart);
+    uint64_t sumOfRanges = (xend - xstart) + (yend - ystart);
 
     if (sumOfRanges > totalRange) { // means they overlap
         if (overlap_end!=NULL) *overlap_end = TinyTIFFReader_min(xend, yend);
@@ -241,13 +537,10 @@ int TinyTIFFReader_fOK(const TinyTIFFReaderFile* tiff)  {
 
 int TinyTIFFReader_fseek_set(TinyTIFFReaderFile* tiff, long long offset) {
 #ifdef TINYTIFF_USE_WINAPI_FOR_FILEIO
-   DWORD res = SetFilePointer (tiff->hFile,
-                                offset,
-                                NULL,
-                                FILE_BEGIN);
-
-
-   return res;
+    // SetFilePointerEx() is used, as BigTIFF files may be larger than 4GB
+    LARGE_INTEGER distance;
+    distance.QuadPart=offset;
+    return SetFilePointerEx(tiff->hFile, distance, NULL, FILE_BEGIN)?0:-1;
 #else
 #  ifdef HAVE_FSEEKO64
     return fseeko64(tiff->file, offset, SEEK_SET);
@@ -262,13 +555,9 @@ int TinyTIFFReader_fseek_set(TinyTIFFReaderFile* tiff, long long offset) {
 
 int TinyTIFFReader_fseek_cur(TinyTIFFReaderFile* tiff, long long offset) {
 #ifdef TINYTIFF_USE_WINAPI_FOR_FILEIO
-   DWORD res = SetFilePointer (tiff->hFile,
-                                offset,
-                                NULL,
-                                FILE_CURRENT);
-
-
-   return res;
+    LARGE_INTEGER distance;
+    distance.QuadPart=offset;
+    return SetFilePointerEx(tiff->hFile, distance, NULL, FILE_CURRENT)?0:-1;
 #else
 #  ifdef HAVE_FSEEKO64
     return fseeko64(tiff->file, offset, SEEK_CUR);
@@ -298,24 +587,20 @@ unsigned long TinyTIFFReader_fread(void * ptr, unsigned long ptrsize, unsigned l
 
 
 int TinyTIFFReader_fgetpos(TinyTIFFReaderFile* tiff, TinyTIFFReader_POSTYPE* pos) {
+    if (tiff->shared) return 0;
 #ifdef TINYTIFF_USE_WINAPI_FOR_FILEIO
-    *pos= SetFilePointer( tiff->hFile,
-                                0,
-                                NULL,
-                                FILE_CURRENT );
-    return 0;
+    LARGE_INTEGER distance;
+    distance.QuadPart=0;
+    return SetFilePointerEx(tiff->hFile, distance, pos, FILE_CURRENT)?0:-1;
 #else
     return fgetpos(tiff->file, pos);
 #endif // TINYTIFF_USE_WINAPI_FOR_FILEIO
 }
 
 int TinyTIFFReader_fsetpos(TinyTIFFReaderFile* tiff, const TinyTIFFReader_POSTYPE* pos) {
+    if (tiff->shared) return 0;
 #ifdef TINYTIFF_USE_WINAPI_FOR_FILEIO
-    SetFilePointer( tiff->hFile,
-                                *pos,
-                                NULL,
-                                FILE_BEGIN );
-    return 0;
+    return SetFilePointerEx(tiff->hFile, *pos, NULL, FILE_BEGIN)?0:-1;
 #else
     return fsetpos(tiff->file, pos);
 #endif // TINYTIFF_USE_WINAPI_FOR_FILEIO
@@ -324,6 +609,128 @@ int TinyTIFFReader_fsetpos(TinyTIFFReaderFile* tiff, const TinyTIFFReader_POSTYP
 
 
 
+/*! \brief reads \a count bytes, starting at the file position \a offset of the shared file \a shared into \a dest, without changing any state,
+           so any number of threads may call this function concurrently
+    \ingroup tinytiffreader_internal
+    \internal
+
+    \return the number of bytes actually read
+ */
+static size_t TinyTIFFReader_readShared(TinyTIFFReaderSharedFile* shared, uint64_t offset, void* dest, size_t count) {
+    size_t done=0;
+#if defined(__WINDOWS__)
+    while (done<count) {
+        OVERLAPPED ov;
+        memset(&ov, 0, sizeof(ov));
+        ov.Offset=(DWORD)((offset+done)&0xFFFFFFFF);
+        ov.OffsetHigh=(DWORD)((offset+done)>>32);
+        const DWORD chunk=(count-done>0x40000000)?0x40000000:(DWORD)(count-done);
+        DWORD n=0;
+        if (!ReadFile(shared->hFile, ((uint8_t*)dest)+done, chunk, &n, &ov) || n==0) break;
+        done+=n;
+    }
+#elif defined(TINYTIFF_HAVE_PREAD)
+    while (done<count) {
+        const ssize_t n=pread(shared->fd, ((uint8_t*)dest)+done, count-done, (off_t)(offset+done));
+        if (n<0 && errno==EINTR) continue;
+        if (n<=0) break;
+        done+=(size_t)n;
+    }
+#else
+    TinyTIFF_Mutex_lock(&(shared->fileMutex));
+#  ifdef HAVE_FSEEKO64
+    const int seekres=fseeko64(shared->file, offset, SEEK_SET);
+#  elif defined(HAVE_FSEEKI64)
+    const int seekres=_fseeki64(shared->file, offset, SEEK_SET);
+#  else
+    const int seekres=fseek(shared->file, (long)offset, SEEK_SET);
+#  endif
+    if (seekres==0) done=fread(dest, 1, count, shared->file);
+    TinyTIFF_Mutex_unlock(&(shared->fileMutex));
+#endif
+    return done;
+}
+
+/*! \brief reads \a count bytes, starting at the file position \a offset into \a dest. If the file is memory mapped,
+           the data is copied from the mapping, for a view on a shared file (see TinyTIFFReader_readFrameAt()) positional reads are used,
+           otherwise the file is read with TinyTIFFReader_fseek_set() and TinyTIFFReader_fread()
+    \ingroup tinytiffreader_internal
+    \internal
+
+    \return the number of bytes actually read
+ */
+static size_t TinyTIFFReader_readAt(TinyTIFFReaderFile* tiff, uint64_t offset, void* dest, size_t destsize, size_t count) {
+    if (tiff->mappedData) {
+        if (offset>=tiff->mappedSize) return 0;
+        if (count>tiff->mappedSize-offset) count=(size_t)(tiff->mappedSize-offset);
+        TinyTIFF_memcpy_s(dest, destsize, tiff->mappedData+offset, count);
+        return count;
+    }
+    if (tiff->shared) {
+        if (count>destsize) count=destsize;
+        return TinyTIFFReader_readShared(tiff->shared, offset, dest, count);
+    }
+    TinyTIFFReader_fseek_set(tiff, offset);
+    return TinyTIFFReader_fread(dest, destsize, 1, count, tiff);
+}
+
+/*! \brief creates a read-only memory mapping of the complete file
+    \ingroup tinytiffreader_internal
+    \internal
+
+    \return TINYTIFF_TRUE on success. On failure the reader simply keeps using read calls.
+ */
+static int TinyTIFFReader_mapFile(TinyTIFFReaderFile* tiff, const char* filename) {
+    tiff->mappedData=NULL;
+    tiff->mappedSize=0;
+    if (tiff->filesize==0 || (uint64_t)((size_t)tiff->filesize)!=tiff->filesize) return TINYTIFF_FALSE;
+#if defined(__WINDOWS__)
+    tiff->hMappedFile=CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (tiff->hMappedFile==INVALID_HANDLE_VALUE) return TINYTIFF_FALSE;
+    tiff->hMapping=CreateFileMappingA(tiff->hMappedFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (tiff->hMapping==NULL) {
+        CloseHandle(tiff->hMappedFile);
+        return TINYTIFF_FALSE;
+    }
+    tiff->mappedData=(const uint8_t*)MapViewOfFile(tiff->hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (!tiff->mappedData) {
+        CloseHandle(tiff->hMapping);
+        CloseHandle(tiff->hMappedFile);
+        return TINYTIFF_FALSE;
+    }
+#elif defined(TINYTIFF_HAVE_MEMORYMAPPING)
+    const int fd=open(filename, O_RDONLY);
+    if (fd<0) return TINYTIFF_FALSE;
+    void* map=mmap(NULL, (size_t)tiff->filesize, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping stays valid after closing the descriptor
+    close(fd);
+    if (map==MAP_FAILED) return TINYTIFF_FALSE;
+    tiff->mappedData=(const uint8_t*)map;
+#else
+    (void)filename;
+    return TINYTIFF_FALSE;
+#endif
+    tiff->mappedSize=tiff->filesize;
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief releases the memory mapping created by TinyTIFFReader_mapFile()
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static void TinyTIFFReader_unmapFile(TinyTIFFReaderFile* tiff) {
+    if (!tiff->mappedData) return;
+#if defined(__WINDOWS__)
+    UnmapViewOfFile(tiff->mappedData);
+    CloseHandle(tiff->hMapping);
+    CloseHandle(tiff->hMappedFile);
+#elif defined(TINYTIFF_HAVE_MEMORYMAPPING)
+    munmap((void*)tiff->mappedData, (size_t)tiff->mappedSize);
+#endif
+    tiff->mappedData=NULL;
+    tiff->mappedSize=0;
+}
+
 const char* TinyTIFFReader_getLastError(TinyTIFFReaderFile* tiff) {
     if (tiff) return tiff->lastError;
     return NULL;
@@ -365,6 +772,15 @@ static uint16_t TinyTIFFReader_Byteswap16(uint16_t nValue)
    return (((nValue>> 8)) | (nValue << 8));
 }
 
+static uint64_t TinyTIFFReader_readuint64(TinyTIFFReaderFile* tiff) {
+    uint64_t res=0;
+    TinyTIFFReader_fread(&res, sizeof(res), 8,1,tiff);
+    if (tiff->systembyteorder!=tiff->filebyteorder) {
+        res=TinyTIFFReader_Byteswap64(res);
+    }
+    return res;
+}
+
 static uint32_t TinyTIFFReader_readuint32(TinyTIFFReaderFile* tiff) {
     uint32_t res=0;
     //fread(&res, 4,1,tiff->file);
@@ -386,209 +802,492 @@ static uint16_t TinyTIFFReader_readuint16(TinyTIFFReaderFile* tiff) {
     return res;
 }
 
-static uint8_t TinyTIFFReader_readuint8(TinyTIFFReaderFile* tiff) {
-    uint8_t res=0;
-    //fread(&res, 1,1,tiff->file);
-    TinyTIFFReader_fread(&res, sizeof(res), 1,1,tiff);
+
+/*! \brief reads a file offset, i.e. a 32-bit value from a TIFF or a 64-bit value from a BigTIFF
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static uint64_t TinyTIFFReader_readOffset(TinyTIFFReaderFile* tiff) {
+    if (tiff->bigTIFF) return TinyTIFFReader_readuint64(tiff);
+    else return TinyTIFFReader_readuint32(tiff);
+}
+
+/*! \brief decodes a 16-bit value in the byte order of the file from the memory at \a data
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static uint16_t TinyTIFFReader_getuint16(const TinyTIFFReaderFile* tiff, const uint8_t* data) {
+    uint16_t res;
+    memcpy(&res, data, sizeof(res));
+    if (tiff->systembyteorder!=tiff->filebyteorder) res=TinyTIFFReader_Byteswap16(res);
+    return res;
+}
+
+/*! \brief decodes a 32-bit value in the byte order of the file from the memory at \a data
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static uint32_t TinyTIFFReader_getuint32(const TinyTIFFReaderFile* tiff, const uint8_t* data) {
+    uint32_t res;
+    memcpy(&res, data, sizeof(res));
+    if (tiff->systembyteorder!=tiff->filebyteorder) res=TinyTIFFReader_Byteswap32(res);
+    return res;
+}
+
+/*! \brief decodes a 64-bit value in the byte order of the file from the memory at \a data
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static uint64_t TinyTIFFReader_getuint64(const TinyTIFFReaderFile* tiff, const uint8_t* data) {
+    uint64_t res;
+    memcpy(&res, data, sizeof(res));
+    if (tiff->systembyteorder!=tiff->filebyteorder) res=TinyTIFFReader_Byteswap64(res);
     return res;
 }
 
+/*! \brief decodes the IFD count (2 bytes for TIFF, 8 bytes for BigTIFF) from the memory at \a data
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static uint64_t TinyTIFFReader_getIFDCount(const TinyTIFFReaderFile* tiff, const uint8_t* data) {
+    if (tiff->bigTIFF) return TinyTIFFReader_getuint64(tiff, data);
+    else return TinyTIFFReader_getuint16(tiff, data);
+}
+
+/*! \brief decodes a file offset (4 bytes for TIFF, 8 bytes for BigTIFF) from the memory at \a data
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static uint64_t TinyTIFFReader_getOffset(const TinyTIFFReaderFile* tiff, const uint8_t* data) {
+    if (tiff->bigTIFF) return TinyTIFFReader_getuint64(tiff, data);
+    else return TinyTIFFReader_getuint32(tiff, data);
+}
+
 
 typedef struct TinyTIFFReader_IFD {
     uint16_t tag;
     uint16_t type;
-    uint32_t count;
-    uint32_t value;
+    uint64_t count;
+    uint64_t value;
     uint32_t value2;
 
     uint32_t* pvalue;
     uint32_t* pvalue2;
+    /** \brief values of LONG8/SLONG8/IFD8 entries (BigTIFF only), \c pvalue is NULL for these */
+    uint64_t* pvalue64;
+    /** \brief file offset of the values, if these were not read (see TinyTIFFReader_readIFD()), 0 otherwise */
+    uint64_t dataoffset;
 } TinyTIFFReader_IFD;
 
-static void TinyTIFFReader_freeIFD(TinyTIFFReader_IFD d) {
-    if (d.pvalue /*&& d.count>1*/) { free(d.pvalue);  d.pvalue=NULL; }
-    if (d.pvalue2 /*&& d.count>1*/) { free(d.pvalue2);  d.pvalue2=NULL; }
+/*! \brief returns the values of an integer IFD entry (SHORT, LONG or LONG8) as a uint64_t array, allocated from the frame arena of \a tiff
+    \ingroup tinytiffreader_internal
+    \internal
+
+    The values of LONG8 entries are already stored in the frame arena and are returned without copying.
+
+    \return the array (valid until the next frame is read), or NULL if the entry does not contain values or memory could not be allocated
+ */
+static uint64_t* TinyTIFFReader_getIFDValuesUInt64(TinyTIFFReaderFile* tiff, const TinyTIFFReader_IFD* ifd) {
+    if (ifd->count==0 || (!ifd->pvalue && !ifd->pvalue64)) return NULL;
+    if (ifd->pvalue64) return ifd->pvalue64;
+    uint64_t* res=(uint64_t*)TinyTIFFReader_arenaAlloc(&(tiff->frameArena), (size_t)ifd->count*sizeof(uint64_t));
+    if (res) {
+        uint64_t i;
+        for (i=0; i<ifd->count; i++) {
+            res[i]=ifd->pvalue[i];
+        }
+    }
+    return res;
+}
+
+/*! \brief returns the size of a single value of the given TIFF datatype in bytes, or 0 for datatypes that are not supported by the reader
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static uint64_t TinyTIFFReader_getTypeSize(const TinyTIFFReaderFile* tiff, uint16_t type) {
+    switch(type) {
+        case TIFF_TYPE_BYTE:
+        case TIFF_TYPE_ASCII: return 1;
+        case TIFF_TYPE_SHORT: return 2;
+        case TIFF_TYPE_LONG: return 4;
+        case TIFF_TYPE_RATIONAL: return 8;
+        case TIFF_TYPE_LONG8:
+        case TIFF_TYPE_SLONG8:
+        case TIFF_TYPE_IFD8: if (tiff->bigTIFF) return 8; break;
+        default: break;
+    }
+    return 0;
+}
+
+/*! \brief decodes \c d->count values of the datatype \c d->type from the raw data \a raw (in the byte order of the file) into the
+           (already allocated) arrays of \a d
+    \ingroup tinytiffreader_internal
+    \internal
+
+    The values are decoded from the last to the first, so \a raw may point to the start of \c d->pvalue or \c d->pvalue64
+    (the raw data is never larger than the decoded data), i.e. the values may be decoded in-place.
+ */
+static void TinyTIFFReader_decodeIFDValues(const TinyTIFFReaderFile* tiff, TinyTIFFReader_IFD* d, const uint8_t* raw) {
+    uint64_t i=d->count;
+    switch(d->type) {
+        case TIFF_TYPE_BYTE:
+        case TIFF_TYPE_ASCII:
+            while (i>0) { i--; d->pvalue[i]=raw[i]; }
+            break;
+        case TIFF_TYPE_SHORT:
+            while (i>0) { i--; d->pvalue[i]=TinyTIFFReader_getuint16(tiff, raw+i*2); }
+            break;
+        case TIFF_TYPE_LONG:
+            while (i>0) { i--; d->pvalue[i]=TinyTIFFReader_getuint32(tiff, raw+i*4); }
+            break;
+        case TIFF_TYPE_RATIONAL:
+            while (i>0) { i--; d->pvalue2[i]=TinyTIFFReader_getuint32(tiff, raw+i*8+4); d->pvalue[i]=TinyTIFFReader_getuint32(tiff, raw+i*8); }
+            break;
+        case TIFF_TYPE_LONG8:
+        case TIFF_TYPE_SLONG8:
+        case TIFF_TYPE_IFD8:
+            while (i>0) { i--; d->pvalue64[i]=TinyTIFFReader_getuint64(tiff, raw+i*8); }
+            break;
+        default: break;
+    }
 }
 
-static TinyTIFFReader_IFD TinyTIFFReader_readIFD(TinyTIFFReaderFile* tiff) {
+/*! \brief decodes the IFD entry at \a entry (12 bytes for TIFF, 20 bytes for BigTIFF, in the byte order of the file).
+    \ingroup tinytiffreader_internal
+    \internal
+
+    Values stored inline are decoded from \a entry, values stored outside the IFD are read with a single call of TinyTIFFReader_readAt()
+    and then decoded from memory. The values of an ImageDescription, that is stored outside the IFD, are not read, only their position
+    is returned in \c dataoffset .
+ */
+static TinyTIFFReader_IFD TinyTIFFReader_readIFD(TinyTIFFReaderFile* tiff, const uint8_t* entry) {
     TinyTIFFReader_IFD d;
+    const size_t valuepos=(tiff->bigTIFF)?12:8;
+    const uint8_t* valuefield=entry+valuepos;
 
     d.value=0;
     d.value2=0;
 
     d.pvalue=0;
     d.pvalue2=0;
-
-    d.tag=TinyTIFFReader_readuint16(tiff);
-    d.type=TinyTIFFReader_readuint16(tiff);
-    d.count=TinyTIFFReader_readuint32(tiff);
-    //uint32_t val=TinyTIFFReader_readuint32(tiff);
-    TinyTIFFReader_POSTYPE pos;
-    //fgetpos(tiff->file, &pos);
-    TinyTIFFReader_fgetpos(tiff, &pos);
-    int changedpos=TINYTIFF_FALSE;
-    //printf("    - pos=0x%X   tag=%d type=%d count=%u \n",pos, d.tag, d.type, d.count);
-    switch(d.type) {
-        case TIFF_TYPE_BYTE:
-        case TIFF_TYPE_ASCII:
-            if (d.count>0) {
-              d.pvalue=(uint32_t*)calloc(d.count, sizeof(uint32_t));
-                if (d.pvalue) {
-                  if (d.count<=4) {
-                    unsigned int i;
-                    for (i=0; i<4; i++) {
-                      uint32_t v=TinyTIFFReader_readuint8(tiff);
-                      if (i<d.count) d.pvalue[i]=v;
-                    }
-                  } else {
-                    changedpos=TINYTIFF_TRUE;
-                    uint32_t offset=TinyTIFFReader_readuint32(tiff);
-
-                    if (offset+d.count*1<=tiff->filesize) {
-                      //fseek(tiff->file, offset, SEEK_SET);
-                      TinyTIFFReader_fseek_set(tiff, offset);
-                      unsigned int i;
-                      for (i=0; i<d.count; i++) {
-                        d.pvalue[i]=TinyTIFFReader_readuint8(tiff);
-                      }
-                    }
-                  }
-                } else {
-                    tiff->wasError=TINYTIFF_TRUE;
-                    TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
-                }
-            }
-            d.pvalue2=NULL;
-            //printf("    - BYTE/CHAR: tag=%d count=%u   val[0]=%u\n",d.tag,d.count, d.pvalue[0]);
-            break;
-        case TIFF_TYPE_SHORT:
-            d.pvalue=(uint32_t*)calloc(d.count, sizeof(uint32_t));
-            if (d.pvalue) {
-                if (d.count<=2) {
-                    unsigned int i;
-                    for (i=0; i<2; i++) {
-                        uint32_t v=TinyTIFFReader_readuint16(tiff);
-                        if (i<d.count) d.pvalue[i]=v;
+    d.pvalue64=0;
+    d.dataoffset=0;
+
+    d.tag=TinyTIFFReader_getuint16(tiff, entry);
+    d.type=TinyTIFFReader_getuint16(tiff, entry+2);
+    if (tiff->bigTIFF) d.count=TinyTIFFReader_getuint64(tiff, entry+4);
+    else d.count=TinyTIFFReader_getuint32(tiff, entry+4);
+    //printf("    - tag=%d type=%d count=%u \n", d.tag, d.type, d.count);
+    uint64_t typesize=TinyTIFFReader_getTypeSize(tiff, d.type);
+    if (typesize>0 && d.count>tiff->filesize/typesize) {
+        // the entry claims more data than the file contains: ignore it
+        typesize=0;
+    }
+    if (d.tag==TIFF_FIELD_IMAGEDESCRIPTION && typesize==1 && d.count>(uint64_t)TINYTIFFREADER_OFFSETSIZE(tiff)) {
+        // the ImageDescription may be very large (e.g. OME-XML), so it is only read on demand, see TinyTIFFReader_getImageDescription()
+        d.dataoffset=TinyTIFFReader_getOffset(tiff, valuefield);
+    } else if (typesize>0 && d.count>0) {
+        const uint64_t datasize=d.count*typesize;
+        if (d.type==TIFF_TYPE_LONG8 || d.type==TIFF_TYPE_SLONG8 || d.type==TIFF_TYPE_IFD8) {
+            d.pvalue64=(uint64_t*)TinyTIFFReader_arenaAlloc(&(tiff->frameArena), (size_t)d.count*sizeof(uint64_t));
+        } else {
+            d.pvalue=(uint32_t*)TinyTIFFReader_arenaAlloc(&(tiff->frameArena), (size_t)d.count*sizeof(uint32_t));
+            if (d.type==TIFF_TYPE_RATIONAL) d.pvalue2=(uint32_t*)TinyTIFFReader_arenaAlloc(&(tiff->frameArena), (size_t)d.count*sizeof(uint32_t));
+        }
+        if ((!d.pvalue && !d.pvalue64) || (d.type==TIFF_TYPE_RATIONAL && !d.pvalue2)) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+            d.pvalue=d.pvalue2=NULL;
+        } else if (datasize<=(uint64_t)TINYTIFFREADER_OFFSETSIZE(tiff)) {
+            TinyTIFFReader_decodeIFDValues(tiff, &d, valuefield);
+        } else {
+            const uint64_t offset=TinyTIFFReader_getOffset(tiff, valuefield);
+            if (offset<=tiff->filesize && datasize<=tiff->filesize-offset) {
+                if (d.type==TIFF_TYPE_RATIONAL) {
+                    // the raw data is larger than pvalue, so a temporary buffer is needed
+                    uint8_t* raw=(uint8_t*)TinyTIFFReader_arenaAlloc(&(tiff->frameArena), (size_t)datasize);
+                    if (raw) {
+                        if (TinyTIFFReader_readAt(tiff, offset, raw, (size_t)datasize, (size_t)datasize)==datasize) TinyTIFFReader_decodeIFDValues(tiff, &d, raw);
                     }
                 } else {
-                    changedpos=TINYTIFF_TRUE;
-                    uint32_t offset=TinyTIFFReader_readuint32(tiff);
-                    if (offset+d.count*2<=tiff->filesize) {
-                        //fseek(tiff->file, offset, SEEK_SET);
-                        TinyTIFFReader_fseek_set(tiff, offset);
-                        unsigned int i;
-                        for (i=0; i<d.count; i++) {
-                            d.pvalue[i]=TinyTIFFReader_readuint16(tiff);
-                        }
-                    }
+                    // read the raw data into the value array and decode it in-place
+                    uint8_t* raw=(d.pvalue64)?((uint8_t*)d.pvalue64):((uint8_t*)d.pvalue);
+                    const size_t rawsize=(d.pvalue64)?((size_t)d.count*sizeof(uint64_t)):((size_t)d.count*sizeof(uint32_t));
+                    if (TinyTIFFReader_readAt(tiff, offset, raw, rawsize, (size_t)datasize)==datasize) TinyTIFFReader_decodeIFDValues(tiff, &d, raw);
+                    else memset(raw, 0, rawsize);
                 }
-            } else {
-                tiff->wasError=TINYTIFF_TRUE;
-                TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
             }
-            d.pvalue2=NULL;
-            //printf("    - SHORT: tag=%d count=%u   val[0]=%u\n",d.tag,d.count, d.pvalue[0]);
-            break;
+        }
+    } else if (typesize==0) {
+        d.value=TinyTIFFReader_getuint32(tiff, valuefield);
+    }
+    if (d.pvalue) d.value=d.pvalue[0];
+    if (d.pvalue2) d.value2=d.pvalue2[0];
+    if (d.pvalue64) d.value=d.pvalue64[0];
+    return d;
+}
 
-        case TIFF_TYPE_LONG:
-            d.pvalue=(uint32_t*)calloc(d.count, sizeof(uint32_t));
-            if (d.pvalue) {
-                if (d.count<=1) {
-                    d.pvalue[0]=TinyTIFFReader_readuint32(tiff);
-                } else {
-                    changedpos=TINYTIFF_TRUE;
-                    uint32_t offset=TinyTIFFReader_readuint32(tiff);
-                    if (offset+d.count*4<=tiff->filesize) {
-                        //fseek(tiff->file, offset, SEEK_SET);
-                        TinyTIFFReader_fseek_set(tiff, offset);
-                        uint32_t i;
-                        for (i=0; i<d.count; i++) {
-                            d.pvalue[i]=TinyTIFFReader_readuint32(tiff);
-                        }
-                    }
-                    //printf("    - LONG: pos=0x%X   offset=0x%X   tag=%d count=%u   val[0]=%u\n",pos, offset,d.tag,d.count, d.pvalue[0]);
-                }
-            } else {
-                tiff->wasError=TINYTIFF_TRUE;
-                TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
-            }
 
-            d.pvalue2=NULL;
-            //printf("    - LONG: tag=%d count=%u   val[0]=%u\n",d.tag,d.count, d.pvalue[0]);
-            break;
-        case TIFF_TYPE_RATIONAL: {
-            d.pvalue=(uint32_t*)calloc(d.count, sizeof(uint32_t));
-            if (d.pvalue) {
-                d.pvalue2=(uint32_t*)calloc(d.count, sizeof(uint32_t));
-                if (d.pvalue2) {
-
-                    changedpos=TINYTIFF_TRUE;
-                    uint32_t offset=TinyTIFFReader_readuint32(tiff);
-                    if (offset+d.count*4<=tiff->filesize) {
-                        //fseek(tiff->file, offset, SEEK_SET);
-                        TinyTIFFReader_fseek_set(tiff, offset);
-                        uint32_t i;
-                        for (i=0; i<d.count; i++) {
-                            d.pvalue[i]=TinyTIFFReader_readuint32(tiff);
-                            d.pvalue2[i]=TinyTIFFReader_readuint32(tiff);
-                        }
-                    }
-                } else {
-                    tiff->wasError=TINYTIFF_TRUE;
-                    TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
-                    free(d.pvalue);
-                    d.pvalue=NULL;
-                }
-            } else {
-                tiff->wasError=TINYTIFF_TRUE;
-                TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
-            }
+/*! \brief adds the IFD offset \a offset of the frame \a frame to the frame index of \a tiff
+    \ingroup tinytiffreader_internal
+    \internal
 
-            //printf("    - RATIONAL: pos=0x%X   offset=0x%X   tag=%d count=%u   val[0]=%u/%u\n",pos, offset,d.tag,d.count, d.pvalue[0], d.pvalue[1]);
-            } break;
+    Only the next unknown frame (\a frame == \c tiff->frameOffsetsCount ) is added, otherwise the call is ignored.
+    An invalid offset (0 or outside the file) marks the index as complete, as it ends the IFD chain. As each IFD
+    occupies at least \c TINYTIFFREADER_IFDCOUNTSIZE+TINYTIFFREADER_OFFSETSIZE bytes, the index is also treated as
+    complete when it would contain more frames than fit into the file (i.e. for cyclic IFD chains).
 
-       default: d.value=TinyTIFFReader_readuint32(tiff); break;
+    \return TINYTIFF_TRUE if the frame was added to the index, TINYTIFF_FALSE otherwise (also if memory could not be allocated)
+ */
+static int TinyTIFFReader_addFrameIndex(TinyTIFFReaderFile* tiff, uint32_t frame, uint64_t offset) {
+    if (tiff->frameOffsetsComplete || frame!=tiff->frameOffsetsCount) return TINYTIFF_FALSE;
+    if (offset==0 || offset>=tiff->filesize || frame==0xFFFFFFFF
+        || (uint64_t)frame>=tiff->filesize/(uint64_t)(TINYTIFFREADER_IFDCOUNTSIZE(tiff)+TINYTIFFREADER_OFFSETSIZE(tiff))) {
+        tiff->frameOffsetsComplete=TINYTIFF_TRUE;
+        return TINYTIFF_FALSE;
     }
-    if (d.pvalue) d.value=d.pvalue[0];
-    if (d.pvalue2) d.value2=d.pvalue2[0];
+    if (tiff->frameOffsetsCount>=tiff->frameOffsetsCapacity) {
+        const uint32_t newcapacity=(tiff->frameOffsetsCapacity<64)?64:((tiff->frameOffsetsCapacity>0x7FFFFFFF)?0xFFFFFFFF:tiff->frameOffsetsCapacity*2);
+        uint64_t* newoffsets=(uint64_t*)realloc(tiff->frameOffsets, (size_t)newcapacity*sizeof(uint64_t));
+        if (!newoffsets) return TINYTIFF_FALSE;
+        tiff->frameOffsets=newoffsets;
+        tiff->frameOffsetsCapacity=newcapacity;
+    }
+    tiff->frameOffsets[tiff->frameOffsetsCount]=offset;
+    tiff->frameOffsetsCount++;
+    return TINYTIFF_TRUE;
+}
 
-    if (changedpos) {
-        //fsetpos(tiff->file, &pos);
-        TinyTIFFReader_fsetpos(tiff, &pos);
-        //fseek(tiff->file, 4, SEEK_CUR);
-        TinyTIFFReader_fseek_cur(tiff, 4);
+/*! \brief reads the IFD at \a offset without interpreting its entries
+    \ingroup tinytiffreader_internal
+    \internal
+
+    \param tiff TIFF file
+    \param offset file offset of the IFD
+    \param[out] entries receives the raw (not byte-swapped) entries of the IFD, may be NULL
+    \param entries_size size of \a entries in bytes
+    \param[out] count receives the number of entries in the IFD
+    \param[out] next receives the offset of the next IFD
+    \return TINYTIFF_TRUE on success, TINYTIFF_FALSE if the IFD could not be read or does not fit into \a entries
+ */
+static int TinyTIFFReader_readRawIFD(TinyTIFFReaderFile* tiff, uint64_t offset, uint8_t* entries, size_t entries_size, uint64_t* count, uint64_t* next) {
+    const size_t countsize=TINYTIFFREADER_IFDCOUNTSIZE(tiff);
+    const size_t offsetsize=TINYTIFFREADER_OFFSETSIZE(tiff);
+    uint8_t buf[8];
+    if (offset>=tiff->filesize || tiff->filesize-offset<countsize) return TINYTIFF_FALSE;
+    if (TinyTIFFReader_readAt(tiff, offset, buf, sizeof(buf), countsize)!=countsize) return TINYTIFF_FALSE;
+    *count=TinyTIFFReader_getIFDCount(tiff, buf);
+    if (*count>(tiff->filesize-offset)/TINYTIFFREADER_IFDENTRYSIZE(tiff)) return TINYTIFF_FALSE;
+    const size_t entriesbytes=(size_t)(*count*TINYTIFFREADER_IFDENTRYSIZE(tiff));
+    if (entries) {
+        if (entriesbytes>entries_size) return TINYTIFF_FALSE;
+        if (TinyTIFFReader_readAt(tiff, offset+countsize, entries, entries_size, entriesbytes)!=entriesbytes) return TINYTIFF_FALSE;
     }
-    return d;
+    if (TinyTIFFReader_readAt(tiff, offset+countsize+entriesbytes, buf, sizeof(buf), offsetsize)!=offsetsize) return TINYTIFF_FALSE;
+    *next=TinyTIFFReader_getOffset(tiff, buf);
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief compares the raw IFD entries \a a and \a b (both with \a count entries), ignoring the values of StripOffsets and
+           all values that are stored outside the IFD (i.e. only the offsets of these values differ)
+    \ingroup tinytiffreader_internal
+    \internal
+
+    \return TINYTIFF_TRUE if the IFDs describe frames with identical geometry and data layout
+ */
+static int TinyTIFFReader_compareRawIFDs(const TinyTIFFReaderFile* tiff, const uint8_t* a, const uint8_t* b, uint64_t count) {
+    const size_t entrysize=TINYTIFFREADER_IFDENTRYSIZE(tiff);
+    const size_t offsetsize=TINYTIFFREADER_OFFSETSIZE(tiff);
+    const size_t headersize=entrysize-offsetsize;
+    uint64_t i;
+    for (i=0; i<count; i++) {
+        const uint8_t* ea=a+i*entrysize;
+        const uint8_t* eb=b+i*entrysize;
+        if (memcmp(ea, eb, headersize)!=0) return TINYTIFF_FALSE;
+        const uint16_t tag=TinyTIFFReader_getuint16(tiff, ea);
+        const uint16_t type=TinyTIFFReader_getuint16(tiff, ea+2);
+        const uint64_t valcount=(tiff->bigTIFF)?TinyTIFFReader_getuint64(tiff, ea+4):TinyTIFFReader_getuint32(tiff, ea+4);
+        const uint64_t typesize=TinyTIFFReader_getTypeSize(tiff, type);
+        if (tag!=TIFF_FIELD_STRIPOFFSETS && tag!=TIFF_FIELD_TILE_OFFSETS && typesize>0 && valcount<=offsetsize/typesize) {
+            if (memcmp(ea+headersize, eb+headersize, offsetsize)!=0) return TINYTIFF_FALSE;
+        }
+    }
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief tries to detect a uniform layout of the IFDs, as written by TinyTIFFWriter, ImageJ or libtiff for stacks of equally sized frames
+    \ingroup tinytiffreader_internal
+    \internal
+
+    Needs the first 4 frames in the frame index. If these follow each other at a constant distance (starting with the second frame, as the first
+    IFD usually contains additional tags, such as the ImageDescription), the number of frames is taken from the ImageDescription (\c images=N )
+    or estimated from the file size. This guess is then verified by reading a few samples of IFDs (including the last one), which have to be at
+    the predicted positions, have the same entries as the second IFD and point to the next predicted IFD (or end the chain).
+    On success, the frame index is complete and all further frame offsets are calculated.
+
+    \return TINYTIFF_TRUE if a uniform layout was detected
+ */
+static int TinyTIFFReader_detectUniformLayout(TinyTIFFReaderFile* tiff) {
+    if (tiff->uniformLayoutChecked || tiff->strictFrameValidation || tiff->frameOffsetsComplete || tiff->frameOffsetsCount<4) return tiff->uniformLayout;
+    tiff->uniformLayoutChecked=TINYTIFF_TRUE;
+    const uint64_t first=tiff->frameOffsets[1];
+    const uint64_t stride=tiff->frameOffsets[2]-tiff->frameOffsets[1];
+    if (tiff->frameOffsets[2]<=tiff->frameOffsets[1]) return TINYTIFF_FALSE;
+    uint32_t i;
+    for (i=2; i<tiff->frameOffsetsCount; i++) {
+        if (tiff->frameOffsets[i]!=first+(uint64_t)(i-1)*stride) return TINYTIFF_FALSE;
+    }
+
+    uint64_t count=0, next=0;
+    if (!TinyTIFFReader_readRawIFD(tiff, first, NULL, 0, &count, &next) || count==0) return TINYTIFF_FALSE;
+    const size_t entriesbytes=(size_t)(count*TINYTIFFREADER_IFDENTRYSIZE(tiff));
+    const uint64_t ifdsize=TINYTIFFREADER_IFDCOUNTSIZE(tiff)+entriesbytes+TINYTIFFREADER_OFFSETSIZE(tiff);
+    if (first+ifdsize>tiff->filesize) return TINYTIFF_FALSE;
+
+    uint64_t frames=tiff->descriptionFrames;
+    if (frames<tiff->frameOffsetsCount) {
+        // no (usable) number of frames in the ImageDescription: assume that the file ends with the last frame
+        frames=2+(tiff->filesize-first-ifdsize)/stride;
+    }
+    if (frames>0xFFFFFFFE || frames>tiff->filesize/(uint64_t)(TINYTIFFREADER_IFDCOUNTSIZE(tiff)+TINYTIFFREADER_OFFSETSIZE(tiff))) return TINYTIFF_FALSE;
+    if (first+(frames-2)*stride+ifdsize>tiff->filesize) return TINYTIFF_FALSE;
+
+    uint8_t* reference=(uint8_t*)malloc(entriesbytes);
+    uint8_t* entries=(uint8_t*)malloc(entriesbytes);
+    int ok=(reference && entries);
+    if (ok) ok=TinyTIFFReader_readRawIFD(tiff, first, reference, entriesbytes, &count, &next);
+    const uint64_t samples[]={frames-1, frames-2, frames/2, frames/4, 3*(frames/4), frames/3, 2*(frames/3), tiff->frameOffsetsCount-1};
+    const size_t nsamples=sizeof(samples)/sizeof(samples[0]);
+    size_t j;
+    for (j=0; ok && j<nsamples; j++) {
+        const uint64_t frame=samples[j];
+        if (frame<1 || frame>=frames) continue;
+        const uint64_t offset=first+(frame-1)*stride;
+        uint64_t framecount=0, framenext=0;
+        ok=TinyTIFFReader_readRawIFD(tiff, offset, entries, entriesbytes, &framecount, &framenext)
+           && framecount==count
+           && TinyTIFFReader_compareRawIFDs(tiff, reference, entries, count);
+        if (ok) {
+            if (frame==frames-1) ok=(framenext==0 || framenext>=tiff->filesize);
+            else ok=(framenext==offset+stride);
+        }
+    }
+    free(reference);
+    free(entries);
+    if (!ok) return TINYTIFF_FALSE;
+
+    tiff->uniformLayout=TINYTIFF_TRUE;
+    tiff->uniformStride=stride;
+    tiff->uniformFrames=(uint32_t)frames;
+    tiff->frameOffsetsComplete=TINYTIFF_TRUE;
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief returns the number of frames in the frame index of \a tiff (all frames, if the index is complete)
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static uint32_t TinyTIFFReader_getIndexedFrames(const TinyTIFFReaderFile* tiff) {
+    if (tiff->uniformLayout) return tiff->uniformFrames;
+    return tiff->frameOffsetsCount;
 }
 
+/*! \brief returns the offset of the IFD of frame \a frame, which has to be in the frame index
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static uint64_t TinyTIFFReader_getIndexedFrameOffset(const TinyTIFFReaderFile* tiff, uint32_t frame) {
+    if (frame<tiff->frameOffsetsCount) return tiff->frameOffsets[frame];
+    return tiff->frameOffsets[1]+(uint64_t)(frame-1)*tiff->uniformStride;
+}
+
+/*! \brief walks the IFD chain, starting at the last known frame, until the frame index of \a tiff contains the frame \a frame
+           (or the end of the file is reached)
+    \ingroup tinytiffreader_internal
+    \internal
+
+    The current file position is preserved.
+
+    \return TINYTIFF_TRUE if \a frame is in the index after the call
+ */
+static int TinyTIFFReader_extendFrameIndex(TinyTIFFReaderFile* tiff, uint32_t frame) {
+    if (frame<TinyTIFFReader_getIndexedFrames(tiff)) return TINYTIFF_TRUE;
+    if (tiff->frameOffsetsComplete) return TINYTIFF_FALSE;
+    TinyTIFFReader_POSTYPE pos;
+    TinyTIFFReader_fgetpos(tiff, &pos);
+    if (tiff->frameOffsetsCount==0) {
+        TinyTIFFReader_addFrameIndex(tiff, 0, tiff->firstrecord_offset);
+    }
+    while (!tiff->frameOffsetsComplete && tiff->frameOffsetsCount>0 && frame>=tiff->frameOffsetsCount) {
+        if (TinyTIFFReader_detectUniformLayout(tiff)) break;
+        // only positional reads are used, as the prefetch thread may read from the file at the same time
+        uint64_t count=0;
+        uint64_t nextOffset=0;
+        if (!TinyTIFFReader_readRawIFD(tiff, tiff->frameOffsets[tiff->frameOffsetsCount-1], NULL, 0, &count, &nextOffset)) nextOffset=0;
+        if (!TinyTIFFReader_addFrameIndex(tiff, tiff->frameOffsetsCount, nextOffset) && !tiff->frameOffsetsComplete) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "could not allocate memory for the frame index\0");
+            break;
+        }
+    }
+    TinyTIFFReader_fsetpos(tiff, &pos);
+    return frame<TinyTIFFReader_getIndexedFrames(tiff);
+}
 
 static void TinyTIFFReader_readNextFrame(TinyTIFFReaderFile* tiff) {
 
-    TinyTIFFReader_freeEmptyFrame(tiff->currentFrame);
+    // all memory of the previous frame is released here
+    TinyTIFFReader_resetArena(&(tiff->frameArena));
     tiff->currentFrame=TinyTIFFReader_getEmptyFrame();
     #ifdef DEBUG_IFDTIMING
     HighResTimer timer;
     timer.start();
     #endif
-    if (tiff->nextifd_offset!=0 && tiff->nextifd_offset+2<tiff->filesize) {
+    if (tiff->nextifd_offset!=0 && tiff->nextifd_offset+TINYTIFFREADER_IFDCOUNTSIZE(tiff)<tiff->filesize) {
         //printf("    - seeking=0x%X\n", tiff->nextifd_offset);
-        //fseek(tiff->file, tiff->nextifd_offset, SEEK_SET);
-        TinyTIFFReader_fseek_set(tiff, tiff->nextifd_offset);
-        uint16_t ifd_count=TinyTIFFReader_readuint16(tiff);
+        // read the IFD as a single block: usually it fits into the fixed-size buffer, so one read returns
+        // the entry count, all entries and the offset of the next IFD
+        uint8_t ifdbuffer[TINYTIFFREADER_IFDBUFFER_SIZE];
+        uint8_t* ifd_data=ifdbuffer;
+        const uint64_t ifd_available=tiff->filesize-tiff->nextifd_offset;
+        size_t ifd_read=TinyTIFFReader_readAt(tiff, tiff->nextifd_offset, ifdbuffer, sizeof(ifdbuffer), (size_t)TinyTIFFReader_min(sizeof(ifdbuffer), ifd_available));
+        uint64_t ifd_count=0;
+        if (ifd_read>=(size_t)TINYTIFFREADER_IFDCOUNTSIZE(tiff)) ifd_count=TinyTIFFReader_getIFDCount(tiff, ifdbuffer);
+        if (ifd_read<(size_t)TINYTIFFREADER_IFDCOUNTSIZE(tiff) || ifd_count>ifd_available/TINYTIFFREADER_IFDENTRYSIZE(tiff)) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "IFD entry count exceeds the file size\0");
+            tiff->nextifd_offset=0;
+            return;
+        }
+        const uint64_t ifd_size=TINYTIFFREADER_IFDCOUNTSIZE(tiff)+TINYTIFFREADER_IFDENTRYSIZE(tiff)*ifd_count+TINYTIFFREADER_OFFSETSIZE(tiff);
+        const size_t ifd_needed=(size_t)TinyTIFFReader_min(ifd_size, ifd_available);
+        if (ifd_needed>ifd_read) {
+            // large IFD: read it completely into a temporary buffer
+            ifd_data=(uint8_t*)TinyTIFFReader_arenaAlloc(&(tiff->frameArena), ifd_needed);
+            if (!ifd_data) {
+                tiff->wasError=TINYTIFF_TRUE;
+                TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+                tiff->nextifd_offset=0;
+                return;
+            }
+            ifd_read=TinyTIFFReader_readAt(tiff, tiff->nextifd_offset, ifd_data, ifd_needed, ifd_needed);
+        }
+        // entries, which could not be read completely (truncated file), are ignored
+        const uint64_t ifd_entries=TinyTIFFReader_min(ifd_count, (ifd_read-TINYTIFFREADER_IFDCOUNTSIZE(tiff))/TINYTIFFREADER_IFDENTRYSIZE(tiff));
 #ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
-        printf("    - tag_count=%u\n", ifd_count);
+        printf("    - tag_count=%lu\n", (unsigned long)ifd_count);
 #endif
-        uint16_t i;
-        for ( i=0; i<ifd_count; i++) {
+        uint64_t i;
+        for ( i=0; i<ifd_entries; i++) {
     #ifdef DEBUG_IFDTIMING
             timer.start();
     #endif
-            TinyTIFFReader_IFD ifd=TinyTIFFReader_readIFD(tiff);
+            TinyTIFFReader_IFD ifd=TinyTIFFReader_readIFD(tiff, ifd_data+TINYTIFFREADER_IFDCOUNTSIZE(tiff)+i*TINYTIFFREADER_IFDENTRYSIZE(tiff));
 #ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
     #ifdef DEBUG_IFDTIMING
-            printf("    - readIFD %d (tag: %u, type: %u, count: %u): %lf us\n", i, ifd.tag, ifd.type, ifd.count, timer.get_time());
+            printf("    - readIFD %lu (tag: %u, type: %u, count: %lu): %lf us\n", (unsigned long)i, ifd.tag, ifd.type, (unsigned long)ifd.count, timer.get_time());
     #else
-            printf("    - readIFD %d (tag: %u, type: %u, count: %u)\n", i, ifd.tag, ifd.type, ifd.count);
+            printf("    - readIFD %lu (tag: %u, type: %u, count: %lu)\n", (unsigned long)i, ifd.tag, ifd.type, (unsigned long)ifd.count);
     #endif
 #endif
             switch(ifd.tag) {
@@ -613,13 +1312,16 @@ static void TinyTIFFReader_readNextFrame(TinyTIFFReaderFile* tiff) {
 
                      } break;
                 case TIFF_FIELD_COMPRESSION: tiff->currentFrame.compression=ifd.value; break;
+                case TIFF_FIELD_PREDICTOR: tiff->currentFrame.predictor=ifd.value; break;
+                case TIFF_FIELD_TILE_OFFSETS:
+                    tiff->currentFrame.isTiled=TINYTIFF_TRUE;
+                    // the tile offsets are stored like the strip offsets
+                    /* fall through */
                 case TIFF_FIELD_STRIPOFFSETS:
-                    if (ifd.count>0 && ifd.pvalue) { // max U32
-                        tiff->currentFrame.stripcount=ifd.count;
-                        tiff->currentFrame.stripoffsets=(uint32_t*)calloc(ifd.count, sizeof(uint32_t));
-                        if (tiff->currentFrame.stripoffsets) {
-                            TinyTIFF_memcpy_s(tiff->currentFrame.stripoffsets, ifd.count*sizeof(uint32_t), ifd.pvalue, ifd.count*sizeof(uint32_t));
-                        } else {
+                    if (ifd.count>0 && ifd.count<=0xFFFFFFFF && (ifd.pvalue || ifd.pvalue64)) { // max U32
+                        tiff->currentFrame.stripcount=(uint32_t)ifd.count;
+                        tiff->currentFrame.stripoffsets=TinyTIFFReader_getIFDValuesUInt64(tiff, &ifd);
+                        if (!tiff->currentFrame.stripoffsets) {
                             tiff->wasError=TINYTIFF_TRUE;
                             TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
                         }
@@ -632,11 +1334,18 @@ static void TinyTIFFReader_readNextFrame(TinyTIFFReaderFile* tiff) {
                 case TIFF_FIELD_SAMPLEFORMAT: tiff->currentFrame.sampleformat=ifd.value; break;
                 case TIFF_FIELD_IMAGEDESCRIPTION: {
                     //printf("TIFF_FIELD_IMAGEDESCRIPTION: (tag: %u, type: %u, count: %u)\n", ifd.tag, ifd.type, ifd.count);
-                    if (tiff->currentFrame.description) free(tiff->currentFrame.description);
-                    tiff->currentFrame.description=(char*)calloc(ifd.count+1, sizeof(char));
+                    if (ifd.dataoffset>0) {
+                        // read on demand in TinyTIFFReader_getImageDescription()
+                        tiff->currentFrame.description=NULL;
+                        tiff->currentFrame.descriptionOffset=ifd.dataoffset;
+                        tiff->currentFrame.descriptionLength=ifd.count;
+                        break;
+                    }
+                    tiff->currentFrame.descriptionLength=0;
+                    tiff->currentFrame.description=(char*)TinyTIFFReader_arenaAlloc(&(tiff->frameArena), (size_t)ifd.count+1);
                     if (tiff->currentFrame.description) {
                         if (ifd.count>0 && ifd.pvalue) {
-                            for (uint32_t ji=0; ji<ifd.count; ji++) {
+                            for (uint64_t ji=0; ji<ifd.count; ji++) {
                                 tiff->currentFrame.description[ji]=(char)ifd.pvalue[ji];
                                 //printf(" %d[%d]", int(tiff->currentFrame.description[ji]), int(ifd.pvalue[ji]));
                             }
@@ -648,11 +1357,18 @@ static void TinyTIFFReader_readNextFrame(TinyTIFFReaderFile* tiff) {
                     }
                     //printf("\n  %s\n", tiff->currentFrame.description);
                     } break;
+                case TIFF_FIELD_TILE_BYTECOUNTS:
+                    tiff->currentFrame.isTiled=TINYTIFF_TRUE;
+                    // the tile byte counts are stored like the strip byte counts
+                    /* fall through */
                 case TIFF_FIELD_STRIPBYTECOUNTS:
-                    if (ifd.count>0 && ifd.pvalue) {
-                        tiff->currentFrame.stripcount=ifd.count;
-                        tiff->currentFrame.stripbytecounts=(uint32_t*)calloc(ifd.count, sizeof(uint32_t));
-                        TinyTIFF_memcpy_s(tiff->currentFrame.stripbytecounts, ifd.count*sizeof(uint32_t), ifd.pvalue, ifd.count*sizeof(uint32_t));
+                    if (ifd.count>0 && ifd.count<=0xFFFFFFFF && (ifd.pvalue || ifd.pvalue64)) {
+                        tiff->currentFrame.stripcount=(uint32_t)ifd.count;
+                        tiff->currentFrame.stripbytecounts=TinyTIFFReader_getIFDValuesUInt64(tiff, &ifd);
+                        if (!tiff->currentFrame.stripbytecounts) {
+                            tiff->wasError=TINYTIFF_TRUE;
+                            TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+                        }
                     } else {
                         tiff->wasError=TINYTIFF_TRUE;
                         TINYTIFF_SET_LAST_ERROR(tiff, "STRIPBYTECOUNTS has an invalid value (==0) or error reading data!\0");
@@ -662,11 +1378,13 @@ static void TinyTIFFReader_readNextFrame(TinyTIFFReaderFile* tiff) {
                 case TIFF_FIELD_ORIENTATION: tiff->currentFrame.orientation=ifd.value; break;
                 case TIFF_FIELD_PHOTOMETRICINTERPRETATION: tiff->currentFrame.photometric_interpretation=ifd.value; break;
                 case TIFF_FIELD_FILLORDER: tiff->currentFrame.fillorder=ifd.value; break;
-                case TIFF_FIELD_TILE_BYTECOUNTS:
+                case TIFF_FIELD_TILE_WIDTH:
+                    tiff->currentFrame.isTiled=TINYTIFF_TRUE;
+                    tiff->currentFrame.tilewidth=ifd.value;
+                    break;
                 case TIFF_FIELD_TILE_LENGTH:
-                case TIFF_FIELD_TILE_OFFSETS:
-                case TIFF_FIELD_TILE_WIDTH :
                     tiff->currentFrame.isTiled=TINYTIFF_TRUE;
+                    tiff->currentFrame.tilelength=ifd.value;
                     break;
                 case TIFF_FIELD_XRESOLUTION:{
                     tiff->currentFrame.xresolution= ((float)ifd.value)/((float) ifd.value2);
@@ -679,15 +1397,17 @@ static void TinyTIFFReader_readNextFrame(TinyTIFFReaderFile* tiff) {
 #endif
                     break;
             }
-            TinyTIFFReader_freeIFD(ifd);
             //printf("    - tag=%u\n", ifd.tag);
         }
         tiff->currentFrame.height=tiff->currentFrame.imagelength;
         //printf("      - width=%u\n", tiff->currentFrame.width);
         //printf("      - height=%u\n", tiff->currentFrame.height);
-        //fseek(tiff->file, tiff->nextifd_offset+2+12*ifd_count, SEEK_SET);
-        TinyTIFFReader_fseek_set(tiff, tiff->nextifd_offset+2+12*ifd_count);
-        tiff->nextifd_offset=TinyTIFFReader_readuint32(tiff);
+        if (ifd_read>=ifd_size) tiff->nextifd_offset=TinyTIFFReader_getOffset(tiff, ifd_data+ifd_size-TINYTIFFREADER_OFFSETSIZE(tiff));
+        else tiff->nextifd_offset=0;
+        if (TinyTIFFReader_addFrameIndex(tiff, tiff->currentFrameIndex+1, tiff->nextifd_offset)) {
+            // for uniform stacks, the index does not need to grow any further
+            TinyTIFFReader_detectUniformLayout(tiff);
+        }
         //printf("      - nextifd_offset=%lu\n", tiff->nextifd_offset);
     } else {
         tiff->wasError=TINYTIFF_TRUE;
@@ -696,38 +1416,563 @@ static void TinyTIFFReader_readNextFrame(TinyTIFFReaderFile* tiff) {
 }
 
 
-int TinyTIFFReader_getSampleData_s___internl(TinyTIFFReaderFile* tiff, void* buffer, unsigned long buffer_size, uint16_t sample, int doSizeChecks) {
-    if (tiff) {
-        if (tiff->currentFrame.compression!=TIFF_COMPRESSION_NONE) {
+/*! \brief returns the number of tiles of a tiled \a frame (per sample for PlanarConfiguration=2)
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static uint64_t TinyTIFFReader_getTilesPerPlane(const TinyTIFFReaderFrame* frame) {
+    const uint64_t tilesAcross=((uint64_t)frame->width+frame->tilewidth-1)/frame->tilewidth;
+    const uint64_t tilesDown=((uint64_t)frame->height+frame->tilelength-1)/frame->tilelength;
+    return tilesAcross*tilesDown;
+}
+
+/*! \brief checks whether the sample data of the current frame can be read by this library, if not an error is set
+    \ingroup tinytiffreader_internal
+    \internal
+
+    \return TINYTIFF_TRUE if the frame is supported
+ */
+static int TinyTIFFReader_checkSampleDataSupported(TinyTIFFReaderFile* tiff) {
+    const uint16_t compression=tiff->currentFrame.compression;
+#ifdef TINYTIFF_HAVE_DEFLATE
+    const int deflate=(compression==TIFF_COMPRESSION_ADOBE_DEFLATE || compression==TIFF_COMPRESSION_DEFLATE);
+#else
+    const int deflate=TINYTIFF_FALSE;
+#endif
+    if (compression!=TIFF_COMPRESSION_NONE && compression!=TIFF_COMPRESSION_PACKBITS && compression!=TIFF_COMPRESSION_LZW && !deflate) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "the compression of the file is not supported by this library\0");
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->currentFrame.compression!=TIFF_COMPRESSION_NONE && tiff->currentFrame.predictor!=TIFF_PREDICTOR_NONE && tiff->currentFrame.predictor!=TIFF_PREDICTOR_HORIZONTAL) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "only the horizontal differencing predictor is supported by this library\0");
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->currentFrame.compression!=TIFF_COMPRESSION_NONE && tiff->currentFrame.isTiled!=TINYTIFF_FALSE) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "compressed tiles are not supported by this library\0");
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->currentFrame.orientation!=TIFF_ORIENTATION_STANDARD) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "only standard TIFF orientations are supported by this library\0");
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->currentFrame.photometric_interpretation==TIFF_PHOTOMETRICINTERPRETATION_PALETTE) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "palette-colored TIFF images are supported by this library\0");
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->currentFrame.width==0 || tiff->currentFrame.height==0 ) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "the current frame does not contain images\0");
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->currentFrame.bitspersample!=8 && tiff->currentFrame.bitspersample!=16 && tiff->currentFrame.bitspersample!=32 && tiff->currentFrame.bitspersample!=64) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "this library only support 8,16,32 and 64 bits per sample\0");
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->currentFrame.isTiled!=TINYTIFF_FALSE) {
+        const TinyTIFFReaderFrame* frame=&(tiff->currentFrame);
+        if (frame->tilewidth==0 || frame->tilelength==0) {
             tiff->wasError=TINYTIFF_TRUE;
-            TINYTIFF_SET_LAST_ERROR(tiff, "the compression of the file is not supported by this library\0");
+            TINYTIFF_SET_LAST_ERROR(tiff, "the tile size of the current frame is invalid\0");
             return TINYTIFF_FALSE;
         }
-        if (tiff->currentFrame.isTiled!=TINYTIFF_FALSE) {
+        const uint64_t tiles=TinyTIFFReader_getTilesPerPlane(frame)*((frame->planarconfiguration==TIFF_PLANARCONFIG_PLANAR)?frame->samplesperpixel:1);
+        if (!frame->stripoffsets || !frame->stripbytecounts || frame->stripcount<tiles) {
             tiff->wasError=TINYTIFF_TRUE;
-            TINYTIFF_SET_LAST_ERROR(tiff, "tiled images are not supported by this library\0");
+            TINYTIFF_SET_LAST_ERROR(tiff, "the current frame does not contain all tiles\0");
             return TINYTIFF_FALSE;
         }
-        if (tiff->currentFrame.orientation!=TIFF_ORIENTATION_STANDARD) {
+    }
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief transforms the byteorder of the \a count samples in \a buffer from the byteorder of the file to the byteorder of the system
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static void TinyTIFFReader_byteswapSampleData(TinyTIFFReaderFile* tiff, void* buffer, uint64_t count) {
+    if (tiff->systembyteorder!=tiff->filebyteorder) {
+        if (tiff->currentFrame.bitspersample==8) {
+            // we're done no little/big-endian correction necessary for 1-byte data
+        } else if (tiff->currentFrame.bitspersample==16 || tiff->currentFrame.bitspersample==32 || tiff->currentFrame.bitspersample==64) {
+#ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
+            printf("        - correcting %u-bit little-big-endian\n", (unsigned)tiff->currentFrame.bitspersample);
+#endif
+            TinyTIFF_byteswap(buffer, (size_t)count, tiff->currentFrame.bitspersample/8);
+        } else {
             tiff->wasError=TINYTIFF_TRUE;
-            TINYTIFF_SET_LAST_ERROR(tiff, "only standard TIFF orientations are supported by this library\0");
-            return TINYTIFF_FALSE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader does not support the bitsPerSample, given in teh file (only 8,16,32bit are supported)\0");
         }
-        if (tiff->currentFrame.photometric_interpretation==TIFF_PHOTOMETRICINTERPRETATION_PALETTE) {
-            tiff->wasError=TINYTIFF_TRUE;
-            TINYTIFF_SET_LAST_ERROR(tiff, "palette-colored TIFF images are supported by this library\0");
-            return TINYTIFF_FALSE;
+    }
+}
+
+/*! \brief transforms the byteorder of the samples in \a buffer that were completed since the last call, i.e. the bytes \a done ... \a available-1,
+           from the byteorder of the file to the byteorder of the system
+    \ingroup tinytiffreader_internal
+    \internal
+
+    This allows to correct the byteorder of each strip directly after it was read (while it is still in the cache), instead of in a second pass
+    over the whole frame. A sample that is split between two strips is converted once it is complete.
+
+    \return the new value for \a done
+ */
+static uint64_t TinyTIFFReader_byteswapNewData(TinyTIFFReaderFile* tiff, uint8_t* buffer, uint64_t done, uint64_t available) {
+    const uint16_t bytespersample=tiff->currentFrame.bitspersample/8;
+    if (tiff->systembyteorder==tiff->filebyteorder || bytespersample<=1 || available<=done) return available;
+    const uint64_t count=(available-done)/bytespersample;
+    TinyTIFFReader_byteswapSampleData(tiff, buffer+done, count);
+    return done+count*bytespersample;
+}
+
+/*! \brief reads the region of interest (\a x, \a y, \a width, \a height) of a tiled frame into \a buffer, in the byteorder of the system
+    \ingroup tinytiffreader_internal
+    \internal
+
+    Only the tiles intersecting the region are accessed and from each tile only the rows that overlap the region are read, as one continuous block.
+    If \a allSamples is set, all samples of a chunky frame are copied interleaved, otherwise only \a sample is copied, so every row
+    of \a buffer receives <code>width*(allSamples?samplesperpixel:1)</code> tightly packed samples. Consecutive rows start \a outrow_bytes bytes apart.
+
+    \note The region has to lie inside the frame, which is checked by the caller.
+ */
+static int TinyTIFFReader_readTiles(TinyTIFFReaderFile* tiff, void* buffer, uint64_t buffer_size, uint64_t outrow_bytes, uint16_t sample, int allSamples, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    const TinyTIFFReaderFrame* frame=&(tiff->currentFrame);
+    const int planar=(frame->samplesperpixel>1 && frame->planarconfiguration==TIFF_PLANARCONFIG_PLANAR);
+    const uint16_t bytespersample=frame->bitspersample/8;
+    const uint16_t filesamples=planar?1:frame->samplesperpixel;
+    const uint16_t outsamples=allSamples?frame->samplesperpixel:1;
+    const size_t filepixelsize_bytes=(size_t)bytespersample*filesamples;
+    const size_t outpixelsize_bytes=(size_t)bytespersample*outsamples;
+    const uint64_t tilerow_bytes=(uint64_t)frame->tilewidth*filepixelsize_bytes;
+    const uint64_t tilesAcross=((uint64_t)frame->width+frame->tilewidth-1)/frame->tilewidth;
+    const uint64_t firsttile=planar?(uint64_t)sample*TinyTIFFReader_getTilesPerPlane(frame):0;
+    if (sample>=frame->samplesperpixel || (allSamples && planar)) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "the requested sample is not available in the current frame\0");
+        return TINYTIFF_FALSE;
+    }
+    if (outrow_bytes<(uint64_t)width*outpixelsize_bytes || buffer_size<outrow_bytes*(height-1)+(uint64_t)width*outpixelsize_bytes) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "sizeof input buffer was too small!\0");
+        return TINYTIFF_FALSE;
+    }
+
+    uint8_t* tiledata=NULL;
+    size_t tiledata_size=0;
+    const uint64_t ty0=y/frame->tilelength, ty1=((uint64_t)y+height-1)/frame->tilelength;
+    const uint64_t tx0=x/frame->tilewidth, tx1=((uint64_t)x+width-1)/frame->tilewidth;
+    uint64_t ty, tx;
+    for (ty=ty0; ty<=ty1 && !tiff->wasError; ty++) {
+        const uint64_t tiley=ty*frame->tilelength;
+        // rows r0..r1-1 of the tile overlap the region
+        const uint64_t r0=(y>tiley)?y-tiley:0;
+        const uint64_t r1=(((uint64_t)y+height<tiley+frame->tilelength)?(uint64_t)y+height:tiley+frame->tilelength)-tiley;
+        for (tx=tx0; tx<=tx1 && !tiff->wasError; tx++) {
+            const uint64_t tile=firsttile+ty*tilesAcross+tx;
+            const uint64_t tilex=tx*frame->tilewidth;
+            // columns c0..c1-1 of the tile overlap the region
+            const uint64_t c0=(x>tilex)?x-tilex:0;
+            const uint64_t c1=(((uint64_t)x+width<tilex+frame->tilewidth)?(uint64_t)x+width:tilex+frame->tilewidth)-tilex;
+            const uint64_t start_bytes=r0*tilerow_bytes+c0*filepixelsize_bytes;
+            const size_t count_bytes=(size_t)((r1-r0-1)*tilerow_bytes+(c1-c0)*filepixelsize_bytes);
+            const uint8_t* tilesrc=NULL;
+            if (start_bytes+count_bytes>frame->stripbytecounts[tile]) {
+                tiff->wasError=TINYTIFF_TRUE;
+                TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the tile!\0");
+                break;
+            }
+            if (tiff->mappedData) {
+                const uint64_t offset=frame->stripoffsets[tile]+start_bytes;
+                if (offset>tiff->mappedSize || count_bytes>tiff->mappedSize-offset) {
+                    tiff->wasError=TINYTIFF_TRUE;
+                    TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the tile!\0");
+                    break;
+                }
+                tilesrc=tiff->mappedData+offset;
+            } else {
+                if (count_bytes>tiledata_size) {
+                    if (tiledata) free(tiledata);
+                    tiledata=(uint8_t*)malloc(count_bytes);
+                    if (!tiledata) {
+                        tiff->wasError=TINYTIFF_TRUE;
+                        TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+                        return TINYTIFF_FALSE;
+                    }
+                    tiledata_size=count_bytes;
+                }
+                if (TinyTIFFReader_readAt(tiff, frame->stripoffsets[tile]+start_bytes, tiledata, tiledata_size, count_bytes)!=count_bytes) {
+                    tiff->wasError=TINYTIFF_TRUE;
+                    TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the tile!\0");
+                    break;
+                }
+                tilesrc=tiledata;
+            }
+            uint64_t r;
+            for (r=r0; r<r1; r++) {
+                const uint8_t* rowsrc=tilesrc+(r-r0)*tilerow_bytes;
+                uint8_t* rowdst=((uint8_t*)buffer)+(tiley+r-y)*outrow_bytes+(tilex+c0-x)*outpixelsize_bytes;
+                if (filesamples==outsamples) memcpy(rowdst, rowsrc, (size_t)(c1-c0)*filepixelsize_bytes);
+                else TinyTIFF_extractSample(rowsrc, rowdst, (size_t)(c1-c0), filesamples, sample, bytespersample);
+                TinyTIFFReader_byteswapSampleData(tiff, rowdst, (c1-c0)*outsamples);
+            }
         }
-        if (tiff->currentFrame.width==0 || tiff->currentFrame.height==0 ) {
+    }
+    if (tiledata) free(tiledata);
+    return !tiff->wasError;
+}
+
+/*! \brief makes sure that \a *memory has room for at least \a count elements of size \a elementSize ( \a *capacity is the current number of elements)
+    \ingroup tinytiffreader_internal
+    \internal
+
+    \return TINYTIFF_FALSE, if the memory could not be allocated
+ */
+static int TinyTIFFReader_reserve(void** memory, uint64_t* capacity, uint64_t count, size_t elementSize) {
+    if (count<=*capacity) return TINYTIFF_TRUE;
+    if (elementSize!=0 && count>SIZE_MAX/elementSize) return TINYTIFF_FALSE;
+    void* newmemory=realloc(*memory, (size_t)(count*elementSize));
+    if (!newmemory) return TINYTIFF_FALSE;
+    *memory=newmemory;
+    *capacity=count;
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief state of a sequence of TinyTIFFReader_readStripRange() calls for the current frame, initialize with TinyTIFFReader_initStripCursor()
+           and release with TinyTIFFReader_freeStripCursor()
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+typedef struct TinyTIFFReaderStripCursor {
+    /** \brief the strip containing the last requested byte */
+    uint32_t strip;
+    /** \brief start of \c strip in the strip byte space */
+    uint64_t stripstart;
+    /** \brief buffer for the raw data of a compressed strip, if the file is not memory mapped */
+    uint8_t* raw;
+    /** \brief size of \c raw in bytes */
+    uint64_t rawCapacity;
+    /** \brief buffer for the decoded strip \c decodedStrip of a compressed frame */
+    uint8_t* decoded;
+    /** \brief size of \c decoded in bytes */
+    uint64_t decodedCapacity;
+    /** \brief index of the strip in \c decoded, or -1 */
+    int64_t decodedStrip;
+} TinyTIFFReaderStripCursor;
+
+/*! \brief initializes \a cursor for a new sequence of reads
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static void TinyTIFFReader_initStripCursor(TinyTIFFReaderStripCursor* cursor) {
+    cursor->strip=0;
+    cursor->stripstart=0;
+    cursor->raw=NULL;
+    cursor->rawCapacity=0;
+    cursor->decoded=NULL;
+    cursor->decodedCapacity=0;
+    cursor->decodedStrip=-1;
+}
+
+/*! \brief releases the buffers of \a cursor
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static void TinyTIFFReader_freeStripCursor(TinyTIFFReaderStripCursor* cursor) {
+    free(cursor->raw);
+    free(cursor->decoded);
+    TinyTIFFReader_initStripCursor(cursor);
+}
+
+/*! \brief returns the number of rows per strip of the current frame (the whole frame, if RowsPerStrip is missing or larger than the frame)
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static uint32_t TinyTIFFReader_getRowsPerStrip(const TinyTIFFReaderFrame* frame) {
+    if (frame->rowsperstrip==0 || frame->rowsperstrip>frame->height) return frame->height;
+    return frame->rowsperstrip;
+}
+
+/*! \brief returns the size of the strip \a strip of the current frame in bytes, after decompression
+    \ingroup tinytiffreader_internal
+    \internal
+
+    Each plane (the whole frame for chunky frames, each sample for planar frames) consists of strips of TinyTIFFReader_getRowsPerStrip() rows,
+    only the last strip of each plane may be shorter.
+ */
+static uint64_t TinyTIFFReader_getDecodedStripSize(const TinyTIFFReaderFrame* frame, uint32_t strip) {
+    const int planar=(frame->samplesperpixel>1 && frame->planarconfiguration==TIFF_PLANARCONFIG_PLANAR);
+    const uint64_t row_bytes=(uint64_t)frame->width*(frame->bitspersample/8)*(planar?1:frame->samplesperpixel);
+    const uint32_t rowsperstrip=TinyTIFFReader_getRowsPerStrip(frame);
+    const uint32_t stripsPerPlane=(frame->height+rowsperstrip-1)/rowsperstrip;
+    const uint32_t firstrow=(strip%stripsPerPlane)*rowsperstrip;
+    return (uint64_t)((frame->height-firstrow<rowsperstrip)?frame->height-firstrow:rowsperstrip)*row_bytes;
+}
+
+/*! \brief reads the compressed strip \a strip of the current frame and decodes its first \a size bytes into \a dest
+    \ingroup tinytiffreader_internal
+    \internal
+
+    \return TINYTIFF_TRUE, if \a size bytes were decoded
+ */
+static int TinyTIFFReader_decodeStrip(TinyTIFFReaderFile* tiff, TinyTIFFReaderStripCursor* cursor, uint32_t strip, uint8_t* dest, uint64_t size) {
+    const TinyTIFFReaderFrame* frame=&(tiff->currentFrame);
+    const uint64_t offset=frame->stripoffsets[strip];
+    const uint64_t rawsize=frame->stripbytecounts[strip];
+    const uint8_t* raw=NULL;
+    if (tiff->mappedData) {
+        if (offset>tiff->mappedSize || rawsize>tiff->mappedSize-offset) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
+            return TINYTIFF_FALSE;
+        }
+        raw=tiff->mappedData+offset;
+    } else {
+        if (!TinyTIFFReader_reserve((void**)&(cursor->raw), &(cursor->rawCapacity), rawsize, 1)) {
             tiff->wasError=TINYTIFF_TRUE;
-            TINYTIFF_SET_LAST_ERROR(tiff, "the current frame does not contain images\0");
+            TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
             return TINYTIFF_FALSE;
         }
-        if (tiff->currentFrame.bitspersample!=8 && tiff->currentFrame.bitspersample!=16 && tiff->currentFrame.bitspersample!=32 && tiff->currentFrame.bitspersample!=64) {
+        if (TinyTIFFReader_readAt(tiff, offset, cursor->raw, (size_t)cursor->rawCapacity, (size_t)rawsize)!=rawsize) {
             tiff->wasError=TINYTIFF_TRUE;
-            TINYTIFF_SET_LAST_ERROR(tiff, "this library only support 8,16,32 and 64 bits per sample\0");
+            TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
             return TINYTIFF_FALSE;
         }
+        raw=cursor->raw;
+    }
+    uint64_t decoded=0;
+    switch(frame->compression) {
+        case TIFF_COMPRESSION_PACKBITS:
+            decoded=TinyTIFF_packBitsDecode(raw, (size_t)rawsize, dest, (size_t)size);
+            break;
+        case TIFF_COMPRESSION_LZW:
+            decoded=TinyTIFF_lzwDecode(raw, (size_t)rawsize, dest, (size_t)size);
+            break;
+#ifdef TINYTIFF_HAVE_DEFLATE
+        case TIFF_COMPRESSION_ADOBE_DEFLATE:
+        case TIFF_COMPRESSION_DEFLATE:
+            decoded=TinyTIFF_deflateDecode(&(tiff->deflateCodec), raw, (size_t)rawsize, dest, (size_t)size);
+            break;
+#endif
+        default:
+            break;
+    }
+    if (decoded!=size) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to decode all necessary data from the strip!\0");
+        return TINYTIFF_FALSE;
+    }
+    if (frame->predictor==TIFF_PREDICTOR_HORIZONTAL) {
+        // the differences are taken between the samples in the byte order of the file, so this is done before any byteswapping
+        const int planar=(frame->samplesperpixel>1 && frame->planarconfiguration==TIFF_PLANARCONFIG_PLANAR);
+        const uint16_t samples=planar?1:frame->samplesperpixel;
+        const uint64_t row_bytes=(uint64_t)frame->width*(frame->bitspersample/8)*samples;
+        TinyTIFF_horizontalPredictorDecode(dest, (size_t)size, (size_t)row_bytes, (uint16_t)(frame->bitspersample/8), samples, tiff->filebyteorder==TIFF_ORDER_BIGENDIAN);
+    }
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief implementation of TinyTIFFReader_readStripRange() for compressed frames, where the strip byte space is formed by the decoded strips
+    \ingroup tinytiffreader_internal
+    \internal
+
+    Strips that are requested completely are decoded directly into \a dest, otherwise the strip is decoded into the buffer of \a cursor,
+    where it is kept for the following requests.
+ */
+static int TinyTIFFReader_readDecodedStripRange(TinyTIFFReaderFile* tiff, uint64_t start, uint64_t count, uint8_t* dest, TinyTIFFReaderStripCursor* cursor) {
+    const TinyTIFFReaderFrame* frame=&(tiff->currentFrame);
+    const int planar=(frame->samplesperpixel>1 && frame->planarconfiguration==TIFF_PLANARCONFIG_PLANAR);
+    const uint64_t row_bytes=(uint64_t)frame->width*(frame->bitspersample/8)*(planar?1:frame->samplesperpixel);
+    const uint64_t plane_bytes=row_bytes*frame->height;
+    const uint32_t rowsperstrip=TinyTIFFReader_getRowsPerStrip(frame);
+    const uint64_t strip_bytes=row_bytes*rowsperstrip;
+    const uint64_t stripsPerPlane=(frame->height+rowsperstrip-1)/rowsperstrip;
+    while (count>0) {
+        const uint64_t plane=start/plane_bytes;
+        const uint64_t planestrip=(start-plane*plane_bytes)/strip_bytes;
+        const uint64_t strip=plane*stripsPerPlane+planestrip;
+        if (strip>=frame->stripcount) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
+            return TINYTIFF_FALSE;
+        }
+        const uint64_t size=TinyTIFFReader_getDecodedStripSize(frame, (uint32_t)strip);
+        const uint64_t skip=start-plane*plane_bytes-planestrip*strip_bytes;
+        const uint64_t n=(size-skip<count)?size-skip:count;
+        if (skip==0 && n==size && (int64_t)strip!=cursor->decodedStrip) {
+            if (!TinyTIFFReader_decodeStrip(tiff, cursor, (uint32_t)strip, dest, size)) return TINYTIFF_FALSE;
+        } else {
+            if ((int64_t)strip!=cursor->decodedStrip) {
+                cursor->decodedStrip=-1;
+                if (!TinyTIFFReader_reserve((void**)&(cursor->decoded), &(cursor->decodedCapacity), size, 1)) {
+                    tiff->wasError=TINYTIFF_TRUE;
+                    TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+                    return TINYTIFF_FALSE;
+                }
+                if (!TinyTIFFReader_decodeStrip(tiff, cursor, (uint32_t)strip, cursor->decoded, size)) return TINYTIFF_FALSE;
+                cursor->decodedStrip=(int64_t)strip;
+            }
+            memcpy(dest, cursor->decoded+skip, (size_t)n);
+        }
+        dest+=n;
+        start+=n;
+        count-=n;
+    }
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief reads \a count bytes, starting at \a start in the continuous byte space formed by all strips of the current frame, into \a dest
+    \ingroup tinytiffreader_internal
+    \internal
+
+    \a cursor holds the strip containing the last requested byte and its start in the strip byte space. This allows to continue the search
+    for the next strip, as long as the requested ranges increase. Strips that directly follow each other in the file are read with a single read call.
+    For compressed frames the strip byte space is formed by the decoded strips (see TinyTIFFReader_readDecodedStripRange()).
+ */
+static int TinyTIFFReader_readStripRange(TinyTIFFReaderFile* tiff, uint64_t start, uint64_t count, uint8_t* dest, TinyTIFFReaderStripCursor* cursor) {
+    const TinyTIFFReaderFrame* frame=&(tiff->currentFrame);
+    uint32_t* strip=&(cursor->strip);
+    uint64_t* stripstart=&(cursor->stripstart);
+    if (frame->compression!=TIFF_COMPRESSION_NONE) {
+        return TinyTIFFReader_readDecodedStripRange(tiff, start, count, dest, cursor);
+    }
+    while (count>0) {
+        while (*strip<frame->stripcount && *stripstart+frame->stripbytecounts[*strip]<=start) {
+            *stripstart+=frame->stripbytecounts[*strip];
+            (*strip)++;
+        }
+        if (*strip>=frame->stripcount) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
+            return TINYTIFF_FALSE;
+        }
+        uint32_t laststrip=*strip;
+        uint64_t laststripstart=*stripstart;
+        uint64_t n=laststripstart+frame->stripbytecounts[laststrip]-start;
+        while (n<count && laststrip+1<frame->stripcount && frame->stripoffsets[laststrip+1]==frame->stripoffsets[laststrip]+frame->stripbytecounts[laststrip]) {
+            laststripstart+=frame->stripbytecounts[laststrip];
+            laststrip++;
+            n=laststripstart+frame->stripbytecounts[laststrip]-start;
+        }
+        if (n>count) n=count;
+        if (TinyTIFFReader_readAt(tiff, frame->stripoffsets[*strip]+(start-*stripstart), dest, (size_t)n, (size_t)n)!=n) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
+            return TINYTIFF_FALSE;
+        }
+        dest+=n;
+        start+=n;
+        count-=n;
+    }
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief reads the region of interest (\a x, \a y, \a width, \a height) of \a sample from a stripped frame into \a buffer, in the byteorder of the system
+    \ingroup tinytiffreader_internal
+    \internal
+
+    Only the byte ranges that cover the region are read. The ranges of consecutive rows are merged into a single read call,
+    if they are separated by at most TINYTIFFREADER_ROI_MAXGAP bytes. Every row of \a buffer receives \a width tightly packed samples,
+    consecutive rows start \a outrow_bytes bytes apart.
+
+    \note The region and \a sample have to lie inside the frame, which is checked by the caller.
+ */
+static int TinyTIFFReader_readStripsROI(TinyTIFFReaderFile* tiff, void* buffer, uint64_t outrow_bytes, uint16_t sample, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    const TinyTIFFReaderFrame* frame=&(tiff->currentFrame);
+    const int planar=(frame->samplesperpixel>1 && frame->planarconfiguration==TIFF_PLANARCONFIG_PLANAR);
+    const uint16_t bytespersample=frame->bitspersample/8;
+    const uint16_t filesamples=planar?1:frame->samplesperpixel;
+    const uint64_t filepixelsize_bytes=(uint64_t)bytespersample*filesamples;
+    const uint64_t framerow_bytes=(uint64_t)frame->width*filepixelsize_bytes;
+    const uint64_t row_bytes=(uint64_t)width*filepixelsize_bytes;
+    const uint64_t first_bytes=(planar?(uint64_t)sample*framerow_bytes*frame->height:0)+(uint64_t)y*framerow_bytes+(uint64_t)x*filepixelsize_bytes;
+    TinyTIFFReaderStripCursor cursor;
+    TinyTIFFReader_initStripCursor(&cursor);
+
+    if (filesamples==1 && row_bytes==framerow_bytes && outrow_bytes==row_bytes) {
+        // the region is a single continuous range in the file and in the output
+        const uint64_t count_bytes=row_bytes*height;
+        if (tiff->systembyteorder==tiff->filebyteorder || bytespersample<=1) {
+            TinyTIFFReader_readStripRange(tiff, first_bytes, count_bytes, (uint8_t*)buffer, &cursor);
+        } else {
+            // read in blocks, so each block is byteswapped while it is still in the cache
+            const uint64_t block_bytes=TINYTIFFREADER_ROI_BLOCKSIZE-TINYTIFFREADER_ROI_BLOCKSIZE%bytespersample;
+            uint64_t done_bytes;
+            for (done_bytes=0; done_bytes<count_bytes; done_bytes+=block_bytes) {
+                const uint64_t n=(count_bytes-done_bytes<block_bytes)?count_bytes-done_bytes:block_bytes;
+                if (!TinyTIFFReader_readStripRange(tiff, first_bytes+done_bytes, n, ((uint8_t*)buffer)+done_bytes, &cursor)) break;
+                TinyTIFFReader_byteswapSampleData(tiff, ((uint8_t*)buffer)+done_bytes, n/bytespersample);
+            }
+        }
+        TinyTIFFReader_freeStripCursor(&cursor);
+        return !tiff->wasError;
+    }
+
+    // read blocks of rows (including the unused bytes between them) and copy the region from these
+    uint32_t blockrows=1;
+    if (framerow_bytes-row_bytes<=TINYTIFFREADER_ROI_MAXGAP && framerow_bytes<TINYTIFFREADER_ROI_BLOCKSIZE) {
+        blockrows=(uint32_t)(TINYTIFFREADER_ROI_BLOCKSIZE/framerow_bytes);
+        if (blockrows>height) blockrows=height;
+    }
+    const size_t blockdata_size=(size_t)((blockrows-1)*framerow_bytes+row_bytes);
+    uint8_t* blockdata=(uint8_t*)malloc(blockdata_size);
+    if (!blockdata) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+        return TINYTIFF_FALSE;
+    }
+    uint32_t r;
+    for (r=0; r<height; r+=blockrows) {
+        const uint32_t rows=(height-r<blockrows)?height-r:blockrows;
+        if (!TinyTIFFReader_readStripRange(tiff, first_bytes+(uint64_t)r*framerow_bytes, (rows-1)*framerow_bytes+row_bytes, blockdata, &cursor)) break;
+        uint32_t i;
+        for (i=0; i<rows; i++) {
+            uint8_t* rowdst=((uint8_t*)buffer)+(uint64_t)(r+i)*outrow_bytes;
+            if (filesamples==1) memcpy(rowdst, blockdata+i*framerow_bytes, (size_t)row_bytes);
+            else TinyTIFF_extractSample(blockdata+i*framerow_bytes, rowdst, width, filesamples, sample, bytespersample);
+            TinyTIFFReader_byteswapSampleData(tiff, rowdst, width);
+        }
+    }
+    free(blockdata);
+    TinyTIFFReader_freeStripCursor(&cursor);
+    return !tiff->wasError;
+}
+
+
+/*! \brief returns a pointer to the data of the sample \a sample of the current frame, if it was loaded in advance by the prefetch thread (see TinyTIFFReader_enablePrefetch()), or NULL
+    \ingroup tinytiffreader_internal
+    \internal
+
+    The data is in system byte order and valid until the next frame is read.
+ */
+static const void* TinyTIFFReader_getPrefetchedSampleData(TinyTIFFReaderFile* tiff, uint16_t sample) {
+    // current is only changed by the calling thread, so no lock is needed here
+    if (!tiff->prefetch || tiff->prefetch->current<0) return NULL;
+    const TinyTIFFReaderPrefetchSlot* slot=&(tiff->prefetch->slots[tiff->prefetch->current]);
+    if (slot->planeSize==0 || sample>=slot->frame.samplesperpixel) return NULL;
+    return slot->data+(uint64_t)sample*slot->planeSize;
+}
+
+int TinyTIFFReader_getSampleData_s___internl(TinyTIFFReaderFile* tiff, void* buffer, unsigned long buffer_size, uint16_t sample, int doSizeChecks) {
+    if (tiff) {
+        if (!TinyTIFFReader_checkSampleDataSupported(tiff)) {
+            return TINYTIFF_FALSE;
+        }
+        const void* prefetched=TinyTIFFReader_getPrefetchedSampleData(tiff, sample);
+        if (prefetched) {
+            const uint64_t planeSize=tiff->prefetch->slots[tiff->prefetch->current].planeSize;
+            if (doSizeChecks && buffer_size<planeSize) {
+                tiff->wasError=TINYTIFF_TRUE;
+                TINYTIFF_SET_LAST_ERROR(tiff, "sizeof input buffer was too small!\0");
+                return TINYTIFF_FALSE;
+            }
+            tiff->wasError=TINYTIFF_FALSE;
+            memcpy(buffer, prefetched, (size_t)planeSize);
+            return TINYTIFF_TRUE;
+        }
         TinyTIFFReader_POSTYPE pos;
         //fgetpos(tiff->file, &pos);
         TinyTIFFReader_fgetpos(tiff, &pos);
@@ -736,12 +1981,29 @@ int TinyTIFFReader_getSampleData_s___internl(TinyTIFFReaderFile* tiff, void* buf
 #ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
         printf("    - stripcount=%lu\n", (unsigned long)tiff->currentFrame.stripcount);
 #endif
-        if (tiff->currentFrame.stripcount>0 && tiff->currentFrame.stripbytecounts && tiff->currentFrame.stripoffsets) {
+        if (tiff->currentFrame.isTiled!=TINYTIFF_FALSE) {
+            const uint64_t sample_image_size_bytes=(uint64_t)tiff->currentFrame.width*(uint64_t)tiff->currentFrame.height*tiff->currentFrame.bitspersample/8;
+            TinyTIFFReader_readTiles(tiff, buffer, doSizeChecks?(uint64_t)buffer_size:sample_image_size_bytes, (uint64_t)tiff->currentFrame.width*(tiff->currentFrame.bitspersample/8), sample, TINYTIFF_FALSE, 0, 0, tiff->currentFrame.width, tiff->currentFrame.height);
+        } else if (tiff->currentFrame.stripcount>0 && tiff->currentFrame.stripbytecounts && tiff->currentFrame.stripoffsets) {
 #ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
             printf("    - bitspersample=%lu\n", (unsigned long)tiff->currentFrame.bitspersample);
 #endif
 
-            if (tiff->currentFrame.samplesperpixel==1 || tiff->currentFrame.planarconfiguration==TIFF_PLANARCONFIG_PLANAR) {
+            if (tiff->currentFrame.compression!=TIFF_COMPRESSION_NONE) {
+                // the strips are decoded one after the other, the region-of-interest reader already takes care of this (and of the sample extraction)
+                const uint64_t sample_image_size_bytes=(uint64_t)tiff->currentFrame.width*(uint64_t)tiff->currentFrame.height*tiff->currentFrame.bitspersample/8;
+                if (doSizeChecks!=0 && buffer_size<sample_image_size_bytes) {
+                    tiff->wasError=TINYTIFF_TRUE;
+                    TINYTIFF_SET_LAST_ERROR(tiff, "sizeof input buffer was too small!\0");
+                    return TINYTIFF_FALSE;
+                }
+                if (sample>=tiff->currentFrame.samplesperpixel) {
+                    tiff->wasError=TINYTIFF_TRUE;
+                    TINYTIFF_SET_LAST_ERROR(tiff, "the requested sample is not available in the current frame\0");
+                    return TINYTIFF_FALSE;
+                }
+                TinyTIFFReader_readStripsROI(tiff, buffer, (uint64_t)tiff->currentFrame.width*(tiff->currentFrame.bitspersample/8), sample, 0, 0, tiff->currentFrame.width, tiff->currentFrame.height);
+            } else if (tiff->currentFrame.samplesperpixel==1 || tiff->currentFrame.planarconfiguration==TIFF_PLANARCONFIG_PLANAR) {
                 // we assume the set of strips form a continuous memory-range. The actual strip offsets are only taken into account, when actually seeking in the file
                 //
                 //  strip 0                          strip 1                          strip 2                          strip 3                          strip 4
@@ -772,44 +2034,45 @@ int TinyTIFFReader_getSampleData_s___internl(TinyTIFFReaderFile* tiff, void* buf
                 //                                   |
                 //                                   outputimageidx_bytes: points to where to start writing in output array
 
-                const unsigned long sample_image_size_bytes=tiff->currentFrame.width*tiff->currentFrame.height*tiff->currentFrame.bitspersample/8;
+                const uint64_t sample_image_size_bytes=(uint64_t)tiff->currentFrame.width*(uint64_t)tiff->currentFrame.height*tiff->currentFrame.bitspersample/8;
                 if (doSizeChecks!=0 && buffer_size<sample_image_size_bytes) {
                     tiff->wasError=TINYTIFF_TRUE;
                     TINYTIFF_SET_LAST_ERROR(tiff, "sizeof input buffer was too small!\0");
                     return TINYTIFF_FALSE;
                 }
-                const unsigned long sample_start_bytes=sample*sample_image_size_bytes;
-                const unsigned long sample_end_bytes=sample_start_bytes+sample_image_size_bytes;
+                const uint64_t sample_start_bytes=sample*sample_image_size_bytes;
+                const uint64_t sample_end_bytes=sample_start_bytes+sample_image_size_bytes;
 #ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
                 printf("    - sample_image_size_bytes=%lu\n", (unsigned long)sample_image_size_bytes);
                 printf("    - sample_start_bytes=%lu\n", (unsigned long)sample_start_bytes);
                 printf("    - sample_end_bytes=%lu\n", (unsigned long)sample_end_bytes);
 #endif
                 uint32_t strip;
-                unsigned long fileimageidx_bytes=0;
-                unsigned long outputimageidx_bytes=0;
+                uint64_t fileimageidx_bytes=0;
+                uint64_t outputimageidx_bytes=0;
+                uint64_t swappedimageidx_bytes=0;
                 for (strip=0; strip<tiff->currentFrame.stripcount; strip++) {
-                    const unsigned long stripsize_bytes=tiff->currentFrame.stripbytecounts[strip];
-                    const unsigned long strip_offset_bytes=tiff->currentFrame.stripoffsets[strip];
-                    unsigned long bytes_to_read_start=0, bytes_to_read_end=0;
+                    const uint64_t stripsize_bytes=tiff->currentFrame.stripbytecounts[strip];
+                    const uint64_t strip_offset_bytes=tiff->currentFrame.stripoffsets[strip];
+                    uint64_t bytes_to_read_start=0, bytes_to_read_end=0;
                     const int hasToReadFromStrip=TinyTIFFReader_doRangesOverlap(sample_start_bytes, sample_end_bytes, fileimageidx_bytes, fileimageidx_bytes+stripsize_bytes, &bytes_to_read_start, &bytes_to_read_end);
 #ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
                     printf("    - strip %2lu, stripoffset=%8lubytes, stripsize=%8lubytes, fileimageidx=%8lubytes, outputimageidx_bytes=%8lubytes\n", (unsigned long)strip, (unsigned long)strip_offset_bytes,(unsigned long)stripsize_bytes,(unsigned long)fileimageidx_bytes, (unsigned long)outputimageidx_bytes);
 #endif
 
                     if (hasToReadFromStrip!=TINYTIFF_FALSE) {
-                        const unsigned long count_bytes_to_read=bytes_to_read_end-bytes_to_read_start;
+                        const size_t count_bytes_to_read=(size_t)(bytes_to_read_end-bytes_to_read_start);
 #ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
                         printf("      - bytes_to_read_start=%8lu, bytes_to_read_end=%8lu, count_bytes_to_read=%8lu\n", (unsigned long)bytes_to_read_start-fileimageidx_bytes, (unsigned long)bytes_to_read_end-fileimageidx_bytes, (unsigned long)count_bytes_to_read);
                         printf("      - READ -> Writing to %8lu...%8lu / %8lu\n", (unsigned long)outputimageidx_bytes, (unsigned long)outputimageidx_bytes+count_bytes_to_read, (unsigned long)sample_image_size_bytes);
 #endif
-                        TinyTIFFReader_fseek_set(tiff, strip_offset_bytes+(bytes_to_read_start-fileimageidx_bytes));
-                        unsigned long readbytes=TinyTIFFReader_fread(&(((uint8_t*)buffer)[outputimageidx_bytes]), sample_image_size_bytes, 1, count_bytes_to_read, tiff);
+                        size_t readbytes=TinyTIFFReader_readAt(tiff, strip_offset_bytes+(bytes_to_read_start-fileimageidx_bytes), &(((uint8_t*)buffer)[outputimageidx_bytes]), (size_t)(sample_image_size_bytes-outputimageidx_bytes), count_bytes_to_read);
                         if(readbytes!=count_bytes_to_read) {
                             tiff->wasError=TINYTIFF_TRUE;
                             TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
                         }
                         outputimageidx_bytes+=count_bytes_to_read;
+                        swappedimageidx_bytes=TinyTIFFReader_byteswapNewData(tiff, (uint8_t*)buffer, swappedimageidx_bytes, outputimageidx_bytes);
                     } else if (fileimageidx_bytes>sample_end_bytes) {
                         // we have read all data successfully
 #ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
@@ -822,43 +2085,56 @@ int TinyTIFFReader_getSampleData_s___internl(TinyTIFFReaderFile* tiff, void* buf
                 }
             } else if (tiff->currentFrame.samplesperpixel>1 && tiff->currentFrame.planarconfiguration==TIFF_PLANARCONFIG_CHUNKY) {
                 uint32_t strip;
-                unsigned long fileimageidx_bytes=0;
-                unsigned long outputimageidx_bytes=0;
+                uint64_t fileimageidx_bytes=0;
+                uint64_t outputimageidx_bytes=0;
+                uint64_t swappedimageidx_bytes=0;
+                const uint64_t sample_image_size_bytes=(uint64_t)tiff->currentFrame.width*(uint64_t)tiff->currentFrame.height*tiff->currentFrame.bitspersample/8;
                 uint8_t* stripdata=NULL;
-                unsigned long last_stripsize_bytes=0;
+                size_t last_stripsize_bytes=0;
                 for (strip=0; strip<tiff->currentFrame.stripcount; strip++) {
-                    const unsigned long stripsize_bytes=tiff->currentFrame.stripbytecounts[strip];
-                    if (stripsize_bytes>last_stripsize_bytes) {
-                        if (stripdata) free(stripdata);
-                        stripdata=(uint8_t*)malloc(stripsize_bytes);
-                        if (!stripdata) {
-                            tiff->wasError=TINYTIFF_TRUE;
-                            TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
-                            return TINYTIFF_FALSE;
-                        }
-                        last_stripsize_bytes=stripsize_bytes;
-                    }
-
-                    const unsigned long strip_offset_bytes=tiff->currentFrame.stripoffsets[strip];
+                    const size_t stripsize_bytes=(size_t)tiff->currentFrame.stripbytecounts[strip];
+                    const uint64_t strip_offset_bytes=tiff->currentFrame.stripoffsets[strip];
 #ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
                     printf("    - strip %2lu, stripoffset=%8lubytes, stripsize=%8lubytes, fileimageidx=%8lubytes, outputimageidx_bytes=%8lubytes\n", (unsigned long)strip, (unsigned long)strip_offset_bytes,(unsigned long)stripsize_bytes,(unsigned long)fileimageidx_bytes, (unsigned long)outputimageidx_bytes);
 #endif
-                    TinyTIFFReader_fseek_set(tiff, strip_offset_bytes);
-                    unsigned long readbytes=TinyTIFFReader_fread(stripdata, last_stripsize_bytes, 1, stripsize_bytes, tiff);
-                    if(readbytes!=stripsize_bytes) {
-                        tiff->wasError=TINYTIFF_TRUE;
-                        TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
+                    const uint8_t* stripsrc=NULL;
+                    if (tiff->mappedData) {
+                        // deinterleave directly from the memory mapping
+                        if (strip_offset_bytes>tiff->mappedSize || stripsize_bytes>tiff->mappedSize-strip_offset_bytes) {
+                            tiff->wasError=TINYTIFF_TRUE;
+                            TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
+                            break;
+                        }
+                        stripsrc=tiff->mappedData+strip_offset_bytes;
+                    } else {
+                        if (stripsize_bytes>last_stripsize_bytes) {
+                            if (stripdata) free(stripdata);
+                            stripdata=(uint8_t*)malloc(stripsize_bytes);
+                            if (!stripdata) {
+                                tiff->wasError=TINYTIFF_TRUE;
+                                TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+                                return TINYTIFF_FALSE;
+                            }
+                            last_stripsize_bytes=stripsize_bytes;
+                        }
+                        size_t readbytes=TinyTIFFReader_readAt(tiff, strip_offset_bytes, stripdata, last_stripsize_bytes, stripsize_bytes);
+                        if(readbytes!=stripsize_bytes) {
+                            tiff->wasError=TINYTIFF_TRUE;
+                            TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
+                        }
+                        stripsrc=stripdata;
                     }
-                    unsigned long stripi=0;
+                    size_t stripi=0;
                     for (stripi=sample*tiff->currentFrame.bitspersample/8; stripi<stripsize_bytes; stripi+=tiff->currentFrame.bitspersample/8*tiff->currentFrame.samplesperpixel) {
-                        if (doSizeChecks) TinyTIFF_memcpy_s(&(((uint8_t*)buffer)[outputimageidx_bytes]), buffer_size-outputimageidx_bytes, &(stripdata[stripi]), tiff->currentFrame.bitspersample/8);
-                        else memcpy(&(((uint8_t*)buffer)[outputimageidx_bytes]), &(stripdata[stripi]), tiff->currentFrame.bitspersample/8);
+                        if (doSizeChecks) TinyTIFF_memcpy_s(&(((uint8_t*)buffer)[outputimageidx_bytes]), buffer_size-outputimageidx_bytes, &(stripsrc[stripi]), tiff->currentFrame.bitspersample/8);
+                        else memcpy(&(((uint8_t*)buffer)[outputimageidx_bytes]), &(stripsrc[stripi]), tiff->currentFrame.bitspersample/8);
 #ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
                         if (stripi<sample*tiff->currentFrame.bitspersample/8+10*tiff->currentFrame.bitspersample/8*tiff->currentFrame.samplesperpixel) printf("      - memcpy(buffer[%8lu], stripdata[%8lu], %lu)\n", (unsigned long)outputimageidx_bytes, (unsigned long)stripi, (unsigned long)(tiff->currentFrame.bitspersample/8));
                         else if (stripi==sample*tiff->currentFrame.bitspersample/8+10*tiff->currentFrame.bitspersample/8*tiff->currentFrame.samplesperpixel) printf("      - memcpy(...)\n");
 #endif
                         outputimageidx_bytes+=tiff->currentFrame.bitspersample/8;
                     }
+                    swappedimageidx_bytes=TinyTIFFReader_byteswapNewData(tiff, (uint8_t*)buffer, swappedimageidx_bytes, (outputimageidx_bytes<sample_image_size_bytes)?outputimageidx_bytes:sample_image_size_bytes);
 
                     fileimageidx_bytes+=stripsize_bytes;
 
@@ -868,65 +2144,319 @@ int TinyTIFFReader_getSampleData_s___internl(TinyTIFFReaderFile* tiff, void* buf
             }
 
 
+        } else {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "TIFF format not recognized\0");
+        }
 
-            if (tiff->systembyteorder!=tiff->filebyteorder) {
-                if (tiff->currentFrame.bitspersample==8) {
-                    // we're done no little/big-endian correction necessary for 1-byte data
-                } else if (tiff->currentFrame.bitspersample==16) {
-                    // little/big-endian correction necessary for 2-byte data
-#ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
-                    printf("        - correcting 16-bit little-big-endian\n");
-#endif
-                    unsigned long x=0;
-                    for (x=0; x<tiff->currentFrame.width*tiff->currentFrame.height; x++) {
-                        ((uint16_t*)buffer)[x]=TinyTIFFReader_Byteswap16(((uint16_t*)buffer)[x]);
-                    }
-                } else if (tiff->currentFrame.bitspersample==32) {
-#ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
-                    printf("        - correcting 32-bit little-big-endian\n");
-#endif
+        //fsetpos(tiff->file, &pos);
+        TinyTIFFReader_fsetpos(tiff, &pos);
+        return !tiff->wasError;
+    }
+    return TINYTIFF_FALSE;
+}
 
-                    // little/big-endian correction necessary for 4-byte data
-                    unsigned long x=0;
-                    for (x=0; x<tiff->currentFrame.width*tiff->currentFrame.height; x++) {
-                        ((uint32_t*)buffer)[x]=TinyTIFFReader_Byteswap32(((uint32_t*)buffer)[x]);
-                    }
-                } else if (tiff->currentFrame.bitspersample==64) {
-#ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
-                    printf("        - correcting 32-bit little-big-endian\n");
-#endif
 
-                    // little/big-endian correction necessary for 8-byte data
-                    unsigned long x=0;
-                    for (x=0; x<tiff->currentFrame.width*tiff->currentFrame.height; x++) {
-                        ((uint64_t*)buffer)[x]=TinyTIFFReader_Byteswap64(((uint64_t*)buffer)[x]);
+/*! \brief returns a pointer to the given sample of the current frame inside the memory mapping of the file,
+           or NULL if the data cannot be accessed without copying
+    \ingroup tinytiffreader_internal
+    \internal
+
+    This is possible, if the file is memory mapped, the sample is stored uncompressed and in native byte order
+    as a single continuous (and suitably aligned) range of bytes, i.e. for 1-sample frames or planar frames, whose
+    strips directly follow each other in the file (e.g. a single strip per frame/sample).
+ */
+static const void* TinyTIFFReader_getMappedSampleData(TinyTIFFReaderFile* tiff, uint16_t sample) {
+    const TinyTIFFReaderFrame* frame=&(tiff->currentFrame);
+    if (!tiff->mappedData) return NULL;
+    if (frame->compression!=TIFF_COMPRESSION_NONE || frame->isTiled!=TINYTIFF_FALSE || frame->orientation!=TIFF_ORIENTATION_STANDARD) return NULL;
+    if (frame->photometric_interpretation==TIFF_PHOTOMETRICINTERPRETATION_PALETTE || frame->width==0 || frame->height==0) return NULL;
+    if (frame->bitspersample!=8 && frame->bitspersample!=16 && frame->bitspersample!=32 && frame->bitspersample!=64) return NULL;
+    if (frame->bitspersample>8 && tiff->systembyteorder!=tiff->filebyteorder) return NULL;
+    if (sample>=frame->samplesperpixel) return NULL;
+    if (frame->samplesperpixel>1 && frame->planarconfiguration!=TIFF_PLANARCONFIG_PLANAR) return NULL;
+    if (frame->stripcount==0 || !frame->stripoffsets || !frame->stripbytecounts) return NULL;
+
+    const uint64_t sample_image_size_bytes=(uint64_t)frame->width*(uint64_t)frame->height*frame->bitspersample/8;
+    const uint64_t sample_start_bytes=sample*sample_image_size_bytes;
+    const uint64_t sample_end_bytes=sample_start_bytes+sample_image_size_bytes;
+    uint64_t fileimageidx_bytes=0;
+    uint64_t start_fileoffset=0;
+    uint64_t expected_fileoffset=0;
+    int started=TINYTIFF_FALSE;
+    uint32_t strip;
+    for (strip=0; strip<frame->stripcount && fileimageidx_bytes<sample_end_bytes; strip++) {
+        const uint64_t stripsize_bytes=frame->stripbytecounts[strip];
+        if (!started && sample_start_bytes<fileimageidx_bytes+stripsize_bytes) {
+            start_fileoffset=frame->stripoffsets[strip]+(sample_start_bytes-fileimageidx_bytes);
+            started=TINYTIFF_TRUE;
+        } else if (started && frame->stripoffsets[strip]!=expected_fileoffset) {
+            // the strips of this sample are not continuous in the file
+            return NULL;
+        }
+        expected_fileoffset=frame->stripoffsets[strip]+stripsize_bytes;
+        fileimageidx_bytes+=stripsize_bytes;
+    }
+    if (!started || fileimageidx_bytes<sample_end_bytes) return NULL;
+    if (start_fileoffset>tiff->mappedSize || sample_image_size_bytes>tiff->mappedSize-start_fileoffset) return NULL;
+    const uint8_t* data=tiff->mappedData+start_fileoffset;
+    if (((size_t)data)%(frame->bitspersample/8)!=0) return NULL;
+    return data;
+}
+
+const void* TinyTIFFReader_getSampleDataPointer(TinyTIFFReaderFile* tiff, void* buffer, unsigned long buffer_size, uint16_t sample) {
+    if (!tiff) return NULL;
+    const void* mapped=TinyTIFFReader_getMappedSampleData(tiff, sample);
+    if (mapped) return mapped;
+    const void* prefetched=TinyTIFFReader_getPrefetchedSampleData(tiff, sample);
+    if (prefetched) return prefetched;
+    if (!buffer) return NULL;
+    if (TinyTIFFReader_getSampleData_s(tiff, buffer, buffer_size, sample)) return buffer;
+    return NULL;
+}
+
+int TinyTIFFReader_getSampleData(TinyTIFFReaderFile* tiff, void* buffer, uint16_t sample) {
+    return TinyTIFFReader_getSampleData_s___internl(tiff, buffer, 0, sample, TINYTIFF_FALSE);
+}
+
+int TinyTIFFReader_getSampleData_s(TinyTIFFReaderFile* tiff, void* buffer, unsigned long buffer_size, uint16_t sample) {
+    return TinyTIFFReader_getSampleData_s___internl(tiff, buffer, buffer_size, sample, TINYTIFF_TRUE);
+}
+
+int TinyTIFFReader_getSampleDataAll(TinyTIFFReaderFile* tiff, void* const* buffers, unsigned long buffer_size) {
+    if (tiff) {
+        if (!buffers) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "no output buffers given\0");
+            return TINYTIFF_FALSE;
+        }
+        if (!TinyTIFFReader_checkSampleDataSupported(tiff)) {
+            return TINYTIFF_FALSE;
+        }
+        const TinyTIFFReaderFrame* frame=&(tiff->currentFrame);
+        uint16_t sample;
+        if (frame->samplesperpixel<=1 || frame->planarconfiguration!=TIFF_PLANARCONFIG_CHUNKY || frame->isTiled!=TINYTIFF_FALSE || TinyTIFFReader_getPrefetchedSampleData(tiff, 0)) {
+            // the samples are stored separately (or in tiles, which are read row by row anyways, or were already loaded by the prefetch thread), so there is nothing to gain from reading them together
+            for (sample=0; sample<frame->samplesperpixel; sample++) {
+                if (!TinyTIFFReader_getSampleData_s___internl(tiff, buffers[sample], buffer_size, sample, TINYTIFF_TRUE)) return TINYTIFF_FALSE;
+            }
+            return TINYTIFF_TRUE;
+        }
+
+        const uint16_t bytespersample=frame->bitspersample/8;
+        const uint64_t pixels=(uint64_t)frame->width*(uint64_t)frame->height;
+        const size_t pixelsize_bytes=(size_t)bytespersample*frame->samplesperpixel;
+        if (buffer_size<pixels*bytespersample) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "sizeof input buffer was too small!\0");
+            return TINYTIFF_FALSE;
+        }
+        if (frame->stripcount==0 || !frame->stripbytecounts || !frame->stripoffsets) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "TIFF format not recognized\0");
+            return TINYTIFF_FALSE;
+        }
+        TinyTIFFReader_POSTYPE pos;
+        TinyTIFFReader_fgetpos(tiff, &pos);
+        tiff->wasError=TINYTIFF_FALSE;
+
+        // all samples are taken from a single pass over the strips, each strip is read once and then deinterleaved into the output buffers
+        void* dst[TINYTIFFREADER_MAXSAMPLES_SINGLEPASS];
+        void** dstp=dst;
+        if (frame->samplesperpixel>TINYTIFFREADER_MAXSAMPLES_SINGLEPASS) {
+            dstp=(void**)malloc(frame->samplesperpixel*sizeof(void*));
+            if (!dstp) {
+                tiff->wasError=TINYTIFF_TRUE;
+                TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+                return TINYTIFF_FALSE;
+            }
+        }
+        uint8_t* stripdata=NULL;
+        size_t last_stripsize_bytes=0;
+        uint64_t outputpixel=0;
+        uint32_t strip;
+        TinyTIFFReaderStripCursor cursor;
+        TinyTIFFReader_initStripCursor(&cursor);
+        for (strip=0; strip<frame->stripcount && outputpixel<pixels && !tiff->wasError; strip++) {
+            size_t stripsize_bytes=(size_t)frame->stripbytecounts[strip];
+            const uint64_t strip_offset_bytes=frame->stripoffsets[strip];
+            const uint8_t* stripsrc=NULL;
+            if (frame->compression!=TIFF_COMPRESSION_NONE) {
+                stripsize_bytes=(size_t)TinyTIFFReader_getDecodedStripSize(frame, strip);
+                if (!TinyTIFFReader_reserve((void**)&(cursor.decoded), &(cursor.decodedCapacity), stripsize_bytes, 1)) {
+                    tiff->wasError=TINYTIFF_TRUE;
+                    TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+                    break;
+                }
+                if (!TinyTIFFReader_decodeStrip(tiff, &cursor, strip, cursor.decoded, stripsize_bytes)) break;
+                stripsrc=cursor.decoded;
+            } else if (tiff->mappedData) {
+                if (strip_offset_bytes>tiff->mappedSize || stripsize_bytes>tiff->mappedSize-strip_offset_bytes) {
+                    tiff->wasError=TINYTIFF_TRUE;
+                    TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
+                    break;
+                }
+                stripsrc=tiff->mappedData+strip_offset_bytes;
+            } else {
+                if (stripsize_bytes>last_stripsize_bytes) {
+                    if (stripdata) free(stripdata);
+                    stripdata=(uint8_t*)malloc(stripsize_bytes);
+                    if (!stripdata) {
+                        tiff->wasError=TINYTIFF_TRUE;
+                        TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+                        break;
                     }
-                } else {
+                    last_stripsize_bytes=stripsize_bytes;
+                }
+                if (TinyTIFFReader_readAt(tiff, strip_offset_bytes, stripdata, last_stripsize_bytes, stripsize_bytes)!=stripsize_bytes) {
                     tiff->wasError=TINYTIFF_TRUE;
-                    TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader does not support the bitsPerSample, given in teh file (only 8,16,32bit are supported)\0");
+                    TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
+                    break;
                 }
+                stripsrc=stripdata;
             }
+            uint64_t strippixels=stripsize_bytes/pixelsize_bytes;
+            if (strippixels>pixels-outputpixel) strippixels=pixels-outputpixel;
+            for (sample=0; sample<frame->samplesperpixel; sample++) {
+                dstp[sample]=((uint8_t*)buffers[sample])+outputpixel*bytespersample;
+            }
+            TinyTIFF_deinterleave(stripsrc, dstp, (size_t)strippixels, frame->samplesperpixel, bytespersample);
+            if (tiff->systembyteorder!=tiff->filebyteorder) {
+                for (sample=0; sample<frame->samplesperpixel; sample++) {
+                    TinyTIFFReader_byteswapSampleData(tiff, dstp[sample], strippixels);
+                }
+            }
+            outputpixel+=strippixels;
+        }
+        if (stripdata) free(stripdata);
+        TinyTIFFReader_freeStripCursor(&cursor);
+        if (dstp!=dst) free(dstp);
+        if (!tiff->wasError && outputpixel<pixels) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
+        }
 
+        TinyTIFFReader_fsetpos(tiff, &pos);
+        return !tiff->wasError;
+    }
+    return TINYTIFF_FALSE;
+}
 
-        } else {
+int TinyTIFFReader_getFrameDataInterleaved(TinyTIFFReaderFile* tiff, void* buffer, unsigned long buffer_size) {
+    if (tiff) {
+        if (!TinyTIFFReader_checkSampleDataSupported(tiff)) {
+            return TINYTIFF_FALSE;
+        }
+        const TinyTIFFReaderFrame* frame=&(tiff->currentFrame);
+        if (frame->samplesperpixel>1 && frame->planarconfiguration!=TIFF_PLANARCONFIG_CHUNKY) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "the samples of the current frame are not stored interleaved (PlanarConfiguration=2)\0");
+            return TINYTIFF_FALSE;
+        }
+        const uint64_t samples=(uint64_t)frame->width*(uint64_t)frame->height*(frame->samplesperpixel>0?frame->samplesperpixel:1);
+        const uint64_t frame_size_bytes=samples*frame->bitspersample/8;
+        if (buffer_size<frame_size_bytes) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "sizeof input buffer was too small!\0");
+            return TINYTIFF_FALSE;
+        }
+        if (frame->stripcount==0 || !frame->stripbytecounts || !frame->stripoffsets) {
             tiff->wasError=TINYTIFF_TRUE;
             TINYTIFF_SET_LAST_ERROR(tiff, "TIFF format not recognized\0");
+            return TINYTIFF_FALSE;
+        }
+        TinyTIFFReader_POSTYPE pos;
+        TinyTIFFReader_fgetpos(tiff, &pos);
+        tiff->wasError=TINYTIFF_FALSE;
+
+        if (frame->isTiled!=TINYTIFF_FALSE) {
+            TinyTIFFReader_readTiles(tiff, buffer, buffer_size, (uint64_t)frame->width*(frame->samplesperpixel>0?frame->samplesperpixel:1)*(frame->bitspersample/8), 0, TINYTIFF_TRUE, 0, 0, frame->width, frame->height);
+            TinyTIFFReader_fsetpos(tiff, &pos);
+            return !tiff->wasError;
+        }
+
+        // the interleaved frame is simply the concatenation of all (decoded) strips
+        uint64_t outputidx_bytes=0;
+        uint64_t swappedidx_bytes=0;
+        uint32_t strip;
+        TinyTIFFReaderStripCursor cursor;
+        TinyTIFFReader_initStripCursor(&cursor);
+        for (strip=0; strip<frame->stripcount && outputidx_bytes<frame_size_bytes; strip++) {
+            size_t count_bytes_to_read=(size_t)((frame->compression!=TIFF_COMPRESSION_NONE)?TinyTIFFReader_getDecodedStripSize(frame, strip):frame->stripbytecounts[strip]);
+            if (count_bytes_to_read>frame_size_bytes-outputidx_bytes) count_bytes_to_read=(size_t)(frame_size_bytes-outputidx_bytes);
+            if (frame->compression!=TIFF_COMPRESSION_NONE) {
+                if (!TinyTIFFReader_decodeStrip(tiff, &cursor, strip, ((uint8_t*)buffer)+outputidx_bytes, count_bytes_to_read)) break;
+            } else if (TinyTIFFReader_readAt(tiff, frame->stripoffsets[strip], ((uint8_t*)buffer)+outputidx_bytes, (size_t)(frame_size_bytes-outputidx_bytes), count_bytes_to_read)!=count_bytes_to_read) {
+                tiff->wasError=TINYTIFF_TRUE;
+                TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
+                break;
+            }
+            outputidx_bytes+=count_bytes_to_read;
+            swappedidx_bytes=TinyTIFFReader_byteswapNewData(tiff, (uint8_t*)buffer, swappedidx_bytes, outputidx_bytes);
+        }
+        TinyTIFFReader_freeStripCursor(&cursor);
+        if (!tiff->wasError && outputidx_bytes<frame_size_bytes) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "TINYTIFFReader was unable to read all necessary data from the strip!\0");
         }
 
-        //fsetpos(tiff->file, &pos);
         TinyTIFFReader_fsetpos(tiff, &pos);
         return !tiff->wasError;
     }
     return TINYTIFF_FALSE;
 }
 
+int TinyTIFFReader_getSampleDataROIStrided(TinyTIFFReaderFile* tiff, void* buffer, unsigned long rowstride, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint16_t sample) {
+    if (tiff) {
+        if (!buffer) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "no output buffer given\0");
+            return TINYTIFF_FALSE;
+        }
+        if (!TinyTIFFReader_checkSampleDataSupported(tiff)) {
+            return TINYTIFF_FALSE;
+        }
+        const TinyTIFFReaderFrame* frame=&(tiff->currentFrame);
+        if (width==0 || height==0 || x>=frame->width || y>=frame->height || width>frame->width-x || height>frame->height-y) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "the region of interest exceeds the frame\0");
+            return TINYTIFF_FALSE;
+        }
+        if (sample>=frame->samplesperpixel) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "the requested sample is not available in the current frame\0");
+            return TINYTIFF_FALSE;
+        }
+        const uint16_t bytespersample=frame->bitspersample/8;
+        const uint64_t row_bytes=(uint64_t)width*bytespersample;
+        if (rowstride<row_bytes || rowstride%bytespersample!=0) {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "the row stride of the output buffer is invalid\0");
+            return TINYTIFF_FALSE;
+        }
+        TinyTIFFReader_POSTYPE pos;
+        TinyTIFFReader_fgetpos(tiff, &pos);
+        tiff->wasError=TINYTIFF_FALSE;
 
-int TinyTIFFReader_getSampleData(TinyTIFFReaderFile* tiff, void* buffer, uint16_t sample) {
-    return TinyTIFFReader_getSampleData_s___internl(tiff, buffer, 0, sample, TINYTIFF_FALSE);
+        if (frame->isTiled!=TINYTIFF_FALSE) {
+            TinyTIFFReader_readTiles(tiff, buffer, (uint64_t)rowstride*(height-1)+row_bytes, rowstride, sample, TINYTIFF_FALSE, x, y, width, height);
+        } else if (frame->stripcount>0 && frame->stripbytecounts && frame->stripoffsets) {
+            TinyTIFFReader_readStripsROI(tiff, buffer, rowstride, sample, x, y, width, height);
+        } else {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "TIFF format not recognized\0");
+        }
+        TinyTIFFReader_fsetpos(tiff, &pos);
+        return !tiff->wasError;
+    }
+    return TINYTIFF_FALSE;
 }
 
-int TinyTIFFReader_getSampleData_s(TinyTIFFReaderFile* tiff, void* buffer, unsigned long buffer_size, uint16_t sample) {
-    return TinyTIFFReader_getSampleData_s___internl(tiff, buffer, buffer_size, sample, TINYTIFF_TRUE);
+int TinyTIFFReader_getSampleDataROI(TinyTIFFReaderFile* tiff, void* buffer, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint16_t sample) {
+    if (tiff) {
+        return TinyTIFFReader_getSampleDataROIStrided(tiff, buffer, (unsigned long)width*(tiff->currentFrame.bitspersample/8), x, y, width, height, sample);
+    }
+    return TINYTIFF_FALSE;
 }
 
 
@@ -942,6 +2472,353 @@ int TinyTIFFReader_getSampleData_s(TinyTIFFReaderFile* tiff, void* buffer, unsig
 
 
 
+/*! \brief returns the number of frames \c N, given as a line \c images=N in the ImageDescription \a description (as written by TinyTIFFWriter and ImageJ),
+           or 0 if the description does not contain this information
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static uint32_t TinyTIFFReader_parseDescriptionFrames(const char* description) {
+    const char* p=description;
+    while (p && *p) {
+        if (strncmp(p, "images=", 7)==0) {
+            char* end=NULL;
+            const unsigned long long frames=strtoull(p+7, &end, 10);
+            // the number has to be complete, i.e. followed by another character (e.g. a linebreak) or the end of the string
+            if (end==p+7) return 0;
+            return (frames<=0xFFFFFFFF)?(uint32_t)frames:0;
+        }
+        p=strchr(p, '\n');
+        if (p) p++;
+    }
+    return 0;
+}
+
+/** \brief number of bytes at the start of the ImageDescription, that are searched for \c images=N by TinyTIFFReader_getDescriptionFrames() \internal */
+#define TINYTIFFREADER_DESCRIPTIONPREFIX_SIZE 1024
+
+/*! \brief returns the number of frames \c N, given as a line \c images=N in the ImageDescription of the current frame, or 0
+    \ingroup tinytiffreader_internal
+    \internal
+
+    If the ImageDescription was not read yet, only its first TINYTIFFREADER_DESCRIPTIONPREFIX_SIZE bytes are read (TinyTIFFWriter and
+    ImageJ write this information at the start), so the (possibly huge) ImageDescription is not loaded.
+ */
+static uint32_t TinyTIFFReader_getDescriptionFrames(TinyTIFFReaderFile* tiff) {
+    const TinyTIFFReaderFrame* frame=&(tiff->currentFrame);
+    if (frame->description) return TinyTIFFReader_parseDescriptionFrames(frame->description);
+    if (frame->descriptionLength==0) return 0;
+    char prefix[TINYTIFFREADER_DESCRIPTIONPREFIX_SIZE+1];
+    const int complete=(frame->descriptionLength<=TINYTIFFREADER_DESCRIPTIONPREFIX_SIZE);
+    const size_t length=(size_t)TinyTIFFReader_min(frame->descriptionLength, TINYTIFFREADER_DESCRIPTIONPREFIX_SIZE);
+    const size_t read=TinyTIFFReader_readAt(tiff, frame->descriptionOffset, prefix, sizeof(prefix), length);
+    prefix[read]='\0';
+    if (!complete && read>0) {
+        // drop the last (possibly incomplete) line
+        char* lastline=strrchr(prefix, '\n');
+        if (lastline) *lastline='\0';
+        else return 0;
+    }
+    return TinyTIFFReader_parseDescriptionFrames(prefix);
+}
+
+/*! \brief reads the ImageDescription of the current frame (with a single read), if this was not done yet
+    \ingroup tinytiffreader_internal
+    \internal
+
+    The memory for the description is allocated from the frame arena, so it is valid until the next frame is read.
+ */
+static void TinyTIFFReader_loadImageDescription(TinyTIFFReaderFile* tiff) {
+    TinyTIFFReaderFrame* frame=&(tiff->currentFrame);
+    if (frame->description || frame->descriptionLength==0) return;
+    const uint64_t length=frame->descriptionLength;
+    frame->descriptionLength=0;
+    if (frame->descriptionOffset>tiff->filesize || length>tiff->filesize-frame->descriptionOffset) return;
+    char* description=(char*)TinyTIFFReader_arenaAlloc(&(tiff->frameArena), (size_t)length+1);
+    if (!description) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "Unable to allocate memory for frame's description!\0");
+        return;
+    }
+    if (TinyTIFFReader_readAt(tiff, frame->descriptionOffset, description, (size_t)length+1, (size_t)length)==length) {
+        description[length]='\0';
+        frame->description=description;
+    }
+}
+
+/*! \brief makes the (already open) file of \a tiff available for positional reads through \a shared, \a tiff keeps the ownership of the file
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static void TinyTIFFReader_borrowFile(TinyTIFFReaderFile* tiff, TinyTIFFReaderSharedFile* shared) {
+#if defined(TINYTIFF_USE_WINAPI_FOR_FILEIO)
+    shared->hFile=tiff->hFile;
+#elif defined(__WINDOWS__)
+    shared->hFile=(HANDLE)_get_osfhandle(_fileno(tiff->file));
+#elif defined(TINYTIFF_HAVE_PREAD)
+    shared->fd=fileno(tiff->file);
+#else
+    shared->file=tiff->file;
+    TinyTIFF_Mutex_init(&(shared->fileMutex));
+#endif
+    shared->mappedData=tiff->mappedData;
+    shared->mappedSize=tiff->mappedSize;
+}
+
+/*! \brief releases the resources of a file, made available with TinyTIFFReader_borrowFile() (the file stays open)
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static void TinyTIFFReader_releaseBorrowedFile(TinyTIFFReaderSharedFile* shared) {
+#if !defined(__WINDOWS__) && !defined(TINYTIFF_HAVE_PREAD)
+    TinyTIFF_Mutex_destroy(&(shared->fileMutex));
+#else
+    (void)shared;
+#endif
+}
+
+/*! \brief copies the current frame of the prefetch thread's reader \a scout (properties, strip tables, ImageDescription and the data of all samples) into \a slot
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static void TinyTIFFReader_fillPrefetchSlot(TinyTIFFReaderFile* scout, TinyTIFFReaderPrefetchSlot* slot) {
+    TinyTIFFReaderFrame* frame=&(scout->currentFrame);
+    slot->frame=*frame;
+    slot->nextifd_offset=scout->nextifd_offset;
+    slot->wasError=scout->wasError;
+    if (scout->wasError) memcpy(slot->lastError, scout->lastError, TIFF_LAST_ERROR_SIZE);
+    slot->planeSize=0;
+    slot->frame.stripoffsets=NULL;
+    slot->frame.stripbytecounts=NULL;
+    if (frame->stripoffsets && frame->stripbytecounts && TinyTIFFReader_reserve((void**)&(slot->tables), &(slot->tablesCapacity), 2*(uint64_t)frame->stripcount, sizeof(uint64_t))) {
+        memcpy(slot->tables, frame->stripoffsets, frame->stripcount*sizeof(uint64_t));
+        memcpy(slot->tables+frame->stripcount, frame->stripbytecounts, frame->stripcount*sizeof(uint64_t));
+        slot->frame.stripoffsets=slot->tables;
+        slot->frame.stripbytecounts=slot->tables+frame->stripcount;
+    }
+    slot->frame.description=NULL;
+    if (frame->description) {
+        const uint64_t length=strlen(frame->description)+1;
+        if (TinyTIFFReader_reserve((void**)&(slot->description), &(slot->descriptionCapacity), length, 1)) {
+            memcpy(slot->description, frame->description, (size_t)length);
+            slot->frame.description=slot->description;
+        }
+    }
+    if (scout->wasError || !slot->frame.stripoffsets || frame->width==0 || frame->height==0) return;
+
+    // the data of all samples is loaded in a single pass, if possible (see TinyTIFFReader_getSampleDataAll())
+    const uint64_t planeSize=(uint64_t)frame->width*(uint64_t)frame->height*(frame->bitspersample/8);
+    if (planeSize==0 || (uint64_t)((unsigned long)planeSize)!=planeSize) return;
+    if (!TinyTIFFReader_reserve((void**)&(slot->data), &(slot->dataCapacity), planeSize*frame->samplesperpixel, 1)) return;
+    int ok=TINYTIFF_TRUE;
+    uint16_t sample;
+    if (frame->samplesperpixel<=TINYTIFFREADER_MAXSAMPLES_SINGLEPASS) {
+        void* planes[TINYTIFFREADER_MAXSAMPLES_SINGLEPASS];
+        for (sample=0; sample<frame->samplesperpixel; sample++) {
+            planes[sample]=slot->data+sample*planeSize;
+        }
+        ok=TinyTIFFReader_getSampleDataAll(scout, planes, (unsigned long)planeSize);
+    } else {
+        for (sample=0; ok && sample<frame->samplesperpixel; sample++) {
+            ok=TinyTIFFReader_getSampleData_s___internl(scout, slot->data+sample*planeSize, (unsigned long)planeSize, sample, TINYTIFF_TRUE);
+        }
+    }
+    if (ok) slot->planeSize=planeSize;
+    scout->wasError=TINYTIFF_FALSE;
+}
+
+/*! \brief main function of the prefetch thread: parses the following IFDs and loads the frames into the ring of slots,
+           until the last frame was loaded or TinyTIFFReaderPrefetch::stop is set
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static void TinyTIFFReader_prefetchThread(void* arg) {
+    TinyTIFFReaderPrefetch* prefetch=(TinyTIFFReaderPrefetch*)arg;
+    TinyTIFFReaderFile* scout=&(prefetch->scout);
+    while (TinyTIFFReader_hasNext(scout)) {
+        // the IFD is parsed before waiting for a free slot, as its size is needed to check the memory limit
+        scout->currentFrameIndex++;
+        scout->wasError=TINYTIFF_FALSE;
+        TinyTIFFReader_readNextFrame(scout);
+        TinyTIFFReader_loadImageDescription(scout);
+        const TinyTIFFReaderFrame* frame=&(scout->currentFrame);
+        const uint64_t frameBytes=(uint64_t)frame->width*(uint64_t)frame->height*(frame->bitspersample/8)*frame->samplesperpixel;
+
+        TinyTIFF_Mutex_lock(&prefetch->mutex);
+        while (!prefetch->stop && (prefetch->queued>=prefetch->frames || (prefetch->queued>0 && prefetch->maxBytes>0 && prefetch->queuedBytes+frameBytes>prefetch->maxBytes))) {
+            TinyTIFF_Cond_wait(&prefetch->frameTaken, &prefetch->mutex);
+        }
+        if (prefetch->stop) {
+            TinyTIFF_Mutex_unlock(&prefetch->mutex);
+            return;
+        }
+        const uint32_t slot=prefetch->head;
+        // the slot is not touched by the caller, until queued is incremented, so the file I/O runs without holding the lock
+        TinyTIFF_Mutex_unlock(&prefetch->mutex);
+        TinyTIFFReader_fillPrefetchSlot(scout, &(prefetch->slots[slot]));
+        TinyTIFF_Mutex_lock(&prefetch->mutex);
+        prefetch->head=(slot+1)%prefetch->slotCount;
+        prefetch->queued++;
+        prefetch->queuedBytes+=prefetch->slots[slot].planeSize*prefetch->slots[slot].frame.samplesperpixel;
+        TinyTIFF_Cond_broadcast(&prefetch->frameLoaded);
+        TinyTIFF_Mutex_unlock(&prefetch->mutex);
+    }
+    TinyTIFF_Mutex_lock(&prefetch->mutex);
+    prefetch->finished=TINYTIFF_TRUE;
+    TinyTIFF_Cond_broadcast(&prefetch->frameLoaded);
+    TinyTIFF_Mutex_unlock(&prefetch->mutex);
+}
+
+/*! \brief makes the next frame, loaded by the prefetch thread, the current frame of \a tiff (waits until it is loaded)
+    \ingroup tinytiffreader_internal
+    \internal
+
+    \return TINYTIFF_FALSE, if the prefetch thread did not load the next frame, it then has to be read synchronously
+ */
+static int TinyTIFFReader_takePrefetchedFrame(TinyTIFFReaderFile* tiff) {
+    TinyTIFFReaderPrefetch* prefetch=tiff->prefetch;
+    TinyTIFF_Mutex_lock(&prefetch->mutex);
+    prefetch->current=-1;
+    while (prefetch->queued==0 && !prefetch->finished) {
+        TinyTIFF_Cond_wait(&prefetch->frameLoaded, &prefetch->mutex);
+    }
+    if (prefetch->queued==0) {
+        TinyTIFF_Mutex_unlock(&prefetch->mutex);
+        return TINYTIFF_FALSE;
+    }
+    const uint32_t slotidx=(prefetch->head+prefetch->slotCount-prefetch->queued)%prefetch->slotCount;
+    const TinyTIFFReaderPrefetchSlot* slot=&(prefetch->slots[slotidx]);
+    prefetch->queued--;
+    prefetch->queuedBytes-=slot->planeSize*slot->frame.samplesperpixel;
+    prefetch->current=(int32_t)slotidx;
+    TinyTIFF_Cond_broadcast(&prefetch->frameTaken);
+    TinyTIFF_Mutex_unlock(&prefetch->mutex);
+
+    // the strip tables and the ImageDescription are copied into the frame arena, as for a frame read with TinyTIFFReader_readNextFrame()
+    TinyTIFFReader_resetArena(&(tiff->frameArena));
+    tiff->currentFrame=slot->frame;
+    tiff->currentFrame.stripoffsets=NULL;
+    tiff->currentFrame.stripbytecounts=NULL;
+    tiff->currentFrame.description=NULL;
+    if (slot->frame.stripoffsets) {
+        uint64_t* tables=(uint64_t*)TinyTIFFReader_arenaAlloc(&(tiff->frameArena), 2*(size_t)slot->frame.stripcount*sizeof(uint64_t));
+        if (tables) {
+            memcpy(tables, slot->tables, 2*(size_t)slot->frame.stripcount*sizeof(uint64_t));
+            tiff->currentFrame.stripoffsets=tables;
+            tiff->currentFrame.stripbytecounts=tables+slot->frame.stripcount;
+        } else {
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+        }
+    }
+    if (slot->frame.description) {
+        const size_t length=strlen(slot->frame.description)+1;
+        tiff->currentFrame.description=(char*)TinyTIFFReader_arenaAlloc(&(tiff->frameArena), length);
+        if (tiff->currentFrame.description) memcpy(tiff->currentFrame.description, slot->frame.description, length);
+    }
+    if (slot->wasError) {
+        tiff->wasError=TINYTIFF_TRUE;
+        memcpy(tiff->lastError, slot->lastError, TIFF_LAST_ERROR_SIZE);
+    }
+    tiff->nextifd_offset=slot->nextifd_offset;
+    if (TinyTIFFReader_addFrameIndex(tiff, tiff->currentFrameIndex+1, tiff->nextifd_offset)) {
+        TinyTIFFReader_detectUniformLayout(tiff);
+    }
+    return TINYTIFF_TRUE;
+}
+
+int TinyTIFFReader_enablePrefetch(TinyTIFFReaderFile* tiff, uint32_t frames, uint64_t maxBytes) {
+    if (!tiff) return TINYTIFF_FALSE;
+    TinyTIFFReader_disablePrefetch(tiff);
+    if (frames==0 || frames==0xFFFFFFFF) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "TinyTIFFReader_enablePrefetch() needs at least one frame\0");
+        return TINYTIFF_FALSE;
+    }
+    TinyTIFFReaderPrefetch* prefetch=(TinyTIFFReaderPrefetch*)calloc(1, sizeof(TinyTIFFReaderPrefetch));
+    if (prefetch) {
+        prefetch->slotCount=frames+1;
+        prefetch->slots=(TinyTIFFReaderPrefetchSlot*)calloc(prefetch->slotCount, sizeof(TinyTIFFReaderPrefetchSlot));
+    }
+    if (!prefetch || !prefetch->slots) {
+        if (prefetch) free(prefetch);
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+        return TINYTIFF_FALSE;
+    }
+    prefetch->frames=frames;
+    prefetch->maxBytes=maxBytes;
+    prefetch->current=-1;
+    TinyTIFFReader_borrowFile(tiff, &(prefetch->file));
+    // the prefetch thread's reader starts at the current frame and does not need a frame index
+    TinyTIFFReaderFile* scout=&(prefetch->scout);
+    scout->shared=&(prefetch->file);
+    scout->systembyteorder=tiff->systembyteorder;
+    scout->filebyteorder=tiff->filebyteorder;
+    scout->bigTIFF=tiff->bigTIFF;
+    scout->filesize=tiff->filesize;
+    scout->mappedData=tiff->mappedData;
+    scout->mappedSize=tiff->mappedSize;
+    scout->currentFrameIndex=tiff->currentFrameIndex;
+    scout->nextifd_offset=tiff->nextifd_offset;
+    scout->frameOffsetsComplete=TINYTIFF_TRUE;
+    scout->frameArena.blocks=NULL;
+    TinyTIFF_Mutex_init(&prefetch->mutex);
+    TinyTIFF_Cond_init(&prefetch->frameLoaded);
+    TinyTIFF_Cond_init(&prefetch->frameTaken);
+    // from now on, the caller also uses positional reads, so both threads can read from the file at the same time
+    tiff->shared=&(prefetch->file);
+    tiff->prefetch=prefetch;
+    if (!TinyTIFF_Thread_create(&prefetch->thread, TinyTIFFReader_prefetchThread, prefetch)) {
+        tiff->shared=NULL;
+        tiff->prefetch=NULL;
+        TinyTIFF_Cond_destroy(&prefetch->frameTaken);
+        TinyTIFF_Cond_destroy(&prefetch->frameLoaded);
+        TinyTIFF_Mutex_destroy(&prefetch->mutex);
+        TinyTIFFReader_releaseBorrowedFile(&(prefetch->file));
+        free(prefetch->slots);
+        free(prefetch);
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "unable to start the prefetch thread\0");
+        return TINYTIFF_FALSE;
+    }
+    return TINYTIFF_TRUE;
+}
+
+void TinyTIFFReader_disablePrefetch(TinyTIFFReaderFile* tiff) {
+    if (!tiff || !tiff->prefetch) return;
+    TinyTIFFReaderPrefetch* prefetch=tiff->prefetch;
+    TinyTIFF_Mutex_lock(&prefetch->mutex);
+    prefetch->stop=TINYTIFF_TRUE;
+    TinyTIFF_Cond_broadcast(&prefetch->frameTaken);
+    TinyTIFF_Mutex_unlock(&prefetch->mutex);
+    TinyTIFF_Thread_join(prefetch->thread);
+    // the current frame stays valid, its data is read synchronously from now on
+    tiff->shared=NULL;
+    tiff->prefetch=NULL;
+    TinyTIFF_Cond_destroy(&prefetch->frameTaken);
+    TinyTIFF_Cond_destroy(&prefetch->frameLoaded);
+    TinyTIFF_Mutex_destroy(&prefetch->mutex);
+    TinyTIFFReader_releaseBorrowedFile(&(prefetch->file));
+    TinyTIFFReader_freeArena(&(prefetch->scout.frameArena));
+    TinyTIFF_deflateCodecRelease(&(prefetch->scout.deflateCodec));
+    uint32_t i;
+    for (i=0; i<prefetch->slotCount; i++) {
+        free(prefetch->slots[i].tables);
+        free(prefetch->slots[i].description);
+        free(prefetch->slots[i].data);
+    }
+    free(prefetch->slots);
+    free(prefetch);
+}
+
+uint32_t TinyTIFFReader_getPrefetchedFrames(TinyTIFFReaderFile* tiff) {
+    if (!tiff || !tiff->prefetch) return 0;
+    TinyTIFF_Mutex_lock(&tiff->prefetch->mutex);
+    const uint32_t queued=tiff->prefetch->queued;
+    TinyTIFF_Mutex_unlock(&tiff->prefetch->mutex);
+    return queued;
+}
+
 TinyTIFFReaderFile* TinyTIFFReader_open(const char* filename) {
     TinyTIFFReaderFile* tiff=(TinyTIFFReaderFile*)malloc(sizeof(TinyTIFFReaderFile));
     if (tiff) {
@@ -951,6 +2828,24 @@ TinyTIFFReaderFile* TinyTIFFReader_open(const char* filename) {
              tiff->filesize=file.st_size;
         }
         tiff->currentFrame=TinyTIFFReader_getEmptyFrame();
+        tiff->frameArena.blocks=NULL;
+        memset(&(tiff->deflateCodec), 0, sizeof(tiff->deflateCodec));
+        tiff->mappedData=NULL;
+        tiff->mappedSize=0;
+        tiff->currentFrameIndex=0;
+        tiff->frameOffsets=NULL;
+        tiff->frameOffsetsCount=0;
+        tiff->frameOffsetsCapacity=0;
+        tiff->frameOffsetsComplete=TINYTIFF_FALSE;
+        tiff->uniformLayout=TINYTIFF_FALSE;
+        tiff->uniformLayoutChecked=TINYTIFF_FALSE;
+        tiff->uniformStride=0;
+        tiff->uniformFrames=0;
+        tiff->strictFrameValidation=TINYTIFF_FALSE;
+        tiff->descriptionFrames=0;
+        tiff->shared=NULL;
+        tiff->prefetch=NULL;
+        tiff->readThreads=0;
 
 
         //tiff->file=v(filename, "rb");
@@ -958,6 +2853,7 @@ TinyTIFFReaderFile* TinyTIFFReader_open(const char* filename) {
         tiff->systembyteorder=TIFFReader_get_byteorder();
         memset(tiff->lastError, 0, TIFF_LAST_ERROR_SIZE);
         tiff->wasError=TINYTIFF_FALSE;
+        tiff->bigTIFF=TINYTIFF_FALSE;
         if (TinyTIFFReader_fOK(tiff) && tiff->filesize>0) {
             const unsigned long tiffidsize=3;
             uint8_t tiffid[3]={0,0,0};
@@ -969,7 +2865,7 @@ TinyTIFFReaderFile* TinyTIFFReader_open(const char* filename) {
             if (tiffid[0]=='I' && tiffid[1]=='I') tiff->filebyteorder=TIFF_ORDER_LITTLEENDIAN;
             else if (tiffid[0]=='M' && tiffid[1]=='M') tiff->filebyteorder=TIFF_ORDER_BIGENDIAN;
             else {
-                TinyTIFFReader_freeEmptyFrame(tiff->currentFrame);
+                TinyTIFFReader_freeArena(&(tiff->frameArena));
                 free(tiff);
                 return NULL;
             }
@@ -977,20 +2873,35 @@ TinyTIFFReaderFile* TinyTIFFReader_open(const char* filename) {
     #ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
             printf("      - magic=%u\n", magic);
     #endif
-            if (magic!=42) {
-                TinyTIFFReader_freeEmptyFrame(tiff->currentFrame);
+            if (magic==43) {
+                // BigTIFF: the magic is followed by the offset bytesize (always 8) and a reserved 0
+                const uint16_t offsetsize=TinyTIFFReader_readuint16(tiff);
+                const uint16_t reserved=TinyTIFFReader_readuint16(tiff);
+                if (offsetsize!=8 || reserved!=0) {
+                    TinyTIFFReader_freeArena(&(tiff->frameArena));
+                    TinyTIFFReader_fclose(tiff);
+                    free(tiff);
+                    return NULL;
+                }
+                tiff->bigTIFF=TINYTIFF_TRUE;
+            } else if (magic!=42) {
+                TinyTIFFReader_freeArena(&(tiff->frameArena));
+                TinyTIFFReader_fclose(tiff);
                 free(tiff);
                 return NULL;
             }
-            tiff->firstrecord_offset=TinyTIFFReader_readuint32(tiff);
+            tiff->firstrecord_offset=TinyTIFFReader_readOffset(tiff);
             tiff->nextifd_offset=tiff->firstrecord_offset;
     #ifdef TINYTIFF_ADDITIONAL_DEBUG_MESSAGES
-            printf("      - filesize=%lu\n", tiff->filesize);
-            printf("      - firstrecord_offset=%4X\n", tiff->firstrecord_offset);
+            printf("      - filesize=%lu\n", (unsigned long)tiff->filesize);
+            printf("      - bigTIFF=%d\n", (int)tiff->bigTIFF);
+            printf("      - firstrecord_offset=%4lX\n", (unsigned long)tiff->firstrecord_offset);
     #endif
+            TinyTIFFReader_addFrameIndex(tiff, 0, tiff->firstrecord_offset);
             TinyTIFFReader_readNextFrame(tiff);
+            tiff->descriptionFrames=TinyTIFFReader_getDescriptionFrames(tiff);
         } else {
-            TinyTIFFReader_freeEmptyFrame(tiff->currentFrame);
+            TinyTIFFReader_freeArena(&(tiff->frameArena));
             free(tiff);
             return NULL;
         }
@@ -1003,15 +2914,37 @@ TinyTIFFReaderFile* TinyTIFFReader_open(const char* filename) {
     return tiff;
 }
 
+TinyTIFFReaderFile* TinyTIFFReader_openMemoryMapped(const char* filename) {
+    TinyTIFFReaderFile* tiff=TinyTIFFReader_open(filename);
+    if (tiff) {
+        TinyTIFFReader_mapFile(tiff, filename);
+    }
+    return tiff;
+}
+
+int TinyTIFFReader_isMemoryMapped(TinyTIFFReaderFile* tiff) {
+    if (tiff && tiff->mappedData) return TINYTIFF_TRUE;
+    return TINYTIFF_FALSE;
+}
+
 void TinyTIFFReader_close(TinyTIFFReaderFile* tiff) {
     if (tiff) {
-        TinyTIFFReader_freeEmptyFrame(tiff->currentFrame);
+        TinyTIFFReader_disablePrefetch(tiff);
+        TinyTIFFReader_unmapFile(tiff);
+        TinyTIFFReader_freeArena(&(tiff->frameArena));
+        TinyTIFF_deflateCodecRelease(&(tiff->deflateCodec));
+        if (tiff->frameOffsets) free(tiff->frameOffsets);
         //fclose(tiff->file);
         TinyTIFFReader_fclose(tiff);
         free(tiff);
     }
 }
 
+int TinyTIFFReader_isBigTIFF(TinyTIFFReaderFile* tiff) {
+    if (tiff) return tiff->bigTIFF;
+    return TINYTIFF_FALSE;
+}
+
 int TinyTIFFReader_hasNext(TinyTIFFReaderFile* tiff) {
     if (tiff) {
         if (tiff->nextifd_offset>0 && tiff->nextifd_offset<tiff->filesize) return TINYTIFF_TRUE;
@@ -1025,11 +2958,50 @@ int TinyTIFFReader_readNext(TinyTIFFReaderFile* tiff) {
     if (!tiff) return TINYTIFF_FALSE;
     int hasNext=TinyTIFFReader_hasNext(tiff);
     if (hasNext) {
-        TinyTIFFReader_readNextFrame(tiff);
+        tiff->currentFrameIndex++;
+        if (!tiff->prefetch || !TinyTIFFReader_takePrefetchedFrame(tiff)) {
+            TinyTIFFReader_readNextFrame(tiff);
+        }
     }
     return hasNext;
 }
 
+int TinyTIFFReader_seekFrame(TinyTIFFReaderFile* tiff, uint32_t frame) {
+    if (!tiff) return TINYTIFF_FALSE;
+    if (tiff->prefetch) {
+        // the frames loaded in advance are discarded and the prefetch thread restarts at the new position
+        const uint32_t frames=tiff->prefetch->frames;
+        const uint64_t maxBytes=tiff->prefetch->maxBytes;
+        TinyTIFFReader_disablePrefetch(tiff);
+        const int ok=TinyTIFFReader_seekFrame(tiff, frame);
+        TinyTIFFReader_enablePrefetch(tiff, frames, maxBytes);
+        return ok;
+    }
+    if (!TinyTIFFReader_extendFrameIndex(tiff, frame)) return TINYTIFF_FALSE;
+    tiff->currentFrameIndex=frame;
+    tiff->nextifd_offset=TinyTIFFReader_getIndexedFrameOffset(tiff, frame);
+    TinyTIFFReader_readNextFrame(tiff);
+    return TINYTIFF_TRUE;
+}
+
+uint32_t TinyTIFFReader_getCurrentFrame(TinyTIFFReaderFile* tiff) {
+    if (tiff) return tiff->currentFrameIndex;
+    return 0;
+}
+
+void TinyTIFFReader_setStrictFrameValidation(TinyTIFFReaderFile* tiff, int enabled) {
+    if (!tiff) return;
+    tiff->strictFrameValidation=(enabled)?TINYTIFF_TRUE:TINYTIFF_FALSE;
+    if (tiff->strictFrameValidation && tiff->uniformLayout) {
+        // forget the calculated frame offsets, the IFD chain is walked on demand
+        tiff->uniformLayout=TINYTIFF_FALSE;
+        tiff->frameOffsetsComplete=TINYTIFF_FALSE;
+    }
+    if (!tiff->strictFrameValidation && !tiff->uniformLayout) {
+        tiff->uniformLayoutChecked=TINYTIFF_FALSE;
+    }
+}
+
 uint32_t TinyTIFFReader_getWidth(TinyTIFFReaderFile* tiff) {
     if (tiff) {
         return tiff->currentFrame.width;
@@ -1046,6 +3018,7 @@ uint32_t TinyTIFFReader_getHeight(TinyTIFFReaderFile* tiff) {
 
 const char* TinyTIFFReader_getImageDescription(TinyTIFFReaderFile* tiff) {
     if (tiff) {
+        TinyTIFFReader_loadImageDescription(tiff);
         if (tiff->currentFrame.description) return tiff->currentFrame.description;
     }
     static const char* nothing = "";
@@ -1076,33 +3049,378 @@ uint16_t TinyTIFFReader_getSamplesPerPixel(TinyTIFFReaderFile* tiff) {
 
 
 uint32_t TinyTIFFReader_countFrames(TinyTIFFReaderFile* tiff) {
-
     if (tiff) {
-        uint32_t frames=0;
-        TinyTIFFReader_POSTYPE pos;
-        //printf("    -> countFrames: pos before %ld\n", ftell(tiff->file));
-        //fgetpos(tiff->file, &pos);
-        TinyTIFFReader_fgetpos(tiff, &pos);
+        // walk the IFD chain once, all further calls (and TinyTIFFReader_seekFrame()) reuse the frame index
+        TinyTIFFReader_extendFrameIndex(tiff, 0xFFFFFFFF);
+        return TinyTIFFReader_getIndexedFrames(tiff);
+    }
+    return 0;
+}
 
-        uint32_t nextOffset=tiff->firstrecord_offset;
-        while (nextOffset>0) {
-            //fseek(tiff->file, nextOffset, SEEK_SET);
-            TinyTIFFReader_fseek_set(tiff, nextOffset);
-            uint16_t count=TinyTIFFReader_readuint16(tiff);
-            //fseek(tiff->file, count*12, SEEK_CUR);
-            TinyTIFFReader_fseek_cur(tiff, count*12);
-            nextOffset=TinyTIFFReader_readuint32(tiff);
-            frames++;
+/*! \brief parses the IFDs of up to \a maxFrames frames of \a tiff, starting with the current frame, and stores their properties in \a shared
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static int TinyTIFFReader_collectSharedFrames(TinyTIFFReaderFile* tiff, TinyTIFFReaderSharedFile* shared, uint32_t maxFrames) {
+    uint32_t capacity=0;
+    uint64_t stripTablesSize=0, stripTablesCapacity=0;
+    // start of the strip tables of each frame in shared->stripTables (which may still move, while it grows)
+    uint64_t* tableStarts=NULL;
+    int ok=TINYTIFF_TRUE;
+    do {
+        if (tiff->wasError) {
+            ok=TINYTIFF_FALSE;
+            break;
+        }
+        if (shared->frameCount>=capacity) {
+            capacity=(capacity==0)?16:capacity*2;
+            TinyTIFFReaderFrame* frames=(TinyTIFFReaderFrame*)realloc(shared->frames, capacity*sizeof(TinyTIFFReaderFrame));
+            if (frames) shared->frames=frames;
+            uint64_t* starts=(uint64_t*)realloc(tableStarts, capacity*sizeof(uint64_t));
+            if (starts) tableStarts=starts;
+            if (!frames || !starts) {
+                ok=TINYTIFF_FALSE;
+                break;
+            }
+        }
+        const uint32_t stripcount=(tiff->currentFrame.stripoffsets && tiff->currentFrame.stripbytecounts)?tiff->currentFrame.stripcount:0;
+        if (stripTablesSize+2*(uint64_t)stripcount>stripTablesCapacity) {
+            while (stripTablesSize+2*(uint64_t)stripcount>stripTablesCapacity) stripTablesCapacity=(stripTablesCapacity==0)?64:stripTablesCapacity*2;
+            uint64_t* tables=(uint64_t*)realloc(shared->stripTables, (size_t)stripTablesCapacity*sizeof(uint64_t));
+            if (!tables) {
+                ok=TINYTIFF_FALSE;
+                break;
+            }
+            shared->stripTables=tables;
+        }
+        TinyTIFFReaderFrame* frame=&(shared->frames[shared->frameCount]);
+        *frame=tiff->currentFrame;
+        frame->description=NULL;
+        frame->descriptionOffset=0;
+        frame->descriptionLength=0;
+        frame->stripcount=stripcount;
+        frame->stripoffsets=NULL;
+        frame->stripbytecounts=NULL;
+        if (stripcount>0) {
+            memcpy(shared->stripTables+stripTablesSize, tiff->currentFrame.stripoffsets, stripcount*sizeof(uint64_t));
+            memcpy(shared->stripTables+stripTablesSize+stripcount, tiff->currentFrame.stripbytecounts, stripcount*sizeof(uint64_t));
         }
+        tableStarts[shared->frameCount]=stripTablesSize;
+        stripTablesSize+=2*(uint64_t)stripcount;
+        shared->frameCount++;
+    } while (shared->frameCount<maxFrames && TinyTIFFReader_readNext(tiff));
+    if (ok && tiff->wasError) ok=TINYTIFF_FALSE;
+    if (ok) {
+        uint32_t i;
+        for (i=0; i<shared->frameCount; i++) {
+            TinyTIFFReaderFrame* frame=&(shared->frames[i]);
+            if (frame->stripcount>0) {
+                frame->stripoffsets=shared->stripTables+tableStarts[i];
+                frame->stripbytecounts=shared->stripTables+tableStarts[i]+frame->stripcount;
+            }
+        }
+    }
+    if (tableStarts) free(tableStarts);
+    return ok;
+}
 
+/*! \brief releases the frame index of \a shared
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static void TinyTIFFReader_freeSharedFrames(TinyTIFFReaderSharedFile* shared) {
+    if (shared->frames) free(shared->frames);
+    if (shared->stripTables) free(shared->stripTables);
+    shared->frames=NULL;
+    shared->stripTables=NULL;
+    shared->frameCount=0;
+}
 
-        //fsetpos(tiff->file, &pos);
-        TinyTIFFReader_fsetpos(tiff, &pos);
-        //printf("    -> countFrames: pos after %ld\n", ftell(tiff->file));
-        return frames;
+/*! \brief initializes \a view as a reader on the frame \a frame of \a shared, which reads all data with positional reads.
+    \ingroup tinytiffreader_internal
+    \internal
+
+    Each thread uses its own view (usually on the stack), so the views only share the immutable frame index and
+    differ in their private error state. The Deflate decompressor of \a view is kept, so a view can be reused for several frames:
+    it has to be zero-initialized before the first call and released with TinyTIFF_deflateCodecRelease() after the last.
+ */
+static void TinyTIFFReader_initSharedView(TinyTIFFReaderFile* view, TinyTIFFReaderSharedFile* shared, uint32_t frame) {
+    const TinyTIFF_DeflateCodec deflateCodec=view->deflateCodec;
+    memset(view, 0, sizeof(TinyTIFFReaderFile));
+    view->deflateCodec=deflateCodec;
+    view->shared=shared;
+    view->systembyteorder=shared->systembyteorder;
+    view->filebyteorder=shared->filebyteorder;
+    view->bigTIFF=shared->bigTIFF;
+    view->filesize=shared->filesize;
+    view->mappedData=shared->mappedData;
+    view->mappedSize=shared->mappedSize;
+    view->currentFrameIndex=frame;
+    view->currentFrame=shared->frames[frame];
+    view->wasError=TINYTIFF_FALSE;
+}
+
+TinyTIFFReaderSharedFile* TinyTIFFReader_openShared(const char* filename) {
+    TinyTIFFReaderFile* tiff=TinyTIFFReader_open(filename);
+    if (!tiff) return NULL;
+    TinyTIFFReaderSharedFile* shared=(TinyTIFFReaderSharedFile*)calloc(1, sizeof(TinyTIFFReaderSharedFile));
+    if (!shared) {
+        TinyTIFFReader_close(tiff);
+        return NULL;
     }
+    shared->systembyteorder=tiff->systembyteorder;
+    shared->filebyteorder=tiff->filebyteorder;
+    shared->bigTIFF=tiff->bigTIFF;
+    shared->filesize=tiff->filesize;
+    const int ok=TinyTIFFReader_collectSharedFrames(tiff, shared, 0xFFFFFFFF);
+    TinyTIFFReader_close(tiff);
+    int fileok=TINYTIFF_FALSE;
+    if (ok) {
+#if defined(__WINDOWS__)
+        shared->hFile=CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL|FILE_FLAG_RANDOM_ACCESS, NULL);
+        fileok=(shared->hFile!=INVALID_HANDLE_VALUE);
+#elif defined(TINYTIFF_HAVE_PREAD)
+        shared->fd=open(filename, O_RDONLY);
+        fileok=(shared->fd>=0);
+#else
+        shared->file=fopen(filename, "rb");
+        fileok=(shared->file!=NULL);
+        if (fileok) TinyTIFF_Mutex_init(&(shared->fileMutex));
+#endif
+    }
+    if (!ok || !fileok) {
+        TinyTIFFReader_freeSharedFrames(shared);
+        free(shared);
+        return NULL;
+    }
+    return shared;
+}
+
+void TinyTIFFReader_closeShared(TinyTIFFReaderSharedFile* shared) {
+    if (shared) {
+#if defined(__WINDOWS__)
+        CloseHandle(shared->hFile);
+#elif defined(TINYTIFF_HAVE_PREAD)
+        close(shared->fd);
+#else
+        fclose(shared->file);
+        TinyTIFF_Mutex_destroy(&(shared->fileMutex));
+#endif
+        TinyTIFFReader_freeSharedFrames(shared);
+        free(shared);
+    }
+}
+
+uint32_t TinyTIFFReader_countSharedFrames(const TinyTIFFReaderSharedFile* shared) {
+    if (shared) return shared->frameCount;
+    return 0;
+}
+
+int TinyTIFFReader_getSharedFrameInfo(const TinyTIFFReaderSharedFile* shared, uint32_t frame, uint32_t* width, uint32_t* height, uint16_t* samplesPerPixel, uint16_t* bitsPerSample, uint16_t* sampleFormat) {
+    if (!shared || frame>=shared->frameCount) return TINYTIFF_FALSE;
+    const TinyTIFFReaderFrame* f=&(shared->frames[frame]);
+    if (width) *width=f->width;
+    if (height) *height=f->height;
+    if (samplesPerPixel) *samplesPerPixel=f->samplesperpixel;
+    if (bitsPerSample) *bitsPerSample=(uint16_t)f->bitspersample;
+    if (sampleFormat) *sampleFormat=f->sampleformat;
+    return TINYTIFF_TRUE;
+}
+
+int TinyTIFFReader_readFrameAt(TinyTIFFReaderSharedFile* shared, uint32_t frame, uint16_t sample, void* buffer, unsigned long buffer_size) {
+    if (!shared || !buffer || frame>=shared->frameCount || sample>=shared->frames[frame].samplesperpixel) return TINYTIFF_FALSE;
+    TinyTIFFReaderFile view;
+    memset(&view, 0, sizeof(view));
+    TinyTIFFReader_initSharedView(&view, shared, frame);
+    const int ok=TinyTIFFReader_getSampleData_s___internl(&view, buffer, buffer_size, sample, TINYTIFF_TRUE);
+    TinyTIFF_deflateCodecRelease(&(view.deflateCodec));
+    return ok;
+}
+
+/*! \brief a frame to read in TinyTIFFReader_readFrames()
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+typedef struct TinyTIFFReader_BatchJob {
+    /** \brief file offset of the frame's data, the jobs are sorted by this offset */
+    uint64_t offset;
+    /** \brief index of the frame in the batch (and in the output buffer) */
+    uint32_t frame;
+} TinyTIFFReader_BatchJob;
+
+/*! \brief state of TinyTIFFReader_readFrames(), shared by all of its threads
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+typedef struct TinyTIFFReader_Batch {
+    TinyTIFFReaderSharedFile* shared;
+    TinyTIFFReader_BatchJob* jobs;
+    uint32_t jobCount;
+    /** \brief the next job to be taken by a thread (protected by \c mutex ) */
+    uint32_t nextJob;
+    TinyTIFF_Mutex mutex;
+    uint16_t sample;
+    uint8_t* buffer;
+    uint64_t frameSize;
+    /** \brief set by the first thread that failed, the other threads then stop (protected by \c mutex ) */
+    int wasError;
+    char lastError[TIFF_LAST_ERROR_SIZE];
+} TinyTIFFReader_Batch;
+
+/*! \brief qsort() comparison for TinyTIFFReader_BatchJob, by file offset
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static int TinyTIFFReader_compareBatchJobs(const void* a, const void* b) {
+    const uint64_t oa=((const TinyTIFFReader_BatchJob*)a)->offset;
+    const uint64_t ob=((const TinyTIFFReader_BatchJob*)b)->offset;
+    if (oa<ob) return -1;
+    if (oa>ob) return 1;
     return 0;
 }
+
+/*! \brief thread function of TinyTIFFReader_readFrames(): reads frames until all jobs are taken
+    \ingroup tinytiffreader_internal
+    \internal
+ */
+static void TinyTIFFReader_batchThread(void* arg) {
+    TinyTIFFReader_Batch* batch=(TinyTIFFReader_Batch*)arg;
+    TinyTIFFReaderFile view;
+    memset(&view, 0, sizeof(view));
+    for (;;) {
+        TinyTIFF_Mutex_lock(&batch->mutex);
+        if (batch->wasError || batch->nextJob>=batch->jobCount) {
+            TinyTIFF_Mutex_unlock(&batch->mutex);
+            break;
+        }
+        const uint32_t frame=batch->jobs[batch->nextJob].frame;
+        batch->nextJob++;
+        TinyTIFF_Mutex_unlock(&batch->mutex);
+
+        TinyTIFFReader_initSharedView(&view, batch->shared, frame);
+        if (!TinyTIFFReader_getSampleData_s___internl(&view, batch->buffer+(uint64_t)frame*batch->frameSize, (unsigned long)batch->frameSize, batch->sample, TINYTIFF_TRUE)) {
+            TinyTIFF_Mutex_lock(&batch->mutex);
+            if (!batch->wasError) {
+                batch->wasError=TINYTIFF_TRUE;
+                memcpy(batch->lastError, view.lastError, TIFF_LAST_ERROR_SIZE);
+            }
+            TinyTIFF_Mutex_unlock(&batch->mutex);
+        }
+    }
+    TinyTIFF_deflateCodecRelease(&(view.deflateCodec));
+}
+
+void TinyTIFFReader_setReadThreads(TinyTIFFReaderFile* tiff, uint32_t threads) {
+    if (tiff) tiff->readThreads=threads;
+}
+
+int TinyTIFFReader_readFrames(TinyTIFFReaderFile* tiff, uint32_t first, uint32_t count, uint16_t sample, void* buffer, uint64_t buffer_size) {
+    if (!tiff) return TINYTIFF_FALSE;
+    if (!buffer || count==0) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "no output buffer or no frames given\0");
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->prefetch) {
+        // the batch parses its IFDs with the reader itself, so the prefetch thread is stopped meanwhile
+        const uint32_t frames=tiff->prefetch->frames;
+        const uint64_t maxBytes=tiff->prefetch->maxBytes;
+        TinyTIFFReader_disablePrefetch(tiff);
+        const int ok=TinyTIFFReader_readFrames(tiff, first, count, sample, buffer, buffer_size);
+        TinyTIFFReader_enablePrefetch(tiff, frames, maxBytes);
+        return ok;
+    }
+    tiff->wasError=TINYTIFF_FALSE;
+    const uint32_t currentFrame=tiff->currentFrameIndex;
+
+    // parse the IFDs of all requested frames (in this thread, as this changes the state of the reader)
+    TinyTIFFReaderSharedFile batchfile;
+    memset(&batchfile, 0, sizeof(batchfile));
+    batchfile.systembyteorder=tiff->systembyteorder;
+    batchfile.filebyteorder=tiff->filebyteorder;
+    batchfile.bigTIFF=tiff->bigTIFF;
+    batchfile.filesize=tiff->filesize;
+    int ok=TinyTIFFReader_seekFrame(tiff, first) && TinyTIFFReader_collectSharedFrames(tiff, &batchfile, count);
+    TinyTIFFReader_seekFrame(tiff, currentFrame);
+    if (!ok || batchfile.frameCount<count) {
+        TinyTIFFReader_freeSharedFrames(&batchfile);
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "the requested frames are not available in the file\0");
+        return TINYTIFF_FALSE;
+    }
+
+    const TinyTIFFReaderFrame* frame0=&(batchfile.frames[0]);
+    const uint64_t frameSize=(uint64_t)frame0->width*(uint64_t)frame0->height*(frame0->bitspersample/8);
+    uint32_t i;
+    for (i=0; i<count; i++) {
+        const TinyTIFFReaderFrame* frame=&(batchfile.frames[i]);
+        if (frame->width!=frame0->width || frame->height!=frame0->height || frame->bitspersample!=frame0->bitspersample || sample>=frame->samplesperpixel) {
+            TinyTIFFReader_freeSharedFrames(&batchfile);
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "the requested frames differ in size or do not contain the requested sample\0");
+            return TINYTIFF_FALSE;
+        }
+    }
+    if (buffer_size<frameSize*count || (uint64_t)((unsigned long)frameSize)!=frameSize) {
+        TinyTIFFReader_freeSharedFrames(&batchfile);
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "sizeof input buffer was too small!\0");
+        return TINYTIFF_FALSE;
+    }
+
+    TinyTIFFReader_Batch batch;
+    batch.jobs=(TinyTIFFReader_BatchJob*)malloc(count*sizeof(TinyTIFFReader_BatchJob));
+    if (!batch.jobs) {
+        TinyTIFFReader_freeSharedFrames(&batchfile);
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+        return TINYTIFF_FALSE;
+    }
+    // the frames are read in the order of their data in the file
+    for (i=0; i<count; i++) {
+        batch.jobs[i].offset=(batchfile.frames[i].stripcount>0)?batchfile.frames[i].stripoffsets[0]:0;
+        batch.jobs[i].frame=i;
+    }
+    qsort(batch.jobs, count, sizeof(TinyTIFFReader_BatchJob), TinyTIFFReader_compareBatchJobs);
+    TinyTIFFReader_borrowFile(tiff, &batchfile);
+    batch.shared=&batchfile;
+    batch.jobCount=count;
+    batch.nextJob=0;
+    batch.sample=sample;
+    batch.buffer=(uint8_t*)buffer;
+    batch.frameSize=frameSize;
+    batch.wasError=TINYTIFF_FALSE;
+    batch.lastError[0]='\0';
+    TinyTIFF_Mutex_init(&batch.mutex);
+
+    // this thread reads too, so threads-1 additional threads are started
+    uint32_t threads=(tiff->readThreads>0)?tiff->readThreads:(uint32_t)TinyTIFF_Thread_hardwareConcurrency();
+    if (threads>count) threads=count;
+    TinyTIFF_Thread* workers=NULL;
+    uint32_t started=0;
+    if (threads>1) {
+        workers=(TinyTIFF_Thread*)malloc((threads-1)*sizeof(TinyTIFF_Thread));
+        while (workers && started<threads-1 && TinyTIFF_Thread_create(&(workers[started]), TinyTIFFReader_batchThread, &batch)) {
+            started++;
+        }
+    }
+    TinyTIFFReader_batchThread(&batch);
+    for (i=0; i<started; i++) {
+        TinyTIFF_Thread_join(workers[i]);
+    }
+    if (workers) free(workers);
+
+    TinyTIFF_Mutex_destroy(&batch.mutex);
+    TinyTIFFReader_releaseBorrowedFile(&batchfile);
+    free(batch.jobs);
+    TinyTIFFReader_freeSharedFrames(&batchfile);
+    if (batch.wasError) {
+        tiff->wasError=TINYTIFF_TRUE;
+        memcpy(tiff->lastError, batch.lastError, TIFF_LAST_ERROR_SIZE);
+        return TINYTIFF_FALSE;
+    }
+    return TINYTIFF_TRUE;
+}
 float TinyTIFFReader_getXResolution(TinyTIFFReaderFile* tiff){
     if(tiff){
         return tiff->currentFrame.xresolution;
@@ -48,6 +48,11 @@
   */
 typedef struct TinyTIFFReaderFile TinyTIFFReaderFile; // forward
 
+/** \brief struct used to describe a TIFF file, that can be read from several threads concurrently (see TinyTIFFReader_openShared())
+  * \ingroup tinytiffreader
+  */
+typedef struct TinyTIFFReaderSharedFile TinyTIFFReaderSharedFile; // forward
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -62,6 +67,26 @@ extern "C" {
       */
     TINYTIFF_EXPORT TinyTIFFReaderFile* TinyTIFFReader_open(const char* filename);
 
+    /*! \brief open TIFF file for reading and additionally map it read-only into memory
+        \ingroup tinytiffreader_C
+
+        The sample data is then taken from the memory mapping instead of file reads and
+        TinyTIFFReader_getSampleDataPointer() can return the data of uncompressed, continuous frames without any copy.
+        If the file cannot be mapped (e.g. on platforms without memory mapping, or if the file does not fit into the
+        address space), the file is read as with TinyTIFFReader_open(), see TinyTIFFReader_isMemoryMapped().
+
+        \param filename name of the new TIFF file
+        \return a new TinyTIFFReaderFile pointer on success, or NULL on errors
+     */
+    TINYTIFF_EXPORT TinyTIFFReaderFile* TinyTIFFReader_openMemoryMapped(const char* filename);
+
+    /*! \brief returns TINYTIFF_TRUE (non-zero) if the file is accessed through a memory mapping (see TinyTIFFReader_openMemoryMapped())
+        \ingroup tinytiffreader_C
+
+        \param tiff TIFF file
+     */
+    TINYTIFF_EXPORT int TinyTIFFReader_isMemoryMapped(TinyTIFFReaderFile* tiff);
+
 
     /*! \brief close a given TIFF file
         \ingroup tinytiffreader_C
@@ -102,6 +127,14 @@ extern "C" {
      */
     TINYTIFF_EXPORT int TinyTIFFReader_success(TinyTIFFReaderFile* tiff);
 
+    /*! \brief returns TINYTIFF_TRUE (non-zero) if the file is a BigTIFF (64-bit offsets), TINYTIFF_FALSE for a classic TIFF
+        \ingroup tinytiffreader_C
+
+        \param tiff TIFF file
+
+     */
+    TINYTIFF_EXPORT int TinyTIFFReader_isBigTIFF(TinyTIFFReaderFile* tiff);
+
     /*! \brief returns TINYTIFF_TRUE (non-zero) if another frame exists in the TIFF file
         \ingroup tinytiffreader_C
 
@@ -119,6 +152,79 @@ extern "C" {
      */
     TINYTIFF_EXPORT int TinyTIFFReader_readNext(TinyTIFFReaderFile* tiff);
 
+    /*! \brief makes the frame \a frame (0 is the first frame in the file) the current frame
+        \ingroup tinytiffreader_C
+
+        The reader keeps an index of the IFD offsets of all frames it has seen so far (also filled by TinyTIFFReader_readNext()
+        and TinyTIFFReader_countFrames()). Frames in this index are reached with a single seek, so jumping back and forth in a
+        large multi-frame TIFF does not require walking the chain of IFDs from the start of the file. Frames after
+        the last known frame are added to the index on demand.
+
+        \param tiff TIFF file
+        \param frame index of the frame to read
+        \return TINYTIFF_TRUE (non-zero) if the frame exists in the TIFF file and was read, TINYTIFF_FALSE otherwise
+                (in this case the current frame is not changed)
+
+        \see TinyTIFFReader_getCurrentFrame(), TinyTIFFReader_countFrames()
+     */
+    TINYTIFF_EXPORT int TinyTIFFReader_seekFrame(TinyTIFFReaderFile* tiff, uint32_t frame);
+
+    /*! \brief returns the index of the current frame (0 is the first frame in the file)
+        \ingroup tinytiffreader_C
+
+        \param tiff TIFF file
+     */
+    TINYTIFF_EXPORT uint32_t TinyTIFFReader_getCurrentFrame(TinyTIFFReaderFile* tiff);
+
+    /*! \brief enables or disables the strict validation of the IFD chain (disabled by default)
+        \ingroup tinytiffreader_C
+
+        Stacks of equally sized frames (e.g. written by TinyTIFFWriter, ImageJ or libtiff) usually store their IFDs at a constant distance
+        with identical entries. TinyTIFFReader_countFrames() and TinyTIFFReader_seekFrame() detect such files by checking the first frames
+        and a few samples throughout the file (including the last frame) and then calculate the positions of all other frames, instead
+        of reading every IFD. With strict validation, every IFD in the chain is read instead, which is slower for large files, but also
+        handles files, where only some IFDs in the middle of the file deviate from the layout of their neighbours.
+
+        \param tiff TIFF file
+        \param enabled TINYTIFF_TRUE to enable strict validation
+     */
+    TINYTIFF_EXPORT void TinyTIFFReader_setStrictFrameValidation(TinyTIFFReaderFile* tiff, int enabled);
+
+    /*! \brief switch the reader into prefetch mode: a background thread parses the IFDs of the next \a frames frames and loads their data
+               (all samples, in system byte order) into memory, while the caller still works on the current frame
+        \ingroup tinytiffreader_C
+
+        In this mode TinyTIFFReader_readNext() takes the next frame from the prefetched frames (waiting for it, if it is not loaded yet),
+        so TinyTIFFReader_getSampleData(), TinyTIFFReader_getSampleData_s(), TinyTIFFReader_getSampleDataAll() and
+        TinyTIFFReader_getSampleDataPointer() (without a copy) return the data from memory. This overlaps the file I/O with
+        the processing of the frames, e.g. for movie playback from slow storage. All other functions work as before, but read synchronously.
+
+        TinyTIFFReader_seekFrame() discards the prefetched frames and restarts the prefetching at the new frame.
+
+        \param tiff TIFF file
+        \param frames maximum number of frames, loaded in advance (at least 1)
+        \param maxBytes maximum number of bytes of pixel data, loaded in advance (0: no limit). At least one frame is always loaded.
+        \return TINYTIFF_TRUE on success and TINYTIFF_FALSE on failure.
+                An error description can be obtained by calling TinyTIFFReader_getLastError().
+
+        \note In prefetch mode, the reader uses positional reads (e.g. \c pread() ) and has to be used from a single thread, as before.
+     */
+    TINYTIFF_EXPORT int TinyTIFFReader_enablePrefetch(TinyTIFFReaderFile* tiff, uint32_t frames, uint64_t maxBytes);
+
+    /*! \brief stop the prefetch thread and release the prefetched frames, i.e. switch back to synchronous reading (see TinyTIFFReader_enablePrefetch())
+        \ingroup tinytiffreader_C
+
+        \param tiff TIFF file
+     */
+    TINYTIFF_EXPORT void TinyTIFFReader_disablePrefetch(TinyTIFFReaderFile* tiff);
+
+    /*! \brief returns the number of frames, which were loaded in advance by the prefetch thread, but not yet reached by TinyTIFFReader_readNext()
+        \ingroup tinytiffreader_C
+
+        \param tiff TIFF file
+     */
+    TINYTIFF_EXPORT uint32_t TinyTIFFReader_getPrefetchedFrames(TinyTIFFReaderFile* tiff);
+
 
     /*! \brief return the width of the current frame
         \ingroup tinytiffreader_C
@@ -141,6 +247,8 @@ extern "C" {
 
     \param tiff TIFF file
 
+    The ImageDescription is only read from the file on the first call for a frame (with a single read), so large descriptions (e.g. OME-XML)
+    do not slow down TinyTIFFReader_open() and TinyTIFFReader_readNext(). The returned string is valid until the next frame is read.
     */
     TINYTIFF_EXPORT const char* TinyTIFFReader_getImageDescription(TinyTIFFReaderFile* tiff);
 
@@ -225,16 +333,174 @@ extern "C" {
      */
     TINYTIFF_EXPORT int TinyTIFFReader_getSampleData_s(TinyTIFFReaderFile* tiff, void* buffer, unsigned long buffer_size, uint16_t sample);
 
+    /*! \brief returns a pointer to the given sample of the current frame, without copying the data if possible
+        \ingroup tinytiffreader_C
 
+        If the file was opened with TinyTIFFReader_openMemoryMapped() and the sample is stored uncompressed, in the byte order
+        of the system and as one continuous range of bytes in the file (1-sample frames or planar frames, e.g. with a single strip),
+        a pointer directly into the memory mapping is returned (zero-copy). In prefetch mode (see TinyTIFFReader_enablePrefetch()),
+        a pointer to the prefetched data of the frame is returned. Otherwise the sample is read into \a buffer,
+        as with TinyTIFFReader_getSampleData_s(), and \a buffer is returned.
 
-    /*! \brief return the width of the current frame
+        \param tiff TIFF file
+        \param buffer fallback buffer, used if zero-copy access is not possible. The size has to be at least <code>TinyTIFFReader_getWidth() * TinyTIFFReader_getHeight() * TinyTIFFReader_getBitsPerSample() / 8 </code>.
+                      May be NULL, then NULL is returned, if zero-copy access is not possible.
+        \param buffer_size size of \a buffer
+        \param sample the sample to read [default: 0]
+        \return a pointer to the sample data (either into the memory mapping or \a buffer), or NULL if the data could not be accessed.
+
+        \warning A pointer into the memory mapping (or the prefetched data) is only valid until the next call of TinyTIFFReader_readNext() or TinyTIFFReader_close()
+                 and must not be written to.
+     */
+    TINYTIFF_EXPORT const void* TinyTIFFReader_getSampleDataPointer(TinyTIFFReaderFile* tiff, void* buffer, unsigned long buffer_size, uint16_t sample);
+
+    /*! \brief read all samples of the current frame into separate buffers (one per sample),
+               the byteorder is transformed to the byteorder of the system!
+        \ingroup tinytiffreader_C
+
+        For frames with interleaved samples (PlanarConfiguration=1, e.g. RGB or multi-channel images) every strip is read only once
+        and its samples are distributed into the output buffers with a vectorized kernel, instead of reading the complete frame once for
+        every sample, as with repeated calls of TinyTIFFReader_getSampleData(). For all other frames this is equivalent to
+        calling TinyTIFFReader_getSampleData_s() for every sample.
+
+        \param tiff TIFF file
+        \param buffers an array of TinyTIFFReader_getSamplesPerPixel() buffers, \c buffers[s] receives sample \c s
+        \param buffer_size size of each of the \a buffers, has to be at least <code>TinyTIFFReader_getWidth() * TinyTIFFReader_getHeight() * TinyTIFFReader_getBitsPerSample() / 8 </code>
+        \return \c TINYTIFF_TRUE (non-zero) on success, if an error occured \c TINYTIFF_FALSE is returned and the error message can be retrieved with TinyTIFFReader_getLastError()
+     */
+    TINYTIFF_EXPORT int TinyTIFFReader_getSampleDataAll(TinyTIFFReaderFile* tiff, void* const* buffers, unsigned long buffer_size);
+
+    /*! \brief read the current frame with all samples interleaved (i.e. <code>R0 G0 B0 R1 G1 B1 ...</code>) into \a buffer,
+               the byteorder is transformed to the byteorder of the system!
+        \ingroup tinytiffreader_C
+
+        This is the layout of frames with PlanarConfiguration=1 in the file, so the strips are copied into \a buffer without any reordering.
+        For 1-sample frames the result is the same as with TinyTIFFReader_getSampleData_s().
+
+        \param tiff TIFF file
+        \param buffer the buffer this function writes into
+        \param buffer_size size of \a buffer, has to be at least <code>TinyTIFFReader_getWidth() * TinyTIFFReader_getHeight() * TinyTIFFReader_getSamplesPerPixel() * TinyTIFFReader_getBitsPerSample() / 8 </code>
+        \return \c TINYTIFF_TRUE (non-zero) on success, if an error occured \c TINYTIFF_FALSE is returned and the error message can be retrieved with TinyTIFFReader_getLastError().
+                This function fails for frames with several samples in planar configuration (PlanarConfiguration=2), use TinyTIFFReader_getSampleDataAll() for those.
+     */
+    TINYTIFF_EXPORT int TinyTIFFReader_getFrameDataInterleaved(TinyTIFFReaderFile* tiff, void* buffer, unsigned long buffer_size);
+
+    /*! \brief read the region of interest with the top-left corner (\a x, \a y) and the size \a width * \a height pixels of the given sample from the current frame
+               into \a buffer, the byteorder is transformed to the byteorder of the system!
+        \ingroup tinytiffreader_C
+
+        For tiled frames only the tiles that intersect the region are read, for stripped frames only the byte ranges that cover
+        the requested rows (ranges of neighbouring rows are merged into a single read call).
+
+        \param tiff TIFF file
+        \param buffer the buffer this function writes into (row by row, without gaps), the size has to be at least <code>width * height * TinyTIFFReader_getBitsPerSample() / 8 </code>
+        \param x first column of the region
+        \param y first row of the region
+        \param width width of the region in pixels
+        \param height height of the region in pixels
+        \param sample the sample to read
+        \return \c TINYTIFF_TRUE (non-zero) on success, if an error occured \c TINYTIFF_FALSE is returned and the error message can be retrieved with TinyTIFFReader_getLastError().
+                The function fails, if the region is empty or does not lie completely inside the frame.
+     */
+    TINYTIFF_EXPORT int TinyTIFFReader_getSampleDataROI(TinyTIFFReaderFile* tiff, void* buffer, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint16_t sample);
+    /*! \brief read the region of interest with the top-left corner (\a x, \a y) and the size \a width * \a height pixels of the given sample from the current frame
+               into \a buffer, where consecutive rows start \a rowstride bytes apart (e.g. to read into a part of a larger image),
+               the byteorder is transformed to the byteorder of the system!
+        \ingroup tinytiffreader_C
+
+        This is the same as TinyTIFFReader_getSampleDataROI(), but the bytes between the rows of the region in \a buffer are not touched.
+
+        \param tiff TIFF file
+        \param buffer the buffer this function writes into, the size has to be at least <code>(height-1) * rowstride + width * TinyTIFFReader_getBitsPerSample() / 8 </code>
+        \param rowstride distance between the starts of two rows in \a buffer in bytes, has to be at least <code>width * TinyTIFFReader_getBitsPerSample() / 8 </code>
+                         and a multiple of <code>TinyTIFFReader_getBitsPerSample() / 8 </code>
+        \param x first column of the region
+        \param y first row of the region
+        \param width width of the region in pixels
+        \param height height of the region in pixels
+        \param sample the sample to read
+        \return \c TINYTIFF_TRUE (non-zero) on success, if an error occured \c TINYTIFF_FALSE is returned and the error message can be retrieved with TinyTIFFReader_getLastError().
+                The function fails, if the region is empty or does not lie completely inside the frame.
+     */
+    TINYTIFF_EXPORT int TinyTIFFReader_getSampleDataROIStrided(TinyTIFFReaderFile* tiff, void* buffer, unsigned long rowstride, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint16_t sample);
+
+
+
+    /*! \brief return the number of frames in the TIFF file
         \ingroup tinytiffreader_C
 
         \param tiff TIFF file
 
+        The chain of IFDs is only walked once, the result is kept in the frame index of the reader (see TinyTIFFReader_seekFrame()),
+        so repeated calls are cheap.
      */
     TINYTIFF_EXPORT uint32_t TinyTIFFReader_countFrames(TinyTIFFReaderFile* tiff);
 
+    /*! \brief read the given sample of \a count frames, starting with the frame \a first, into the 3D buffer \a buffer (frame \c first+i is stored at
+               <code>buffer + i * width * height * bitsPerSample / 8</code>), the byteorder is transformed to the byteorder of the system!
+        \ingroup tinytiffreader_C
+
+        The IFDs of the frames are parsed first, then the frames are read (and byteswapped) by several threads in parallel, in the order of
+        their data in the file. The number of threads can be set with TinyTIFFReader_setReadThreads(). The current frame of \a tiff is not changed.
+
+        \param tiff TIFF file
+        \param first the first frame to read (0 is the first frame in the file)
+        \param count number of frames to read
+        \param sample the sample to read
+        \param buffer the buffer this function writes into
+        \param buffer_size size of \a buffer, has to be at least <code>count * width * height * bitsPerSample / 8 </code>
+        \return \c TINYTIFF_TRUE (non-zero) on success, if an error occured \c TINYTIFF_FALSE is returned and the error message can be retrieved with TinyTIFFReader_getLastError().
+                The function fails, if not all frames exist, or if they differ in size or data type.
+     */
+    TINYTIFF_EXPORT int TinyTIFFReader_readFrames(TinyTIFFReaderFile* tiff, uint32_t first, uint32_t count, uint16_t sample, void* buffer, uint64_t buffer_size);
+    /*! \brief set the number of threads used by TinyTIFFReader_readFrames(), 0 (the default) uses one thread per processor
+        \ingroup tinytiffreader_C
+     */
+    TINYTIFF_EXPORT void TinyTIFFReader_setReadThreads(TinyTIFFReaderFile* tiff, uint32_t threads);
+
+
+
+    /*! \brief open TIFF file for reading from several threads at the same time
+        \ingroup tinytiffreader_C
+
+        The IFDs of all frames are parsed once, while opening the file. The result is an immutable index of all frames,
+        so the returned handle has no current frame or file position and TinyTIFFReader_readFrameAt() can be called
+        from any number of threads concurrently, without locking (the data is read with positional reads, i.e. \c pread() ).
+
+        \param filename name of the TIFF file
+        \return a new TinyTIFFReaderSharedFile pointer on success, or NULL on errors (file not accessible, no TIFF file, or a broken IFD).
+                Close the file with TinyTIFFReader_closeShared().
+
+        \see TinyTIFFReader_readFrameAt()
+     */
+    TINYTIFF_EXPORT TinyTIFFReaderSharedFile* TinyTIFFReader_openShared(const char* filename);
+    /*! \brief close a file opened with TinyTIFFReader_openShared(), no other thread may still read from it
+        \ingroup tinytiffreader_C
+     */
+    TINYTIFF_EXPORT void TinyTIFFReader_closeShared(TinyTIFFReaderSharedFile* shared);
+    /*! \brief returns the number of frames in a file opened with TinyTIFFReader_openShared()
+        \ingroup tinytiffreader_C
+     */
+    TINYTIFF_EXPORT uint32_t TinyTIFFReader_countSharedFrames(const TinyTIFFReaderSharedFile* shared);
+    /*! \brief returns the properties of the frame \a frame in a file opened with TinyTIFFReader_openShared(), any of the output pointers may be NULL
+        \ingroup tinytiffreader_C
+
+        \return \c TINYTIFF_TRUE on success, \c TINYTIFF_FALSE if \a frame does not exist
+     */
+    TINYTIFF_EXPORT int TinyTIFFReader_getSharedFrameInfo(const TinyTIFFReaderSharedFile* shared, uint32_t frame, uint32_t* width, uint32_t* height, uint16_t* samplesPerPixel, uint16_t* bitsPerSample, uint16_t* sampleFormat);
+    /*! \brief read the given sample of the frame \a frame from a file opened with TinyTIFFReader_openShared() into \a buffer,
+               the byteorder is transformed to the byteorder of the system! This function may be called from several threads concurrently.
+        \ingroup tinytiffreader_C
+
+        \param shared TIFF file
+        \param frame the frame to read (0 is the first frame in the file)
+        \param sample the sample to read
+        \param buffer the buffer this function writes into, the size has to be at least <code>width * height * bitsPerSample / 8 </code> (see TinyTIFFReader_getSharedFrameInfo())
+        \param buffer_size size of \a buffer
+        \return \c TINYTIFF_TRUE (non-zero) on success, \c TINYTIFF_FALSE on errors. As the handle is shared between threads, no error message is stored.
+     */
+    TINYTIFF_EXPORT int TinyTIFFReader_readFrameAt(TinyTIFFReaderSharedFile* shared, uint32_t frame, uint16_t sample, void* buffer, unsigned long buffer_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,7 +26,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include "tiff_definitions_internal.h"
+#include "tinytiff_compression_internal.h"
 #include "tinytiff_ctools_internal.h"
+#include "tinytiff_simd_internal.h"
+#include "tinytiff_threads_internal.h"
 #include "tinytiff_version.h"
 
 #ifndef __WINDOWS__
@@ -65,6 +68,142 @@
 #define TINYTIFFWRITER_DESCRIPTION_SIZE 1024
 #define TIFF_LAST_ERROR_SIZE 1024
 
+/*! \brief state of the asynchronous writing mode (see TinyTIFFWriter_enableAsyncWriting())
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    The caller copies frames into a ring of \c bufferCount frame buffers, from which a background I/O thread
+    writes them into the file in the order they were queued. Slot \c head is the next free slot, the \c queued
+    slots before it hold frames that are not yet (completely) written.
+ */
+typedef struct TinyTIFFWriterAsync {
+    /** \brief the background I/O thread */
+    TinyTIFF_Thread thread;
+    /** \brief protects all fields below */
+    TinyTIFF_Mutex mutex;
+    /** \brief signalled when a frame was queued or the thread should stop */
+    TinyTIFF_Cond frameQueued;
+    /** \brief signalled when the I/O thread finished writing a frame */
+    TinyTIFF_Cond frameWritten;
+    /** \brief the ring of frame buffers, each of size \c frameSize */
+    uint8_t** buffers;
+    /** \brief sample layout of the data in each buffer */
+    enum TinyTIFFSampleLayout* inputOrganisation;
+    /** \brief sample layout to use in the file for each buffer */
+    enum TinyTIFFSampleLayout* outputOrganization;
+    /** \brief number of frame buffers in the ring */
+    uint32_t bufferCount;
+    /** \brief size of a single frame in bytes */
+    size_t frameSize;
+    /** \brief next free slot in the ring */
+    uint32_t head;
+    /** \brief number of frames in the ring, which have not been written completely */
+    uint32_t queued;
+    /** \brief number of frames, which were rejected, because the ring was full */
+    uint64_t overruns;
+    /** \brief set, when the I/O thread failed to write a frame */
+    int error;
+    /** \brief error message of the I/O thread, copied into TinyTIFFWriterFile::lastError by the calling thread, see TinyTIFFWriter_takeAsyncError() */
+    char lastError[TIFF_LAST_ERROR_SIZE];
+    /** \brief set, while the I/O thread writes a frame, see TinyTIFFWriter_setError() */
+    int writing;
+    /** \brief tells the I/O thread to exit, once the ring is empty */
+    int stop;
+} TinyTIFFWriterAsync;
+
+/*! \brief describes the strips of a compressed frame, see TinyTIFFWriter_compressFrameStrip()
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+typedef struct TinyTIFFWriterStrips {
+    /** \brief the frame data, as passed by the caller */
+    const void* data;
+    /** \brief sample layout of \c data */
+    enum TinyTIFFSampleLayout inputOrganisation;
+    /** \brief sample layout in the file */
+    enum TinyTIFFSampleLayout outputOrganization;
+    /** \brief size of a row of a strip in bytes */
+    uint64_t rowsize;
+    /** \brief number of rows in each strip (except the last strip of a plane) */
+    uint32_t rowsPerStrip;
+    /** \brief number of strips per sample plane */
+    uint64_t segmentsPerPlane;
+} TinyTIFFWriterStrips;
+
+struct TinyTIFFWriterPool;
+
+/*! \brief a thread of the compression pool, together with its scratch buffers (see TinyTIFFWriter_setCompressionThreads())
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+typedef struct TinyTIFFWriterPoolWorker {
+    TinyTIFF_Thread thread;
+    struct TinyTIFFWriterPool* pool;
+    /** \brief scratch buffer for reordering and the predictor, holds one uncompressed strip */
+    uint8_t* scratch;
+    /** \brief size of \c scratch in bytes */
+    size_t scratchSize;
+    /** \brief table of sample plane pointers for TinyTIFFWriter_getStripData() */
+    const void** planes;
+    /** \brief Deflate compressor of this thread */
+    TinyTIFF_DeflateCodec deflateCodec;
+} TinyTIFFWriterPoolWorker;
+
+/*! \brief state of the compression pool (see TinyTIFFWriter_setCompressionThreads())
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    The thread, which writes a compressed frame, queues its strips here and compresses strips itself, until all are taken.
+    Each strip is compressed into its own slot of TinyTIFFWriterFile::compressBuffer (sized for the worst case), afterwards the slots are
+    moved together, so the file is identical to single-threaded compression. Then the IFD is written and the data of the frame is queued
+    as a write job, which the next free worker executes, while the next frame is already compressed into the second buffer \c spareBuffer.
+ */
+typedef struct TinyTIFFWriterPool {
+    TinyTIFFWriterFile* tiff;
+    /** \brief the worker threads, the thread writing the frame compresses too */
+    TinyTIFFWriterPoolWorker* workers;
+    /** \brief number of started workers */
+    uint32_t workerCount;
+    /** \brief protects all fields below */
+    TinyTIFF_Mutex mutex;
+    /** \brief signalled when strips or a write job were queued, or the workers should stop */
+    TinyTIFF_Cond workQueued;
+    /** \brief signalled when the last strip of a frame was compressed, or the write job is finished */
+    TinyTIFF_Cond workDone;
+    /** \brief strips of the current frame */
+    TinyTIFFWriterStrips strips;
+    /** \brief buffer, into which the strips are compressed */
+    uint8_t* buffer;
+    /** \brief offset of the slot of each strip in \c buffer */
+    const uint64_t* slots;
+    /** \brief receives the compressed size of each strip */
+    uint64_t* bytecounts;
+    /** \brief number of strips of the current frame */
+    uint64_t stripCount;
+    /** \brief next strip to be taken by a thread */
+    uint64_t nextStrip;
+    /** \brief number of strips, which are completely compressed */
+    uint64_t stripsDone;
+    /** \brief set, when a strip could not be compressed */
+    int compressError;
+    /** \brief data of the write job (a completely compressed frame) */
+    const uint8_t* writeData;
+    /** \brief size of the write job in bytes */
+    size_t writeSize;
+    /** \brief set, when a write job is queued, but not yet taken by a worker */
+    int writeQueued;
+    /** \brief set, while a worker executes the write job */
+    int writing;
+    /** \brief set, when a write job failed, reported by TinyTIFFWriter_waitForPendingWrite() */
+    int writeError;
+    /** \brief second compression buffer, which is swapped with TinyTIFFWriterFile::compressBuffer after each frame */
+    uint8_t* spareBuffer;
+    /** \brief size of \c spareBuffer in bytes */
+    size_t spareBufferSize;
+    /** \brief tells the workers to exit, once the write job is done */
+    int stop;
+} TinyTIFFWriterPool;
+
 int TinyTIFFWriter_getMaxDescriptionTextSize() {
     return TINYTIFFWRITER_DESCRIPTION_SIZE;
 }
@@ -109,9 +248,9 @@ struct TinyTIFFWriterFile {
     FILE* file;
 #endif // TINYTIFF_USE_WINAPI_FOR_FILEIO
     /** \brief position of the field in the previously written IFD/header, which points to the next frame. This is set to 0, when closing the file to indicate, the last frame! */
-    uint32_t lastIFDOffsetField;
+    uint64_t lastIFDOffsetField;
     /** \brief file position (from ftell) of the first byte of the previous IFD/frame header */
-    long int lastStartPos;
+    int64_t lastStartPos;
     //uint32_t lastIFDEndAdress;
     uint32_t lastIFDDATAAdress;
     /** \brief counts the entries in the current IFD/frame header */
@@ -131,12 +270,14 @@ struct TinyTIFFWriterFile {
     uint16_t sampleformat;
     /** \brief number of samples of the frames */
     uint16_t samples;
-    uint32_t descriptionOffset;
-    uint32_t descriptionSizeOffset;
+    uint64_t descriptionOffset;
+    uint64_t descriptionSizeOffset;
     /** \brief counter for the frames, written into the file */
     uint64_t frames;
     /** \brief specifies the byte order of the system (and the written file!) */
     uint8_t byteorder;
+    /** \brief TINYTIFF_TRUE, if the file is written as BigTIFF (64-bit offsets, 20-byte IFD entries), TINYTIFF_FALSE for classic TIFF */
+    uint8_t bigTIFF;
     /** \brief photometric interpretation to store in the file */
     uint16_t photometricInterpretation;
     /** \brief type of the first extra channel */
@@ -145,8 +286,77 @@ struct TinyTIFFWriterFile {
     uint16_t secondaryExtraChannelType;
     char lastError[TIFF_LAST_ERROR_SIZE];
     int wasError;
+    /** \brief state of the asynchronous writing mode, NULL if frames are written synchronously */
+    TinyTIFFWriterAsync* async;
+    /** \brief scratch buffer, used to reorder the samples of a frame blockwise before writing it, see TinyTIFFWriter_writeReorderedSamples() (NULL until the first reordered frame) */
+    uint8_t* reorderBuffer;
+    /** \brief size of reorderBuffer in bytes */
+    size_t reorderBufferSize;
+    /** \brief table of \c samples pointers to the sample planes of the current block, used by TinyTIFFWriter_writeReorderedSamples() */
+    const void** reorderPlanes;
+    /** \brief number of image rows per strip, 0 to store every frame (or every sample plane) as a single strip, see TinyTIFFWriter_setRowsPerStrip() */
+    uint32_t rowsPerStrip;
+    /** \brief width of the tiles in pixels, 0 to write stripped frames, see TinyTIFFWriter_setTileSize() */
+    uint32_t tileWidth;
+    /** \brief length (height) of the tiles in pixels, see TinyTIFFWriter_setTileSize() */
+    uint32_t tileLength;
+    /** \brief number of tiles of the current frame, which were already written with TinyTIFFWriter_writeTile() (0, if no frame is in progress) */
+    uint64_t tilesWritten;
+    /** \brief sample organization of the frame, which is currently written with TinyTIFFWriter_writeTile() */
+    enum TinyTIFFSampleLayout tileOrganization;
+    /** \brief compression scheme of the strips (TIFF_COMPRESSION_NONE, TIFF_COMPRESSION_PACKBITS, TIFF_COMPRESSION_LZW or TIFF_COMPRESSION_ADOBE_DEFLATE), see TinyTIFFWriter_setCompression() */
+    uint16_t compression;
+    /** \brief compression level for TIFF_COMPRESSION_ADOBE_DEFLATE, see TinyTIFFWriter_setCompressionLevel() */
+    int compressionLevel;
+    /** \brief Deflate compressor of the writing thread, which is reused for all strips */
+    TinyTIFF_DeflateCodec deflateCodec;
+    /** \brief predictor, which is applied to the strips before compression (TIFF_PREDICTOR_NONE or TIFF_PREDICTOR_HORIZONTAL), see TinyTIFFWriter_setCompression() */
+    uint16_t predictor;
+    /** \brief buffer, which receives the compressed strips of a frame, before they are written (NULL until the first compressed frame) */
+    uint8_t* compressBuffer;
+    /** \brief size of compressBuffer in bytes */
+    size_t compressBufferSize;
+    /** \brief number of threads compressing the strips of a frame, see TinyTIFFWriter_setCompressionThreads() */
+    uint32_t compressionThreads;
+    /** \brief the compression threads, NULL if strips are compressed in the writing thread only (started with the first compressed frame) */
+    TinyTIFFWriterPool* pool;
 };
 
+/*! \brief reports an error of the frame-writing code
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    While the asynchronous I/O thread writes a frame, the calling thread may read TinyTIFFWriterFile::lastError,
+    so the error is stored in the TinyTIFFWriterAsync state instead and copied by TinyTIFFWriter_takeAsyncError().
+ */
+static void TinyTIFFWriter_setError(TinyTIFFWriterFile* tiff, const char* message) {
+    TinyTIFFWriterAsync* async=tiff->async;
+    if (async) {
+        TinyTIFF_Mutex_lock(&async->mutex);
+        if (async->writing) {
+            async->error=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(async, message);
+            TinyTIFF_Mutex_unlock(&async->mutex);
+            return;
+        }
+        TinyTIFF_Mutex_unlock(&async->mutex);
+    }
+    tiff->wasError=TINYTIFF_TRUE;
+    TINYTIFF_SET_LAST_ERROR(tiff, message);
+}
+
+/*! \brief copies the error of the asynchronous I/O thread into TinyTIFFWriterFile::lastError (the mutex of \a async has to be locked, or the I/O thread has to be stopped)
+    \ingroup tinytiffwriter_internal
+    \internal
+    \return TINYTIFF_FALSE, if the I/O thread failed to write a frame
+ */
+static int TinyTIFFWriter_takeAsyncError(TinyTIFFWriterFile* tiff, TinyTIFFWriterAsync* async) {
+    if (!async->error) return TINYTIFF_TRUE;
+    tiff->wasError=TINYTIFF_TRUE;
+    memcpy(tiff->lastError, async->lastError, TIFF_LAST_ERROR_SIZE);
+    return TINYTIFF_FALSE;
+}
+
 /*! \brief wrapper around fopen
     \ingroup tinytiffwriter_internal
     \internal
@@ -223,11 +433,11 @@ static size_t TinyTIFFWriter_fwrite(const void * ptr, size_t size, size_t count,
  */
 static int64_t TinyTIFFWriter_ftell ( TinyTIFFWriterFile * tiff ) {
 #ifdef TINYTIFF_USE_WINAPI_FOR_FILEIO
-DWORD dwPtr = SetFilePointer( tiff->hFile,
-                                0,
-                                NULL,
-                                FILE_CURRENT );
-    return dwPtr;
+    // SetFilePointerEx() is used, as BigTIFF files may be larger than 4GB
+    LARGE_INTEGER distance, pos;
+    distance.QuadPart=0;
+    if (!SetFilePointerEx(tiff->hFile, distance, &pos, FILE_CURRENT)) return -1;
+    return (int64_t)pos.QuadPart;
 #else
 #  ifdef HAVE_FTELLO64
     return ftello64(tiff->file);
@@ -246,13 +456,9 @@ DWORD dwPtr = SetFilePointer( tiff->hFile,
  */
 static int TinyTIFFWriter_fseek_set(TinyTIFFWriterFile* tiff, long long offset) {
 #ifdef TINYTIFF_USE_WINAPI_FOR_FILEIO
-   DWORD res = SetFilePointer (tiff->hFile,
-                                offset,
-                                NULL,
-                                FILE_BEGIN);
-
-
-   return res;
+    LARGE_INTEGER distance;
+    distance.QuadPart=offset;
+    return SetFilePointerEx(tiff->hFile, distance, NULL, FILE_BEGIN)?0:-1;
 #else
 #  ifdef HAVE_FSEEKO64
     return fseeko64(tiff->file, offset, SEEK_SET);
@@ -279,7 +485,7 @@ static uint16_t TinyTIFFWriter_getPhotometricChannels(uint16_t photometric) {
 
 
 
-/*! \brief fixed size of the TIFF frame header in bytes
+/*! \brief size of the TIFF frame header in bytes, without the StripOffsets/StripByteCounts arrays (see TinyTIFFWriter_getStripArraySize()) and the ImageDescription
     \ingroup tinytiffwriter_internal
     \internal
  */
@@ -289,10 +495,61 @@ static uint16_t TinyTIFFWriter_getPhotometricChannels(uint16_t photometric) {
     \internal
  */
 #define TIFF_HEADER_MAX_ENTRIES 20
+/*! \brief size of the BigTIFF frame header in bytes (IFD entries are 20 bytes instead of 12 bytes in BigTIFF), without the StripOffsets/StripByteCounts arrays and the ImageDescription
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+#define TIFF_HEADER_SIZE_BIGTIFF 700
+/*! \brief the image data of every frame starts at a file offset, which is a multiple of this value (in bytes).
+           The frame header is padded accordingly. This allows to access the data of a frame directly in a memory mapping
+           of the file (see TinyTIFFReader_getSampleDataPointer()), without unaligned access for up to 64-bit samples.
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+#define TINYTIFFWRITER_DATA_ALIGNMENT 8
+
+/*! \brief compression level, which is used for Deflate compression, unless TinyTIFFWriter_setCompressionLevel() is called (the zlib default)
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+#define TINYTIFF_DEFAULT_COMPRESSION_LEVEL 6
+
+/*! \brief size of the entry count at the start of an IFD in bytes (2 for TIFF, 8 for BigTIFF)
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+#define TINYTIFFWRITER_IFDCOUNTSIZE(tiff) ((tiff)->bigTIFF?8:2)
+/*! \brief size of a single IFD entry in bytes (12 for TIFF, 20 for BigTIFF)
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+#define TINYTIFFWRITER_IFDENTRYSIZE(tiff) ((tiff)->bigTIFF?20:12)
+/*! \brief size of a file offset (and of the count and value fields in an IFD entry) in bytes (4 for TIFF, 8 for BigTIFF)
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+#define TINYTIFFWRITER_OFFSETSIZE(tiff) ((tiff)->bigTIFF?8:4)
+
 
 
 
 
+/*! \brief write a 8-byte word \a data directly into a file \a fileno
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+#define WRITE64DIRECT(filen, data)  { \
+    TinyTIFFWriter_fwrite((void*)(&(data)), 8, 1, filen); \
+}
+
+/*! \brief write a data word \a data , which is first cast into a 8-byte word directly into a file \a fileno
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+#define WRITE64DIRECT_CAST(filen, data)  { \
+    uint64_t d=data; \
+    WRITE64DIRECT((filen), d); \
+}
 
 /*! \brief write a 4-byte word \a data directly into a file \a fileno
     \ingroup tinytiffwriter_internal
@@ -311,6 +568,18 @@ static uint16_t TinyTIFFWriter_getPhotometricChannels(uint16_t photometric) {
     WRITE32DIRECT((filen), d); \
 }
 
+/*! \brief write a file offset \a data directly into a file \a fileno, as 4-byte word for TIFF and as 8-byte word for BigTIFF
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+#define WRITEOFFSETDIRECT_CAST(filen, data)  { \
+    if ((filen)->bigTIFF) { \
+        WRITE64DIRECT_CAST(filen, data); \
+    } else { \
+        WRITE32DIRECT_CAST(filen, data); \
+    } \
+}
+
 
 
 
@@ -358,6 +627,23 @@ static uint16_t TinyTIFFWriter_getPhotometricChannels(uint16_t photometric) {
 
 
 
+/*! \brief writes a 64-bit word at the current position into the current file header and advances the position by 8 bytes
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+#define WRITEH64DIRECT_LE(filen, data)  { \
+    *((uint64_t*)(&filen->lastHeader[filen->pos]))=data; \
+    filen->pos+=8;\
+}
+/*! \brief writes a value, which is cast to a 64-bit word at the current position into the current file header and advances the position by 8 bytes
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+#define WRITEH64_LE(filen, data)  { \
+    uint64_t d=data; \
+    WRITEH64DIRECT_LE(filen, d); \
+}
+
 /*! \brief writes a 32-bit word at the current position into the current file header and advances the position by 4 bytes
     \ingroup tinytiffwriter_internal
     \internal
@@ -411,8 +697,23 @@ static uint16_t TinyTIFFWriter_getPhotometricChannels(uint16_t photometric) {
 #define WRITEH16(filen, data)  WRITEH16_LE(filen, data)
 #define WRITEH32(filen, data)  WRITEH32_LE(filen, data)
 
+#define WRITEH64(filen, data)  WRITEH64_LE(filen, data)
+
 #define WRITEH16DIRECT(filen, data)  WRITEH16DIRECT_LE(filen, data)
 #define WRITEH32DIRECT(filen, data)  WRITEH32DIRECT_LE(filen, data)
+#define WRITEH64DIRECT(filen, data)  WRITEH64DIRECT_LE(filen, data)
+
+/*! \brief writes a file offset (or an IFD entry count) at the current position into the current file header, as 32-bit word for TIFF and as 64-bit word for BigTIFF
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+#define WRITEHOFFSET(filen, data) { \
+    if ((filen)->bigTIFF) { \
+        WRITEH64(filen, data); \
+    } else { \
+        WRITEH32(filen, data); \
+    } \
+}
 
 /*! \brief starts a new IFD (TIFF frame header)
     \ingroup tinytiffwriter_internal
@@ -420,9 +721,10 @@ static uint16_t TinyTIFFWriter_getPhotometricChannels(uint16_t photometric) {
  */
 static void TinyTIFFWriter_startIFD(TinyTIFFWriterFile* tiff, int hsize) {
     if (!tiff) return;
+    const int csize=TINYTIFFWRITER_IFDCOUNTSIZE(tiff);
     tiff->lastStartPos=TinyTIFFWriter_ftell(tiff);//ftell(tiff->file);
     //tiff->lastIFDEndAdress=startPos+2+TIFF_HEADER_SIZE;
-    tiff->lastIFDDATAAdress=2+TIFF_HEADER_MAX_ENTRIES*12;
+    tiff->lastIFDDATAAdress=csize+TIFF_HEADER_MAX_ENTRIES*TINYTIFFWRITER_IFDENTRYSIZE(tiff)+TINYTIFFWRITER_OFFSETSIZE(tiff);
     tiff->lastIFDCount=0;
     if (tiff->lastHeader!=NULL && hsize!=tiff->lastHeaderSize) {
         free(tiff->lastHeader);
@@ -430,38 +732,59 @@ static void TinyTIFFWriter_startIFD(TinyTIFFWriterFile* tiff, int hsize) {
         tiff->lastHeaderSize=0;
     }
     if (tiff->lastHeader==NULL) {
-        tiff->lastHeader=(uint8_t*)calloc(hsize+2, 1);
+        tiff->lastHeader=(uint8_t*)calloc(hsize+csize, 1);
         tiff->lastHeaderSize=hsize;
     } else {
-        TinyTIFF_memset_s(tiff->lastHeader, tiff->lastHeaderSize+2, 0, hsize+2);
+        TinyTIFF_memset_s(tiff->lastHeader, tiff->lastHeaderSize+csize, 0, hsize+csize);
     }
-    tiff->pos=2;
+    tiff->pos=csize;
 }
 
 /*! \brief ends the current IFD (TIFF frame header) and writes the header (as a single block of size TIFF_HEADER_SIZE) into the file
     \ingroup tinytiffwriter_internal
     \internal
 
-    This function also sets the pointer to the next IFD, based on the known header size and frame data size.
+    This function also sets the pointer to the next IFD, based on the known header size and the frame data size \a datasize (in bytes).
  */
-static void TinyTIFFWriter_endIFD(TinyTIFFWriterFile* tiff, int hsize) {
+static void TinyTIFFWriter_endIFD(TinyTIFFWriterFile* tiff, int hsize, uint64_t datasize) {
     if (!tiff) return;
     //long startPos=ftell(tiff->file);
+    const int csize=TINYTIFFWRITER_IFDCOUNTSIZE(tiff);
 
     tiff->pos=0;
-    WRITEH16DIRECT(tiff, tiff->lastIFDCount);
+    if (tiff->bigTIFF) {
+        WRITEH64(tiff, tiff->lastIFDCount);
+    } else {
+        WRITEH16DIRECT(tiff, tiff->lastIFDCount);
+    }
 
-    tiff->pos=2+tiff->lastIFDCount*12; // header start (2byte) + 12 bytes per IFD entry
-    WRITEH32(tiff, tiff->lastStartPos+2+hsize+tiff->width*tiff->height*tiff->samples*(tiff->bitspersample/8));
+    tiff->pos=csize+tiff->lastIFDCount*TINYTIFFWRITER_IFDENTRYSIZE(tiff); // header start (2/8 byte) + 12/20 bytes per IFD entry
+    WRITEHOFFSET(tiff, tiff->lastStartPos+csize+hsize+datasize);
     //printf("imagesize = %d\n", tiff->width*tiff->height*(tiff->bitspersample/8));
 
     //fwrite((void*)tiff->lastHeader, TIFF_HEADER_SIZE+2, 1, tiff->file);
-    TinyTIFFWriter_fwrite((void*)tiff->lastHeader, tiff->lastHeaderSize+2, 1, tiff);
-    tiff->lastIFDOffsetField=tiff->lastStartPos+2+tiff->lastIFDCount*12;
+    TinyTIFFWriter_fwrite((void*)tiff->lastHeader, tiff->lastHeaderSize+csize, 1, tiff);
+    tiff->lastIFDOffsetField=tiff->lastStartPos+csize+tiff->lastIFDCount*TINYTIFFWRITER_IFDENTRYSIZE(tiff);
     //free(tiff->lastHeader);
     //tiff->lastHeader=NULL;
 }
 
+/*! \brief writes tag, type and count of a new IFD entry and returns the position of its value/offset field in TinyTIFFFile::lastHeader
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    The count is written as 32-bit word for TIFF and as 64-bit word for BigTIFF files.
+
+    \note This function writes into TinyTIFFFile::lastHeader, starting at the position TinyTIFFFile::pos
+ */
+static uint32_t TinyTIFFWriter_writeIFDEntryHead(TinyTIFFWriterFile* tiff, uint16_t tag, uint16_t type, uint64_t count) {
+    tiff->lastIFDCount++;
+    WRITEH16DIRECT(tiff, tag);
+    WRITEH16(tiff, type);
+    WRITEHOFFSET(tiff, count);
+    return tiff->pos;
+}
+
 #ifdef ENABLE_UNUSED_TinyTIFFWriter_writeIFDEntry // Silence "unused" warning
 /*! \brief write an arbitrary IFD entry
     \ingroup tinytiffwriter_internal
@@ -472,11 +795,9 @@ static void TinyTIFFWriter_endIFD(TinyTIFFWriterFile* tiff, int hsize) {
 static void TinyTIFFWriter_writeIFDEntry(TinyTIFFWriterFile* tiff, uint16_t tag, uint16_t type, uint32_t count, uint32_t data) {
     if (!tiff) return;
     if (tiff->lastIFDCount<TIFF_HEADER_MAX_ENTRIES) {
-        tiff->lastIFDCount++;
-        WRITEH16DIRECT(tiff, tag);
-        WRITEH16DIRECT(tiff, type);
-        WRITEH32DIRECT(tiff, count);
+        const uint32_t valuepos=TinyTIFFWriter_writeIFDEntryHead(tiff, tag, type, count);
         WRITEH32DIRECT(tiff, data);
+        tiff->pos=valuepos+TINYTIFFWRITER_OFFSETSIZE(tiff);
     }
 }
 #endif
@@ -491,13 +812,9 @@ static void TinyTIFFWriter_writeIFDEntry(TinyTIFFWriterFile* tiff, uint16_t tag,
  static void TinyTIFFWriter_writeIFDEntryBYTE(TinyTIFFWriterFile* tiff, uint16_t tag, uint8_t data) {
     if (!tiff) return;
     if (tiff->lastIFDCount<TIFF_HEADER_MAX_ENTRIES) {
-        tiff->lastIFDCount++;
-        WRITEH16DIRECT(tiff, tag);
-        WRITEH16(tiff, TIFF_TYPE_BYTE);
-        WRITEH32(tiff, 1);
+        const uint32_t valuepos=TinyTIFFWriter_writeIFDEntryHead(tiff, tag, TIFF_TYPE_BYTE, 1);
         WRITEH8DIRECT(tiff, data);
-        WRITEH8(tiff, 0);
-        WRITEH16(tiff, 0);
+        tiff->pos=valuepos+TINYTIFFWRITER_OFFSETSIZE(tiff);
     }
 }
 #endif
@@ -511,12 +828,9 @@ static void TinyTIFFWriter_writeIFDEntry(TinyTIFFWriterFile* tiff, uint16_t tag,
  void TinyTIFFWriter_writeIFDEntrySHORT(TinyTIFFWriterFile* tiff, uint16_t tag, uint16_t data) {
     if (!tiff) return;
     if (tiff->lastIFDCount<TIFF_HEADER_MAX_ENTRIES) {
-        tiff->lastIFDCount++;
-        WRITEH16DIRECT(tiff, tag);
-        WRITEH16(tiff, TIFF_TYPE_SHORT);
-        WRITEH32(tiff, 1);
+        const uint32_t valuepos=TinyTIFFWriter_writeIFDEntryHead(tiff, tag, TIFF_TYPE_SHORT, 1);
         WRITEH16DIRECT(tiff, data);
-        WRITEH16(tiff, 0);
+        tiff->pos=valuepos+TINYTIFFWRITER_OFFSETSIZE(tiff);
     }
 }
 
@@ -529,14 +843,13 @@ static void TinyTIFFWriter_writeIFDEntry(TinyTIFFWriterFile* tiff, uint16_t tag,
  static void TinyTIFFWriter_writeIFDEntryLONG(TinyTIFFWriterFile* tiff, uint16_t tag, uint32_t data) {
     if (!tiff) return;
     if (tiff->lastIFDCount<TIFF_HEADER_MAX_ENTRIES) {
-        tiff->lastIFDCount++;
-        WRITEH16DIRECT(tiff, tag);
-        WRITEH16(tiff, TIFF_TYPE_LONG);
-        WRITEH32(tiff, 1);
+        const uint32_t valuepos=TinyTIFFWriter_writeIFDEntryHead(tiff, tag, TIFF_TYPE_LONG, 1);
         WRITEH32DIRECT(tiff, data);
+        tiff->pos=valuepos+TINYTIFFWRITER_OFFSETSIZE(tiff);
     }
 }
 
+#ifdef ENABLE_UNUSED_TinyTIFFWriter_writeIFDEntryLONGARRAY // Silence "unused" warning
 /*! \brief write an array of 32-bit words as IFD entry
     \ingroup tinytiffwriter_internal
     \internal
@@ -546,14 +859,14 @@ static void TinyTIFFWriter_writeIFDEntry(TinyTIFFWriterFile* tiff, uint16_t tag,
  static void TinyTIFFWriter_writeIFDEntryLONGARRAY(TinyTIFFWriterFile* tiff, uint16_t tag, uint32_t* data, uint32_t N) {
     if (!tiff) return;
     if (tiff->lastIFDCount<TIFF_HEADER_MAX_ENTRIES) {
-        tiff->lastIFDCount++;
-        WRITEH16DIRECT(tiff, tag);
-        WRITEH16(tiff, TIFF_TYPE_LONG);
-        WRITEH32(tiff, N);
-        if (N==1) {
-            WRITEH32DIRECT(tiff, *data);
+        const uint32_t valuepos=TinyTIFFWriter_writeIFDEntryHead(tiff, tag, TIFF_TYPE_LONG, N);
+        if (N*4<=TINYTIFFWRITER_OFFSETSIZE(tiff)) {
+            for (uint32_t i=0; i<N; i++) {
+                WRITEH32DIRECT(tiff, data[i]);
+            }
+            tiff->pos=valuepos+TINYTIFFWRITER_OFFSETSIZE(tiff);
         } else {
-            WRITEH32DIRECT(tiff, tiff->lastIFDDATAAdress+tiff->lastStartPos);
+            WRITEHOFFSET(tiff, tiff->lastIFDDATAAdress+tiff->lastStartPos);
             int pos=tiff->pos;
             tiff->pos=tiff->lastIFDDATAAdress;
             for (uint32_t i=0; i<N; i++) {
@@ -564,6 +877,33 @@ static void TinyTIFFWriter_writeIFDEntry(TinyTIFFWriterFile* tiff, uint16_t tag,
         }
     }
 }
+#endif
+
+/*! \brief write an array of file offsets (or byte counts) as IFD entry. These are stored as LONG in TIFF and as LONG8 in BigTIFF files.
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    \note This function writes into TinyTIFFFile::lastHeader, starting at the position TinyTIFFFile::pos
+ */
+ static void TinyTIFFWriter_writeIFDEntryOFFSETARRAY(TinyTIFFWriterFile* tiff, uint16_t tag, const uint64_t* data, uint32_t N) {
+    if (!tiff) return;
+    if (tiff->lastIFDCount<TIFF_HEADER_MAX_ENTRIES) {
+        const uint32_t valuepos=TinyTIFFWriter_writeIFDEntryHead(tiff, tag, tiff->bigTIFF?TIFF_TYPE_LONG8:TIFF_TYPE_LONG, N);
+        if (N==1) {
+            WRITEHOFFSET(tiff, data[0]);
+            tiff->pos=valuepos+TINYTIFFWRITER_OFFSETSIZE(tiff);
+        } else {
+            WRITEHOFFSET(tiff, tiff->lastIFDDATAAdress+tiff->lastStartPos);
+            int pos=tiff->pos;
+            tiff->pos=tiff->lastIFDDATAAdress;
+            for (uint32_t i=0; i<N; i++) {
+                WRITEHOFFSET(tiff, data[i]);
+            }
+            tiff->lastIFDDATAAdress=tiff->pos;
+            tiff->pos=pos;
+        }
+    }
+}
 
 /*! \brief write an array of 16-bit words as IFD entry
     \ingroup tinytiffwriter_internal
@@ -574,18 +914,14 @@ static void TinyTIFFWriter_writeIFDEntry(TinyTIFFWriterFile* tiff, uint16_t tag,
 static void TinyTIFFWriter_writeIFDEntrySHORTARRAY(TinyTIFFWriterFile* tiff, uint16_t tag, uint16_t* data, uint32_t N) {
     if (!tiff) return;
     if (tiff->lastIFDCount<TIFF_HEADER_MAX_ENTRIES) {
-        tiff->lastIFDCount++;
-        WRITEH16DIRECT(tiff, tag);
-        WRITEH16(tiff, TIFF_TYPE_SHORT);
-        WRITEH32(tiff, N);
-        if (N==1) {
-            WRITEH16DIRECT(tiff, data[0]);
-            WRITEH16DIRECT(tiff, 0);
-        } else if (N==2) {
-            WRITEH16DIRECT(tiff, data[0]);
-            WRITEH16DIRECT(tiff, data[1]);
+        const uint32_t valuepos=TinyTIFFWriter_writeIFDEntryHead(tiff, tag, TIFF_TYPE_SHORT, N);
+        if (N*2<=TINYTIFFWRITER_OFFSETSIZE(tiff)) {
+            for (uint32_t i=0; i<N; i++) {
+                WRITEH16DIRECT(tiff, data[i]);
+            }
+            tiff->pos=valuepos+TINYTIFFWRITER_OFFSETSIZE(tiff);
         } else {
-            WRITEH32DIRECT(tiff, tiff->lastIFDDATAAdress+tiff->lastStartPos);
+            WRITEHOFFSET(tiff, tiff->lastIFDDATAAdress+tiff->lastStartPos);
             int pos=tiff->pos;
             tiff->pos=tiff->lastIFDDATAAdress;
             for (uint32_t i=0; i<N; i++) {
@@ -617,6 +953,7 @@ static void TinyTIFFWriter_writeIFDEntrySHORTARRAY_allsame(TinyTIFFWriterFile* t
 }
 #endif
 
+#ifdef ENABLE_UNUSED_TinyTIFFWriter_writeIFDEntryLONGARRAY // Silence "unused" warning
 /*! \brief write an array of 32-bit words as IFD entry, where every entry has the same value
     \ingroup tinytiffwriter_internal
     \internal
@@ -632,6 +969,25 @@ static void TinyTIFFWriter_writeIFDEntryLONGARRAY_allsame(TinyTIFFWriterFile* ti
         free(tmp);
     }
 }
+#endif
+
+#ifdef ENABLE_UNUSED_TinyTIFFWriter_writeIFDEntryOFFSETARRAY_allsame // Silence "unused" warning
+/*! \brief write an array of file offsets (or byte counts) as IFD entry, where every entry has the same value
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    \note This function writes into TinyTIFFFile::lastHeader, starting at the position TinyTIFFFile::pos
+   */
+static void TinyTIFFWriter_writeIFDEntryOFFSETARRAY_allsame(TinyTIFFWriterFile* tiff, uint16_t tag, uint64_t data, uint16_t N) {
+    uint64_t* tmp=(uint64_t*)malloc(N*sizeof(uint64_t));
+    if (tmp) {
+        uint16_t i;
+        for(i=0; i<N; i++) tmp[i]=data;
+        TinyTIFFWriter_writeIFDEntryOFFSETARRAY(tiff, tag, tmp, N);
+        free(tmp);
+    }
+}
+#endif
 
 /*! \brief write an array of characters (ASCII TEXT) as IFD entry
     \ingroup tinytiffwriter_internal
@@ -642,22 +998,16 @@ static void TinyTIFFWriter_writeIFDEntryLONGARRAY_allsame(TinyTIFFWriterFile* ti
 static void TinyTIFFWriter_writeIFDEntryASCIIARRAY(TinyTIFFWriterFile* tiff, uint16_t tag, const char* data, uint32_t N, int* datapos, int* sizepos) {
     if (!tiff) return;
     if (tiff->lastIFDCount<TIFF_HEADER_MAX_ENTRIES) {
-        tiff->lastIFDCount++;
-        WRITEH16DIRECT(tiff, tag);
-        WRITEH16(tiff, TIFF_TYPE_ASCII);
-        if (sizepos) *sizepos=tiff->pos;
-        WRITEH32(tiff, N);
-        if (N<4) {
+        if (sizepos) *sizepos=tiff->pos+4;
+        const uint32_t valuepos=TinyTIFFWriter_writeIFDEntryHead(tiff, tag, TIFF_TYPE_ASCII, N);
+        if (N<=TINYTIFFWRITER_OFFSETSIZE(tiff)) {
             if (datapos) *datapos=tiff->pos;
-            for (uint32_t i=0; i<4; i++) {
-                if (i<N) {
-                    WRITEH8DIRECT(tiff, data[i]);
-                } else {
-                    WRITEH8DIRECT(tiff, 0);
-                }
+            for (uint32_t i=0; i<N; i++) {
+                WRITEH8DIRECT(tiff, data[i]);
             }
+            tiff->pos=valuepos+TINYTIFFWRITER_OFFSETSIZE(tiff);
         } else {
-            WRITEH32DIRECT(tiff, tiff->lastIFDDATAAdress+tiff->lastStartPos);
+            WRITEHOFFSET(tiff, tiff->lastIFDDATAAdress+tiff->lastStartPos);
             int pos=tiff->pos;
             tiff->pos=tiff->lastIFDDATAAdress;
             if (datapos) *datapos=tiff->pos;
@@ -681,33 +1031,59 @@ static void TinyTIFFWriter_writeIFDEntryASCIIARRAY(TinyTIFFWriterFile* tiff, uin
 static void TinyTIFFWriter_writeIFDEntryRATIONAL(TinyTIFFWriterFile* tiff, uint16_t tag, uint32_t numerator, uint32_t denominator) {
     if (!tiff) return;
     if (tiff->lastIFDCount<TIFF_HEADER_MAX_ENTRIES) {
-        tiff->lastIFDCount++;
-        WRITEH16DIRECT(tiff, tag);
-        WRITEH16(tiff, TIFF_TYPE_RATIONAL);
-        WRITEH32(tiff, 1);
-        WRITEH32DIRECT(tiff, tiff->lastIFDDATAAdress+tiff->lastStartPos);
-        //printf("1 - %lx\n", tiff->pos);
-        int pos=tiff->pos;
-        tiff->pos=tiff->lastIFDDATAAdress;
-        //printf("2 - %lx\n", tiff->pos);
-        WRITEH32DIRECT(tiff, numerator);
-        //printf("3 - %lx\n", tiff->pos);
-        WRITEH32DIRECT(tiff, denominator);
-        tiff->lastIFDDATAAdress=tiff->pos;
-        tiff->pos=pos;
-        //printf("4 - %lx\n", tiff->pos);
+        const uint32_t valuepos=TinyTIFFWriter_writeIFDEntryHead(tiff, tag, TIFF_TYPE_RATIONAL, 1);
+        if (tiff->bigTIFF) {
+            // BigTIFF: the 8 bytes of a RATIONAL fit into the value field of the IFD entry
+            WRITEH32DIRECT(tiff, numerator);
+            WRITEH32DIRECT(tiff, denominator);
+            tiff->pos=valuepos+TINYTIFFWRITER_OFFSETSIZE(tiff);
+        } else {
+            WRITEHOFFSET(tiff, tiff->lastIFDDATAAdress+tiff->lastStartPos);
+            //printf("1 - %lx\n", tiff->pos);
+            int pos=tiff->pos;
+            tiff->pos=tiff->lastIFDDATAAdress;
+            //printf("2 - %lx\n", tiff->pos);
+            WRITEH32DIRECT(tiff, numerator);
+            //printf("3 - %lx\n", tiff->pos);
+            WRITEH32DIRECT(tiff, denominator);
+            tiff->lastIFDDATAAdress=tiff->pos;
+            tiff->pos=pos;
+            //printf("4 - %lx\n", tiff->pos);
+        }
     }
 }
 
 
 
+
 TinyTIFFWriterFile* TinyTIFFWriter_open(const char* filename, uint16_t bitsPerSample, enum TinyTIFFWriterSampleFormat sampleFormat, uint16_t samples, uint32_t width, uint32_t height, enum TinyTIFFWriterSampleInterpretation sampleInterpretation) {
+    return TinyTIFFWriter_open_withformat(filename, bitsPerSample, sampleFormat, samples, width, height, sampleInterpretation, TinyTIFFWriter_TIFF);
+}
+
+TinyTIFFWriterFile* TinyTIFFWriter_open_withformat(const char* filename, uint16_t bitsPerSample, enum TinyTIFFWriterSampleFormat sampleFormat, uint16_t samples, uint32_t width, uint32_t height, enum TinyTIFFWriterSampleInterpretation sampleInterpretation, enum TinyTIFFWriterFileFormat fileFormat) {
     TinyTIFFWriterFile* tiff=(TinyTIFFWriterFile*)malloc(sizeof(TinyTIFFWriterFile));
     if (!tiff) return NULL;
     //tiff->file=fopen(filename, "wb");
     TinyTIFFWriter_fopen(tiff, filename);
     TinyTIFF_memset_s(tiff->lastError, TIFF_LAST_ERROR_SIZE, 0, TIFF_LAST_ERROR_SIZE);
     tiff->wasError=TINYTIFF_FALSE;
+    tiff->async=NULL;
+    tiff->reorderBuffer=NULL;
+    tiff->reorderBufferSize=0;
+    tiff->reorderPlanes=NULL;
+    tiff->rowsPerStrip=0;
+    tiff->tileWidth=0;
+    tiff->tileLength=0;
+    tiff->tilesWritten=0;
+    tiff->tileOrganization=TinyTIFF_Interleaved;
+    tiff->compression=TIFF_COMPRESSION_NONE;
+    tiff->predictor=TIFF_PREDICTOR_NONE;
+    tiff->compressionLevel=TINYTIFF_DEFAULT_COMPRESSION_LEVEL;
+    memset(&(tiff->deflateCodec), 0, sizeof(tiff->deflateCodec));
+    tiff->compressBuffer=NULL;
+    tiff->compressBufferSize=0;
+    tiff->compressionThreads=1;
+    tiff->pool=NULL;
     tiff->width=width;
     tiff->height=height;
     tiff->sampleformat=TIFF_SAMPLEFORMAT_UINT;
@@ -784,6 +1160,7 @@ TinyTIFFWriterFile* TinyTIFFWriter_open(const char* filename, uint16_t bitsPerSa
     tiff->lastHeader=NULL;
     tiff->lastHeaderSize=0;
     tiff->byteorder=TIFF_get_byteorder();
+    tiff->bigTIFF=(fileFormat==TinyTIFFWriter_BigTIFF)?TINYTIFF_TRUE:TINYTIFF_FALSE;
     tiff->frames=0;
     tiff->descriptionOffset=0;
     tiff->descriptionSizeOffset=0;
@@ -800,19 +1177,137 @@ TinyTIFFWriterFile* TinyTIFFWriter_open(const char* filename, uint16_t bitsPerSa
             WRITE8DIRECT(tiff, 'I');   // write TIFF header for little-endian
             WRITE8DIRECT(tiff, 'I');
         }
-        WRITE16DIRECT_CAST(tiff, 42);
-        tiff->lastIFDOffsetField=TinyTIFFWriter_ftell(tiff);//ftell(tiff->file);
-        WRITE32DIRECT_CAST(tiff, 8);      // now write offset to first IFD, which is simply 8 here (in little-endian order)
+        if (tiff->bigTIFF) {
+            WRITE16DIRECT_CAST(tiff, 43);
+            WRITE16DIRECT_CAST(tiff, 8);      // bytesize of offsets
+            WRITE16DIRECT_CAST(tiff, 0);      // always 0
+            tiff->lastIFDOffsetField=TinyTIFFWriter_ftell(tiff);//ftell(tiff->file);
+            WRITE64DIRECT_CAST(tiff, 16);     // now write offset to first IFD, which is simply 16 here
+        } else {
+            WRITE16DIRECT_CAST(tiff, 42);
+            tiff->lastIFDOffsetField=TinyTIFFWriter_ftell(tiff);//ftell(tiff->file);
+            WRITE32DIRECT_CAST(tiff, 8);      // now write offset to first IFD, which is simply 8 here (in little-endian order)
+        }
         return tiff;
     } else {
         free(tiff);
         return NULL;
     }
 }
+/*! \brief returns the number of strips or tiles per frame (for TinyTIFF_Interleaved) or per sample plane (for TinyTIFF_Separate)
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+static uint64_t TinyTIFFWriter_getSegmentsPerPlane(TinyTIFFWriterFile* tiff) {
+    if (tiff->tileWidth>0) {
+        const uint64_t tilesAcross=((uint64_t)tiff->width+tiff->tileWidth-1)/tiff->tileWidth;
+        const uint64_t tilesDown=((uint64_t)tiff->height+tiff->tileLength-1)/tiff->tileLength;
+        return tilesAcross*tilesDown;
+    }
+    if (tiff->rowsPerStrip==0 || tiff->rowsPerStrip>=tiff->height) return 1;
+    return ((uint64_t)tiff->height+tiff->rowsPerStrip-1)/tiff->rowsPerStrip;
+}
+
+/*! \brief returns the number of strips or tiles of a frame, written with the given \a outputOrganization
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+static uint64_t TinyTIFFWriter_getSegmentCount(TinyTIFFWriterFile* tiff, enum TinyTIFFSampleLayout outputOrganization) {
+    return TinyTIFFWriter_getSegmentsPerPlane(tiff)*((outputOrganization==TinyTIFF_Separate)?tiff->samples:1);
+}
+
+/*! \brief returns the size of a single tile in bytes (including the padding at the right and bottom border of the frame)
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+static uint64_t TinyTIFFWriter_getTileSize(TinyTIFFWriterFile* tiff, enum TinyTIFFSampleLayout outputOrganization) {
+    return (uint64_t)tiff->tileWidth*(uint64_t)tiff->tileLength*(uint64_t)(tiff->bitspersample/8)*((outputOrganization==TinyTIFF_Separate)?1:tiff->samples);
+}
+
+/*! \brief waits until the data of the last compressed frame was written by the compression pool (see TinyTIFFWriterPool)
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    Has to be called before the file is accessed by the writing thread again.
+
+    \return TINYTIFF_FALSE, if writing the data failed
+ */
+static int TinyTIFFWriter_waitForPendingWrite(TinyTIFFWriterFile* tiff) {
+    TinyTIFFWriterPool* pool=tiff->pool;
+    if (!pool) return TINYTIFF_TRUE;
+    TinyTIFF_Mutex_lock(&pool->mutex);
+    while (pool->writeQueued || pool->writing) {
+        TinyTIFF_Cond_wait(&pool->workDone, &pool->mutex);
+    }
+    const int ok=!pool->writeError;
+    pool->writeError=TINYTIFF_FALSE;
+    TinyTIFF_Mutex_unlock(&pool->mutex);
+    if (!ok) {
+        TinyTIFFWriter_setError(tiff, "unable to write the image data\0");
+    }
+    return ok;
+}
+
+/*! \brief finishes the pending write job, stops the threads of the compression pool and releases it
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    \return TINYTIFF_FALSE, if writing the data of the last frame failed
+ */
+static int TinyTIFFWriter_stopCompressionPool(TinyTIFFWriterFile* tiff) {
+    TinyTIFFWriterPool* pool=tiff->pool;
+    if (!pool) return TINYTIFF_TRUE;
+    const int ok=TinyTIFFWriter_waitForPendingWrite(tiff);
+    TinyTIFF_Mutex_lock(&pool->mutex);
+    pool->stop=TINYTIFF_TRUE;
+    TinyTIFF_Cond_broadcast(&pool->workQueued);
+    TinyTIFF_Mutex_unlock(&pool->mutex);
+    uint32_t i;
+    for (i=0; i<pool->workerCount; i++) {
+        TinyTIFF_Thread_join(pool->workers[i].thread);
+    }
+    for (i=0; i<pool->workerCount; i++) {
+        free(pool->workers[i].scratch);
+        free((void*)pool->workers[i].planes);
+        TinyTIFF_deflateCodecRelease(&(pool->workers[i].deflateCodec));
+    }
+    TinyTIFF_Cond_destroy(&pool->workDone);
+    TinyTIFF_Cond_destroy(&pool->workQueued);
+    TinyTIFF_Mutex_destroy(&pool->mutex);
+    free(pool->workers);
+    free(pool->spareBuffer);
+    free(pool);
+    tiff->pool=NULL;
+    return ok;
+}
+
+/*! \brief completes a frame, whose tiles were not all written with TinyTIFFWriter_writeTile(), by writing zero-filled tiles
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+static void TinyTIFFWriter_finishTiledFrame(TinyTIFFWriterFile* tiff) {
+    if (tiff->tilesWritten==0) return;
+    const uint64_t tiles=TinyTIFFWriter_getSegmentCount(tiff, tiff->tileOrganization);
+    const size_t tilesize=(size_t)TinyTIFFWriter_getTileSize(tiff, tiff->tileOrganization);
+    uint8_t* zeros=(uint8_t*)calloc(1, tilesize);
+    if (zeros) {
+        while (tiff->tilesWritten<tiles) {
+            TinyTIFFWriter_fwrite(zeros, 1, tilesize, tiff);
+            tiff->tilesWritten++;
+        }
+        free(zeros);
+    }
+    tiff->tilesWritten=0;
+    tiff->frames=tiff->frames+1;
+}
+
 void TinyTIFFWriter_close_withdescription(TinyTIFFWriterFile* tiff, const char* imageDescription) {
    if (tiff) {
+        TinyTIFFWriter_disableAsyncWriting(tiff);
+        TinyTIFFWriter_stopCompressionPool(tiff);
+        TinyTIFFWriter_finishTiledFrame(tiff);
         TinyTIFFWriter_fseek_set(tiff, tiff->lastIFDOffsetField);
-        WRITE32DIRECT_CAST(tiff, 0);
+        WRITEOFFSETDIRECT_CAST(tiff, 0);
         if (imageDescription) {
     #ifdef TINYTIFF_WRITE_COMMENTS
             if (tiff->descriptionOffset>0) {
@@ -839,18 +1334,26 @@ void TinyTIFFWriter_close_withdescription(TinyTIFFWriterFile* tiff, const char*
               TinyTIFFWriter_fseek_set(tiff, tiff->descriptionOffset);
               TinyTIFFWriter_fwrite(description, 1, TINYTIFFWRITER_DESCRIPTION_SIZE+1, tiff);//<<" / "<<dlen<<"\n";
               TinyTIFFWriter_fseek_set(tiff, tiff->descriptionSizeOffset);
-              WRITE32DIRECT_CAST(tiff, dlen);//(TINYTIFFWRITER_DESCRIPTION_SIZE+1));
+              WRITEOFFSETDIRECT_CAST(tiff, dlen);//(TINYTIFFWRITER_DESCRIPTION_SIZE+1));
             }
     #endif // TINYTIFF_WRITE_COMMENTS
         }
         TinyTIFFWriter_fclose(tiff);
         free(tiff->lastHeader);
+        free(tiff->reorderBuffer);
+        free((void*)tiff->reorderPlanes);
+        free(tiff->compressBuffer);
+        TinyTIFF_deflateCodecRelease(&(tiff->deflateCodec));
         free(tiff);
     }
 }
 
 void TinyTIFFWriter_close_withmetadatadescription(TinyTIFFWriterFile* tiff, double pixel_width, double pixel_height, double frametime, double deltaz) {
     if (tiff) {
+      // all queued frames have to be written, before tiff->frames is final
+      TinyTIFFWriter_disableAsyncWriting(tiff);
+      TinyTIFFWriter_stopCompressionPool(tiff);
+      TinyTIFFWriter_finishTiledFrame(tiff);
       char description[TINYTIFFWRITER_DESCRIPTION_SIZE+1];
       TinyTIFF_memset_s(description, TINYTIFFWRITER_DESCRIPTION_SIZE+1, 0, TINYTIFFWRITER_DESCRIPTION_SIZE+1);
       const int spwlen=256;
@@ -892,136 +1395,754 @@ void TinyTIFFWriter_close_withmetadatadescription(TinyTIFFWriterFile* tiff, doub
      }
 
 
-int TinyTIFFWriter_writeImageMultiSample(TinyTIFFWriterFile *tiff, const void *data, enum TinyTIFFSampleLayout inputOrganisation, enum TinyTIFFSampleLayout outputOrganization)
-{
-    if (!tiff) {
-        return TINYTIFF_FALSE;
-    }
-    if (!data) {
-        tiff->wasError=TINYTIFF_TRUE;
-        TINYTIFF_SET_LAST_ERROR(tiff, "no data provided to TinyTIFFWriter_writeImage()\0");
-        return TINYTIFF_FALSE;
-    }
-    const long pos=TinyTIFFWriter_ftell(tiff);
+/*! \brief size of the scratch buffer TinyTIFFWriterFile::reorderBuffer, which limits the additional memory needed to write a frame with reordered samples
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+#define TINYTIFFWRITER_REORDER_BUFFER_SIZE (1024*1024)
 
-    int hsize=TIFF_HEADER_SIZE;
-#ifdef TINYTIFF_WRITE_COMMENTS
-    if (tiff->frames<=0) {
-        hsize=TIFF_HEADER_SIZE+TINYTIFFWRITER_DESCRIPTION_SIZE+1+16;
-    }
-#endif // TINYTIFF_WRITE_COMMENTS
-    const uint16_t photoChannels=TinyTIFFWriter_getPhotometricChannels(tiff->photometricInterpretation);
-    if (tiff->samples<photoChannels) {
-        tiff->wasError=TINYTIFF_TRUE;
-        TINYTIFF_SET_LAST_ERROR(tiff, "too few samples specified for given photometric interpretation\0");
-        return TINYTIFF_FALSE;
+/*! \brief makes sure that the scratch buffers TinyTIFFWriterFile::reorderBuffer and TinyTIFFWriterFile::reorderPlanes are available
+    \ingroup tinytiffwriter_internal
+    \internal
 
+    The buffers are allocated once and reused for all frames of the file. They are never larger than TINYTIFFWRITER_REORDER_BUFFER_SIZE
+    or the size of a frame, but at least \a min_size bytes (i.e. one pixel for reordering, or one tile for tiled frames).
+
+    \return TINYTIFF_TRUE on success
+ */
+static int TinyTIFFWriter_allocateReorderBuffer(TinyTIFFWriterFile* tiff, uint64_t frame_size, size_t min_size) {
+    size_t size=TINYTIFFWRITER_REORDER_BUFFER_SIZE;
+    if (frame_size<size) size=(size_t)frame_size;
+    if (size<min_size) size=min_size;
+    if (!tiff->reorderPlanes) {
+        tiff->reorderPlanes=(const void**)malloc(tiff->samples*sizeof(void*));
+        if (!tiff->reorderPlanes) return TINYTIFF_FALSE;
     }
+    if (tiff->reorderBufferSize<size) {
+        free(tiff->reorderBuffer);
+        tiff->reorderBufferSize=0;
+        tiff->reorderBuffer=(uint8_t*)malloc(size);
+        if (!tiff->reorderBuffer) return TINYTIFF_FALSE;
+        tiff->reorderBufferSize=size;
+    }
+    return TINYTIFF_TRUE;
+}
 
-    TinyTIFFWriter_startIFD(tiff,hsize);
-    TinyTIFFWriter_writeIFDEntryLONG(tiff, TIFF_FIELD_IMAGEWIDTH, tiff->width);
-    TinyTIFFWriter_writeIFDEntryLONG(tiff, TIFF_FIELD_IMAGELENGTH, tiff->height);
-    TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_BITSPERSAMPLE, tiff->bitspersample);
-    TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_COMPRESSION, TIFF_COMPRESSION_NONE);
-    TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_PHOTOMETRICINTERPRETATION, tiff->photometricInterpretation);
+/*! \brief converts the frame \a data with layout \a inputOrganisation into the other layout (interleaved <-> separate) and writes it into the file
+    \ingroup tinytiffwriter_internal
+    \internal
 
-#ifdef TINYTIFF_WRITE_COMMENTS
-    TINTIFFWRITER_WRITEImageDescriptionTemplate(tiff);
-#endif // TINYTIFF_WRITE_COMMENTS
+    The frame is reordered blockwise into TinyTIFFWriterFile::reorderBuffer (see TinyTIFFWriter_allocateReorderBuffer()) and each block is
+    written, as soon as it is complete, so the memory needed does not depend on the frame size:
+      - separate -> interleaved: each block contains all samples of consecutive pixels and is filled with TinyTIFF_interleave()
+      - interleaved -> separate: the output is written sample plane by sample plane, each block contains one sample of consecutive pixels
+        and is filled with TinyTIFF_extractSample()
+    .
 
-    if (outputOrganization==TinyTIFF_Separate) {
-        uint32_t* stripoffset=(uint32_t*)malloc(tiff->samples*sizeof(uint32_t));
-        if (stripoffset) {
-            stripoffset[0]=pos+2+hsize;
-            uint32_t i;
-            for (i=1; i<tiff->samples; i++) {
-                stripoffset[i]=stripoffset[i-1]+tiff->width*tiff->height*(tiff->bitspersample/8);
+    \return TINYTIFF_TRUE on success
+ */
+static int TinyTIFFWriter_writeReorderedSamples(TinyTIFFWriterFile* tiff, const void* data, enum TinyTIFFSampleLayout inputOrganisation) {
+    const size_t pixels=(size_t)tiff->width*(size_t)tiff->height;
+    const uint16_t bytecount=tiff->bitspersample/8;
+    const uint8_t* src=(const uint8_t*)data;
+    size_t start;
+    uint16_t sample;
+    if (inputOrganisation==TinyTIFF_Separate) {
+        const size_t blockpixels=tiff->reorderBufferSize/((size_t)tiff->samples*bytecount);
+        for (start=0; start<pixels; start+=blockpixels) {
+            const size_t n=(pixels-start<blockpixels)?(pixels-start):blockpixels;
+            const size_t blocksize=n*tiff->samples*bytecount;
+            for (sample=0; sample<tiff->samples; sample++) {
+                tiff->reorderPlanes[sample]=src+((size_t)sample*pixels+start)*bytecount;
             }
-            TinyTIFFWriter_writeIFDEntryLONGARRAY(tiff, TIFF_FIELD_STRIPOFFSETS, stripoffset, tiff->samples);
-            free(stripoffset);
+            TinyTIFF_interleave(tiff->reorderPlanes, tiff->reorderBuffer, n, tiff->samples, bytecount);
+            if (TinyTIFFWriter_fwrite(tiff->reorderBuffer, 1, blocksize, tiff)!=blocksize) return TINYTIFF_FALSE;
         }
     } else {
-        TinyTIFFWriter_writeIFDEntryLONG(tiff, TIFF_FIELD_STRIPOFFSETS, pos+2+hsize);
-    }
-
-    TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_SAMPLESPERPIXEL, tiff->samples);
-    TinyTIFFWriter_writeIFDEntryLONG(tiff, TIFF_FIELD_ROWSPERSTRIP, tiff->height);
-    if (outputOrganization==TinyTIFF_Separate)     {
-        TinyTIFFWriter_writeIFDEntryLONGARRAY_allsame(tiff, TIFF_FIELD_STRIPBYTECOUNTS, tiff->width*tiff->height*(tiff->bitspersample/8), tiff->samples);
-    } else {
-        TinyTIFFWriter_writeIFDEntryLONG(tiff, TIFF_FIELD_STRIPBYTECOUNTS, tiff->width*tiff->height*tiff->samples*(tiff->bitspersample/8));
-    }
-    TinyTIFFWriter_writeIFDEntryRATIONAL(tiff, TIFF_FIELD_XRESOLUTION, 1,1);
-    TinyTIFFWriter_writeIFDEntryRATIONAL(tiff, TIFF_FIELD_YRESOLUTION, 1,1);
-    if (outputOrganization==TinyTIFF_Separate) {
-        TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_PLANARCONFIG, TIFF_PLANARCONFIG_PLANAR);
-    } else {
-        TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_PLANARCONFIG, TIFF_PLANARCONFIG_CHUNKY);
-    }
-    TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_RESOLUTIONUNIT, TIFF_RESOLUTIONUNIT_NONE);
-    if (tiff->samples>photoChannels) {
-        const uint16_t NExtraSamples=tiff->samples-photoChannels;
-        uint16_t* extraSamples=(uint16_t*)malloc(NExtraSamples*sizeof(uint16_t));
-        if (extraSamples) {
-            extraSamples[0]=tiff->firstExtraChannelType;
-            if (NExtraSamples>1) {
-                uint16_t i=0;
-                for (i=1; i<NExtraSamples; i++) {
-                    extraSamples[i]=tiff->secondaryExtraChannelType;
-                }
+        const size_t blockpixels=tiff->reorderBufferSize/bytecount;
+        for (sample=0; sample<tiff->samples; sample++) {
+            for (start=0; start<pixels; start+=blockpixels) {
+                const size_t n=(pixels-start<blockpixels)?(pixels-start):blockpixels;
+                TinyTIFF_extractSample(src+start*tiff->samples*bytecount, tiff->reorderBuffer, n, tiff->samples, sample, bytecount);
+                if (TinyTIFFWriter_fwrite(tiff->reorderBuffer, 1, n*bytecount, tiff)!=n*bytecount) return TINYTIFF_FALSE;
             }
-            TinyTIFFWriter_writeIFDEntrySHORTARRAY(tiff, TIFF_FIELD_EXTRASAMPLES, extraSamples, NExtraSamples);
-            free(extraSamples);
         }
     }
-    TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_SAMPLEFORMAT, tiff->sampleformat);
-    TinyTIFFWriter_endIFD(tiff, hsize);
-
-    const int64_t datapos=TinyTIFFWriter_ftell(tiff);
-    const int64_t data_size_expected=tiff->width*tiff->height*tiff->samples*(tiff->bitspersample/8);
-    const int64_t expected_endpos=datapos+data_size_expected;
-    const int64_t max_endpos=(((int64_t)TINYTIFF_MAX_FILE_SIZE)-(int64_t)1024);
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief returns the size of the image data of a frame in the file, i.e. width*height*samples*bitspersample/8 for stripped frames,
+           or the size of all (padded) tiles for tiled frames
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+static int64_t TinyTIFFWriter_getFrameDataSize(TinyTIFFWriterFile* tiff, enum TinyTIFFSampleLayout outputOrganization) {
+    if (tiff->tileWidth>0) {
+        return (int64_t)(TinyTIFFWriter_getSegmentCount(tiff, outputOrganization)*TinyTIFFWriter_getTileSize(tiff, outputOrganization));
+    }
+    return (int64_t)tiff->width*(int64_t)tiff->height*(int64_t)(tiff->bitspersample/8)*(int64_t)tiff->samples;
+}
+
+/*! \brief returns the number of bytes, which the StripOffsets/TileOffsets and StripByteCounts/TileByteCounts arrays of a frame with \a segments strips or tiles need in the frame header
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    A single strip is stored inside the IFD entries, so no additional space is needed.
+ */
+static int64_t TinyTIFFWriter_getSegmentArraySize(TinyTIFFWriterFile* tiff, uint64_t segments) {
+    if (segments<=1) return 0;
+    return 2*(int64_t)segments*TINYTIFFWRITER_OFFSETSIZE(tiff);
+}
+
+/*! \brief fills the StripOffsets/TileOffsets (\a offsets ) and StripByteCounts/TileByteCounts (\a bytecounts ) arrays of a frame, whose image data
+           starts at \a image_datapos and is written continuously with the given \a outputOrganization
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    Each plane (the complete frame for TinyTIFF_Interleaved, each sample for TinyTIFF_Separate) is split into TinyTIFFWriter_getSegmentsPerPlane()
+    strips of TinyTIFFWriterFile::rowsPerStrip rows (the last strip of a plane may be shorter), or into tiles of TinyTIFFWriter_getTileSize() bytes,
+    which are stored row by row.
+ */
+static void TinyTIFFWriter_calcSegments(TinyTIFFWriterFile* tiff, uint64_t image_datapos, enum TinyTIFFSampleLayout outputOrganization, uint64_t* offsets, uint64_t* bytecounts) {
+    const uint64_t segmentsPerPlane=TinyTIFFWriter_getSegmentsPerPlane(tiff);
+    const uint32_t planes=(outputOrganization==TinyTIFF_Separate)?tiff->samples:1;
+    uint64_t offset=image_datapos;
+    uint64_t i=0;
+    if (tiff->tileWidth>0) {
+        const uint64_t tilesize=TinyTIFFWriter_getTileSize(tiff, outputOrganization);
+        for (i=0; i<segmentsPerPlane*planes; i++) {
+            offsets[i]=offset;
+            bytecounts[i]=tilesize;
+            offset+=tilesize;
+        }
+        return;
+    }
+    const uint64_t rowsize=(uint64_t)tiff->width*(uint64_t)(tiff->bitspersample/8)*((outputOrganization==TinyTIFF_Separate)?1:tiff->samples);
+    const uint32_t rows=(segmentsPerPlane>1)?tiff->rowsPerStrip:tiff->height;
+    uint32_t plane;
+    uint64_t strip;
+    for (plane=0; plane<planes; plane++) {
+        for (strip=0; strip<segmentsPerPlane; strip++) {
+            const uint32_t stripRows=(strip+1<segmentsPerPlane)?rows:(uint32_t)(tiff->height-strip*rows);
+            offsets[i]=offset;
+            bytecounts[i]=(uint64_t)stripRows*rowsize;
+            offset+=bytecounts[i];
+            i++;
+        }
+    }
+}
+
+/*! \brief cuts the frame \a data with layout \a inputOrganisation into tiles and writes them into the file, in the order of TinyTIFFWriter_calcSegments()
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    The tiles are assembled in TinyTIFFWriterFile::reorderBuffer (which has to hold at least one tile, see TinyTIFFWriter_allocateReorderBuffer())
+    and written, as soon as no further tile fits into the buffer, so the file is written sequentially. Tiles at the right and bottom border
+    of the frame are padded with zeros. If the sample layout changes, the rows of each tile are converted with TinyTIFF_interleave()
+    or TinyTIFF_extractSample().
+
+    \return TINYTIFF_TRUE on success
+ */
+static int TinyTIFFWriter_writeTiledFrame(TinyTIFFWriterFile* tiff, const void* data, enum TinyTIFFSampleLayout inputOrganisation, enum TinyTIFFSampleLayout outputOrganization) {
+    const size_t pixels=(size_t)tiff->width*(size_t)tiff->height;
+    const uint16_t bytecount=tiff->bitspersample/8;
+    const int reorder=(inputOrganisation!=outputOrganization && tiff->samples>1);
+    const uint16_t planes=(outputOrganization==TinyTIFF_Separate)?tiff->samples:1;
+    const size_t pixelsize=(size_t)bytecount*((outputOrganization==TinyTIFF_Separate)?1:tiff->samples);
+    const size_t tilesize=(size_t)TinyTIFFWriter_getTileSize(tiff, outputOrganization);
+    const uint8_t* src=(const uint8_t*)data;
+    size_t filled=0;
+    uint16_t plane, sample;
+    uint32_t tx, ty, r;
+    for (plane=0; plane<planes; plane++) {
+        for (ty=0; ty<tiff->height; ty+=tiff->tileLength) {
+            const uint32_t rows=(tiff->height-ty<tiff->tileLength)?(tiff->height-ty):tiff->tileLength;
+            for (tx=0; tx<tiff->width; tx+=tiff->tileWidth) {
+                const uint32_t cols=(tiff->width-tx<tiff->tileWidth)?(tiff->width-tx):tiff->tileWidth;
+                uint8_t* tile=tiff->reorderBuffer+filled;
+                if (rows<tiff->tileLength || cols<tiff->tileWidth) {
+                    memset(tile, 0, tilesize);
+                }
+                for (r=0; r<rows; r++) {
+                    const size_t pix=(size_t)(ty+r)*tiff->width+tx;
+                    uint8_t* dst=tile+(size_t)r*tiff->tileWidth*pixelsize;
+                    if (!reorder) {
+                        if (outputOrganization==TinyTIFF_Separate) memcpy(dst, src+((size_t)plane*pixels+pix)*bytecount, (size_t)cols*pixelsize);
+                        else memcpy(dst, src+pix*tiff->samples*bytecount, (size_t)cols*pixelsize);
+                    } else if (outputOrganization==TinyTIFF_Separate) {
+                        TinyTIFF_extractSample(src+pix*tiff->samples*bytecount, dst, cols, tiff->samples, plane, bytecount);
+                    } else {
+                        for (sample=0; sample<tiff->samples; sample++) {
+                            tiff->reorderPlanes[sample]=src+((size_t)sample*pixels+pix)*bytecount;
+                        }
+                        TinyTIFF_interleave(tiff->reorderPlanes, dst, cols, tiff->samples, bytecount);
+                    }
+                }
+                filled+=tilesize;
+                if (filled+tilesize>tiff->reorderBufferSize) {
+                    if (TinyTIFFWriter_fwrite(tiff->reorderBuffer, 1, filled, tiff)!=filled) return TINYTIFF_FALSE;
+                    filled=0;
+                }
+            }
+        }
+    }
+    if (filled>0 && TinyTIFFWriter_fwrite(tiff->reorderBuffer, 1, filled, tiff)!=filled) return TINYTIFF_FALSE;
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief writes the IFD of a new frame with the given \a outputOrganization into the file. The image data (TinyTIFFWriter_getFrameDataSize() bytes, stored as
+           described in TinyTIFFWriter_calcSegments()) has to be written directly afterwards
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    For compressed frames \a compressedBytecounts contains the size of each (compressed) strip. The strips have to be written directly after
+    the IFD in this order. For uncompressed frames \a compressedBytecounts is NULL.
+
+    \return TINYTIFF_TRUE on success
+ */
+static int TinyTIFFWriter_writeFrameIFD(TinyTIFFWriterFile *tiff, enum TinyTIFFSampleLayout outputOrganization, const uint64_t* compressedBytecounts)
+{
+    const int64_t pos=TinyTIFFWriter_ftell(tiff);
+
+    int hsize=(tiff->bigTIFF)?TIFF_HEADER_SIZE_BIGTIFF:TIFF_HEADER_SIZE;
+#ifdef TINYTIFF_WRITE_COMMENTS
+    if (tiff->frames<=0) {
+        hsize=hsize+TINYTIFFWRITER_DESCRIPTION_SIZE+1+16;
+    }
+#endif // TINYTIFF_WRITE_COMMENTS
+    const uint16_t photoChannels=TinyTIFFWriter_getPhotometricChannels(tiff->photometricInterpretation);
+    if (tiff->samples<photoChannels) {
+        TinyTIFFWriter_setError(tiff, "too few samples specified for given photometric interpretation\0");
+        return TINYTIFF_FALSE;
+
+    }
+
+    if (tiff->compression!=TIFF_COMPRESSION_NONE && tiff->tileWidth>0) {
+        TinyTIFFWriter_setError(tiff, "compression is only supported for stripped frames, disable tiling with TinyTIFFWriter_setTileSize(tiff, 0, 0)\0");
+        return TINYTIFF_FALSE;
+    }
+
+    const uint64_t segments=TinyTIFFWriter_getSegmentCount(tiff, outputOrganization);
+    const int64_t segmentarraysize=TinyTIFFWriter_getSegmentArraySize(tiff, segments);
+    if (segmentarraysize>INT32_MAX/2) {
+        TinyTIFFWriter_setError(tiff, "too many strips or tiles per frame, increase the rows per strip or the tile size\0");
+        return TINYTIFF_FALSE;
+    }
+    hsize=hsize+(int)segmentarraysize;
+
+    // pad the header, so the image data starts at an aligned file offset
+    hsize=hsize+(int)((TINYTIFFWRITER_DATA_ALIGNMENT-((pos+TINYTIFFWRITER_IFDCOUNTSIZE(tiff)+hsize)%TINYTIFFWRITER_DATA_ALIGNMENT))%TINYTIFFWRITER_DATA_ALIGNMENT);
+    const int64_t image_datapos=pos+TINYTIFFWRITER_IFDCOUNTSIZE(tiff)+hsize;
+    int64_t data_size_expected=TinyTIFFWriter_getFrameDataSize(tiff, outputOrganization);
+    if (compressedBytecounts) {
+        uint64_t i;
+        data_size_expected=0;
+        for (i=0; i<segments; i++) data_size_expected+=(int64_t)compressedBytecounts[i];
+    }
+    const int64_t expected_endpos=image_datapos+data_size_expected;
+    const int64_t max_endpos=(tiff->bigTIFF)?(((int64_t)TINYTIFF_MAX_BIGTIFF_FILE_SIZE)-(int64_t)1024):(((int64_t)TINYTIFF_MAX_FILE_SIZE)-(int64_t)1024);
     if (expected_endpos>=max_endpos) {
-        tiff->wasError=TINYTIFF_TRUE;
-        TINYTIFF_SET_LAST_ERROR(tiff, "trying to write behind end of file in TinyTIFFWriter_writeImage() (i.e. too many of a too big frame)\0");
+        TinyTIFFWriter_setError(tiff, "trying to write behind end of file in TinyTIFFWriter_writeImage() (i.e. too many of a too big frame)\0");
+        return TINYTIFF_FALSE;
+    }
+    uint64_t* offsets=(uint64_t*)malloc(2*segments*sizeof(uint64_t));
+    if (!offsets) {
+        TinyTIFFWriter_setError(tiff, "unable to allocate memory\0");
         return TINYTIFF_FALSE;
     }
+    uint64_t* bytecounts=offsets+segments;
+    if (compressedBytecounts) {
+        uint64_t i, offset=(uint64_t)image_datapos;
+        for (i=0; i<segments; i++) {
+            offsets[i]=offset;
+            bytecounts[i]=compressedBytecounts[i];
+            offset+=compressedBytecounts[i];
+        }
+    } else {
+        TinyTIFFWriter_calcSegments(tiff, (uint64_t)image_datapos, outputOrganization, offsets, bytecounts);
+    }
+
+    TinyTIFFWriter_startIFD(tiff,hsize);
+    TinyTIFFWriter_writeIFDEntryLONG(tiff, TIFF_FIELD_IMAGEWIDTH, tiff->width);
+    TinyTIFFWriter_writeIFDEntryLONG(tiff, TIFF_FIELD_IMAGELENGTH, tiff->height);
+    TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_BITSPERSAMPLE, tiff->bitspersample);
+    TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_COMPRESSION, tiff->compression);
+    TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_PHOTOMETRICINTERPRETATION, tiff->photometricInterpretation);
+
+#ifdef TINYTIFF_WRITE_COMMENTS
+    TINTIFFWRITER_WRITEImageDescriptionTemplate(tiff);
+#endif // TINYTIFF_WRITE_COMMENTS
 
-    if (inputOrganisation==outputOrganization) {
-        TinyTIFFWriter_fwrite(data, tiff->width*tiff->height*tiff->samples*(tiff->bitspersample/8), 1, tiff);
-    } else if (inputOrganisation==TinyTIFF_Interleaved && outputOrganization==TinyTIFF_Separate) {
-        uint8_t* tmp=(uint8_t*)malloc(tiff->width*tiff->height*tiff->samples*(tiff->bitspersample/8));
-        if (tmp) {
-            uint32_t pix;
-            uint32_t sampidx=0;
-            for (pix=0; pix<tiff->width*tiff->height; pix++) {
-                uint32_t sample=0;
-                for (sample=0; sample<tiff->samples; sample++) {
-                    const size_t bytecount=tiff->bitspersample/8;
-                    const size_t tmpidx=(sample*tiff->width*tiff->height+pix)*bytecount;
-                    TinyTIFF_memcpy_s(&(tmp[tmpidx]), bytecount, &(((uint8_t*)data)[sampidx]), bytecount);
-                    sampidx++;
+    if (tiff->tileWidth>0) {
+        TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_SAMPLESPERPIXEL, tiff->samples);
+    } else {
+        TinyTIFFWriter_writeIFDEntryOFFSETARRAY(tiff, TIFF_FIELD_STRIPOFFSETS, offsets, (uint32_t)segments);
+        TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_SAMPLESPERPIXEL, tiff->samples);
+        TinyTIFFWriter_writeIFDEntryLONG(tiff, TIFF_FIELD_ROWSPERSTRIP, (TinyTIFFWriter_getSegmentsPerPlane(tiff)>1)?tiff->rowsPerStrip:tiff->height);
+        TinyTIFFWriter_writeIFDEntryOFFSETARRAY(tiff, TIFF_FIELD_STRIPBYTECOUNTS, bytecounts, (uint32_t)segments);
+    }
+    TinyTIFFWriter_writeIFDEntryRATIONAL(tiff, TIFF_FIELD_XRESOLUTION, 1,1);
+    TinyTIFFWriter_writeIFDEntryRATIONAL(tiff, TIFF_FIELD_YRESOLUTION, 1,1);
+    if (outputOrganization==TinyTIFF_Separate) {
+        TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_PLANARCONFIG, TIFF_PLANARCONFIG_PLANAR);
+    } else {
+        TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_PLANARCONFIG, TIFF_PLANARCONFIG_CHUNKY);
+    }
+    TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_RESOLUTIONUNIT, TIFF_RESOLUTIONUNIT_NONE);
+    if (tiff->compression!=TIFF_COMPRESSION_NONE && tiff->predictor!=TIFF_PREDICTOR_NONE) {
+        TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_PREDICTOR, tiff->predictor);
+    }
+    if (tiff->tileWidth>0) {
+        // the IFD entries have to be sorted by tag, so the tile tags follow ResolutionUnit
+        TinyTIFFWriter_writeIFDEntryLONG(tiff, TIFF_FIELD_TILE_WIDTH, tiff->tileWidth);
+        TinyTIFFWriter_writeIFDEntryLONG(tiff, TIFF_FIELD_TILE_LENGTH, tiff->tileLength);
+        TinyTIFFWriter_writeIFDEntryOFFSETARRAY(tiff, TIFF_FIELD_TILE_OFFSETS, offsets, (uint32_t)segments);
+        TinyTIFFWriter_writeIFDEntryOFFSETARRAY(tiff, TIFF_FIELD_TILE_BYTECOUNTS, bytecounts, (uint32_t)segments);
+    }
+    free(offsets);
+    if (tiff->samples>photoChannels) {
+        const uint16_t NExtraSamples=tiff->samples-photoChannels;
+        uint16_t* extraSamples=(uint16_t*)malloc(NExtraSamples*sizeof(uint16_t));
+        if (extraSamples) {
+            extraSamples[0]=tiff->firstExtraChannelType;
+            if (NExtraSamples>1) {
+                uint16_t i=0;
+                for (i=1; i<NExtraSamples; i++) {
+                    extraSamples[i]=tiff->secondaryExtraChannelType;
                 }
             }
-            TinyTIFFWriter_fwrite(tmp, tiff->width*tiff->height*tiff->samples*(tiff->bitspersample/8), 1, tiff);
-            free(tmp);
+            TinyTIFFWriter_writeIFDEntrySHORTARRAY(tiff, TIFF_FIELD_EXTRASAMPLES, extraSamples, NExtraSamples);
+            free(extraSamples);
         }
-    } else if (inputOrganisation==TinyTIFF_Separate && outputOrganization==TinyTIFF_Interleaved) {
-        uint8_t* tmp=(uint8_t*)malloc(tiff->width*tiff->height*tiff->samples*(tiff->bitspersample/8));
-        if (tmp) {
-            uint32_t sample;
-            for (sample=0; sample<tiff->samples; sample++) {
-                uint32_t pix;
-                for (pix=0; pix<tiff->width*tiff->height; pix++) {
-                    const size_t bytecount=tiff->bitspersample/8;
-                    const size_t tmpidx=(pix*tiff->samples+sample)*bytecount;
-                    const size_t sampidx=(sample*tiff->width*tiff->height+pix)*bytecount;
-                    TinyTIFF_memcpy_s(&(tmp[tmpidx]), bytecount, &(((uint8_t*)data)[sampidx]), bytecount);
-                }
+    }
+    TinyTIFFWriter_writeIFDEntrySHORT(tiff, TIFF_FIELD_SAMPLEFORMAT, tiff->sampleformat);
+    TinyTIFFWriter_endIFD(tiff, hsize, (uint64_t)data_size_expected);
+
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief returns the uncompressed data of the strip with the rows \a firstRow ... \a firstRow+rows-1 of the plane \a plane (0 for TinyTIFF_Interleaved)
+           of the frame \a data, as it is stored in the file with the given \a outputOrganization
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    If the sample layout does not change, this is a pointer into \a data, otherwise the strip is reordered into \a scratch, which has to hold
+    the complete strip.
+ */
+static const uint8_t* TinyTIFFWriter_getStripData(TinyTIFFWriterFile* tiff, const void* data, enum TinyTIFFSampleLayout inputOrganisation, enum TinyTIFFSampleLayout outputOrganization, uint16_t plane, uint32_t firstRow, uint32_t rows, uint8_t* scratch, const void** planes) {
+    const size_t pixels=(size_t)tiff->width*(size_t)tiff->height;
+    const size_t firstPixel=(size_t)firstRow*tiff->width;
+    const size_t stripPixels=(size_t)rows*tiff->width;
+    const uint16_t bytecount=tiff->bitspersample/8;
+    const uint8_t* src=(const uint8_t*)data;
+    uint16_t sample;
+    if (inputOrganisation==outputOrganization || tiff->samples<=1) {
+        if (outputOrganization==TinyTIFF_Separate) return src+((size_t)plane*pixels+firstPixel)*bytecount;
+        return src+firstPixel*tiff->samples*bytecount;
+    }
+    if (outputOrganization==TinyTIFF_Separate) {
+        TinyTIFF_extractSample(src+firstPixel*tiff->samples*bytecount, scratch, stripPixels, tiff->samples, plane, bytecount);
+    } else {
+        for (sample=0; sample<tiff->samples; sample++) {
+            planes[sample]=src+((size_t)sample*pixels+firstPixel)*bytecount;
+        }
+        TinyTIFF_interleave(planes, scratch, stripPixels, tiff->samples, bytecount);
+    }
+    return scratch;
+}
+
+/*! \brief returns the maximum size of a strip with \a rows rows of \a rowsize bytes, after it was compressed with TinyTIFFWriter_compressStrip()
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+static uint64_t TinyTIFFWriter_getMaxCompressedStripSize(TinyTIFFWriterFile* tiff, uint32_t rows, uint64_t rowsize) {
+    switch(tiff->compression) {
+        case TIFF_COMPRESSION_PACKBITS: return (uint64_t)rows*TinyTIFF_packBitsMaxEncodedSize((size_t)rowsize);
+        case TIFF_COMPRESSION_LZW: return TinyTIFF_lzwMaxEncodedSize((size_t)((uint64_t)rows*rowsize));
+#ifdef TINYTIFF_HAVE_DEFLATE
+        case TIFF_COMPRESSION_ADOBE_DEFLATE: return TinyTIFF_deflateMaxEncodedSize((size_t)((uint64_t)rows*rowsize));
+#endif
+        default: return (uint64_t)rows*rowsize;
+    }
+}
+
+/*! \brief compresses the strip \a strip ( \a rows rows of \a rowsize bytes) with the compression scheme of the file into \a dst
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    \a dst has to hold at least TinyTIFFWriter_getMaxCompressedStripSize() bytes. A predictor has to be applied to \a strip beforehand.
+    \a codec is the Deflate compressor of the calling thread.
+
+    \return the size of the compressed strip in bytes, or 0 if the compression failed
+ */
+static uint64_t TinyTIFFWriter_compressStrip(TinyTIFFWriterFile* tiff, TinyTIFF_DeflateCodec* codec, const uint8_t* strip, uint32_t rows, uint64_t rowsize, uint8_t* dst) {
+    uint64_t size=0;
+    uint32_t r;
+#ifndef TINYTIFF_HAVE_DEFLATE
+    (void)codec;
+#endif
+    switch(tiff->compression) {
+        case TIFF_COMPRESSION_PACKBITS:
+            // PackBits runs must not cross row boundaries
+            for (r=0; r<rows; r++) {
+                size+=TinyTIFF_packBitsEncode(strip+(uint64_t)r*rowsize, (size_t)rowsize, dst+size);
+            }
+            break;
+        case TIFF_COMPRESSION_LZW:
+            size=TinyTIFF_lzwEncode(strip, (size_t)((uint64_t)rows*rowsize), dst);
+            break;
+#ifdef TINYTIFF_HAVE_DEFLATE
+        case TIFF_COMPRESSION_ADOBE_DEFLATE:
+            size=TinyTIFF_deflateEncode(codec, strip, (size_t)((uint64_t)rows*rowsize), dst, tiff->compressionLevel);
+            break;
+#endif
+        default:
+            size=(uint64_t)rows*rowsize;
+            memcpy(dst, strip, (size_t)size);
+            break;
+    }
+    return size;
+}
+
+/*! \brief compresses the strip \a i (counted over all sample planes) of the frame \a strips into \a dst
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    \a scratch has to hold one uncompressed strip and \a planes \c samples pointers, each thread needs its own \a scratch, \a planes
+    and \a codec. A predictor is applied to a copy of the strip in \a scratch.
+
+    \return the size of the compressed strip in bytes, or 0 if the compression failed
+ */
+static uint64_t TinyTIFFWriter_compressFrameStrip(TinyTIFFWriterFile* tiff, const TinyTIFFWriterStrips* strips, uint64_t i, uint8_t* scratch, const void** planes, TinyTIFF_DeflateCodec* codec, uint8_t* dst) {
+    const uint16_t plane=(uint16_t)(i/strips->segmentsPerPlane);
+    const uint64_t strip=i%strips->segmentsPerPlane;
+    const uint32_t firstRow=(uint32_t)(strip*strips->rowsPerStrip);
+    const uint32_t rows=(strip+1<strips->segmentsPerPlane)?strips->rowsPerStrip:(tiff->height-firstRow);
+    const uint8_t* stripdata=TinyTIFFWriter_getStripData(tiff, strips->data, strips->inputOrganisation, strips->outputOrganization, plane, firstRow, rows, scratch, planes);
+    if (tiff->predictor==TIFF_PREDICTOR_HORIZONTAL) {
+        // the differences are taken in place, so the strip has to be copied, unless it was already reordered
+        if (stripdata!=scratch) memcpy(scratch, stripdata, (size_t)((uint64_t)rows*strips->rowsize));
+        TinyTIFF_horizontalPredictorEncode(scratch, (size_t)((uint64_t)rows*strips->rowsize), (size_t)strips->rowsize, tiff->bitspersample/8, (strips->outputOrganization==TinyTIFF_Separate)?1:tiff->samples, tiff->byteorder==TIFF_ORDER_BIGENDIAN);
+        stripdata=scratch;
+    }
+    return TinyTIFFWriter_compressStrip(tiff, codec, stripdata, rows, strips->rowsize, dst);
+}
+
+/*! \brief main function of the threads of the compression pool: executes write jobs and compresses strips, until TinyTIFFWriterPool::stop is set
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+static void TinyTIFFWriter_poolThread(void* arg) {
+    TinyTIFFWriterPoolWorker* worker=(TinyTIFFWriterPoolWorker*)arg;
+    TinyTIFFWriterPool* pool=worker->pool;
+    TinyTIFF_Mutex_lock(&pool->mutex);
+    for (;;) {
+        if (pool->writeQueued) {
+            // the data of the previous frame is written first, so the I/O overlaps with the compression of the next frame
+            const uint8_t* data=pool->writeData;
+            const size_t size=pool->writeSize;
+            pool->writeQueued=TINYTIFF_FALSE;
+            pool->writing=TINYTIFF_TRUE;
+            TinyTIFF_Mutex_unlock(&pool->mutex);
+            const int ok=(TinyTIFFWriter_fwrite(data, 1, size, pool->tiff)==size);
+            TinyTIFF_Mutex_lock(&pool->mutex);
+            pool->writing=TINYTIFF_FALSE;
+            if (!ok) pool->writeError=TINYTIFF_TRUE;
+            TinyTIFF_Cond_broadcast(&pool->workDone);
+        } else if (pool->nextStrip<pool->stripCount) {
+            const uint64_t i=pool->nextStrip;
+            pool->nextStrip++;
+            TinyTIFF_Mutex_unlock(&pool->mutex);
+            const uint64_t size=TinyTIFFWriter_compressFrameStrip(pool->tiff, &(pool->strips), i, worker->scratch, worker->planes, &(worker->deflateCodec), pool->buffer+pool->slots[i]);
+            TinyTIFF_Mutex_lock(&pool->mutex);
+            pool->bytecounts[i]=size;
+            if (size==0) pool->compressError=TINYTIFF_TRUE;
+            pool->stripsDone++;
+            if (pool->stripsDone==pool->stripCount) TinyTIFF_Cond_broadcast(&pool->workDone);
+        } else if (pool->stop) {
+            break;
+        } else {
+            TinyTIFF_Cond_wait(&pool->workQueued, &pool->mutex);
+        }
+    }
+    TinyTIFF_Mutex_unlock(&pool->mutex);
+}
+
+/*! \brief starts the compression pool with TinyTIFFWriterFile::compressionThreads threads (including the writing thread)
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    If no additional thread can be started, the strips are compressed in the writing thread only.
+
+    \return TINYTIFF_TRUE on success
+ */
+static int TinyTIFFWriter_startCompressionPool(TinyTIFFWriterFile* tiff) {
+    const uint32_t threads=(tiff->compressionThreads>0)?tiff->compressionThreads:(uint32_t)TinyTIFF_Thread_hardwareConcurrency();
+    if (threads<=1) return TINYTIFF_TRUE;
+    TinyTIFFWriterPool* pool=(TinyTIFFWriterPool*)calloc(1, sizeof(TinyTIFFWriterPool));
+    if (pool) pool->workers=(TinyTIFFWriterPoolWorker*)calloc(threads-1, sizeof(TinyTIFFWriterPoolWorker));
+    int ok=(pool && pool->workers);
+    uint32_t i;
+    for (i=0; ok && i<threads-1; i++) {
+        pool->workers[i].pool=pool;
+        pool->workers[i].planes=(const void**)malloc(tiff->samples*sizeof(void*));
+        if (!pool->workers[i].planes) ok=TINYTIFF_FALSE;
+    }
+    if (!ok) {
+        if (pool && pool->workers) {
+            for (i=0; i<threads-1; i++) free((void*)pool->workers[i].planes);
+        }
+        if (pool) free(pool->workers);
+        free(pool);
+        TinyTIFFWriter_setError(tiff, "unable to allocate memory for the compression threads\0");
+        return TINYTIFF_FALSE;
+    }
+    pool->tiff=tiff;
+    TinyTIFF_Mutex_init(&pool->mutex);
+    TinyTIFF_Cond_init(&pool->workQueued);
+    TinyTIFF_Cond_init(&pool->workDone);
+    tiff->pool=pool;
+    while (pool->workerCount<threads-1 && TinyTIFF_Thread_create(&(pool->workers[pool->workerCount].thread), TinyTIFFWriter_poolThread, &(pool->workers[pool->workerCount]))) {
+        pool->workerCount++;
+    }
+    for (i=pool->workerCount; i<threads-1; i++) {
+        free((void*)pool->workers[i].planes);
+        pool->workers[i].planes=NULL;
+    }
+    if (pool->workerCount==0) {
+        // fall back to single-threaded compression (this is not retried for every frame)
+        TinyTIFFWriter_stopCompressionPool(tiff);
+        tiff->compressionThreads=1;
+    }
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief compresses the \a count strips of a frame with the compression pool into their \a slots in TinyTIFFWriterFile::compressBuffer
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    The calling thread compresses strips too, using TinyTIFFWriterFile::reorderBuffer as scratch buffer.
+    The function returns, when all strips are compressed, their sizes are stored in \a bytecounts.
+
+    \return TINYTIFF_TRUE on success
+ */
+static int TinyTIFFWriter_compressStripsInPool(TinyTIFFWriterFile* tiff, const TinyTIFFWriterStrips* strips, uint64_t count, const uint64_t* slots, uint64_t* bytecounts) {
+    TinyTIFFWriterPool* pool=tiff->pool;
+    const size_t scratchSize=(size_t)((uint64_t)strips->rowsPerStrip*strips->rowsize);
+    uint32_t w;
+    // all strips of the previous frame are done, so the workers do not use their scratch buffers
+    for (w=0; w<pool->workerCount; w++) {
+        TinyTIFFWriterPoolWorker* worker=&(pool->workers[w]);
+        if (worker->scratchSize<scratchSize) {
+            free(worker->scratch);
+            worker->scratchSize=0;
+            worker->scratch=(uint8_t*)malloc(scratchSize);
+            if (!worker->scratch) {
+                TinyTIFFWriter_setError(tiff, "unable to allocate memory for the compression threads\0");
+                return TINYTIFF_FALSE;
+            }
+            worker->scratchSize=scratchSize;
+        }
+    }
+    TinyTIFF_Mutex_lock(&pool->mutex);
+    pool->strips=*strips;
+    pool->buffer=tiff->compressBuffer;
+    pool->slots=slots;
+    pool->bytecounts=bytecounts;
+    pool->stripCount=count;
+    pool->nextStrip=0;
+    pool->stripsDone=0;
+    pool->compressError=TINYTIFF_FALSE;
+    TinyTIFF_Cond_broadcast(&pool->workQueued);
+    while (pool->nextStrip<pool->stripCount) {
+        const uint64_t i=pool->nextStrip;
+        pool->nextStrip++;
+        TinyTIFF_Mutex_unlock(&pool->mutex);
+        const uint64_t size=TinyTIFFWriter_compressFrameStrip(tiff, strips, i, tiff->reorderBuffer, tiff->reorderPlanes, &(tiff->deflateCodec), tiff->compressBuffer+slots[i]);
+        TinyTIFF_Mutex_lock(&pool->mutex);
+        bytecounts[i]=size;
+        if (size==0) pool->compressError=TINYTIFF_TRUE;
+        pool->stripsDone++;
+    }
+    while (pool->stripsDone<pool->stripCount) {
+        TinyTIFF_Cond_wait(&pool->workDone, &pool->mutex);
+    }
+    const int ok=!pool->compressError;
+    pool->stripCount=0;
+    pool->nextStrip=0;
+    TinyTIFF_Mutex_unlock(&pool->mutex);
+    if (!ok) {
+        TinyTIFFWriter_setError(tiff, "unable to compress the image data\0");
+    }
+    return ok;
+}
+
+/*! \brief compresses the frame \a data strip by strip into TinyTIFFWriterFile::compressBuffer and writes it into the file together with its IFD
+    \ingroup tinytiffwriter_internal
+    \internal
+
+    The sizes of the compressed strips are only known after compression, so the complete frame is compressed, before the IFD is written.
+    If the sample layout changes, or a predictor is applied, each strip is reordered or copied into a scratch buffer first.
+
+    With a compression pool (see TinyTIFFWriter_setCompressionThreads()) the strips are compressed in parallel and the data is written
+    by a worker, while the calling thread continues with the next frame. The strips are compressed and stored in the same way in both cases,
+    so the file does not depend on the number of threads.
+
+    \return TINYTIFF_TRUE on success
+ */
+static int TinyTIFFWriter_writeCompressedFrame(TinyTIFFWriterFile* tiff, const void* data, enum TinyTIFFSampleLayout inputOrganisation, enum TinyTIFFSampleLayout outputOrganization) {
+    const uint64_t segmentsPerPlane=TinyTIFFWriter_getSegmentsPerPlane(tiff);
+    const uint64_t segments=TinyTIFFWriter_getSegmentCount(tiff, outputOrganization);
+    const uint16_t planes=(outputOrganization==TinyTIFF_Separate)?tiff->samples:1;
+    const uint64_t rowsize=(uint64_t)tiff->width*(uint64_t)(tiff->bitspersample/8)*((outputOrganization==TinyTIFF_Separate)?1:tiff->samples);
+    const uint32_t rowsPerStrip=(segmentsPerPlane>1)?tiff->rowsPerStrip:tiff->height;
+    const int reorder=(inputOrganisation!=outputOrganization && tiff->samples>1);
+    const int predict=(tiff->predictor==TIFF_PREDICTOR_HORIZONTAL);
+    uint64_t maxsize=0, written=0, i=0;
+    uint64_t strip;
+    if (tiff->compressionThreads!=1 && !tiff->pool && !TinyTIFFWriter_startCompressionPool(tiff)) {
+        return TINYTIFF_FALSE;
+    }
+    if ((reorder || predict) && !TinyTIFFWriter_allocateReorderBuffer(tiff, (uint64_t)rowsPerStrip*rowsize, (size_t)((uint64_t)rowsPerStrip*rowsize))) {
+        TinyTIFFWriter_setError(tiff, "unable to allocate memory for reordering the samples\0");
+        return TINYTIFF_FALSE;
+    }
+    for (strip=0; strip<segmentsPerPlane; strip++) {
+        const uint32_t rows=(strip+1<segmentsPerPlane)?rowsPerStrip:(uint32_t)(tiff->height-strip*rowsPerStrip);
+        maxsize+=TinyTIFFWriter_getMaxCompressedStripSize(tiff, rows, rowsize);
+    }
+    maxsize*=planes;
+    if (tiff->compressBufferSize<maxsize) {
+        free(tiff->compressBuffer);
+        tiff->compressBufferSize=0;
+        tiff->compressBuffer=(uint8_t*)malloc((size_t)maxsize);
+        if (!tiff->compressBuffer) {
+            TinyTIFFWriter_setError(tiff, "unable to allocate memory for compressing the frame\0");
+            return TINYTIFF_FALSE;
+        }
+        tiff->compressBufferSize=(size_t)maxsize;
+    }
+    // with a compression pool, the second half of the array receives the slot of each strip in compressBuffer
+    uint64_t* bytecounts=(uint64_t*)malloc((tiff->pool?2:1)*segments*sizeof(uint64_t));
+    if (!bytecounts) {
+        TinyTIFFWriter_setError(tiff, "unable to allocate memory\0");
+        return TINYTIFF_FALSE;
+    }
+    TinyTIFFWriterStrips strips;
+    strips.data=data;
+    strips.inputOrganisation=inputOrganisation;
+    strips.outputOrganization=outputOrganization;
+    strips.rowsize=rowsize;
+    strips.rowsPerStrip=rowsPerStrip;
+    strips.segmentsPerPlane=segmentsPerPlane;
+    if (tiff->pool) {
+        // each strip is compressed into a slot of its maximum size, afterwards the strips are moved together
+        uint64_t* slots=bytecounts+segments;
+        uint64_t slot=0;
+        for (i=0; i<segments; i++) {
+            strip=i%segmentsPerPlane;
+            slots[i]=slot;
+            slot+=TinyTIFFWriter_getMaxCompressedStripSize(tiff, (strip+1<segmentsPerPlane)?rowsPerStrip:(uint32_t)(tiff->height-strip*rowsPerStrip), rowsize);
+        }
+        if (!TinyTIFFWriter_compressStripsInPool(tiff, &strips, segments, slots, bytecounts)) {
+            free(bytecounts);
+            return TINYTIFF_FALSE;
+        }
+        for (i=0; i<segments; i++) {
+            if (slots[i]!=written) memmove(tiff->compressBuffer+written, tiff->compressBuffer+slots[i], (size_t)bytecounts[i]);
+            written+=bytecounts[i];
+        }
+    } else {
+        for (i=0; i<segments; i++) {
+            bytecounts[i]=TinyTIFFWriter_compressFrameStrip(tiff, &strips, i, tiff->reorderBuffer, tiff->reorderPlanes, &(tiff->deflateCodec), tiff->compressBuffer+written);
+            if (bytecounts[i]==0) {
+                free(bytecounts);
+                TinyTIFFWriter_setError(tiff, "unable to compress the image data\0");
+                return TINYTIFF_FALSE;
             }
-            TinyTIFFWriter_fwrite(tmp, tiff->width*tiff->height*tiff->samples*(tiff->bitspersample/8), 1, tiff);
-            free(tmp);
+            written+=bytecounts[i];
+        }
+    }
+    // the data of the previous frame has to be in the file, before this IFD is written
+    const int ok=TinyTIFFWriter_waitForPendingWrite(tiff) && TinyTIFFWriter_writeFrameIFD(tiff, outputOrganization, bytecounts);
+    free(bytecounts);
+    if (!ok) return TINYTIFF_FALSE;
+    if (tiff->pool) {
+        TinyTIFFWriterPool* pool=tiff->pool;
+        uint8_t* buffer=tiff->compressBuffer;
+        const size_t buffersize=tiff->compressBufferSize;
+        TinyTIFF_Mutex_lock(&pool->mutex);
+        pool->writeData=buffer;
+        pool->writeSize=(size_t)written;
+        pool->writeQueued=TINYTIFF_TRUE;
+        TinyTIFF_Cond_broadcast(&pool->workQueued);
+        TinyTIFF_Mutex_unlock(&pool->mutex);
+        // the next frame is compressed into the other buffer, while this one is written
+        tiff->compressBuffer=pool->spareBuffer;
+        tiff->compressBufferSize=pool->spareBufferSize;
+        pool->spareBuffer=buffer;
+        pool->spareBufferSize=buffersize;
+        return TINYTIFF_TRUE;
+    }
+    if (TinyTIFFWriter_fwrite(tiff->compressBuffer, 1, (size_t)written, tiff)!=written) {
+        TinyTIFFWriter_setError(tiff, "unable to write the image data\0");
+        return TINYTIFF_FALSE;
+    }
+    return TINYTIFF_TRUE;
+}
+
+/*! \brief writes a frame into the file (used by TinyTIFFWriter_writeImageMultiSample() and the asynchronous I/O thread)
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+static int TinyTIFFWriter_writeImageMultiSample___internl(TinyTIFFWriterFile *tiff, const void *data, enum TinyTIFFSampleLayout inputOrganisation, enum TinyTIFFSampleLayout outputOrganization)
+{
+    if (!tiff) {
+        return TINYTIFF_FALSE;
+    }
+    if (!data) {
+        TinyTIFFWriter_setError(tiff, "no data provided to TinyTIFFWriter_writeImage()\0");
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->tilesWritten>0) {
+        TinyTIFFWriter_setError(tiff, "the current frame is incomplete, write its remaining tiles with TinyTIFFWriter_writeTile() first\0");
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->compression!=TIFF_COMPRESSION_NONE && tiff->tileWidth==0) {
+        if (!TinyTIFFWriter_writeCompressedFrame(tiff, data, inputOrganisation, outputOrganization)) return TINYTIFF_FALSE;
+        tiff->frames=tiff->frames+1;
+        return TINYTIFF_TRUE;
+    }
+    if (!TinyTIFFWriter_waitForPendingWrite(tiff)) {
+        return TINYTIFF_FALSE;
+    }
+    const int64_t data_size_expected=TinyTIFFWriter_getFrameDataSize(tiff, outputOrganization);
+    const int reorder=(inputOrganisation!=outputOrganization && tiff->samples>1);
+    // the scratch buffer has to be allocated before the IFD is written, so the file stays consistent
+    if (tiff->tileWidth>0) {
+        if (!TinyTIFFWriter_allocateReorderBuffer(tiff, (uint64_t)data_size_expected, (size_t)TinyTIFFWriter_getTileSize(tiff, outputOrganization))) {
+            TinyTIFFWriter_setError(tiff, "unable to allocate memory for the tiles\0");
+            return TINYTIFF_FALSE;
         }
+    } else if (reorder && !TinyTIFFWriter_allocateReorderBuffer(tiff, (uint64_t)data_size_expected, (size_t)tiff->samples*(size_t)(tiff->bitspersample/8))) {
+        TinyTIFFWriter_setError(tiff, "unable to allocate memory for reordering the samples\0");
+        return TINYTIFF_FALSE;
+    }
+    if (!TinyTIFFWriter_writeFrameIFD(tiff, outputOrganization, NULL)) {
+        return TINYTIFF_FALSE;
+    }
+
+    int ok=TINYTIFF_TRUE;
+    if (tiff->tileWidth>0) {
+        ok=TinyTIFFWriter_writeTiledFrame(tiff, data, inputOrganisation, outputOrganization);
+    } else if (!reorder) {
+        TinyTIFFWriter_fwrite(data, data_size_expected, 1, tiff);
+    } else {
+        ok=TinyTIFFWriter_writeReorderedSamples(tiff, data, inputOrganisation);
+    }
+    if (!ok) {
+        TinyTIFFWriter_setError(tiff, "unable to write the image data\0");
+        return TINYTIFF_FALSE;
     }
     tiff->frames=tiff->frames+1;
 
@@ -1029,6 +2150,227 @@ int TinyTIFFWriter_writeImageMultiSample(TinyTIFFWriterFile *tiff, const void *d
 }
 
 
+int TinyTIFFWriter_writeImageMultiSample(TinyTIFFWriterFile *tiff, const void *data, enum TinyTIFFSampleLayout inputOrganisation, enum TinyTIFFSampleLayout outputOrganization)
+{
+    if (!tiff) {
+        return TINYTIFF_FALSE;
+    }
+    // frames that are still queued have to be written first, to keep the order of the frames
+    if (tiff->async && !TinyTIFFWriter_flushAsync(tiff)) {
+        return TINYTIFF_FALSE;
+    }
+    return TinyTIFFWriter_writeImageMultiSample___internl(tiff, data, inputOrganisation, outputOrganization);
+}
+
+/*! \brief main function of the asynchronous I/O thread: writes queued frames, until TinyTIFFWriterAsync::stop is set and the ring is empty
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+static void TinyTIFFWriter_asyncThread(void* arg) {
+    TinyTIFFWriterFile* tiff=(TinyTIFFWriterFile*)arg;
+    TinyTIFFWriterAsync* async=tiff->async;
+    TinyTIFF_Mutex_lock(&async->mutex);
+    for (;;) {
+        while (async->queued==0 && !async->stop) {
+            TinyTIFF_Cond_wait(&async->frameQueued, &async->mutex);
+        }
+        if (async->queued==0) break;
+        const uint32_t slot=(async->head+async->bufferCount-async->queued)%async->bufferCount;
+        const enum TinyTIFFSampleLayout inputOrganisation=async->inputOrganisation[slot];
+        const enum TinyTIFFSampleLayout outputOrganization=async->outputOrganization[slot];
+        // the slot is not touched by the caller, until queued is decremented, so the file I/O runs without holding the lock
+        async->writing=TINYTIFF_TRUE;
+        TinyTIFF_Mutex_unlock(&async->mutex);
+        const int ok=TinyTIFFWriter_writeImageMultiSample___internl(tiff, async->buffers[slot], inputOrganisation, outputOrganization);
+        TinyTIFF_Mutex_lock(&async->mutex);
+        async->writing=TINYTIFF_FALSE;
+        if (!ok) async->error=TINYTIFF_TRUE;
+        async->queued--;
+        TinyTIFF_Cond_broadcast(&async->frameWritten);
+    }
+    TinyTIFF_Mutex_unlock(&async->mutex);
+}
+
+/*! \brief releases the memory of an asynchronous writer state (the I/O thread has to be stopped already)
+    \ingroup tinytiffwriter_internal
+    \internal
+ */
+static void TinyTIFFWriter_freeAsync(TinyTIFFWriterAsync* async) {
+    if (!async) return;
+    if (async->buffers) {
+        uint32_t i;
+        for (i=0; i<async->bufferCount; i++) {
+            free(async->buffers[i]);
+        }
+        free(async->buffers);
+    }
+    free(async->inputOrganisation);
+    free(async->outputOrganization);
+    free(async);
+}
+
+int TinyTIFFWriter_enableAsyncWriting(TinyTIFFWriterFile* tiff, uint32_t bufferCount)
+{
+    if (!tiff) {
+        return TINYTIFF_FALSE;
+    }
+    if (!TinyTIFFWriter_disableAsyncWriting(tiff)) {
+        return TINYTIFF_FALSE;
+    }
+    if (bufferCount==0) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "TinyTIFFWriter_enableAsyncWriting() needs at least one frame buffer\0");
+        return TINYTIFF_FALSE;
+    }
+    TinyTIFFWriterAsync* async=(TinyTIFFWriterAsync*)calloc(1, sizeof(TinyTIFFWriterAsync));
+    if (!async) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory\0");
+        return TINYTIFF_FALSE;
+    }
+    async->bufferCount=bufferCount;
+    async->frameSize=(size_t)tiff->width*(size_t)tiff->height*(size_t)tiff->samples*(size_t)(tiff->bitspersample/8);
+    async->buffers=(uint8_t**)calloc(bufferCount, sizeof(uint8_t*));
+    async->inputOrganisation=(enum TinyTIFFSampleLayout*)calloc(bufferCount, sizeof(enum TinyTIFFSampleLayout));
+    async->outputOrganization=(enum TinyTIFFSampleLayout*)calloc(bufferCount, sizeof(enum TinyTIFFSampleLayout));
+    int ok=(async->buffers && async->inputOrganisation && async->outputOrganization);
+    uint32_t i;
+    for (i=0; ok && i<bufferCount; i++) {
+        async->buffers[i]=(uint8_t*)malloc(async->frameSize);
+        if (!async->buffers[i]) ok=TINYTIFF_FALSE;
+    }
+    if (!ok) {
+        TinyTIFFWriter_freeAsync(async);
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "unable to allocate memory for the asynchronous frame buffers\0");
+        return TINYTIFF_FALSE;
+    }
+    TinyTIFF_Mutex_init(&async->mutex);
+    TinyTIFF_Cond_init(&async->frameQueued);
+    TinyTIFF_Cond_init(&async->frameWritten);
+    tiff->async=async;
+    if (!TinyTIFF_Thread_create(&async->thread, TinyTIFFWriter_asyncThread, tiff)) {
+        tiff->async=NULL;
+        TinyTIFF_Cond_destroy(&async->frameWritten);
+        TinyTIFF_Cond_destroy(&async->frameQueued);
+        TinyTIFF_Mutex_destroy(&async->mutex);
+        TinyTIFFWriter_freeAsync(async);
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "unable to start the asynchronous I/O thread\0");
+        return TINYTIFF_FALSE;
+    }
+    return TINYTIFF_TRUE;
+}
+
+int TinyTIFFWriter_disableAsyncWriting(TinyTIFFWriterFile* tiff)
+{
+    if (!tiff) {
+        return TINYTIFF_FALSE;
+    }
+    TinyTIFFWriterAsync* async=tiff->async;
+    if (!async) {
+        return TINYTIFF_TRUE;
+    }
+    TinyTIFF_Mutex_lock(&async->mutex);
+    async->stop=TINYTIFF_TRUE;
+    TinyTIFF_Cond_broadcast(&async->frameQueued);
+    TinyTIFF_Mutex_unlock(&async->mutex);
+    TinyTIFF_Thread_join(async->thread);
+    const int ok=TinyTIFFWriter_takeAsyncError(tiff, async);
+    tiff->async=NULL;
+    TinyTIFF_Cond_destroy(&async->frameWritten);
+    TinyTIFF_Cond_destroy(&async->frameQueued);
+    TinyTIFF_Mutex_destroy(&async->mutex);
+    TinyTIFFWriter_freeAsync(async);
+    return ok;
+}
+
+int TinyTIFFWriter_writeImageMultiSampleAsync(TinyTIFFWriterFile *tiff, const void *data, enum TinyTIFFSampleLayout inputOrganisation, enum TinyTIFFSampleLayout outputOrganization)
+{
+    if (!tiff) {
+        return TINYTIFF_FALSE;
+    }
+    TinyTIFFWriterAsync* async=tiff->async;
+    if (!async) {
+        return TinyTIFFWriter_writeImageMultiSample___internl(tiff, data, inputOrganisation, outputOrganization);
+    }
+    if (!data) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "no image data given to TinyTIFFWriter_writeImageMultiSampleAsync()\0");
+        return TINYTIFF_FALSE;
+    }
+    TinyTIFF_Mutex_lock(&async->mutex);
+    if (!TinyTIFFWriter_takeAsyncError(tiff, async)) {
+        TinyTIFF_Mutex_unlock(&async->mutex);
+        return TINYTIFF_FALSE;
+    }
+    if (async->queued>=async->bufferCount) {
+        async->overruns++;
+        TinyTIFF_Mutex_unlock(&async->mutex);
+        return TINYTIFF_FALSE;
+    }
+    const uint32_t slot=async->head;
+    TinyTIFF_Mutex_unlock(&async->mutex);
+
+    // the free slot is owned by the (single) calling thread, until it is queued below
+    memcpy(async->buffers[slot], data, async->frameSize);
+    async->inputOrganisation[slot]=inputOrganisation;
+    async->outputOrganization[slot]=outputOrganization;
+
+    TinyTIFF_Mutex_lock(&async->mutex);
+    async->head=(slot+1)%async->bufferCount;
+    async->queued++;
+    TinyTIFF_Cond_broadcast(&async->frameQueued);
+    TinyTIFF_Mutex_unlock(&async->mutex);
+    return TINYTIFF_TRUE;
+}
+
+int TinyTIFFWriter_writeImageAsync(TinyTIFFWriterFile *tiff, const void *data)
+{
+    return TinyTIFFWriter_writeImageMultiSampleAsync(tiff, data, TinyTIFF_Interleaved, TinyTIFF_Interleaved);
+}
+
+int TinyTIFFWriter_flushAsync(TinyTIFFWriterFile *tiff)
+{
+    if (!tiff) {
+        return TINYTIFF_FALSE;
+    }
+    TinyTIFFWriterAsync* async=tiff->async;
+    if (!async) {
+        return TinyTIFFWriter_waitForPendingWrite(tiff) && !tiff->wasError;
+    }
+    TinyTIFF_Mutex_lock(&async->mutex);
+    while (async->queued>0) {
+        TinyTIFF_Cond_wait(&async->frameWritten, &async->mutex);
+    }
+    const int ok=TinyTIFFWriter_takeAsyncError(tiff, async);
+    TinyTIFF_Mutex_unlock(&async->mutex);
+    // the I/O thread is idle now, so the data of its last frame can be awaited here
+    return TinyTIFFWriter_waitForPendingWrite(tiff) && ok;
+}
+
+uint32_t TinyTIFFWriter_getAsyncQueueDepth(TinyTIFFWriterFile *tiff)
+{
+    if (!tiff || !tiff->async) {
+        return 0;
+    }
+    TinyTIFF_Mutex_lock(&tiff->async->mutex);
+    const uint32_t queued=tiff->async->queued;
+    TinyTIFF_Mutex_unlock(&tiff->async->mutex);
+    return queued;
+}
+
+uint64_t TinyTIFFWriter_getAsyncOverruns(TinyTIFFWriterFile *tiff)
+{
+    if (!tiff || !tiff->async) {
+        return 0;
+    }
+    TinyTIFF_Mutex_lock(&tiff->async->mutex);
+    const uint64_t overruns=tiff->async->overruns;
+    TinyTIFF_Mutex_unlock(&tiff->async->mutex);
+    return overruns;
+}
+
 int TinyTIFFWriter_writeImagePlanarReorder(TinyTIFFWriterFile* tiff, const void* data)
 {
     return TinyTIFFWriter_writeImageMultiSample(tiff, data, TinyTIFF_Interleaved, TinyTIFF_Separate);
@@ -1044,6 +2386,161 @@ int TinyTIFFWriter_writeImage(TinyTIFFWriterFile *tiff, const void *data)
     return TinyTIFFWriter_writeImageMultiSample(tiff, data, TinyTIFF_Interleaved, TinyTIFF_Interleaved);
 }
 
+int TinyTIFFWriter_setRowsPerStrip(TinyTIFFWriterFile *tiff, uint32_t rowsPerStrip)
+{
+    if (!tiff) {
+        return TINYTIFF_FALSE;
+    }
+    // queued frames have to be written with the setting that was active, when they were queued
+    if (tiff->async && !TinyTIFFWriter_flushAsync(tiff)) {
+        return TINYTIFF_FALSE;
+    }
+    tiff->rowsPerStrip=rowsPerStrip;
+    return TINYTIFF_TRUE;
+}
+
+int TinyTIFFWriter_setCompression(TinyTIFFWriterFile *tiff, enum TinyTIFFWriterCompression compression)
+{
+    if (!tiff) {
+        return TINYTIFF_FALSE;
+    }
+    // queued frames have to be written with the setting that was active, when they were queued
+    if (tiff->async && !TinyTIFFWriter_flushAsync(tiff)) {
+        return TINYTIFF_FALSE;
+    }
+    switch(compression) {
+        case TinyTIFFWriter_NoCompression: tiff->compression=TIFF_COMPRESSION_NONE; tiff->predictor=TIFF_PREDICTOR_NONE; break;
+        case TinyTIFFWriter_PackBits: tiff->compression=TIFF_COMPRESSION_PACKBITS; tiff->predictor=TIFF_PREDICTOR_NONE; break;
+        case TinyTIFFWriter_LZW: tiff->compression=TIFF_COMPRESSION_LZW; tiff->predictor=TIFF_PREDICTOR_NONE; break;
+        case TinyTIFFWriter_LZWPredictor: tiff->compression=TIFF_COMPRESSION_LZW; tiff->predictor=TIFF_PREDICTOR_HORIZONTAL; break;
+#ifdef TINYTIFF_HAVE_DEFLATE
+        case TinyTIFFWriter_Deflate: tiff->compression=TIFF_COMPRESSION_ADOBE_DEFLATE; tiff->predictor=TIFF_PREDICTOR_NONE; break;
+        case TinyTIFFWriter_DeflatePredictor: tiff->compression=TIFF_COMPRESSION_ADOBE_DEFLATE; tiff->predictor=TIFF_PREDICTOR_HORIZONTAL; break;
+#endif
+        default:
+            tiff->wasError=TINYTIFF_TRUE;
+            TINYTIFF_SET_LAST_ERROR(tiff, "the requested compression is not supported (Deflate has to be enabled with the CMake option TinyTIFF_USE_DEFLATE)\0");
+            return TINYTIFF_FALSE;
+    }
+    return TINYTIFF_TRUE;
+}
+
+int TinyTIFFWriter_isCompressionAvailable(enum TinyTIFFWriterCompression compression)
+{
+    switch(compression) {
+        case TinyTIFFWriter_NoCompression:
+        case TinyTIFFWriter_PackBits:
+        case TinyTIFFWriter_LZW:
+        case TinyTIFFWriter_LZWPredictor:
+            return TINYTIFF_TRUE;
+#ifdef TINYTIFF_HAVE_DEFLATE
+        case TinyTIFFWriter_Deflate:
+        case TinyTIFFWriter_DeflatePredictor:
+            return TINYTIFF_TRUE;
+#endif
+        default:
+            return TINYTIFF_FALSE;
+    }
+}
+
+int TinyTIFFWriter_setCompressionLevel(TinyTIFFWriterFile *tiff, int level)
+{
+    if (!tiff) {
+        return TINYTIFF_FALSE;
+    }
+    // queued frames have to be written with the setting that was active, when they were queued
+    if (tiff->async && !TinyTIFFWriter_flushAsync(tiff)) {
+        return TINYTIFF_FALSE;
+    }
+    tiff->compressionLevel=(level<=0)?TINYTIFF_DEFAULT_COMPRESSION_LEVEL:level;
+    return TINYTIFF_TRUE;
+}
+
+int TinyTIFFWriter_setCompressionThreads(TinyTIFFWriterFile *tiff, uint32_t threads)
+{
+    if (!tiff) {
+        return TINYTIFF_FALSE;
+    }
+    // queued frames have to be written with the setting that was active, when they were queued
+    if (tiff->async && !TinyTIFFWriter_flushAsync(tiff)) {
+        return TINYTIFF_FALSE;
+    }
+    // the pool is started again with the new number of threads by the next compressed frame
+    const int ok=TinyTIFFWriter_stopCompressionPool(tiff);
+    tiff->compressionThreads=threads;
+    return ok;
+}
+
+int TinyTIFFWriter_setTileSize(TinyTIFFWriterFile *tiff, uint32_t tileWidth, uint32_t tileLength)
+{
+    if (!tiff) {
+        return TINYTIFF_FALSE;
+    }
+    // queued frames have to be written with the setting that was active, when they were queued
+    if (tiff->async && !TinyTIFFWriter_flushAsync(tiff)) {
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->tilesWritten>0) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "the current frame is incomplete, write its remaining tiles with TinyTIFFWriter_writeTile() first\0");
+        return TINYTIFF_FALSE;
+    }
+    if ((tileWidth==0)!=(tileLength==0) || tileWidth%16!=0 || tileLength%16!=0) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "the tile width and length have to be multiples of 16 (or both 0 to disable tiling)\0");
+        return TINYTIFF_FALSE;
+    }
+    tiff->tileWidth=tileWidth;
+    tiff->tileLength=tileLength;
+    return TINYTIFF_TRUE;
+}
+
+int TinyTIFFWriter_writeTile(TinyTIFFWriterFile *tiff, const void *data, enum TinyTIFFSampleLayout outputOrganization)
+{
+    if (!tiff) {
+        return TINYTIFF_FALSE;
+    }
+    if (!data) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "no data provided to TinyTIFFWriter_writeTile()\0");
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->tileWidth==0) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "tiled writing is not enabled, call TinyTIFFWriter_setTileSize() first\0");
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->async && !TinyTIFFWriter_flushAsync(tiff)) {
+        return TINYTIFF_FALSE;
+    }
+    if (!TinyTIFFWriter_waitForPendingWrite(tiff)) {
+        return TINYTIFF_FALSE;
+    }
+    if (tiff->tilesWritten==0) {
+        // the first tile of a frame: all tiles have the same size, so the complete IFD is known in advance
+        if (!TinyTIFFWriter_writeFrameIFD(tiff, outputOrganization, NULL)) {
+            return TINYTIFF_FALSE;
+        }
+        tiff->tileOrganization=outputOrganization;
+    } else if (outputOrganization!=tiff->tileOrganization) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "all tiles of a frame have to be written with the same sample organization\0");
+        return TINYTIFF_FALSE;
+    }
+    const size_t tilesize=(size_t)TinyTIFFWriter_getTileSize(tiff, outputOrganization);
+    if (TinyTIFFWriter_fwrite(data, 1, tilesize, tiff)!=tilesize) {
+        tiff->wasError=TINYTIFF_TRUE;
+        TINYTIFF_SET_LAST_ERROR(tiff, "unable to write the image data\0");
+        return TINYTIFF_FALSE;
+    }
+    tiff->tilesWritten++;
+    if (tiff->tilesWritten>=TinyTIFFWriter_getSegmentCount(tiff, outputOrganization)) {
+        tiff->tilesWritten=0;
+        tiff->frames=tiff->frames+1;
+    }
+    return TINYTIFF_TRUE;
+}
+
 void TinyTIFFWriter_close(TinyTIFFWriterFile *tiff)
 {
     TinyTIFFWriter_close_withdescription(tiff, NULL);
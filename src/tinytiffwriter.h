@@ -114,6 +114,30 @@ extern "C" {
         TinyTIFFWriter_Float /*!< floating point images */
     };
 
+    /** \brief allows to specify in TinyTIFFWriter_open_withformat() the format of the file to write
+     *  \ingroup tinytiffwriter_C
+     *
+     *  \see TinyTIFFWriter_open_withformat()
+     */
+    enum TinyTIFFWriterFileFormat {
+        TinyTIFFWriter_TIFF, /*!< classic TIFF with 32-bit file offsets, i.e. files are limited to 4GB (the default) */
+        TinyTIFFWriter_BigTIFF /*!< BigTIFF with 64-bit file offsets, which lifts the 4GB limit of classic TIFF */
+    };
+
+    /** \brief allows to specify in TinyTIFFWriter_setCompression() how the strips of the following frames are compressed
+     *  \ingroup tinytiffwriter_C
+     *
+     *  \see TinyTIFFWriter_setCompression()
+     */
+    enum TinyTIFFWriterCompression {
+        TinyTIFFWriter_NoCompression, /*!< the image data is stored uncompressed (the default) */
+        TinyTIFFWriter_PackBits, /*!< PackBits run-length encoding (TIFF compression 32773), very fast and effective for images with large uniform areas, e.g. masks or label images */
+        TinyTIFFWriter_LZW, /*!< LZW compression (TIFF compression 5) */
+        TinyTIFFWriter_LZWPredictor, /*!< LZW compression (TIFF compression 5) of the horizontal differences between neighbouring pixels (Predictor=2), which usually compresses smooth (e.g. 16-bit microscopy) images much better than plain LZW */
+        TinyTIFFWriter_Deflate, /*!< Deflate compression (TIFF compression 8, Adobe ZIP), usually smaller than LZW, the speed depends on TinyTIFFWriter_setCompressionLevel(). Only available, if the library was built with the CMake option TinyTIFF_USE_DEFLATE, see TinyTIFFWriter_isCompressionAvailable() */
+        TinyTIFFWriter_DeflatePredictor /*!< Deflate compression (TIFF compression 8, Adobe ZIP) of the horizontal differences between neighbouring pixels (Predictor=2). Only available, if the library was built with the CMake option TinyTIFF_USE_DEFLATE, see TinyTIFFWriter_isCompressionAvailable() */
+    };
+
     /*! \brief create a new TIFF file
         \ingroup tinytiffwriter_C
 
@@ -136,6 +160,28 @@ extern "C" {
       */
     TINYTIFF_EXPORT TinyTIFFWriterFile* TinyTIFFWriter_open(const char* filename, uint16_t bitsPerSample, enum TinyTIFFWriterSampleFormat sampleFormat, uint16_t samples, uint32_t width, uint32_t height, enum TinyTIFFWriterSampleInterpretation sampleInterpretation);
 
+    /*! \brief create a new TIFF file in the given file format (TIFF or BigTIFF)
+        \ingroup tinytiffwriter_C
+
+        This function works like TinyTIFFWriter_open(), but in addition allows to select the file format. If \a fileFormat is
+        TinyTIFFWriter_BigTIFF, a BigTIFF file (magic number 43, 64-bit offsets, 20-byte IFD entries, LONG8 strip offsets)
+        is written, which is not limited to 4GB. This allows to write very long recordings into a single file.
+
+        \param filename name of the new TIFF file
+        \param bitsPerSample bits used to save each sample of the images
+        \param sampleFormat data type of data in image pixels
+        \param samples number of samples in each frame, see TinyTIFFWriter_open()
+        \param width width of the images in pixels
+        \param height height of the images in pixels
+        \param sampleInterpretation how to interpret the samples in each frame, see TinyTIFFWriter_open()
+        \param fileFormat format of the file to write
+        \return a new TinyTIFFWriterFile pointer on success, or NULL on errors
+
+        \see TinyTIFFWriter_open(), TinyTIFFWriterFileFormat
+
+      */
+    TINYTIFF_EXPORT TinyTIFFWriterFile* TinyTIFFWriter_open_withformat(const char* filename, uint16_t bitsPerSample, enum TinyTIFFWriterSampleFormat sampleFormat, uint16_t samples, uint32_t width, uint32_t height, enum TinyTIFFWriterSampleInterpretation sampleInterpretation, enum TinyTIFFWriterFileFormat fileFormat);
+
 
 
     /** \brief write a new image to the give TIFF file. the image ist stored in separate planes or planar configuration, dependeing on \a outputOrganization and
@@ -146,6 +192,8 @@ extern "C" {
      *        time and memory! This can be seen in the following image comparing the performance of non-reordered writing (left)
      *        and writing with reordering
      *        \image html tinytiffwriter_performance_rgb.png
+     *        The data is reordered and written in blocks, so the additional memory is limited to a scratch buffer of at most 1MB per file,
+     *        independent of the frame size.
      *
      *  \param tiff TIFF file to write to
      *  \param data points to the image in row-major ordering with the right bit-depth,
@@ -229,6 +277,201 @@ extern "C" {
     */
     TINYTIFF_EXPORT int TinyTIFFWriter_writeImage(TinyTIFFWriterFile* tiff, const void* data);
 
+    /*! \brief set the number of image rows per strip (TIFF tag RowsPerStrip) for all frames that are written afterwards
+        \ingroup tinytiffwriter_C
+
+        By default every frame (or every sample plane for TinyTIFF_Separate) is stored as a single strip. Splitting the
+        frames into strips of \a rowsPerStrip rows does not change the order of the image data in the file, but a reader
+        that only needs a part of a frame (e.g. a band of rows) can locate and read only the strips it needs.
+        The last strip of each frame/plane may contain less than \a rowsPerStrip rows.
+
+        \param tiff TIFF file to write to
+        \param rowsPerStrip number of image rows per strip. 0 (or any value >= the image height) stores each frame/plane as a single strip.
+        \return TINYTIFF_TRUE on success and TINYTIFF_FALSE on failure.
+
+        \note Every strip adds an entry to the StripOffsets and StripByteCounts arrays in the frame header, so very small values
+              increase the size of the file. In asynchronous mode (see TinyTIFFWriter_enableAsyncWriting()) all queued frames
+              are written with the previous setting, before the new value is applied.
+    */
+    TINYTIFF_EXPORT int TinyTIFFWriter_setRowsPerStrip(TinyTIFFWriterFile* tiff, uint32_t rowsPerStrip);
+
+    /*! \brief set the compression scheme for all frames that are written afterwards
+        \ingroup tinytiffwriter_C
+
+        Each strip (see TinyTIFFWriter_setRowsPerStrip()) is compressed separately, so readers can still access single strips.
+        As the size of the compressed strips is only known after compression, each frame is compressed completely in memory,
+        before it is written into the file.
+        For TinyTIFFWriter_LZWPredictor and TinyTIFFWriter_DeflatePredictor the horizontal differences are taken on a copy of each strip, the input data is not modified.
+
+        \param tiff TIFF file to write to
+        \param compression the compression scheme
+        \return TINYTIFF_TRUE on success and TINYTIFF_FALSE on failure.
+                An error description can be obtained by calling TinyTIFFWriter_getLastError().
+
+        \note Compression is only supported for stripped frames, writing a frame fails, if tiling is enabled with TinyTIFFWriter_setTileSize().
+              In asynchronous mode (see TinyTIFFWriter_enableAsyncWriting()) all queued frames are written with the previous setting,
+              before the new value is applied.
+    */
+    TINYTIFF_EXPORT int TinyTIFFWriter_setCompression(TinyTIFFWriterFile* tiff, enum TinyTIFFWriterCompression compression);
+
+    /*! \brief returns TINYTIFF_TRUE, if the compression scheme \a compression can be used with TinyTIFFWriter_setCompression() in this build of the library
+        \ingroup tinytiffwriter_C
+
+        TinyTIFFWriter_Deflate and TinyTIFFWriter_DeflatePredictor are only available, if the library was built with the CMake option TinyTIFF_USE_DEFLATE
+        (using libdeflate or zlib).
+    */
+    TINYTIFF_EXPORT int TinyTIFFWriter_isCompressionAvailable(enum TinyTIFFWriterCompression compression);
+
+    /*! \brief set the compression level for all frames that are written afterwards with TinyTIFFWriter_Deflate or TinyTIFFWriter_DeflatePredictor
+        \ingroup tinytiffwriter_C
+
+        \param tiff TIFF file to write to
+        \param level compression level from 1 (fastest) to 9 (smallest files). If the library uses libdeflate, levels up to 12 are supported,
+                     otherwise larger values are treated as 9. 0 or negative values select the default level 6.
+        \return TINYTIFF_TRUE on success and TINYTIFF_FALSE on failure.
+
+        \note In asynchronous mode (see TinyTIFFWriter_enableAsyncWriting()) all queued frames are written with the previous setting,
+              before the new value is applied.
+    */
+    TINYTIFF_EXPORT int TinyTIFFWriter_setCompressionLevel(TinyTIFFWriterFile* tiff, int level);
+
+    /*! \brief set the number of threads, which compress the strips of the frames that are written afterwards (see TinyTIFFWriter_setCompression())
+        \ingroup tinytiffwriter_C
+
+        With more than one thread, the strips of each frame (see TinyTIFFWriter_setRowsPerStrip()) are compressed in parallel by a pool of
+        worker threads and the thread writing the frame. The compressed data of a frame is then written into the file by one of the workers,
+        while the next frame is already compressed. The file is identical to the one written with a single thread.
+
+        \param tiff TIFF file to write to
+        \param threads number of threads, including the writing thread: 1 (the default) compresses in the writing thread only,
+                       0 uses one thread per processor. Parallel compression needs several strips per frame.
+        \return TINYTIFF_TRUE on success and TINYTIFF_FALSE on failure, e.g. if the data of the last frame could not be written.
+                An error description can be obtained by calling TinyTIFFWriter_getLastError().
+
+        \note As the data of a frame is written in the background, an I/O error is reported by the next call that writes into the file,
+              or by TinyTIFFWriter_flushAsync(). Each thread needs a buffer for one uncompressed strip, and the frame is compressed into
+              two alternating buffers of the maximum size of a compressed frame.
+              In asynchronous mode (see TinyTIFFWriter_enableAsyncWriting()) all queued frames are written with the previous setting,
+              before the new value is applied.
+    */
+    TINYTIFF_EXPORT int TinyTIFFWriter_setCompressionThreads(TinyTIFFWriterFile* tiff, uint32_t threads);
+
+    /*! \brief switch the TIFF file to tiled output: all frames that are written afterwards are stored as tiles of \a tileWidth x \a tileLength pixels
+        \ingroup tinytiffwriter_C
+
+        In a tiled TIFF a reader can access a rectangular region of a large frame by reading only the tiles that overlap it, instead of
+        whole rows of the frame. Frames can be written as a whole with the usual functions (e.g. TinyTIFFWriter_writeImage() or
+        TinyTIFFWriter_writeImageMultiSample()), which cut them into tiles, or tile by tile with TinyTIFFWriter_writeTile().
+
+        The tiles are stored row by row (and sample plane by sample plane for TinyTIFF_Separate), so the file is always written sequentially.
+        Tiles at the right and bottom border of a frame are padded with zeros.
+
+        \param tiff TIFF file to write to
+        \param tileWidth width of the tiles in pixels, has to be a multiple of 16
+        \param tileLength length (height) of the tiles in pixels, has to be a multiple of 16
+        \return TINYTIFF_TRUE on success and TINYTIFF_FALSE on failure.
+                An error description can be obtained by calling TinyTIFFWriter_getLastError().
+
+        \note Passing 0 for both \a tileWidth and \a tileLength switches back to stripped output. While tiling is enabled,
+              TinyTIFFWriter_setRowsPerStrip() has no effect.
+    */
+    TINYTIFF_EXPORT int TinyTIFFWriter_setTileSize(TinyTIFFWriterFile* tiff, uint32_t tileWidth, uint32_t tileLength);
+
+    /*! \brief write the next tile of a frame (tiled output has to be enabled with TinyTIFFWriter_setTileSize())
+        \ingroup tinytiffwriter_C
+
+        The tiles have to be written in the order in which they are stored in the file: row by row from the top-left tile,
+        and for \a outputOrganization == TinyTIFF_Separate the tiles of sample 0 first, then the tiles of sample 1, ...
+        A new frame is started with the first tile and completed automatically, when its last tile has been written.
+
+        \param tiff TIFF file to write to
+        \param data the tile data: tileWidth*tileLength pixels in row-major ordering, i.e. including the padding of tiles at the right and bottom
+                    border of the frame. For TinyTIFF_Interleaved each pixel contains all samples (\c R1G1B1|R2G2B2|...), for TinyTIFF_Separate
+                    the tile contains a single sample.
+        \param outputOrganization data format of the image data in the generated TIFF file, has to be the same for all tiles of a frame
+        \return TINYTIFF_TRUE on success and TINYTIFF_FALSE on failure.
+                An error description can be obtained by calling TinyTIFFWriter_getLastError().
+
+        \note If the file is closed before all tiles of a frame were written, the remaining tiles are filled with zeros.
+    */
+    TINYTIFF_EXPORT int TinyTIFFWriter_writeTile(TinyTIFFWriterFile* tiff, const void* data, enum TinyTIFFSampleLayout outputOrganization);
+
+    /*! \brief switch the TIFF file into asynchronous writing mode: frames are copied into a ring of \a bufferCount frame buffers
+               and written into the file by a background I/O thread
+        \ingroup tinytiffwriter_C
+
+        In this mode TinyTIFFWriter_writeImageAsync() and TinyTIFFWriter_writeImageMultiSampleAsync() only copy the frame
+        into a free buffer and return immediately, so short stalls of the storage do not block the calling (e.g. acquisition) thread,
+        as long as they are covered by the ring. If the ring is full, the frame is rejected and counted as an overrun
+        (see TinyTIFFWriter_getAsyncOverruns()).
+
+        The frames are written in the order they were queued. TinyTIFFWriter_flushAsync() waits until all queued frames are written,
+        TinyTIFFWriter_close() (and its variants) drain the queue before finishing the file.
+        An error of the I/O thread is reported by the next call of TinyTIFFWriter_writeImageMultiSampleAsync(), TinyTIFFWriter_flushAsync()
+        or TinyTIFFWriter_disableAsyncWriting(), which also make its description available through TinyTIFFWriter_getLastError().
+
+        \param tiff TIFF file to write to
+        \param bufferCount number of frame buffers in the ring (each of size width*height*samples*bitsPerSample/8 bytes)
+        \return TINYTIFF_TRUE on success and TINYTIFF_FALSE on failure.
+                An error description can be obtained by calling TinyTIFFWriter_getLastError().
+
+        \note The asynchronous functions have to be called from a single thread. Synchronous writes (e.g. TinyTIFFWriter_writeImage())
+              are still allowed in this mode, they first wait until all queued frames are written.
+    */
+    TINYTIFF_EXPORT int TinyTIFFWriter_enableAsyncWriting(TinyTIFFWriterFile* tiff, uint32_t bufferCount);
+
+    /*! \brief write all queued frames, stop the background I/O thread and release the frame buffers,
+               i.e. switch back to synchronous writing (see TinyTIFFWriter_enableAsyncWriting())
+        \ingroup tinytiffwriter_C
+
+        \param tiff TIFF file to write to
+        \return TINYTIFF_FALSE, if writing one of the queued frames failed, TINYTIFF_TRUE otherwise
+    */
+    TINYTIFF_EXPORT int TinyTIFFWriter_disableAsyncWriting(TinyTIFFWriterFile* tiff);
+
+    /*! \brief queue a new image for writing by the background I/O thread, see TinyTIFFWriter_writeImageMultiSample() for the parameters
+        \ingroup tinytiffwriter_C
+
+        The frame is copied into a free buffer of the ring, so \a data may be reused as soon as this function returns.
+        If asynchronous writing is not enabled (TinyTIFFWriter_enableAsyncWriting()), the frame is written synchronously.
+
+        \return TINYTIFF_TRUE if the frame was queued. TINYTIFF_FALSE if the ring was full (the frame is dropped and counted
+                by TinyTIFFWriter_getAsyncOverruns()) or if writing a previously queued frame failed.
+    */
+    TINYTIFF_EXPORT int TinyTIFFWriter_writeImageMultiSampleAsync(TinyTIFFWriterFile* tiff, const void* data, enum TinyTIFFSampleLayout inputOrganisation, enum TinyTIFFSampleLayout outputOrganization);
+
+    /*! \brief queue a new image for writing by the background I/O thread, equivalent to
+               <code>TinyTIFFWriter_writeImageMultiSampleAsync(tiff, data, TinyTIFF_Interleaved, TinyTIFF_Interleaved)</code>
+        \ingroup tinytiffwriter_C
+
+        \see TinyTIFFWriter_writeImageMultiSampleAsync(), TinyTIFFWriter_writeImage()
+    */
+    TINYTIFF_EXPORT int TinyTIFFWriter_writeImageAsync(TinyTIFFWriterFile* tiff, const void* data);
+
+    /*! \brief wait until all frames queued with TinyTIFFWriter_writeImageAsync() have been written into the file
+        \ingroup tinytiffwriter_C
+
+        This also waits for the data of a compressed frame, which is still written by the compression threads (see TinyTIFFWriter_setCompressionThreads()).
+
+        \param tiff TIFF file to write to
+        \return TINYTIFF_FALSE, if writing one of the queued frames failed, TINYTIFF_TRUE otherwise
+    */
+    TINYTIFF_EXPORT int TinyTIFFWriter_flushAsync(TinyTIFFWriterFile* tiff);
+
+    /*! \brief returns the number of frames, which are queued, but not yet completely written into the file
+        \ingroup tinytiffwriter_C
+
+        \param tiff TIFF file to write to
+    */
+    TINYTIFF_EXPORT uint32_t TinyTIFFWriter_getAsyncQueueDepth(TinyTIFFWriterFile* tiff);
+
+    /*! \brief returns the number of frames, which were rejected by TinyTIFFWriter_writeImageAsync(), because the ring of frame buffers was full
+        \ingroup tinytiffwriter_C
+
+        \param tiff TIFF file to write to
+    */
+    TINYTIFF_EXPORT uint64_t TinyTIFFWriter_getAsyncOverruns(TinyTIFFWriterFile* tiff);
+
     /*! \brief close a given TIFF file
         \ingroup tinytiffwriter_C
 
@@ -2,9 +2,11 @@
 #include <tiffio.h>
 #include "libtiff_tools.h"
 #endif
+#include <algorithm>
 #include <array>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <string>
 #include <stdio.h>
 #include <stdlib.h>
@@ -35,6 +37,7 @@
 #include <stdexcept>
 #include <cctype>
 #include <array>
+#include <thread>
 #include "tinytiff_tools.hxx"
 
 
@@ -166,13 +169,13 @@ void SAVE_TIFF(const std::string& filename, const TDATA* data, size_t width, siz
 
 // save data (size=width*height*sizeof(TDATA)) into a file \a filename
 template<class TDATA>
-void SAVE_TIFF_libtiff(const std::string& filename, const TDATA* data, size_t width, size_t height, bool little_endian=true) {
+void SAVE_TIFF_libtiff(const std::string& filename, const TDATA* data, size_t width, size_t height, bool little_endian=true, bool bigtiff=false) {
 #ifdef TINYTIFF_TEST_LIBTIFF
     TIFF* tifvideo;
     if (little_endian) {
-        tifvideo=TIFFOpen(filename.c_str(), "wl");
+        tifvideo=TIFFOpen(filename.c_str(), bigtiff?"wl8":"wl");
     } else {
-        tifvideo=TIFFOpen(filename.c_str(), "wb");
+        tifvideo=TIFFOpen(filename.c_str(), bigtiff?"wb8":"wb");
     }
     if (tifvideo) {
         TIFFWrite<TDATA>(tifvideo, data, width, height);
@@ -183,6 +186,97 @@ void SAVE_TIFF_libtiff(const std::string& filename, const TDATA* data, size_t wi
 }
 
 
+// compress \a in with the LZW scheme of the TIFF specification (codes of 9-12 bits, MSB-first, early code width change)
+static std::vector<uint8_t> LZW_ENCODE(const std::vector<uint8_t>& in) {
+    std::vector<uint8_t> res;
+    std::map<std::pair<int, uint8_t>, int> table;
+    uint32_t bitbuf=0;
+    int bitcount=0, width=9, next=258, w=-1;
+    auto emit=[&](int code) {
+        bitbuf=(bitbuf<<width)|static_cast<uint32_t>(code);
+        bitcount+=width;
+        while (bitcount>=8) { res.push_back(static_cast<uint8_t>(bitbuf>>(bitcount-8))); bitcount-=8; }
+    };
+    emit(256);
+    for (uint8_t c: in) {
+        if (w<0) { w=c; continue; }
+        auto it=table.find(std::make_pair(w, c));
+        if (it!=table.end()) { w=it->second; continue; }
+        emit(w);
+        table[std::make_pair(w, c)]=next++;
+        if (next==4094) { emit(256); table.clear(); next=258; width=9; }
+        else if (next==(1<<width)) width++;
+        w=c;
+    }
+    if (w>=0) emit(w);
+    emit(257);
+    if (bitcount>0) res.push_back(static_cast<uint8_t>(bitbuf<<(8-bitcount)));
+    return res;
+}
+
+// save \a frames frames (alternating \a data and \a datai, each of size=width*height*samples*sizeof(TDATA), chunky) of unsigned integers
+// into a big-endian (Motorola byte order) file \a filename with \a rowsperstrip rows per strip. This does not need libtiff, as TinyTIFFWriter
+// only writes little-endian files. If \a lzw is set, the strips are LZW compressed, optionally after horizontal differencing (\a predictor ).
+template<class TDATA>
+void SAVE_TIFF_bigendian(const std::string& filename, const TDATA* data, const TDATA* datai, size_t width, size_t height, size_t samples, size_t frames, size_t rowsperstrip, bool lzw=false, bool predictor=false) {
+    std::vector<uint8_t> out{'M', 'M', 0, 42};
+    auto put=[&out](uint64_t v, size_t bytes) { for (size_t b=0; b<bytes; b++) out.push_back(static_cast<uint8_t>(v>>(8*(bytes-1-b)))); };
+    auto putEntry=[&put](uint16_t tag, uint16_t type, uint32_t count, uint32_t value) {
+        put(tag, 2); put(type, 2); put(count, 4);
+        if (type==3 && count==1) { put(value, 2); put(0, 2); }
+        else put(value, 4);
+    };
+    const size_t strips=(height+rowsperstrip-1)/rowsperstrip;
+    const uint32_t bits=sizeof(TDATA)*8;
+    size_t nextifd_pos=out.size();
+    put(0, 4);
+    for (size_t f=0; f<frames; f++) {
+        const TDATA* img=(f%2==0)?data:datai;
+        std::vector<uint32_t> offsets, counts;
+        for (size_t s=0; s<strips; s++) {
+            const size_t rows=std::min(rowsperstrip, height-s*rowsperstrip);
+            const size_t start=out.size();
+            offsets.push_back(static_cast<uint32_t>(start));
+            for (size_t i=s*rowsperstrip*width*samples; i<(s*rowsperstrip+rows)*width*samples; i++) {
+                TDATA v=img[i];
+                if (predictor && (i%(width*samples))>=samples) v=static_cast<TDATA>(v-img[i-samples]);
+                put(static_cast<uint64_t>(v), sizeof(TDATA));
+            }
+            if (lzw) {
+                const std::vector<uint8_t> compressed=LZW_ENCODE(std::vector<uint8_t>(out.begin()+start, out.end()));
+                out.resize(start);
+                out.insert(out.end(), compressed.begin(), compressed.end());
+            }
+            counts.push_back(static_cast<uint32_t>(out.size()-start));
+        }
+        const uint32_t offsets_pos=static_cast<uint32_t>(out.size());
+        for (uint32_t o: offsets) put(o, 4);
+        const uint32_t counts_pos=static_cast<uint32_t>(out.size());
+        for (uint32_t c: counts) put(c, 4);
+        const uint32_t bits_pos=static_cast<uint32_t>(out.size());
+        for (size_t s=0; s<samples; s++) put(bits, 2);
+        for (size_t b=0; b<4; b++) out[nextifd_pos+b]=static_cast<uint8_t>(out.size()>>(8*(3-b)));
+        put(((samples>3)?11:10)+(predictor?1:0), 2);
+        putEntry(256, 4, 1, static_cast<uint32_t>(width));
+        putEntry(257, 4, 1, static_cast<uint32_t>(height));
+        if (samples==1) putEntry(258, 3, 1, bits);
+        else putEntry(258, 3, static_cast<uint32_t>(samples), bits_pos);
+        putEntry(259, 3, 1, lzw?5:1);
+        putEntry(262, 3, 1, (samples>=3)?2:1);
+        putEntry(273, 4, static_cast<uint32_t>(strips), (strips==1)?offsets[0]:offsets_pos);
+        putEntry(277, 3, 1, static_cast<uint32_t>(samples));
+        putEntry(278, 4, 1, static_cast<uint32_t>(rowsperstrip));
+        putEntry(279, 4, static_cast<uint32_t>(strips), (strips==1)?counts[0]:counts_pos);
+        putEntry(284, 3, 1, 1);
+        if (predictor) putEntry(317, 3, 1, 2);
+        if (samples>3) putEntry(338, 3, 1, 0);
+        nextifd_pos=out.size();
+        put(0, 4);
+    }
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+}
+
 // try to open a TIFF file with TInyTIFFReader, if read successfully, the read frames are stored using SAVE_TIFF,
 // does not check the contents for correctness!
 template<class TIMAGESAMPLETYPE>
@@ -241,16 +335,17 @@ void TEST_SIMPLE(const std::string& filename, std::vector<TestResult>& test_resu
 // try to read the data in the TIFF file \a filename with TinyTIFFReader, compare the read data to the data in image and imagei, the file is expected to contain either
 // a single frame of contents \a image, or a series of frames alternativ between image and imagei (i.e.  image,imagei,image,imagei,image,...)
 template<class TIMAGESAMPLETYPE>
-void TEST(const std::string& filename, const TIMAGESAMPLETYPE* image, const TIMAGESAMPLETYPE* imagei,size_t WIDTH_IN, size_t HEIGHT_IN, size_t SAMPLES_IN, size_t FRAMES_IN, std::vector<TestResult>& test_results) {
+void TEST(const std::string& filename, const TIMAGESAMPLETYPE* image, const TIMAGESAMPLETYPE* imagei,size_t WIDTH_IN, size_t HEIGHT_IN, size_t SAMPLES_IN, size_t FRAMES_IN, std::vector<TestResult>& test_results, bool memoryMapped=false) {
     HighResTimer timer, timer1;
     bool ok=false;
     std::cout<<"\n\nreading '"<<std::string(filename)<<"' and checking read contents ... filesize = "<<bytestostr(get_filesize(filename.c_str()))<<"\n";
     test_results.emplace_back();
-    const std::string desc=std::to_string(WIDTH_IN)+"x"+std::to_string(HEIGHT_IN)+"pix/"+std::to_string(sizeof(TIMAGESAMPLETYPE)*8)+"bit/"+std::to_string(SAMPLES_IN)+"ch/"+std::to_string(FRAMES_IN)+"frames";
+    std::string desc=std::to_string(WIDTH_IN)+"x"+std::to_string(HEIGHT_IN)+"pix/"+std::to_string(sizeof(TIMAGESAMPLETYPE)*8)+"bit/"+std::to_string(SAMPLES_IN)+"ch/"+std::to_string(FRAMES_IN)+"frames";
+    if (memoryMapped) desc+="/MMAP";
     test_results.back().name=std::string("TEST(")+desc+", "+std::string(filename)+std::string(")");
     test_results.back().success=ok=false;
     try {
-        TinyTIFFReaderFile* tiffr=TinyTIFFReader_open(filename.c_str());
+        TinyTIFFReaderFile* tiffr=(memoryMapped)?TinyTIFFReader_openMemoryMapped(filename.c_str()):TinyTIFFReader_open(filename.c_str());
         if (!tiffr) {
             TESTFAIL("reading (not existent, not accessible or no TIFF file)", test_results.back())
         } else {
@@ -269,6 +364,7 @@ void TEST(const std::string& filename, const TIMAGESAMPLETYPE* image, const TIMA
             timer.start();
             test_results.back().success=ok=true;
             uint32_t frame=0;
+            size_t zerocopy_samples=0;
             double duration_getdata=0, duration_nextframe=0;
             bool next;
             do {
@@ -280,19 +376,30 @@ void TEST(const std::string& filename, const TIMAGESAMPLETYPE* image, const TIMA
                 if (ok) {
                     for (size_t sample=0; sample<samples; sample++) {
                         TIMAGESAMPLETYPE* tmp=(TIMAGESAMPLETYPE*)calloc(width*height, TinyTIFFReader_getBitsPerSample(tiffr, sample)/8);
+                        const TIMAGESAMPLETYPE* data=tmp;
                         timer1.start();
-                        TinyTIFFReader_getSampleData(tiffr, tmp, sample);
+                        if (memoryMapped) {
+                            data=(const TIMAGESAMPLETYPE*)TinyTIFFReader_getSampleDataPointer(tiffr, tmp, width*height*sizeof(TIMAGESAMPLETYPE), sample);
+                            if (!data) {
+                                TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": TinyTIFFReader_getSampleDataPointer() returned NULL", test_results.back())
+                                data=tmp;
+                            } else if (data!=tmp) {
+                                zerocopy_samples++;
+                            }
+                        } else {
+                            TinyTIFFReader_getSampleData(tiffr, tmp, sample);
+                        }
                         duration_getdata+=timer1.get_time();
                         if (TinyTIFFReader_wasError(tiffr)) TESTFAIL(""<<TinyTIFFReader_getLastError(tiffr)<<"", test_results.back())
                         uint32_t poserror=0xFFFFFFFF;
                         if (frame%2==0) {
                             for (uint32_t i=0; i<width*height; i++) {
-                                test_results.back().success=ok=ok&&(tmp[i]==image[i*SAMPLES_IN+sample]);
+                                test_results.back().success=ok=ok&&(data[i]==image[i*SAMPLES_IN+sample]);
                                 if (!ok) { poserror=i; break; }
                             }
                         } else {
                             for (uint32_t i=0; i<width*height; i++) {
-                                test_results.back().success=ok=ok&&(tmp[i]==imagei[i*SAMPLES_IN+sample]);
+                                test_results.back().success=ok=ok&&(data[i]==imagei[i*SAMPLES_IN+sample]);
                                 if (!ok) { poserror=i; break; }
                             }
                         }
@@ -312,6 +419,7 @@ void TEST(const std::string& filename, const TIMAGESAMPLETYPE* image, const TIMA
             test_results.back().numImages=frame;
             std::cout<<"    read and checked "<<frame<<" frames: "<<((ok)?std::string("SUCCESS"):std::string("ERROR"))<<"     [duration: "<<duration<<" us  =  "<<floattounitstr(duration/1.0e6, "s")<<" ]\n";
             std::cout<<"    getSampleData() consumed "<<floattounitstr(duration_getdata/1.0e6, "s")<<"\n";
+            if (memoryMapped) std::cout<<"    memory mapped: "<<(TinyTIFFReader_isMemoryMapped(tiffr)?"yes":"no")<<", zero-copy samples: "<<zerocopy_samples<<"\n";
             std::cout<<"    readNext() consumed "<<floattounitstr(duration_nextframe/1.0e6, "s")<<"\n";
             std::cout<<"    read "<<frame<<" frames\n";
 
@@ -332,6 +440,499 @@ void TEST(const std::string& filename, const TIMAGESAMPLETYPE* image, const TIMA
 }
 
 
+// open the multi-frame TIFF file \a filename (frames alternating between image and imagei) with TinyTIFFReader and access its frames
+// in random order with TinyTIFFReader_seekFrame(), starting with the last frame (before the number of frames is known)
+template<class TIMAGESAMPLETYPE>
+void TEST_SEEK(const std::string& filename, const TIMAGESAMPLETYPE* image, const TIMAGESAMPLETYPE* imagei,size_t WIDTH_IN, size_t HEIGHT_IN, size_t SAMPLES_IN, size_t FRAMES_IN, std::vector<TestResult>& test_results) {
+    HighResTimer timer;
+    bool ok=false;
+    std::cout<<"\n\nreading '"<<std::string(filename)<<"' with random frame access and checking read contents ... filesize = "<<bytestostr(get_filesize(filename.c_str()))<<"\n";
+    test_results.emplace_back();
+    std::string desc=std::to_string(WIDTH_IN)+"x"+std::to_string(HEIGHT_IN)+"pix/"+std::to_string(sizeof(TIMAGESAMPLETYPE)*8)+"bit/"+std::to_string(SAMPLES_IN)+"ch/"+std::to_string(FRAMES_IN)+"frames";
+    test_results.back().name=std::string("TEST_SEEK(")+desc+", "+std::string(filename)+std::string(")");
+    test_results.back().success=ok=false;
+    try {
+        TinyTIFFReaderFile* tiffr=TinyTIFFReader_open(filename.c_str());
+        if (!tiffr) {
+            TESTFAIL("reading (not existent, not accessible or no TIFF file)", test_results.back())
+        } else {
+            test_results.back().success=ok=true;
+            // visit the frames in the order last, first, second to last, second, ...
+            std::vector<uint32_t> order;
+            for (size_t i=0; i<FRAMES_IN; i++) {
+                order.push_back((i%2==0)?static_cast<uint32_t>(FRAMES_IN-1-i/2):static_cast<uint32_t>(i/2));
+            }
+            order.push_back(static_cast<uint32_t>(FRAMES_IN/2));
+            std::vector<TIMAGESAMPLETYPE> tmp(WIDTH_IN*HEIGHT_IN);
+            timer.start();
+            for (size_t i=0; ok && i<order.size(); i++) {
+                const uint32_t frame=order[i];
+                if (!TinyTIFFReader_seekFrame(tiffr, frame)) {
+                    TESTFAIL("TinyTIFFReader_seekFrame("<<frame<<") failed", test_results.back())
+                    break;
+                }
+                if (TinyTIFFReader_getCurrentFrame(tiffr)!=frame) TESTFAIL("TinyTIFFReader_getCurrentFrame() returned "<<TinyTIFFReader_getCurrentFrame(tiffr)<<", expected "<<frame, test_results.back())
+                if (TinyTIFFReader_getWidth(tiffr)!=WIDTH_IN || TinyTIFFReader_getHeight(tiffr)!=HEIGHT_IN || TinyTIFFReader_getSamplesPerPixel(tiffr)!=SAMPLES_IN) TESTFAIL("IN FRAME "<<frame<<": size does not match", test_results.back())
+                if (frame==0) {
+                    // TinyTIFFWriter stores an ImageDescription in the first frame only
+                    if (std::string(TinyTIFFReader_getImageDescription(tiffr)).find("TinyTIFFWriter_version=")!=0) TESTFAIL("IN FRAME "<<frame<<": unexpected ImageDescription '"<<TinyTIFFReader_getImageDescription(tiffr)<<"'", test_results.back())
+                } else if (strlen(TinyTIFFReader_getImageDescription(tiffr))!=0) {
+                    TESTFAIL("IN FRAME "<<frame<<": unexpected ImageDescription '"<<TinyTIFFReader_getImageDescription(tiffr)<<"'", test_results.back())
+                }
+                for (size_t sample=0; ok && sample<SAMPLES_IN; sample++) {
+                    TinyTIFFReader_getSampleData_s(tiffr, tmp.data(), tmp.size()*sizeof(TIMAGESAMPLETYPE), static_cast<uint16_t>(sample));
+                    if (TinyTIFFReader_wasError(tiffr)) TESTFAIL(""<<TinyTIFFReader_getLastError(tiffr)<<"", test_results.back())
+                    const TIMAGESAMPLETYPE* expected=(frame%2==0)?image:imagei;
+                    for (size_t j=0; ok && j<WIDTH_IN*HEIGHT_IN; j++) {
+                        if (tmp[j]!=expected[j*SAMPLES_IN+sample]) TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": did not read correct contents @ pos="<<j<<"", test_results.back())
+                    }
+                }
+            }
+            const double duration=timer.get_time();
+            if (ok && TinyTIFFReader_countFrames(tiffr)!=FRAMES_IN) TESTFAIL("TinyTIFFReader_countFrames() returned "<<TinyTIFFReader_countFrames(tiffr)<<", expected "<<FRAMES_IN, test_results.back())
+            if (ok) {
+                // walking the complete IFD chain has to give the same result
+                TinyTIFFReaderFile* tiffstrict=TinyTIFFReader_open(filename.c_str());
+                TinyTIFFReader_setStrictFrameValidation(tiffstrict, TINYTIFF_TRUE);
+                const uint32_t framesstrict=TinyTIFFReader_countFrames(tiffstrict);
+                if (framesstrict!=FRAMES_IN) TESTFAIL("TinyTIFFReader_countFrames() with strict validation returned "<<framesstrict<<", expected "<<FRAMES_IN, test_results.back())
+                TinyTIFFReader_close(tiffstrict);
+            }
+            if (ok && TinyTIFFReader_seekFrame(tiffr, static_cast<uint32_t>(FRAMES_IN))) TESTFAIL("TinyTIFFReader_seekFrame() beyond the last frame succeeded", test_results.back())
+            if (ok && TinyTIFFReader_getCurrentFrame(tiffr)!=order.back()) TESTFAIL("failed TinyTIFFReader_seekFrame() changed the current frame", test_results.back())
+            if (ok && TinyTIFFReader_wasError(tiffr)) TESTFAIL(""<<TinyTIFFReader_getLastError(tiffr)<<"", test_results.back())
+            test_results.back().duration_ms=duration/1.0e3;
+            test_results.back().numImages=order.size();
+            std::cout<<"    read and checked "<<order.size()<<" frames in random order: "<<((ok)?std::string("SUCCESS"):std::string("ERROR"))<<"     [duration: "<<duration<<" us  =  "<<floattounitstr(duration/1.0e6, "s")<<" ]\n";
+        }
+        TinyTIFFReader_close(tiffr);
+    } catch(...) {
+        ok=false;
+        std::cout<<"       CRASH While reading file\n";
+    }
+
+    test_results.back().success=ok;
+    if (ok) std::cout<<"  => SUCCESS\n";
+    else std::cout<<"  => NOT CORRECTLY READ\n";
+}
+
+
+template<class TIMAGESAMPLETYPE>
+void TEST_ALLSAMPLES(const std::string& filename, const TIMAGESAMPLETYPE* image, const TIMAGESAMPLETYPE* imagei,size_t WIDTH_IN, size_t HEIGHT_IN, size_t SAMPLES_IN, size_t FRAMES_IN, bool interleavedInFile, std::vector<TestResult>& test_results, bool memoryMapped=false) {
+    HighResTimer timer;
+    bool ok=false;
+    std::cout<<"\n\nreading all samples of '"<<std::string(filename)<<"' in a single pass"<<(memoryMapped?std::string(" (memory mapped)"):std::string(""))<<" and checking read contents ... filesize = "<<bytestostr(get_filesize(filename.c_str()))<<"\n";
+    test_results.emplace_back();
+    std::string desc=std::to_string(WIDTH_IN)+"x"+std::to_string(HEIGHT_IN)+"pix/"+std::to_string(sizeof(TIMAGESAMPLETYPE)*8)+"bit/"+std::to_string(SAMPLES_IN)+"ch/"+std::to_string(FRAMES_IN)+"frames";
+    test_results.back().name=std::string("TEST_ALLSAMPLES(")+desc+", "+std::string(filename)+(memoryMapped?std::string(", mmap"):std::string(""))+std::string(")");
+    test_results.back().success=ok=false;
+    try {
+        TinyTIFFReaderFile* tiffr=memoryMapped?TinyTIFFReader_openMemoryMapped(filename.c_str()):TinyTIFFReader_open(filename.c_str());
+        if (!tiffr) {
+            TESTFAIL("reading (not existent, not accessible or no TIFF file)", test_results.back())
+        } else {
+            test_results.back().success=ok=true;
+            std::vector<std::vector<TIMAGESAMPLETYPE> > planes(SAMPLES_IN, std::vector<TIMAGESAMPLETYPE>(WIDTH_IN*HEIGHT_IN));
+            std::vector<void*> buffers;
+            for (size_t sample=0; sample<SAMPLES_IN; sample++) buffers.push_back(planes[sample].data());
+            std::vector<TIMAGESAMPLETYPE> interleaved(WIDTH_IN*HEIGHT_IN*SAMPLES_IN);
+            uint32_t frame=0;
+            timer.start();
+            do {
+                if (TinyTIFFReader_getWidth(tiffr)!=WIDTH_IN || TinyTIFFReader_getHeight(tiffr)!=HEIGHT_IN || TinyTIFFReader_getSamplesPerPixel(tiffr)!=SAMPLES_IN) TESTFAIL("IN FRAME "<<frame<<": size does not match", test_results.back())
+                const TIMAGESAMPLETYPE* expected=(frame%2==0)?image:imagei;
+                if (ok && !TinyTIFFReader_getSampleDataAll(tiffr, buffers.data(), static_cast<unsigned long>(WIDTH_IN*HEIGHT_IN*sizeof(TIMAGESAMPLETYPE)))) TESTFAIL("IN FRAME "<<frame<<": TinyTIFFReader_getSampleDataAll() failed: "<<TinyTIFFReader_getLastError(tiffr), test_results.back())
+                for (size_t sample=0; ok && sample<SAMPLES_IN; sample++) {
+                    for (size_t j=0; ok && j<WIDTH_IN*HEIGHT_IN; j++) {
+                        if (planes[sample][j]!=expected[j*SAMPLES_IN+sample]) TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": TinyTIFFReader_getSampleDataAll() did not read correct contents @ pos="<<j<<"", test_results.back())
+                    }
+                }
+                const int interleavedok=TinyTIFFReader_getFrameDataInterleaved(tiffr, interleaved.data(), static_cast<unsigned long>(interleaved.size()*sizeof(TIMAGESAMPLETYPE)));
+                if (ok && (interleavedInFile || SAMPLES_IN==1)) {
+                    if (!interleavedok) TESTFAIL("IN FRAME "<<frame<<": TinyTIFFReader_getFrameDataInterleaved() failed: "<<TinyTIFFReader_getLastError(tiffr), test_results.back())
+                    for (size_t j=0; ok && j<interleaved.size(); j++) {
+                        if (interleaved[j]!=expected[j]) TESTFAIL("IN FRAME "<<frame<<": TinyTIFFReader_getFrameDataInterleaved() did not read correct contents @ pos="<<j<<"", test_results.back())
+                    }
+                } else if (ok && interleavedok) {
+                    TESTFAIL("IN FRAME "<<frame<<": TinyTIFFReader_getFrameDataInterleaved() succeeded for a planar frame", test_results.back())
+                }
+                frame++;
+            } while (ok && TinyTIFFReader_readNext(tiffr));
+            const double duration=timer.get_time();
+            if (ok && frame!=FRAMES_IN) TESTFAIL("read "<<frame<<" frames, expected "<<FRAMES_IN, test_results.back())
+            test_results.back().duration_ms=duration/1.0e3;
+            test_results.back().numImages=frame;
+            std::cout<<"    read and checked all samples of "<<frame<<" frames: "<<((ok)?std::string("SUCCESS"):std::string("ERROR"))<<"     [duration: "<<duration<<" us  =  "<<floattounitstr(duration/1.0e6, "s")<<" ]\n";
+        }
+        TinyTIFFReader_close(tiffr);
+    } catch(...) {
+        ok=false;
+        std::cout<<"       CRASH While reading file\n";
+    }
+
+    test_results.back().success=ok;
+    if (ok) std::cout<<"  => SUCCESS\n";
+    else std::cout<<"  => NOT CORRECTLY READ\n";
+}
+
+
+// read several regions of interest from the multi-frame TIFF file \a filename (frames alternating between image and imagei) with TinyTIFFReader_getSampleDataROI()
+// and compare them to the corresponding parts of image and imagei, regions that exceed the frame have to be rejected. Each region is also read
+// with TinyTIFFReader_getSampleDataROIStrided() into rows with some padding, which must not be touched
+template<class TIMAGESAMPLETYPE>
+void TEST_ROI(const std::string& filename, const TIMAGESAMPLETYPE* image, const TIMAGESAMPLETYPE* imagei,size_t WIDTH_IN, size_t HEIGHT_IN, size_t SAMPLES_IN, size_t FRAMES_IN, std::vector<TestResult>& test_results, bool memoryMapped=false) {
+    HighResTimer timer;
+    bool ok=false;
+    std::cout<<"\n\nreading regions of interest from '"<<std::string(filename)<<"'"<<(memoryMapped?std::string(" (memory mapped)"):std::string(""))<<" and checking read contents ... filesize = "<<bytestostr(get_filesize(filename.c_str()))<<"\n";
+    test_results.emplace_back();
+    std::string desc=std::to_string(WIDTH_IN)+"x"+std::to_string(HEIGHT_IN)+"pix/"+std::to_string(sizeof(TIMAGESAMPLETYPE)*8)+"bit/"+std::to_string(SAMPLES_IN)+"ch/"+std::to_string(FRAMES_IN)+"frames";
+    test_results.back().name=std::string("TEST_ROI(")+desc+", "+std::string(filename)+(memoryMapped?std::string(", mmap"):std::string(""))+std::string(")");
+    test_results.back().success=ok=false;
+    try {
+        TinyTIFFReaderFile* tiffr=memoryMapped?TinyTIFFReader_openMemoryMapped(filename.c_str()):TinyTIFFReader_open(filename.c_str());
+        if (!tiffr) {
+            TESTFAIL("reading (not existent, not accessible or no TIFF file)", test_results.back())
+        } else {
+            test_results.back().success=ok=true;
+            // x, y, width, height: full frame, single pixels at the corners, a region crossing several tile/strip borders and a region in the interior
+            const uint32_t W=static_cast<uint32_t>(WIDTH_IN), H=static_cast<uint32_t>(HEIGHT_IN);
+            const uint32_t rois[][4]={{0,0,W,H}, {0,0,1,1}, {W-1,H-1,1,1}, {W/3,H/4,W/2,H/2}, {W/2-3,H/3,W/2,H/2}, {W-W/4,H-H/5,W/4,H/5}, {3,0,1,H}};
+            const uint32_t badrois[][4]={{W-10,0,11,1}, {0,H-1,1,2}, {W,0,1,1}, {0,0,0,1}};
+            std::vector<TIMAGESAMPLETYPE> roidata(WIDTH_IN*HEIGHT_IN);
+            const size_t PADDING=3;
+            std::vector<TIMAGESAMPLETYPE> stridedata((WIDTH_IN+PADDING)*HEIGHT_IN);
+            TIMAGESAMPLETYPE padvalue;
+            memset(&padvalue, 0xA5, sizeof(padvalue));
+            uint32_t frame=0;
+            timer.start();
+            do {
+                const TIMAGESAMPLETYPE* expected=(frame%2==0)?image:imagei;
+                for (size_t sample=0; ok && sample<SAMPLES_IN; sample++) {
+                    for (const auto& roi: rois) {
+                        if (!TinyTIFFReader_getSampleDataROI(tiffr, roidata.data(), roi[0], roi[1], roi[2], roi[3], static_cast<uint16_t>(sample))) {
+                            TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": TinyTIFFReader_getSampleDataROI("<<roi[0]<<","<<roi[1]<<","<<roi[2]<<","<<roi[3]<<") failed: "<<TinyTIFFReader_getLastError(tiffr), test_results.back())
+                            break;
+                        }
+                        for (size_t y=0; ok && y<roi[3]; y++) {
+                            for (size_t x=0; ok && x<roi[2]; x++) {
+                                if (roidata[y*roi[2]+x]!=expected[((roi[1]+y)*WIDTH_IN+roi[0]+x)*SAMPLES_IN+sample]) TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": TinyTIFFReader_getSampleDataROI("<<roi[0]<<","<<roi[1]<<","<<roi[2]<<","<<roi[3]<<") did not read correct contents @ x="<<x<<", y="<<y<<"", test_results.back())
+                            }
+                        }
+                        if (!ok) break;
+                        const size_t stride=roi[2]+PADDING;
+                        std::fill(stridedata.begin(), stridedata.end(), padvalue);
+                        if (!TinyTIFFReader_getSampleDataROIStrided(tiffr, stridedata.data(), static_cast<unsigned long>(stride*sizeof(TIMAGESAMPLETYPE)), roi[0], roi[1], roi[2], roi[3], static_cast<uint16_t>(sample))) {
+                            TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": TinyTIFFReader_getSampleDataROIStrided("<<roi[0]<<","<<roi[1]<<","<<roi[2]<<","<<roi[3]<<") failed: "<<TinyTIFFReader_getLastError(tiffr), test_results.back())
+                            break;
+                        }
+                        for (size_t y=0; ok && y<roi[3]; y++) {
+                            for (size_t x=0; ok && x<stride; x++) {
+                                const TIMAGESAMPLETYPE v=stridedata[y*stride+x];
+                                if (x<roi[2] && v!=expected[((roi[1]+y)*WIDTH_IN+roi[0]+x)*SAMPLES_IN+sample]) TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": TinyTIFFReader_getSampleDataROIStrided("<<roi[0]<<","<<roi[1]<<","<<roi[2]<<","<<roi[3]<<") did not read correct contents @ x="<<x<<", y="<<y<<"", test_results.back())
+                                if (x>=roi[2] && memcmp(&v, &padvalue, sizeof(v))!=0) TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": TinyTIFFReader_getSampleDataROIStrided("<<roi[0]<<","<<roi[1]<<","<<roi[2]<<","<<roi[3]<<") overwrote the padding @ x="<<x<<", y="<<y<<"", test_results.back())
+                            }
+                        }
+                        if (!ok) break;
+                    }
+                    for (const auto& roi: badrois) {
+                        if (ok && TinyTIFFReader_getSampleDataROI(tiffr, roidata.data(), roi[0], roi[1], roi[2], roi[3], static_cast<uint16_t>(sample))) TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": TinyTIFFReader_getSampleDataROI("<<roi[0]<<","<<roi[1]<<","<<roi[2]<<","<<roi[3]<<") did not fail for a region outside the frame", test_results.back())
+                    }
+                }
+                if (ok && TinyTIFFReader_getSampleDataROI(tiffr, roidata.data(), 0, 0, 1, 1, static_cast<uint16_t>(SAMPLES_IN))) TESTFAIL("IN FRAME "<<frame<<": TinyTIFFReader_getSampleDataROI() did not fail for an invalid sample", test_results.back())
+                frame++;
+            } while (ok && TinyTIFFReader_readNext(tiffr));
+            const double duration=timer.get_time();
+            if (ok && frame!=FRAMES_IN) TESTFAIL("read "<<frame<<" frames, expected "<<FRAMES_IN, test_results.back())
+            test_results.back().duration_ms=duration/1.0e3;
+            test_results.back().numImages=frame;
+            std::cout<<"    read and checked regions of interest of "<<frame<<" frames: "<<((ok)?std::string("SUCCESS"):std::string("ERROR"))<<"     [duration: "<<duration<<" us  =  "<<floattounitstr(duration/1.0e6, "s")<<" ]\n";
+        }
+        TinyTIFFReader_close(tiffr);
+    } catch(...) {
+        ok=false;
+        std::cout<<"       CRASH While reading file\n";
+    }
+
+    test_results.back().success=ok;
+    if (ok) std::cout<<"  => SUCCESS\n";
+    else std::cout<<"  => NOT CORRECTLY READ\n";
+}
+
+
+// open the multi-frame TIFF file \a filename (frames alternating between image and imagei) with TinyTIFFReader_openShared() and read all frames
+// from \a THREADS threads at the same time with TinyTIFFReader_readFrameAt(), each thread in a different order
+template<class TIMAGESAMPLETYPE>
+void TEST_SHARED(const std::string& filename, const TIMAGESAMPLETYPE* image, const TIMAGESAMPLETYPE* imagei,size_t WIDTH_IN, size_t HEIGHT_IN, size_t SAMPLES_IN, size_t FRAMES_IN, std::vector<TestResult>& test_results, size_t THREADS=4) {
+    HighResTimer timer;
+    bool ok=false;
+    std::cout<<"\n\nreading '"<<std::string(filename)<<"' from "<<THREADS<<" threads with a shared reader and checking read contents ... filesize = "<<bytestostr(get_filesize(filename.c_str()))<<"\n";
+    test_results.emplace_back();
+    std::string desc=std::to_string(WIDTH_IN)+"x"+std::to_string(HEIGHT_IN)+"pix/"+std::to_string(sizeof(TIMAGESAMPLETYPE)*8)+"bit/"+std::to_string(SAMPLES_IN)+"ch/"+std::to_string(FRAMES_IN)+"frames/"+std::to_string(THREADS)+"threads";
+    test_results.back().name=std::string("TEST_SHARED(")+desc+", "+std::string(filename)+std::string(")");
+    test_results.back().success=ok=false;
+    try {
+        timer.start();
+        TinyTIFFReaderSharedFile* shared=TinyTIFFReader_openShared(filename.c_str());
+        const double duration_open=timer.get_time();
+        if (!shared) {
+            TESTFAIL("reading (not existent, not accessible or no TIFF file)", test_results.back())
+        } else {
+            test_results.back().success=ok=true;
+            std::cout<<"    opened and indexed "<<TinyTIFFReader_countSharedFrames(shared)<<" frames     [duration: "<<duration_open<<" us  =  "<<floattounitstr(duration_open/1.0e6, "s")<<" ]\n";
+            if (TinyTIFFReader_countSharedFrames(shared)!=FRAMES_IN) TESTFAIL("found "<<TinyTIFFReader_countSharedFrames(shared)<<" frames, expected "<<FRAMES_IN, test_results.back())
+            uint32_t width=0, height=0;
+            uint16_t samples=0, bits=0;
+            if (ok && (!TinyTIFFReader_getSharedFrameInfo(shared, 0, &width, &height, &samples, &bits, NULL) || width!=WIDTH_IN || height!=HEIGHT_IN || samples!=SAMPLES_IN || bits!=sizeof(TIMAGESAMPLETYPE)*8)) TESTFAIL("size does not match, read "<<width<<"x"<<height<<"x"<<samples<<"    expected "<<WIDTH_IN<<"x"<<HEIGHT_IN<<"x"<<SAMPLES_IN<<"", test_results.back())
+            std::vector<TIMAGESAMPLETYPE> tmp(WIDTH_IN*HEIGHT_IN);
+            if (ok && TinyTIFFReader_readFrameAt(shared, static_cast<uint32_t>(FRAMES_IN), 0, tmp.data(), static_cast<unsigned long>(tmp.size()*sizeof(TIMAGESAMPLETYPE)))) TESTFAIL("TinyTIFFReader_readFrameAt() did not fail for a frame after the end of the file", test_results.back())
+            if (ok && TinyTIFFReader_readFrameAt(shared, 0, static_cast<uint16_t>(SAMPLES_IN), tmp.data(), static_cast<unsigned long>(tmp.size()*sizeof(TIMAGESAMPLETYPE)))) TESTFAIL("TinyTIFFReader_readFrameAt() did not fail for an invalid sample", test_results.back())
+            if (ok) {
+                // every thread reads all frames, starting at a different frame and alternating its direction
+                std::vector<std::string> errors(THREADS);
+                std::vector<std::thread> threads;
+                timer.start();
+                for (size_t t=0; t<THREADS; t++) {
+                    threads.emplace_back([&, t]() {
+                        std::vector<TIMAGESAMPLETYPE> data(WIDTH_IN*HEIGHT_IN);
+                        for (size_t i=0; i<FRAMES_IN && errors[t].empty(); i++) {
+                            const uint32_t frame=static_cast<uint32_t>((t%2==0)?(t+i)%FRAMES_IN:(FRAMES_IN-1-(t+i)%FRAMES_IN));
+                            const TIMAGESAMPLETYPE* expected=(frame%2==0)?image:imagei;
+                            for (size_t sample=0; sample<SAMPLES_IN && errors[t].empty(); sample++) {
+                                if (!TinyTIFFReader_readFrameAt(shared, frame, static_cast<uint16_t>(sample), data.data(), static_cast<unsigned long>(data.size()*sizeof(TIMAGESAMPLETYPE)))) {
+                                    errors[t]="TinyTIFFReader_readFrameAt() failed in frame "+std::to_string(frame)+"/ sample "+std::to_string(sample);
+                                }
+                                for (size_t j=0; j<data.size() && errors[t].empty(); j++) {
+                                    if (data[j]!=expected[j*SAMPLES_IN+sample]) errors[t]="IN FRAME "+std::to_string(frame)+"/ SAMPLE "+std::to_string(sample)+": did not read correct contents @ pos="+std::to_string(j);
+                                }
+                            }
+                        }
+                    });
+                }
+                for (auto& th: threads) th.join();
+                const double duration=timer.get_time();
+                for (size_t t=0; t<THREADS && ok; t++) {
+                    if (!errors[t].empty()) TESTFAIL("THREAD "<<t<<": "<<errors[t], test_results.back())
+                }
+                test_results.back().duration_ms=duration/1.0e3;
+                test_results.back().numImages=FRAMES_IN*THREADS;
+                std::cout<<"    read and checked "<<FRAMES_IN<<" frames in each of "<<THREADS<<" threads: "<<((ok)?std::string("SUCCESS"):std::string("ERROR"))<<"     [duration: "<<duration<<" us  =  "<<floattounitstr(duration/1.0e6, "s")<<" ]\n";
+            }
+        }
+        TinyTIFFReader_closeShared(shared);
+    } catch(...) {
+        ok=false;
+        std::cout<<"       CRASH While reading file\n";
+    }
+
+    test_results.back().success=ok;
+    if (ok) std::cout<<"  => SUCCESS\n";
+    else std::cout<<"  => NOT CORRECTLY READ\n";
+}
+
+
+// open the multi-frame TIFF file \a filename (frames alternating between image and imagei) and read each sample of all frames and of a range of frames
+// into a 3D buffer with TinyTIFFReader_readFrames(), using \a THREADS threads
+template<class TIMAGESAMPLETYPE>
+void TEST_READFRAMES(const std::string& filename, const TIMAGESAMPLETYPE* image, const TIMAGESAMPLETYPE* imagei,size_t WIDTH_IN, size_t HEIGHT_IN, size_t SAMPLES_IN, size_t FRAMES_IN, std::vector<TestResult>& test_results, uint32_t THREADS=0, bool memoryMapped=false) {
+    HighResTimer timer;
+    bool ok=false;
+    std::cout<<"\n\nreading '"<<std::string(filename)<<"'"<<(memoryMapped?std::string(" (memory mapped)"):std::string(""))<<" with TinyTIFFReader_readFrames() and checking read contents ... filesize = "<<bytestostr(get_filesize(filename.c_str()))<<"\n";
+    test_results.emplace_back();
+    std::string desc=std::to_string(WIDTH_IN)+"x"+std::to_string(HEIGHT_IN)+"pix/"+std::to_string(sizeof(TIMAGESAMPLETYPE)*8)+"bit/"+std::to_string(SAMPLES_IN)+"ch/"+std::to_string(FRAMES_IN)+"frames/"+((THREADS>0)?std::to_string(THREADS):std::string("auto"))+"threads";
+    test_results.back().name=std::string("TEST_READFRAMES(")+desc+", "+std::string(filename)+(memoryMapped?std::string(", mmap"):std::string(""))+std::string(")");
+    test_results.back().success=ok=false;
+    try {
+        TinyTIFFReaderFile* tiffr=memoryMapped?TinyTIFFReader_openMemoryMapped(filename.c_str()):TinyTIFFReader_open(filename.c_str());
+        if (!tiffr) {
+            TESTFAIL("reading (not existent, not accessible or no TIFF file)", test_results.back())
+        } else {
+            test_results.back().success=ok=true;
+            TinyTIFFReader_setReadThreads(tiffr, THREADS);
+            const size_t FRAMESIZE=WIDTH_IN*HEIGHT_IN;
+            std::vector<TIMAGESAMPLETYPE> data(FRAMESIZE*FRAMES_IN);
+            const uint64_t data_size=data.size()*sizeof(TIMAGESAMPLETYPE);
+            if (TinyTIFFReader_readFrames(tiffr, 0, static_cast<uint32_t>(FRAMES_IN+1), 0, data.data(), data_size+FRAMESIZE*sizeof(TIMAGESAMPLETYPE))) TESTFAIL("TinyTIFFReader_readFrames() did not fail for frames after the end of the file", test_results.back())
+            if (ok && TinyTIFFReader_readFrames(tiffr, 0, static_cast<uint32_t>(FRAMES_IN), 0, data.data(), data_size-1)) TESTFAIL("TinyTIFFReader_readFrames() did not fail for a too small buffer", test_results.back())
+            if (ok && TinyTIFFReader_readFrames(tiffr, 0, 1, static_cast<uint16_t>(SAMPLES_IN), data.data(), data_size)) TESTFAIL("TinyTIFFReader_readFrames() did not fail for an invalid sample", test_results.back())
+            // first frame, number of frames
+            const size_t ranges[][2]={{0,FRAMES_IN}, {FRAMES_IN/2+1, FRAMES_IN/2-1}, {FRAMES_IN-1,1}};
+            timer.start();
+            for (size_t r=0; ok && r<sizeof(ranges)/sizeof(ranges[0]); r++) {
+                const size_t first=ranges[r][0], count=ranges[r][1];
+                // the current frame of the reader must not change
+                TinyTIFFReader_readNext(tiffr);
+                for (uint16_t sample=0; ok && sample<SAMPLES_IN; sample++) {
+                    std::fill(data.begin(), data.end(), TIMAGESAMPLETYPE(0));
+                    if (!TinyTIFFReader_readFrames(tiffr, static_cast<uint32_t>(first), static_cast<uint32_t>(count), sample, data.data(), data_size)) TESTFAIL("FRAMES "<<first<<"..."<<first+count-1<<"/ SAMPLE "<<sample<<": "<<TinyTIFFReader_getLastError(tiffr), test_results.back())
+                    for (size_t f=0; ok && f<count; f++) {
+                        const TIMAGESAMPLETYPE* expected=((first+f)%2==0)?image:imagei;
+                        for (size_t i=0; ok && i<FRAMESIZE; i++) {
+                            if (data[f*FRAMESIZE+i]!=expected[i*SAMPLES_IN+sample]) TESTFAIL("IN FRAME "<<first+f<<"/ SAMPLE "<<sample<<": did not read correct contents @ pos="<<i<<"", test_results.back())
+                        }
+                    }
+                    for (size_t i=count*FRAMESIZE; ok && i<data.size(); i++) {
+                        if (data[i]!=TIMAGESAMPLETYPE(0)) TESTFAIL("FRAMES "<<first<<"..."<<first+count-1<<": wrote after the end of the requested frames @ pos="<<i<<"", test_results.back())
+                    }
+                }
+                std::vector<TIMAGESAMPLETYPE> current(FRAMESIZE);
+                const TIMAGESAMPLETYPE* expected=((r+1)%2==0)?image:imagei;
+                if (ok && !TinyTIFFReader_getSampleData_s(tiffr, current.data(), static_cast<unsigned long>(current.size()*sizeof(TIMAGESAMPLETYPE)), 0)) TESTFAIL("reading the current frame after TinyTIFFReader_readFrames(): "<<TinyTIFFReader_getLastError(tiffr), test_results.back())
+                for (size_t i=0; ok && i<FRAMESIZE; i++) {
+                    if (current[i]!=expected[i*SAMPLES_IN]) TESTFAIL("TinyTIFFReader_readFrames() changed the current frame of the reader", test_results.back())
+                }
+            }
+            const double duration=timer.get_time();
+            test_results.back().duration_ms=duration/1.0e3;
+            test_results.back().numImages=FRAMES_IN+FRAMES_IN/2;
+            std::cout<<"    read and checked frame ranges: "<<((ok)?std::string("SUCCESS"):std::string("ERROR"))<<"     [duration: "<<duration<<" us  =  "<<floattounitstr(duration/1.0e6, "s")<<" ]\n";
+        }
+        TinyTIFFReader_close(tiffr);
+    } catch(...) {
+        ok=false;
+        std::cout<<"       CRASH While reading file\n";
+    }
+
+    test_results.back().success=ok;
+    if (ok) std::cout<<"  => SUCCESS\n";
+    else std::cout<<"  => NOT CORRECTLY READ\n";
+}
+
+
+// read the multi-frame TIFF file \a filename (frames alternating between image and imagei) sequentially in prefetch mode (loading up to \a PREFETCH_FRAMES frames
+// and \a PREFETCH_BYTES bytes in advance), jumping back to frame 1 once in the middle of the file
+template<class TIMAGESAMPLETYPE>
+void TEST_PREFETCH(const std::string& filename, const TIMAGESAMPLETYPE* image, const TIMAGESAMPLETYPE* imagei,size_t WIDTH_IN, size_t HEIGHT_IN, size_t SAMPLES_IN, size_t FRAMES_IN, std::vector<TestResult>& test_results, uint32_t PREFETCH_FRAMES=4, uint64_t PREFETCH_BYTES=0, bool memoryMapped=false) {
+    HighResTimer timer;
+    bool ok=false;
+    std::cout<<"\n\nreading '"<<std::string(filename)<<"'"<<(memoryMapped?std::string(" (memory mapped)"):std::string(""))<<" with prefetching and checking read contents ... filesize = "<<bytestostr(get_filesize(filename.c_str()))<<"\n";
+    test_results.emplace_back();
+    std::string desc=std::to_string(WIDTH_IN)+"x"+std::to_string(HEIGHT_IN)+"pix/"+std::to_string(sizeof(TIMAGESAMPLETYPE)*8)+"bit/"+std::to_string(SAMPLES_IN)+"ch/"+std::to_string(FRAMES_IN)+"frames/prefetch"+std::to_string(PREFETCH_FRAMES)+((PREFETCH_BYTES>0)?std::string("/max")+bytestostr(static_cast<double>(PREFETCH_BYTES)):std::string(""));
+    test_results.back().name=std::string("TEST_PREFETCH(")+desc+", "+std::string(filename)+(memoryMapped?std::string(", mmap"):std::string(""))+std::string(")");
+    test_results.back().success=ok=false;
+    try {
+        TinyTIFFReaderFile* tiffr=memoryMapped?TinyTIFFReader_openMemoryMapped(filename.c_str()):TinyTIFFReader_open(filename.c_str());
+        if (!tiffr) {
+            TESTFAIL("reading (not existent, not accessible or no TIFF file)", test_results.back())
+        } else {
+            test_results.back().success=ok=true;
+            if (TinyTIFFReader_enablePrefetch(tiffr, 0, 0)) TESTFAIL("TinyTIFFReader_enablePrefetch() did not fail for 0 frames", test_results.back())
+            if (ok && !TinyTIFFReader_enablePrefetch(tiffr, PREFETCH_FRAMES, PREFETCH_BYTES)) TESTFAIL("TinyTIFFReader_enablePrefetch() failed: "<<TinyTIFFReader_getLastError(tiffr), test_results.back())
+            std::vector<TIMAGESAMPLETYPE> data(WIDTH_IN*HEIGHT_IN);
+            size_t framesRead=0;
+            uint32_t frame=0;
+            bool jumped=false;
+            // the first frame and the frame after a seek are read synchronously, all others are taken from the prefetched frames
+            bool prefetched=false;
+            timer.start();
+            while (ok) {
+                if (TinyTIFFReader_getCurrentFrame(tiffr)!=frame) TESTFAIL("current frame is "<<TinyTIFFReader_getCurrentFrame(tiffr)<<", expected "<<frame, test_results.back())
+                if (ok && TinyTIFFReader_getPrefetchedFrames(tiffr)>PREFETCH_FRAMES) TESTFAIL("prefetched "<<TinyTIFFReader_getPrefetchedFrames(tiffr)<<" frames, expected at most "<<PREFETCH_FRAMES, test_results.back())
+                if (ok && (TinyTIFFReader_getWidth(tiffr)!=WIDTH_IN || TinyTIFFReader_getHeight(tiffr)!=HEIGHT_IN || TinyTIFFReader_getSamplesPerPixel(tiffr)!=SAMPLES_IN)) TESTFAIL("IN FRAME "<<frame<<": size does not match", test_results.back())
+                const TIMAGESAMPLETYPE* expected=(frame%2==0)?image:imagei;
+                for (uint16_t sample=0; ok && sample<SAMPLES_IN; sample++) {
+                    std::fill(data.begin(), data.end(), TIMAGESAMPLETYPE(0));
+                    if (!TinyTIFFReader_getSampleData_s(tiffr, data.data(), static_cast<unsigned long>(data.size()*sizeof(TIMAGESAMPLETYPE)), sample)) TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": "<<TinyTIFFReader_getLastError(tiffr), test_results.back())
+                    const TIMAGESAMPLETYPE* ptr=static_cast<const TIMAGESAMPLETYPE*>(TinyTIFFReader_getSampleDataPointer(tiffr, NULL, 0, sample));
+                    // without a fallback buffer, a pointer is only returned for prefetched (or memory mapped) data
+                    if (ok && !ptr && prefetched && !memoryMapped) TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": TinyTIFFReader_getSampleDataPointer() did not return the prefetched data", test_results.back())
+                    for (size_t i=0; ok && i<data.size(); i++) {
+                        if (data[i]!=expected[i*SAMPLES_IN+sample]) TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": did not read correct contents @ pos="<<i<<"", test_results.back())
+                        if (ok && ptr && memcmp(&(ptr[i]), &(expected[i*SAMPLES_IN+sample]), sizeof(TIMAGESAMPLETYPE))!=0) TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": did not return correct contents from TinyTIFFReader_getSampleDataPointer() @ pos="<<i<<"", test_results.back())
+                    }
+                }
+                framesRead++;
+                if (ok && !jumped && frame==FRAMES_IN/2) {
+                    jumped=true;
+                    prefetched=false;
+                    frame=1;
+                    if (!TinyTIFFReader_seekFrame(tiffr, frame)) TESTFAIL("TinyTIFFReader_seekFrame() failed: "<<TinyTIFFReader_getLastError(tiffr), test_results.back())
+                } else if (TinyTIFFReader_readNext(tiffr)) {
+                    prefetched=true;
+                    frame++;
+                } else {
+                    break;
+                }
+            }
+            const double duration=timer.get_time();
+            if (ok && framesRead!=FRAMES_IN+FRAMES_IN/2) TESTFAIL("read "<<framesRead<<" frames, expected "<<FRAMES_IN+FRAMES_IN/2, test_results.back())
+            if (ok && TinyTIFFReader_getPrefetchedFrames(tiffr)!=0) TESTFAIL("still "<<TinyTIFFReader_getPrefetchedFrames(tiffr)<<" frames prefetched after the last frame", test_results.back())
+            // after switching back to synchronous reads, the current frame is still available
+            TinyTIFFReader_disablePrefetch(tiffr);
+            if (ok && !TinyTIFFReader_getSampleData_s(tiffr, data.data(), static_cast<unsigned long>(data.size()*sizeof(TIMAGESAMPLETYPE)), 0)) TESTFAIL("reading the last frame after TinyTIFFReader_disablePrefetch(): "<<TinyTIFFReader_getLastError(tiffr), test_results.back())
+            for (size_t i=0; ok && i<data.size(); i++) {
+                if (data[i]!=((frame%2==0)?image:imagei)[i*SAMPLES_IN]) TESTFAIL("IN FRAME "<<frame<<": did not read correct contents after TinyTIFFReader_disablePrefetch() @ pos="<<i<<"", test_results.back())
+            }
+            test_results.back().duration_ms=duration/1.0e3;
+            test_results.back().numImages=framesRead;
+            std::cout<<"    read and checked "<<framesRead<<" frames: "<<((ok)?std::string("SUCCESS"):std::string("ERROR"))<<"     [duration: "<<duration<<" us  =  "<<floattounitstr(duration/1.0e6, "s")<<" ]\n";
+        }
+        TinyTIFFReader_close(tiffr);
+    } catch(...) {
+        ok=false;
+        std::cout<<"       CRASH While reading file\n";
+    }
+
+    test_results.back().success=ok;
+    if (ok) std::cout<<"  => SUCCESS\n";
+    else std::cout<<"  => NOT CORRECTLY READ\n";
+}
+
+
+// read the TIFF files \a filename and \a reference_filename with TinyTIFFReader and check that both contain the same frames (e.g. the same data stored stripped and tiled)
+template<class TIMAGESAMPLETYPE>
+void TEST_SAME_CONTENTS(const std::string& filename, const std::string& reference_filename, std::vector<TestResult>& test_results) {
+    HighResTimer timer;
+    bool ok=false;
+    std::cout<<"\n\nreading '"<<std::string(filename)<<"' and comparing its contents to '"<<reference_filename<<"' ... filesize = "<<bytestostr(get_filesize(filename.c_str()))<<"\n";
+    test_results.emplace_back();
+    test_results.back().name=std::string("TEST_SAME_CONTENTS(")+std::to_string(sizeof(TIMAGESAMPLETYPE)*8)+"bit, "+std::string(filename)+", "+reference_filename+std::string(")");
+    test_results.back().success=ok=false;
+    try {
+        TinyTIFFReaderFile* tiffr=TinyTIFFReader_open(filename.c_str());
+        TinyTIFFReaderFile* tiffref=TinyTIFFReader_open(reference_filename.c_str());
+        if (!tiffr || !tiffref) {
+            TESTFAIL("reading (not existent, not accessible or no TIFF file)", test_results.back())
+        } else {
+            test_results.back().success=ok=true;
+            uint32_t frame=0;
+            bool next, nextref;
+            timer.start();
+            do {
+                const uint32_t width=TinyTIFFReader_getWidth(tiffr);
+                const uint32_t height=TinyTIFFReader_getHeight(tiffr);
+                const uint16_t samples=TinyTIFFReader_getSamplesPerPixel(tiffr);
+                if (width!=TinyTIFFReader_getWidth(tiffref) || height!=TinyTIFFReader_getHeight(tiffref) || samples!=TinyTIFFReader_getSamplesPerPixel(tiffref)) TESTFAIL("IN FRAME "<<frame<<": size does not match", test_results.back())
+                std::vector<TIMAGESAMPLETYPE> data(static_cast<size_t>(width)*height), refdata(static_cast<size_t>(width)*height);
+                for (uint16_t sample=0; ok && sample<samples; sample++) {
+                    if (!TinyTIFFReader_getSampleData_s(tiffr, data.data(), static_cast<unsigned long>(data.size()*sizeof(TIMAGESAMPLETYPE)), sample)) TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": "<<TinyTIFFReader_getLastError(tiffr), test_results.back())
+                    if (ok && !TinyTIFFReader_getSampleData_s(tiffref, refdata.data(), static_cast<unsigned long>(refdata.size()*sizeof(TIMAGESAMPLETYPE)), sample)) TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": "<<TinyTIFFReader_getLastError(tiffref), test_results.back())
+                    for (size_t i=0; ok && i<data.size(); i++) {
+                        if (memcmp(&(data[i]), &(refdata[i]), sizeof(TIMAGESAMPLETYPE))!=0) TESTFAIL("IN FRAME "<<frame<<"/ SAMPLE "<<sample<<": contents differ @ pos="<<i<<"", test_results.back())
+                    }
+                }
+                frame++;
+                next=TinyTIFFReader_readNext(tiffr);
+                nextref=TinyTIFFReader_readNext(tiffref);
+                if (ok && next!=nextref) TESTFAIL("number of frames differs after frame "<<frame, test_results.back())
+            } while (ok && next);
+            const double duration=timer.get_time();
+            test_results.back().duration_ms=duration/1.0e3;
+            test_results.back().numImages=frame;
+            std::cout<<"    compared "<<frame<<" frames: "<<((ok)?std::string("SUCCESS"):std::string("ERROR"))<<"     [duration: "<<duration<<" us  =  "<<floattounitstr(duration/1.0e6, "s")<<" ]\n";
+        }
+        if (tiffr) TinyTIFFReader_close(tiffr);
+        if (tiffref) TinyTIFFReader_close(tiffref);
+    } catch(...) {
+        ok=false;
+        std::cout<<"       CRASH While reading file\n";
+    }
+
+    test_results.back().success=ok;
+    if (ok) std::cout<<"  => SUCCESS\n";
+    else std::cout<<"  => NOT CORRECTLY READ\n";
+}
+
+
 // try to read the data in the TIFF file \a filename with TinyTIFFReader and LIBTIFF and compare the result of the two
 template<class TIMAGESAMPLETYPE>
 void TEST_AGAINST_LIBTIFF(const std::string& filename, std::vector<TestResult>& test_results) {
@@ -539,6 +1140,8 @@ int main(int argc, char *argv[]) {
     vector<double> imagedi(WIDTH*HEIGHT, 0);
     vector<uint8_t> imagergb(WIDTH*HEIGHT*3, 0);
     vector<uint8_t> imagergbi(WIDTH*HEIGHT*3, 0);
+    vector<uint16_t> imagergba16(WIDTH*HEIGHT*4, 0);
+    vector<uint16_t> imagergba16i(WIDTH*HEIGHT*4, 0);
 
     write1ChannelTestData(image8.data(), WIDTH, HEIGHT, PATTERNSIZE);
     write1ChannelTestData(image8i.data(), WIDTH, HEIGHT, PATTERNSIZE);
@@ -561,6 +1164,10 @@ int main(int argc, char *argv[]) {
     writeRGBTestDataChunky(imagergb.data(), WIDTH, HEIGHT, PATTERNSIZE,3);
     writeRGBTestDataChunky(imagergbi.data(), WIDTH, HEIGHT, PATTERNSIZE,3);
     invertTestImage(imagergbi.data(), WIDTH, HEIGHT,3);
+    writeRGBTestDataChunky(imagergba16.data(), WIDTH, HEIGHT, PATTERNSIZE,4);
+    for (size_t i=0; i<WIDTH*HEIGHT; i++) imagergba16[i*4+3]=static_cast<uint16_t>(i*31);
+    imagergba16i=imagergba16;
+    invertTestImage(imagergba16i.data(), WIDTH, HEIGHT,4);
 
     TinyTIFFWriterFile* tiff = TinyTIFFWriter_open("test8.tif", 8, TinyTIFFWriter_UInt, 1, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
     TinyTIFFWriter_writeImage(tiff, image8.data());
@@ -589,6 +1196,16 @@ int main(int argc, char *argv[]) {
         TinyTIFFWriter_writeImage(tiff, image16i.data());
     }
     TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open_withformat("test16m_big.tif", 16, TinyTIFFWriter_UInt, 1, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation, TinyTIFFWriter_BigTIFF);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImage(tiff, image16.data());
+        TinyTIFFWriter_writeImage(tiff, image16i.data());
+    }
+    TinyTIFFWriter_close(tiff);
+#ifdef TINYTIFF_TEST_LIBTIFF
+    SAVE_TIFF_libtiff("test16_littleendian_big.tif", image16.data(), WIDTH, HEIGHT, true, true);
+    SAVE_TIFF_libtiff("test16_bigendian_big.tif", image16.data(), WIDTH, HEIGHT, false, true);
+#endif
 
     tiff = TinyTIFFWriter_open("test32.tif", 32, TinyTIFFWriter_UInt, 1, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
     TinyTIFFWriter_writeImage(tiff, image32.data());
@@ -647,6 +1264,171 @@ int main(int argc, char *argv[]) {
         TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergbi.data());
     }
     TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open_withformat("testrgbm_big.tif", 8, TinyTIFFWriter_UInt, 3, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation, TinyTIFFWriter_BigTIFF);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergb.data());
+        TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergbi.data());
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open("testrgbm_chunky.tif", 8, TinyTIFFWriter_UInt, 3, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImageMultiSample(tiff, imagergb.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+        TinyTIFFWriter_writeImageMultiSample(tiff, imagergbi.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open("testrgba16m.tif", 16, TinyTIFFWriter_UInt, 4, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergba16.data());
+        TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergba16i.data());
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open("testrgba16m_chunky.tif", 16, TinyTIFFWriter_UInt, 4, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImageMultiSample(tiff, imagergba16.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+        TinyTIFFWriter_writeImageMultiSample(tiff, imagergba16i.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open("test16m_strips.tif", 16, TinyTIFFWriter_UInt, 1, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+    TinyTIFFWriter_setRowsPerStrip(tiff, 5);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImage(tiff, image16.data());
+        TinyTIFFWriter_writeImage(tiff, image16i.data());
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open_withformat("testrgbm_strips_big.tif", 8, TinyTIFFWriter_UInt, 3, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation, TinyTIFFWriter_BigTIFF);
+    TinyTIFFWriter_setRowsPerStrip(tiff, 7);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergb.data());
+        TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergbi.data());
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open("testrgba16m_strips_chunky.tif", 16, TinyTIFFWriter_UInt, 4, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+    TinyTIFFWriter_setRowsPerStrip(tiff, 3);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImageMultiSample(tiff, imagergba16.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+        TinyTIFFWriter_writeImageMultiSample(tiff, imagergba16i.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open("test16m_tiled.tif", 16, TinyTIFFWriter_UInt, 1, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+    TinyTIFFWriter_setTileSize(tiff, 16, 32);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImage(tiff, image16.data());
+        TinyTIFFWriter_writeImage(tiff, image16i.data());
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open_withformat("testrgbm_tiled_big.tif", 8, TinyTIFFWriter_UInt, 3, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation, TinyTIFFWriter_BigTIFF);
+    TinyTIFFWriter_setTileSize(tiff, 48, 48);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergb.data());
+        TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergbi.data());
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open("testrgba16m_tiled_chunky.tif", 16, TinyTIFFWriter_UInt, 4, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+    TinyTIFFWriter_setTileSize(tiff, 32, 16);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImageMultiSample(tiff, imagergba16.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+        TinyTIFFWriter_writeImageMultiSample(tiff, imagergba16i.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open("test8m_packbits.tif", 8, TinyTIFFWriter_UInt, 1, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+    TinyTIFFWriter_setCompression(tiff, TinyTIFFWriter_PackBits);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImage(tiff, image8.data());
+        TinyTIFFWriter_writeImage(tiff, image8i.data());
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open("test16m_packbits_strips.tif", 16, TinyTIFFWriter_UInt, 1, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+    TinyTIFFWriter_setRowsPerStrip(tiff, 5);
+    TinyTIFFWriter_setCompression(tiff, TinyTIFFWriter_PackBits);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImage(tiff, image16.data());
+        TinyTIFFWriter_writeImage(tiff, image16i.data());
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open_withformat("testrgbm_packbits_strips_big.tif", 8, TinyTIFFWriter_UInt, 3, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation, TinyTIFFWriter_BigTIFF);
+    TinyTIFFWriter_setRowsPerStrip(tiff, 7);
+    TinyTIFFWriter_setCompression(tiff, TinyTIFFWriter_PackBits);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergb.data());
+        TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergbi.data());
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open("testrgba16m_packbits_strips_chunky.tif", 16, TinyTIFFWriter_UInt, 4, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+    TinyTIFFWriter_setRowsPerStrip(tiff, 3);
+    TinyTIFFWriter_setCompression(tiff, TinyTIFFWriter_PackBits);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImageMultiSample(tiff, imagergba16.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+        TinyTIFFWriter_writeImageMultiSample(tiff, imagergba16i.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open("test16m_lzwpred_strips.tif", 16, TinyTIFFWriter_UInt, 1, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+    TinyTIFFWriter_setRowsPerStrip(tiff, 5);
+    TinyTIFFWriter_setCompression(tiff, TinyTIFFWriter_LZWPredictor);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImage(tiff, image16.data());
+        TinyTIFFWriter_writeImage(tiff, image16i.data());
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open_withformat("testrgbm_lzw_strips_big.tif", 8, TinyTIFFWriter_UInt, 3, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation, TinyTIFFWriter_BigTIFF);
+    TinyTIFFWriter_setRowsPerStrip(tiff, 7);
+    TinyTIFFWriter_setCompression(tiff, TinyTIFFWriter_LZW);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergb.data());
+        TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergbi.data());
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open("testrgba16m_lzwpred_strips_chunky.tif", 16, TinyTIFFWriter_UInt, 4, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+    TinyTIFFWriter_setRowsPerStrip(tiff, 3);
+    TinyTIFFWriter_setCompression(tiff, TinyTIFFWriter_LZWPredictor);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImageMultiSample(tiff, imagergba16.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+        TinyTIFFWriter_writeImageMultiSample(tiff, imagergba16i.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+    }
+    TinyTIFFWriter_close(tiff);
+    tiff = TinyTIFFWriter_open("test64m_lzwpred.tif", 64, TinyTIFFWriter_UInt, 1, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+    TinyTIFFWriter_setCompression(tiff, TinyTIFFWriter_LZWPredictor);
+    for (size_t i=0; i<TEST_FRAMES/2; i++) {
+        TinyTIFFWriter_writeImage(tiff, image64.data());
+        TinyTIFFWriter_writeImage(tiff, image64i.data());
+    }
+    TinyTIFFWriter_close(tiff);
+    if (TinyTIFFWriter_isCompressionAvailable(TinyTIFFWriter_Deflate)) {
+        tiff = TinyTIFFWriter_open("test16m_deflatepred_strips.tif", 16, TinyTIFFWriter_UInt, 1, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+        TinyTIFFWriter_setRowsPerStrip(tiff, 5);
+        TinyTIFFWriter_setCompression(tiff, TinyTIFFWriter_DeflatePredictor);
+        for (size_t i=0; i<TEST_FRAMES/2; i++) {
+            TinyTIFFWriter_writeImage(tiff, image16.data());
+            TinyTIFFWriter_writeImage(tiff, image16i.data());
+        }
+        TinyTIFFWriter_close(tiff);
+        tiff = TinyTIFFWriter_open_withformat("testrgbm_deflate_strips_big.tif", 8, TinyTIFFWriter_UInt, 3, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation, TinyTIFFWriter_BigTIFF);
+        TinyTIFFWriter_setRowsPerStrip(tiff, 7);
+        TinyTIFFWriter_setCompression(tiff, TinyTIFFWriter_Deflate);
+        TinyTIFFWriter_setCompressionLevel(tiff, 1);
+        for (size_t i=0; i<TEST_FRAMES/2; i++) {
+            TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergb.data());
+            TinyTIFFWriter_writeImagePlanarReorder(tiff, imagergbi.data());
+        }
+        TinyTIFFWriter_close(tiff);
+        tiff = TinyTIFFWriter_open("testrgba16m_deflatepred_strips_chunky.tif", 16, TinyTIFFWriter_UInt, 4, WIDTH,HEIGHT, TinyTIFFWriter_AutodetectSampleInterpetation);
+        TinyTIFFWriter_setRowsPerStrip(tiff, 3);
+        TinyTIFFWriter_setCompression(tiff, TinyTIFFWriter_DeflatePredictor);
+        TinyTIFFWriter_setCompressionLevel(tiff, 9);
+        for (size_t i=0; i<TEST_FRAMES/2; i++) {
+            TinyTIFFWriter_writeImageMultiSample(tiff, imagergba16.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+            TinyTIFFWriter_writeImageMultiSample(tiff, imagergba16i.data(), TinyTIFF_Chunky, TinyTIFF_Chunky);
+        }
+        TinyTIFFWriter_close(tiff);
+    }
+    SAVE_TIFF_bigendian("test16m_bigendian_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, 5);
+    SAVE_TIFF_bigendian("test32m_bigendian_strips.tif", image32.data(), image32i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, 7);
+    SAVE_TIFF_bigendian("test64m_bigendian.tif", image64.data(), image64i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, HEIGHT);
+    SAVE_TIFF_bigendian("testrgba16m_bigendian_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, 3);
+    SAVE_TIFF_bigendian("test8m_lzw.tif", image8.data(), image8i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, HEIGHT, true);
+    SAVE_TIFF_bigendian("testrgbm_lzw_predictor_strips.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, 5, true, true);
+    SAVE_TIFF_bigendian("test16m_lzw_predictor_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, 7, true, true);
+    SAVE_TIFF_bigendian("test32m_lzw_predictor.tif", image32.data(), image32i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, HEIGHT, true, true);
+    SAVE_TIFF_bigendian("testrgba16m_lzw_predictor_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, 3, true, true);
 
     std::cout<<" DONE!\n";
 
@@ -668,6 +1450,127 @@ int main(int argc, char *argv[]) {
     TEST<double>("testdm.tif", imaged.data(), imagedi.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
     TEST<uint8_t>("testrgb.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, 1, test_results);
     TEST<uint8_t>("testrgbm.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+    TEST<uint16_t>("test16m_big.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST<uint8_t>("testrgbm_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+    TEST<uint16_t>("testrgba16m.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+    TEST<uint16_t>("test16m.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, true);
+    TEST<double>("testdm.tif", imaged.data(), imagedi.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, true);
+    TEST<uint8_t>("testrgbm.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results, true);
+    TEST_SEEK<uint16_t>("test16m.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_SEEK<uint8_t>("testrgbm.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+    TEST_SEEK<uint16_t>("test16m_big.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_ALLSAMPLES<uint8_t>("testrgbm_chunky.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, true, test_results);
+    TEST_ALLSAMPLES<uint16_t>("testrgba16m_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, true, test_results);
+    TEST_ALLSAMPLES<uint16_t>("testrgba16m_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, true, test_results, true);
+    TEST_ALLSAMPLES<uint8_t>("testrgbm.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, false, test_results);
+    TEST_ALLSAMPLES<uint16_t>("testrgba16m.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, false, test_results);
+    TEST_ALLSAMPLES<uint16_t>("test16m.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, true, test_results);
+    TEST<uint16_t>("test16m_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST<uint16_t>("test16m_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, true);
+    TEST<uint8_t>("testrgbm_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+    TEST_SEEK<uint8_t>("testrgbm_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+    TEST_ALLSAMPLES<uint8_t>("testrgbm_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, false, test_results);
+    TEST<uint16_t>("testrgba16m_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+    TEST_ALLSAMPLES<uint16_t>("testrgba16m_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, true, test_results);
+    TEST_ALLSAMPLES<uint16_t>("testrgba16m_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, true, test_results, true);
+    TEST<uint16_t>("test16m_tiled.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST<uint16_t>("test16m_tiled.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, true);
+    TEST_SEEK<uint16_t>("test16m_tiled.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_ALLSAMPLES<uint16_t>("test16m_tiled.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, true, test_results);
+    TEST<uint8_t>("testrgbm_tiled_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+    TEST_ALLSAMPLES<uint8_t>("testrgbm_tiled_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, false, test_results, true);
+    TEST<uint16_t>("testrgba16m_tiled_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+    TEST_ALLSAMPLES<uint16_t>("testrgba16m_tiled_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, true, test_results);
+    TEST_ALLSAMPLES<uint16_t>("testrgba16m_tiled_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, true, test_results, true);
+    TEST_ROI<uint16_t>("test16m_tiled.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_ROI<uint8_t>("testrgbm_tiled_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results, true);
+    TEST_ROI<uint16_t>("testrgba16m_tiled_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+    TEST_ROI<uint16_t>("test16m_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_ROI<uint8_t>("testrgbm.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+    TEST_ROI<uint16_t>("testrgba16m_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results, true);
+    TEST_ROI<uint8_t>("testrgbm_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+    TEST_ROI<double>("testdm.tif", imaged.data(), imagedi.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, true);
+    TEST_SHARED<uint16_t>("test16m.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_SHARED<uint8_t>("testrgbm_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+    TEST_SHARED<uint16_t>("testrgba16m_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results, 8);
+    TEST_SHARED<uint16_t>("testrgba16m_tiled_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+    TEST_READFRAMES<uint16_t>("test16m.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_READFRAMES<uint16_t>("test16m.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, 1);
+    TEST_READFRAMES<uint8_t>("testrgbm_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results, 3);
+    TEST_READFRAMES<double>("testdm.tif", imaged.data(), imagedi.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, 4, true);
+    TEST_READFRAMES<uint16_t>("testrgba16m_tiled_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results, 8);
+    TEST_PREFETCH<uint16_t>("test16m.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_PREFETCH<uint16_t>("test16m.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, 1);
+    TEST_PREFETCH<uint16_t>("test16m.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, 16, 3*WIDTH*HEIGHT*sizeof(uint16_t));
+    TEST_PREFETCH<uint8_t>("testrgbm_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results, 3);
+    TEST_PREFETCH<uint16_t>("testrgba16m_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results, 8);
+    TEST_PREFETCH<uint16_t>("testrgba16m_tiled_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results, 2);
+    TEST_PREFETCH<double>("testdm.tif", imaged.data(), imagedi.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, 4, 0, true);
+    TEST<uint16_t>("test16m_bigendian_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST<uint16_t>("test16m_bigendian_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, true);
+    TEST<uint32_t>("test32m_bigendian_strips.tif", image32.data(), image32i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST<uint64_t>("test64m_bigendian.tif", image64.data(), image64i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST<uint16_t>("testrgba16m_bigendian_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+    TEST_ALLSAMPLES<uint16_t>("testrgba16m_bigendian_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, true, test_results);
+    TEST_ALLSAMPLES<uint16_t>("testrgba16m_bigendian_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, true, test_results, true);
+    TEST_ROI<uint16_t>("test16m_bigendian_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_ROI<uint64_t>("test64m_bigendian.tif", image64.data(), image64i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, true);
+    TEST_ROI<uint16_t>("testrgba16m_bigendian_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+    TEST_PREFETCH<uint32_t>("test32m_bigendian_strips.tif", image32.data(), image32i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, 4);
+    TEST<uint8_t>("test8m_packbits.tif", image8.data(), image8i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST<uint8_t>("test8m_packbits.tif", image8.data(), image8i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, true);
+    TEST<uint16_t>("test16m_packbits_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST<uint8_t>("testrgbm_packbits_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results, true);
+    TEST<uint16_t>("testrgba16m_packbits_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+    TEST_SEEK<uint16_t>("test16m_packbits_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_ALLSAMPLES<uint8_t>("testrgbm_packbits_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, false, test_results);
+    TEST_ALLSAMPLES<uint16_t>("testrgba16m_packbits_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, true, test_results);
+    TEST_ALLSAMPLES<uint16_t>("testrgba16m_packbits_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, true, test_results, true);
+    TEST_ROI<uint8_t>("test8m_packbits.tif", image8.data(), image8i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_ROI<uint16_t>("test16m_packbits_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, true);
+    TEST_ROI<uint8_t>("testrgbm_packbits_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+    TEST_ROI<uint16_t>("testrgba16m_packbits_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+    TEST_SHARED<uint16_t>("test16m_packbits_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_READFRAMES<uint16_t>("testrgba16m_packbits_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results, 3);
+    TEST_PREFETCH<uint8_t>("testrgbm_packbits_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results, 2);
+    TEST<uint8_t>("test8m_lzw.tif", image8.data(), image8i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST<uint8_t>("testrgbm_lzw_predictor_strips.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+    TEST<uint16_t>("test16m_lzw_predictor_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, true);
+    TEST<uint32_t>("test32m_lzw_predictor.tif", image32.data(), image32i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST<uint16_t>("testrgba16m_lzw_predictor_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+    TEST_ALLSAMPLES<uint8_t>("testrgbm_lzw_predictor_strips.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, true, test_results);
+    TEST_ALLSAMPLES<uint16_t>("testrgba16m_lzw_predictor_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, true, test_results, true);
+    TEST_ROI<uint8_t>("testrgbm_lzw_predictor_strips.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+    TEST_ROI<uint16_t>("test16m_lzw_predictor_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, true);
+    TEST_ROI<uint32_t>("test32m_lzw_predictor.tif", image32.data(), image32i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_READFRAMES<uint16_t>("test16m_lzw_predictor_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, 3);
+    TEST<uint16_t>("test16m_lzwpred_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST<uint16_t>("test16m_lzwpred_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, true);
+    TEST<uint8_t>("testrgbm_lzw_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+    TEST<uint16_t>("testrgba16m_lzwpred_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+    TEST<uint64_t>("test64m_lzwpred.tif", image64.data(), image64i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_SEEK<uint16_t>("test16m_lzwpred_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_ALLSAMPLES<uint8_t>("testrgbm_lzw_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, false, test_results);
+    TEST_ALLSAMPLES<uint16_t>("testrgba16m_lzwpred_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, true, test_results);
+    TEST_ROI<uint16_t>("test16m_lzwpred_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+    TEST_ROI<uint8_t>("testrgbm_lzw_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results, true);
+    TEST_ROI<uint16_t>("testrgba16m_lzwpred_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+    TEST_SHARED<uint16_t>("testrgba16m_lzwpred_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+    TEST_PREFETCH<uint16_t>("test16m_lzwpred_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, 3);
+    if (TinyTIFFWriter_isCompressionAvailable(TinyTIFFWriter_Deflate)) {
+        TEST<uint16_t>("test16m_deflatepred_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+        TEST<uint16_t>("test16m_deflatepred_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, true);
+        TEST<uint8_t>("testrgbm_deflate_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results);
+        TEST<uint16_t>("testrgba16m_deflatepred_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+        TEST_SEEK<uint16_t>("test16m_deflatepred_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+        TEST_ALLSAMPLES<uint8_t>("testrgbm_deflate_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, false, test_results);
+        TEST_ALLSAMPLES<uint16_t>("testrgba16m_deflatepred_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, true, test_results);
+        TEST_ROI<uint16_t>("test16m_deflatepred_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results);
+        TEST_ROI<uint8_t>("testrgbm_deflate_strips_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, TEST_FRAMES, test_results, true);
+        TEST_SHARED<uint16_t>("testrgba16m_deflatepred_strips_chunky.tif", imagergba16.data(), imagergba16i.data(), WIDTH, HEIGHT, 4, TEST_FRAMES, test_results);
+        TEST_READFRAMES<uint16_t>("test16m_deflatepred_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, 3);
+        TEST_PREFETCH<uint16_t>("test16m_deflatepred_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, TEST_FRAMES, test_results, 3);
+    }
 
 #ifdef TINYTIFF_TEST_LIBTIFF
 
@@ -675,6 +1578,9 @@ int main(int argc, char *argv[]) {
     TEST<uint8_t>("test8_bigendian.tif", image8.data(), image8i.data(), WIDTH, HEIGHT, 1, 1, test_results);
     TEST<uint16_t>("test16_littleendian.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, 1, test_results);
     TEST<uint16_t>("test16_bigendian.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, 1, test_results);
+    TEST<uint16_t>("test16_littleendian_big.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, 1, test_results);
+    TEST<uint16_t>("test16_bigendian_big.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, 1, test_results);
+    TEST<uint16_t>("test16_bigendian.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, 1, test_results, true);
     TEST<uint32_t>("test32_littleendian.tif", image32.data(), image32i.data(), WIDTH, HEIGHT, 1, 1, test_results);
     TEST<uint32_t>("test32_bigendian.tif", image32.data(), image32i.data(), WIDTH, HEIGHT, 1, 1, test_results);
     TEST<uint64_t>("test64_littleendian.tif", image64.data(), image64i.data(), WIDTH, HEIGHT, 1, 1, test_results);
@@ -683,13 +1589,13 @@ int main(int argc, char *argv[]) {
     //TEST_AGAINST_LIBTIFF<uint16_t>("2K_source_Stack.tif",  test_results);
     //TEST_AGAINST_LIBTIFF<uint16_t>("2K_tiff_image.tif",  test_results);
     TEST_AGAINST_LIBTIFF<uint8_t>("cell.tif",  test_results);
-    //TEST_AGAINST_LIBTIFF<uint8_t>("circuit.tif",  test_results);
-    //TEST_AGAINST_LIBTIFF<uint8_t>("galaxy.tif",  test_results);
+    TEST_AGAINST_LIBTIFF<uint8_t>("circuit.tif",  test_results);
+    TEST_AGAINST_LIBTIFF<uint8_t>("galaxy.tif",  test_results);
     //TEST_AGAINST_LIBTIFF<uint8_t>("mri.tif",  test_results);
     TEST_AGAINST_LIBTIFF<uint8_t>("multi-channel-time-series.ome.tif",  test_results);
     TEST_AGAINST_LIBTIFF<uint16_t>("test16m_imagej.tif",  test_results);
     TEST_AGAINST_LIBTIFF<float>("imagej_32bit_ramp.tif",  test_results);
-    //TEST_AGAINST_LIBTIFF<uint8_t>("imagej_32bit_ramp_tiled.tif",  test_results);
+    TEST_AGAINST_LIBTIFF<float>("imagej_32bit_ramp_tiled.tif",  test_results);
     TEST_AGAINST_LIBTIFF<uint8_t>("circuit_nocompression.tif",  test_results);
     //TEST_AGAINST_LIBTIFF<uint8_t>("mri_nocompression.tif",  test_results);
     TEST_AGAINST_LIBTIFF<uint8_t>("galaxy_nocompression.tif",  test_results);
@@ -710,7 +1616,7 @@ int main(int argc, char *argv[]) {
     TEST_SIMPLE<uint8_t>("multi-channel-time-series.ome.tif",  test_results);
     TEST_SIMPLE<uint16_t>("test16m_imagej.tif",  test_results);
     TEST_SIMPLE<float>("imagej_32bit_ramp.tif",  test_results);
-    TEST_SIMPLE<uint8_t>("imagej_32bit_ramp_tiled.tif",  test_results);
+    TEST_SIMPLE<float>("imagej_32bit_ramp_tiled.tif",  test_results);
     TEST_SIMPLE<uint8_t>("circuit_nocompression.tif",  test_results);
     TEST_SIMPLE<uint8_t>("mri_nocompression.tif",  test_results);
     TEST_SIMPLE<uint8_t>("galaxy_nocompression.tif",  test_results);
@@ -722,6 +1628,9 @@ int main(int argc, char *argv[]) {
     TEST_SIMPLE<uint8_t>("corel_photopaint_rgba.tif",  test_results);
     //TEST_SIMPLE<uint8_t>("gh19-id8.tif",  test_results);
 #endif
+    TEST_SAME_CONTENTS<float>("imagej_32bit_ramp_tiled.tif", "imagej_32bit_ramp.tif",  test_results);
+    TEST_SAME_CONTENTS<uint8_t>("circuit.tif", "circuit_nocompression.tif",  test_results);
+    TEST_SAME_CONTENTS<uint8_t>("galaxy.tif", "galaxy_nocompression.tif",  test_results);
 
     std::ostringstream testsum;
     testsum<<"\n\n\n\n";
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <string.h>
 #include <array>
+#include <iterator>
 #ifdef TINYTIFF_TEST_LIBTIFF
 #include <tiffio.h>
 #include "libtiff_tools.h"
@@ -111,13 +112,15 @@ enum class DescriptionMode {
 };
 
 template <class T>
-void performWriteTest(const std::string& name, const char* filename, const T* imagedata, size_t WIDTH, size_t HEIGHT, size_t SAMPLES, TinyTIFFWriterSampleInterpretation interpret, std::vector<TestResult>& test_results, TinyTIFFSampleLayout inputOrg=TinyTIFF_Chunky, TinyTIFFSampleLayout outputOrg=TinyTIFF_Chunky, DescriptionMode descMode=DescriptionMode::None) {
+void performWriteTest(const std::string& name, const char* filename, const T* imagedata, size_t WIDTH, size_t HEIGHT, size_t SAMPLES, TinyTIFFWriterSampleInterpretation interpret, std::vector<TestResult>& test_results, TinyTIFFSampleLayout inputOrg=TinyTIFF_Chunky, TinyTIFFSampleLayout outputOrg=TinyTIFF_Chunky, DescriptionMode descMode=DescriptionMode::None, TinyTIFFWriterFileFormat fileFormat=TinyTIFFWriter_TIFF, uint32_t tileSize=0) {
     const size_t bits=sizeof(T)*8;
     std::string desc=std::to_string(WIDTH)+"x"+std::to_string(HEIGHT)+"pix/"+std::to_string(bits)+"bit/"+std::to_string(SAMPLES)+"ch/1frame";
     if (inputOrg==TinyTIFF_Chunky && outputOrg==TinyTIFF_Chunky) desc+="/CHUNKY_FROM_CHUNKY";
     if (inputOrg==TinyTIFF_Chunky && outputOrg==TinyTIFF_Planar) desc+="/PLANAR_FROM_CHUNKY";
     if (inputOrg==TinyTIFF_Planar && outputOrg==TinyTIFF_Chunky) desc+="/CHUNKY_FROM_PLANAR";
     if (inputOrg==TinyTIFF_Planar && outputOrg==TinyTIFF_Planar) desc+="/PLANAR_FROM_PLANAR";
+    if (fileFormat==TinyTIFFWriter_BigTIFF) desc+="/BigTIFF";
+    if (tileSize>0) desc+="/TILED"+std::to_string(tileSize);
     test_results.emplace_back();
     test_results.back().name=name+" ["+desc+", "+std::string(filename)+"]";
     test_results.back().success=true;
@@ -125,9 +128,13 @@ void performWriteTest(const std::string& name, const char* filename, const T* im
     std::cout<<"* "<<test_results.back().name<<"\n";
     HighResTimer timer;
     timer.start();
-    TinyTIFFWriterFile* tiff = TinyTIFFWriter_open(filename, bits, TinyTIFF_SampleFormatFromType<T>().format, SAMPLES, WIDTH,HEIGHT, interpret);
+    TinyTIFFWriterFile* tiff = TinyTIFFWriter_open_withformat(filename, bits, TinyTIFF_SampleFormatFromType<T>().format, SAMPLES, WIDTH,HEIGHT, interpret, fileFormat);
     if (tiff) {
         int res;
+        if (tileSize>0 && !TinyTIFFWriter_setTileSize(tiff, tileSize, tileSize)) {
+            test_results.back().success=false;
+            TESTFAIL("error enabling tiled writing for '"<<filename<<"'! MESSAGE: "<<TinyTIFFWriter_getLastError(tiff)<<"", test_results.back())
+        }
         res=TinyTIFFWriter_writeImageMultiSample(tiff, imagedata, inputOrg, outputOrg);
         if (res!=TINYTIFF_TRUE) {
             test_results.back().success=false;
@@ -255,14 +262,48 @@ void performMultiFrameWriteTest_ExpectedToFail(const std::string& name, const ch
     }
 }
 
+/** \brief optional writer settings for performMultiFrameWriteTest(), the defaults write a synchronous, uncompressed TIFF with one strip per frame */
+struct WriteTestOptions {
+    TinyTIFFWriterFileFormat fileFormat=TinyTIFFWriter_TIFF;
+    /** \brief number of frame buffers for asynchronous writing (0: synchronous writing) */
+    uint32_t asyncBuffers=0;
+    /** \brief width and height of the tiles (0: strips) */
+    uint32_t tileSize=0;
+    TinyTIFFWriterCompression compression=TinyTIFFWriter_NoCompression;
+    /** \brief rows per strip (0: the default of the writer) */
+    uint32_t rowsPerStrip=0;
+    /** \brief Deflate compression level (0: the default of the writer) */
+    int compressionLevel=0;
+    uint32_t compressionThreads=1;
+
+    WriteTestOptions& withFileFormat(TinyTIFFWriterFileFormat v) { fileFormat=v; return *this; }
+    WriteTestOptions& withAsyncBuffers(uint32_t v) { asyncBuffers=v; return *this; }
+    WriteTestOptions& withTileSize(uint32_t v) { tileSize=v; return *this; }
+    WriteTestOptions& withCompression(TinyTIFFWriterCompression v) { compression=v; return *this; }
+    WriteTestOptions& withRowsPerStrip(uint32_t v) { rowsPerStrip=v; return *this; }
+    WriteTestOptions& withCompressionLevel(int v) { compressionLevel=v; return *this; }
+    WriteTestOptions& withCompressionThreads(uint32_t v) { compressionThreads=v; return *this; }
+};
+
 template <class T>
-void performMultiFrameWriteTest(const std::string& name, const char* filename, const T* imagedata, const T* imagedatai, size_t WIDTH, size_t HEIGHT, size_t SAMPLES, size_t FRAMES, TinyTIFFWriterSampleInterpretation interpret, std::vector<TestResult>& test_results, TinyTIFFSampleLayout inputOrg=TinyTIFF_Chunky, TinyTIFFSampleLayout outputOrg=TinyTIFF_Chunky) {
+void performMultiFrameWriteTest(const std::string& name, const char* filename, const T* imagedata, const T* imagedatai, size_t WIDTH, size_t HEIGHT, size_t SAMPLES, size_t FRAMES, TinyTIFFWriterSampleInterpretation interpret, std::vector<TestResult>& test_results, TinyTIFFSampleLayout inputOrg=TinyTIFF_Chunky, TinyTIFFSampleLayout outputOrg=TinyTIFF_Chunky, const WriteTestOptions& options=WriteTestOptions()) {
     const size_t bits=sizeof(T)*8;
     std::string desc=std::to_string(WIDTH)+"x"+std::to_string(HEIGHT)+"pix/"+std::to_string(bits)+"bit/"+std::to_string(SAMPLES)+"ch/"+std::to_string(FRAMES)+"frames";
     if (inputOrg==TinyTIFF_Chunky && outputOrg==TinyTIFF_Chunky) desc+="/CHUNKY_FROM_CHUNKY";
     if (inputOrg==TinyTIFF_Chunky && outputOrg==TinyTIFF_Planar) desc+="/PLANAR_FROM_CHUNKY";
     if (inputOrg==TinyTIFF_Planar && outputOrg==TinyTIFF_Chunky) desc+="/CHUNKY_FROM_PLANAR";
     if (inputOrg==TinyTIFF_Planar && outputOrg==TinyTIFF_Planar) desc+="/PLANAR_FROM_PLANAR";
+    if (options.fileFormat==TinyTIFFWriter_BigTIFF) desc+="/BigTIFF";
+    if (options.asyncBuffers>0) desc+="/ASYNC"+std::to_string(options.asyncBuffers);
+    if (options.tileSize>0) desc+="/TILED"+std::to_string(options.tileSize);
+    if (options.compression==TinyTIFFWriter_PackBits) desc+="/PACKBITS";
+    if (options.compression==TinyTIFFWriter_LZW) desc+="/LZW";
+    if (options.compression==TinyTIFFWriter_LZWPredictor) desc+="/LZW_PREDICTOR";
+    if (options.compression==TinyTIFFWriter_Deflate) desc+="/DEFLATE";
+    if (options.compression==TinyTIFFWriter_DeflatePredictor) desc+="/DEFLATE_PREDICTOR";
+    if (options.compressionLevel>0) desc+="/LEVEL"+std::to_string(options.compressionLevel);
+    if (options.compressionThreads!=1) desc+="/THREADS"+std::to_string(options.compressionThreads);
+    if (options.rowsPerStrip>0) desc+="/ROWSPERSTRIP"+std::to_string(options.rowsPerStrip);
     test_results.emplace_back();
     test_results.back().name=name+" ["+desc+", "+std::string(filename)+"]";
     test_results.back().success=true;
@@ -270,12 +311,45 @@ void performMultiFrameWriteTest(const std::string& name, const char* filename, c
     std::cout<<"* "<<test_results.back().name<<"\n";
     HighResTimer timer;
     timer.start();
-    TinyTIFFWriterFile* tiff = TinyTIFFWriter_open(filename, bits, TinyTIFF_SampleFormatFromType<T>().format, SAMPLES, WIDTH,HEIGHT, interpret);
+    TinyTIFFWriterFile* tiff = TinyTIFFWriter_open_withformat(filename, bits, TinyTIFF_SampleFormatFromType<T>().format, SAMPLES, WIDTH,HEIGHT, interpret, options.fileFormat);
     if (tiff) {
+        if (options.rowsPerStrip>0 && !TinyTIFFWriter_setRowsPerStrip(tiff, options.rowsPerStrip)) {
+            test_results.back().success=false;
+            TESTFAIL("error setting rows per strip for '"<<filename<<"'! MESSAGE: "<<TinyTIFFWriter_getLastError(tiff)<<"", test_results.back())
+        }
+        if (options.compression!=TinyTIFFWriter_NoCompression && !TinyTIFFWriter_setCompression(tiff, options.compression)) {
+            test_results.back().success=false;
+            TESTFAIL("error enabling compression for '"<<filename<<"'! MESSAGE: "<<TinyTIFFWriter_getLastError(tiff)<<"", test_results.back())
+        }
+        if (options.compressionLevel>0 && !TinyTIFFWriter_setCompressionLevel(tiff, options.compressionLevel)) {
+            test_results.back().success=false;
+            TESTFAIL("error setting the compression level for '"<<filename<<"'! MESSAGE: "<<TinyTIFFWriter_getLastError(tiff)<<"", test_results.back())
+        }
+        if (options.compressionThreads!=1 && !TinyTIFFWriter_setCompressionThreads(tiff, options.compressionThreads)) {
+            test_results.back().success=false;
+            TESTFAIL("error setting the compression threads for '"<<filename<<"'! MESSAGE: "<<TinyTIFFWriter_getLastError(tiff)<<"", test_results.back())
+        }
+        if (options.asyncBuffers>0 && !TinyTIFFWriter_enableAsyncWriting(tiff, options.asyncBuffers)) {
+            test_results.back().success=false;
+            TESTFAIL("error enabling asynchronous writing for '"<<filename<<"'! MESSAGE: "<<TinyTIFFWriter_getLastError(tiff)<<"", test_results.back())
+        }
+        if (options.tileSize>0 && !TinyTIFFWriter_setTileSize(tiff, options.tileSize, options.tileSize)) {
+            test_results.back().success=false;
+            TESTFAIL("error enabling tiled writing for '"<<filename<<"'! MESSAGE: "<<TinyTIFFWriter_getLastError(tiff)<<"", test_results.back())
+        }
         for (size_t f=0; f<FRAMES; f++) {
             int res;
-            if (f%2==0) res=TinyTIFFWriter_writeImageMultiSample(tiff, imagedata, inputOrg, outputOrg);
-            else res=TinyTIFFWriter_writeImageMultiSample(tiff, imagedatai, inputOrg, outputOrg);
+            const T* frame=(f%2==0)?imagedata:imagedatai;
+            if (options.asyncBuffers>0) {
+                const uint64_t overruns=TinyTIFFWriter_getAsyncOverruns(tiff);
+                res=TinyTIFFWriter_writeImageMultiSampleAsync(tiff, frame, inputOrg, outputOrg);
+                if (res!=TINYTIFF_TRUE && TinyTIFFWriter_getAsyncOverruns(tiff)==overruns+1) {
+                    // the ring was full: wait for the I/O thread and queue the frame again
+                    res=TinyTIFFWriter_flushAsync(tiff) && TinyTIFFWriter_writeImageMultiSampleAsync(tiff, frame, inputOrg, outputOrg);
+                }
+            } else {
+                res=TinyTIFFWriter_writeImageMultiSample(tiff, frame, inputOrg, outputOrg);
+            }
             if (res!=TINYTIFF_TRUE) {
                 test_results.back().success=false;
                 TESTFAIL("error writing image data into '"<<filename<<"'! MESSAGE: "<<TinyTIFFWriter_getLastError(tiff)<<"", test_results.back())
@@ -303,6 +377,28 @@ void performMultiFrameWriteTest(const std::string& name, const char* filename, c
     }
 }
 
+void performSameFileTest(const std::string& name, const char* filename, const char* reference, std::vector<TestResult>& test_results) {
+    test_results.emplace_back();
+    test_results.back().name=name+" ["+std::string(filename)+" == "+std::string(reference)+"]";
+    test_results.back().success=true;
+    std::cout<<"\n\n*****************************************************************************\n";
+    std::cout<<"* "<<test_results.back().name<<"\n";
+    std::ifstream f1(filename, std::ios::binary), f2(reference, std::ios::binary);
+    const std::string c1((std::istreambuf_iterator<char>(f1)), std::istreambuf_iterator<char>());
+    const std::string c2((std::istreambuf_iterator<char>(f2)), std::istreambuf_iterator<char>());
+    test_results.back().numImages=1;
+    if (c1.size()==0 || c2.size()==0) {
+        TESTFAIL("could not read '"<<filename<<"' or '"<<reference<<"'!", test_results.back())
+    } else if (c1!=c2) {
+        TESTFAIL("'"<<filename<<"' ("<<c1.size()<<" bytes) differs from '"<<reference<<"' ("<<c2.size()<<" bytes)!", test_results.back())
+    }
+    if (test_results.back().success) {
+        std::cout<<"* ==> SUCCESSFUL\n";
+    } else {
+        std::cout<<"* ==> FAILED\n";
+    }
+}
+
 
 #ifdef TINYTIFF_TEST_LIBTIFF
 static void errorhandler(const char* module, const char* fmt, va_list ap)
@@ -360,6 +456,8 @@ int main(int argc, char *argv[]) {
     std::vector<uint8_t> greyalphai(WIDTH*HEIGHT*2, 0);
     std::vector<uint8_t> imagergbplan(WIDTH*HEIGHT*3, 0);
     std::vector<uint8_t> imagergbplani(WIDTH*HEIGHT*3, 0);
+    std::vector<uint16_t> imagergba16(WIDTH*HEIGHT*4, 0);
+    std::vector<uint16_t> imagergba16plan(WIDTH*HEIGHT*4, 0);
 
 
     write1ChannelTestData(image8.data(), WIDTH, HEIGHT, PATTERNSIZE, 1);
@@ -391,6 +489,9 @@ int main(int argc, char *argv[]) {
     writeRGBTestDataChunky(imagergbai.data(), WIDTH, HEIGHT, PATTERNSIZE,4);
     writeALPHATestData(imagergbai.data(), 3, WIDTH, HEIGHT, 4);
     invertTestImage(imagergbai.data(), WIDTH, HEIGHT,4);
+    writeRGBTestDataChunky(imagergba16.data(), WIDTH, HEIGHT, PATTERNSIZE,4);
+    writeALPHATestData(imagergba16.data(), 3, WIDTH, HEIGHT, 4);
+    writeRGBTestDataPlanar(imagergba16plan.data(), WIDTH, HEIGHT, PATTERNSIZE,4);
     write1ChannelTestData(greyalpha.data(), WIDTH, HEIGHT, PATTERNSIZE, 2);
     writeALPHATestData(greyalpha.data(), 1, WIDTH, HEIGHT, 2);
     write1ChannelTestData(greyalphai.data(), WIDTH, HEIGHT, PATTERNSIZE, 2);
@@ -420,6 +521,18 @@ int main(int argc, char *argv[]) {
         performMultiFrameWriteTest_ExpectedToFail("WRITING TOO MANY 64-Bit UINT GREY TIFF", "test64m_toomany.tif", image64_too_many.data(), image64_too_many.data(), WIDTH_too_many, HEIGHT_too_many, 1, too_many_frames, TinyTIFFWriter_Greyscale, test_results);
     }
 
+    performWriteTest("WRITING 16-Bit UINT GREY BigTIFF", "test16_big.tif", image16.data(), WIDTH, HEIGHT, 1, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, DescriptionMode::Text, TinyTIFFWriter_BigTIFF);
+    performMultiFrameWriteTest("WRITING 16-Bit UINT GREY BigTIFF", "test16m_big.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withFileFormat(TinyTIFFWriter_BigTIFF));
+    performMultiFrameWriteTest("WRITING 16-Bit UINT GREY ASYNC", "test16m_async.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withAsyncBuffers(4));
+    performMultiFrameWriteTest("WRITING 16-Bit UINT GREY ASYNC", "test16m_async1.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withAsyncBuffers(1));
+    if (quicktest==TINYTIFF_FALSE) {
+        const size_t WIDTH_big=8000;
+        const size_t HEIGHT_big=4000;
+        const std::vector<uint64_t> image64_big(WIDTH_big*HEIGHT_big, 0);
+        const size_t big_frames=((size_t)0xFFFFFFFF)/((size_t)(WIDTH_big*HEIGHT_big*sizeof(uint64_t)))+2;
+        performMultiFrameWriteTest("WRITING >4GB 64-Bit UINT GREY BigTIFF", "test64m_big.tif", image64_big.data(), image64_big.data(), WIDTH_big, HEIGHT_big, 1, big_frames, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withFileFormat(TinyTIFFWriter_BigTIFF));
+    }
+
     performWriteTest("WRITING 32-Bit FLOAT GREY TIFF", "testf.tif", imagef.data(), WIDTH, HEIGHT, 1, TinyTIFFWriter_Greyscale, test_results);
     if (quicktest==TINYTIFF_FALSE) performMultiFrameWriteTest("WRITING 32-Bit FLOAT GREY TIFF", "testfm.tif", imagef.data(), imagefi.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results);
 
@@ -438,8 +551,40 @@ int main(int argc, char *argv[]) {
     performWriteTest("WRITING 8-Bit UINT RGB TIFF", "testrgb_planplan.tif", imagergbplan.data(), WIDTH, HEIGHT, 3, TinyTIFFWriter_RGB, test_results, TinyTIFF_Planar, TinyTIFF_Planar);
     if (quicktest==TINYTIFF_FALSE) performMultiFrameWriteTest("WRITING 8-Bit UINT RGB TIFF", "testrgbm_planplan.tif", imagergbplan.data(), imagergbplani.data(), WIDTH, HEIGHT, 3, NUMFRAMES, TinyTIFFWriter_RGB, test_results, TinyTIFF_Planar, TinyTIFF_Planar);
 
+    performMultiFrameWriteTest("WRITING 8-Bit UINT RGB BigTIFF", "testrgbm_chunkplan_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, NUMFRAMES, TinyTIFFWriter_RGB, test_results, TinyTIFF_Chunky, TinyTIFF_Planar, WriteTestOptions().withFileFormat(TinyTIFFWriter_BigTIFF));
+    performMultiFrameWriteTest("WRITING 8-Bit UINT RGB ASYNC", "testrgbm_chunkplan_async.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, NUMFRAMES, TinyTIFFWriter_RGB, test_results, TinyTIFF_Chunky, TinyTIFF_Planar, WriteTestOptions().withAsyncBuffers(3));
+
     performWriteTest("WRITING 8-Bit UINT RGBA TIFF", "testrgba.tif", imagergba.data(), WIDTH, HEIGHT, 4, TinyTIFFWriter_RGBA, test_results);
     if (quicktest==TINYTIFF_FALSE) performMultiFrameWriteTest("WRITING 8-Bit UINT RGBA TIFF", "testrgbam.tif", imagergba.data(), imagergbai.data(), WIDTH, HEIGHT, 4, NUMFRAMES, TinyTIFFWriter_RGBA, test_results);
+    performWriteTest("WRITING 16-Bit UINT RGBA TIFF", "testrgba16_chunkplan.tif", imagergba16.data(), WIDTH, HEIGHT, 4, TinyTIFFWriter_RGBA, test_results, TinyTIFF_Chunky, TinyTIFF_Planar);
+    performWriteTest("WRITING 16-Bit UINT RGBA TIFF", "testrgba16_planchunk.tif", imagergba16plan.data(), WIDTH, HEIGHT, 4, TinyTIFFWriter_RGBA, test_results, TinyTIFF_Planar, TinyTIFF_Chunky);
+
+    performWriteTest("WRITING 16-Bit UINT GREY TILED TIFF", "test16_tiled.tif", image16.data(), WIDTH, HEIGHT, 1, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, DescriptionMode::None, TinyTIFFWriter_TIFF, 16);
+    performWriteTest("WRITING 8-Bit UINT RGB TILED TIFF", "testrgb_tiled.tif", imagergb.data(), WIDTH, HEIGHT, 3, TinyTIFFWriter_RGB, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, DescriptionMode::None, TinyTIFFWriter_TIFF, 32);
+    performWriteTest("WRITING 8-Bit UINT RGB TILED TIFF", "testrgb_chunkplan_tiled.tif", imagergb.data(), WIDTH, HEIGHT, 3, TinyTIFFWriter_RGB, test_results, TinyTIFF_Chunky, TinyTIFF_Planar, DescriptionMode::None, TinyTIFFWriter_TIFF, 32);
+    performWriteTest("WRITING 16-Bit UINT RGBA TILED TIFF", "testrgba16_planchunk_tiled.tif", imagergba16plan.data(), WIDTH, HEIGHT, 4, TinyTIFFWriter_RGBA, test_results, TinyTIFF_Planar, TinyTIFF_Chunky, DescriptionMode::None, TinyTIFFWriter_TIFF, 16);
+    performMultiFrameWriteTest("WRITING 8-Bit UINT RGB TILED BigTIFF ASYNC", "testrgbm_planplan_tiled_big.tif", imagergbplan.data(), imagergbplani.data(), WIDTH, HEIGHT, 3, NUMFRAMES, TinyTIFFWriter_RGB, test_results, TinyTIFF_Planar, TinyTIFF_Planar, WriteTestOptions().withFileFormat(TinyTIFFWriter_BigTIFF).withAsyncBuffers(3).withTileSize(48));
+    performMultiFrameWriteTest("WRITING 8-Bit UINT GREY PACKBITS TIFF", "test8m_packbits.tif", image8.data(), image8i.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withCompression(TinyTIFFWriter_PackBits));
+    performMultiFrameWriteTest("WRITING 16-Bit UINT GREY PACKBITS TIFF", "test16m_packbits_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withCompression(TinyTIFFWriter_PackBits).withRowsPerStrip(7));
+    performMultiFrameWriteTest("WRITING 8-Bit UINT RGB PACKBITS BigTIFF ASYNC", "testrgbm_chunkplan_packbits_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, NUMFRAMES, TinyTIFFWriter_RGB, test_results, TinyTIFF_Chunky, TinyTIFF_Planar, WriteTestOptions().withFileFormat(TinyTIFFWriter_BigTIFF).withAsyncBuffers(3).withCompression(TinyTIFFWriter_PackBits).withRowsPerStrip(16));
+    performMultiFrameWriteTest("WRITING 8-Bit UINT GREY LZW TIFF", "test8m_lzw.tif", image8.data(), image8i.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withCompression(TinyTIFFWriter_LZW));
+    performMultiFrameWriteTest("WRITING 16-Bit UINT GREY LZW+PREDICTOR TIFF", "test16m_lzwpred_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withCompression(TinyTIFFWriter_LZWPredictor).withRowsPerStrip(5));
+    performMultiFrameWriteTest("WRITING 32-Bit FLOAT GREY LZW+PREDICTOR TIFF", "testfm_lzwpred.tif", imagef.data(), imagefi.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withCompression(TinyTIFFWriter_LZWPredictor));
+    performMultiFrameWriteTest("WRITING 8-Bit UINT RGB LZW+PREDICTOR TIFF", "testrgbm_lzwpred_strips.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, NUMFRAMES, TinyTIFFWriter_RGB, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withCompression(TinyTIFFWriter_LZWPredictor).withRowsPerStrip(7));
+    performMultiFrameWriteTest("WRITING 16-Bit UINT RGBA LZW+PREDICTOR BigTIFF ASYNC", "testrgba16m_planchunk_lzwpred_big.tif", imagergba16plan.data(), imagergba16plan.data(), WIDTH, HEIGHT, 4, NUMFRAMES, TinyTIFFWriter_RGBA, test_results, TinyTIFF_Planar, TinyTIFF_Chunky, WriteTestOptions().withFileFormat(TinyTIFFWriter_BigTIFF).withAsyncBuffers(2).withCompression(TinyTIFFWriter_LZWPredictor).withRowsPerStrip(3));
+    performMultiFrameWriteTest("WRITING 16-Bit UINT GREY LZW+PREDICTOR TIFF MULTITHREADED", "test16m_lzwpred_strips_mt.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withCompression(TinyTIFFWriter_LZWPredictor).withRowsPerStrip(5).withCompressionThreads(4));
+    performSameFileTest("COMPARING MULTITHREADED LZW+PREDICTOR", "test16m_lzwpred_strips_mt.tif", "test16m_lzwpred_strips.tif", test_results);
+    performMultiFrameWriteTest("WRITING 8-Bit UINT RGB PACKBITS BigTIFF ASYNC MULTITHREADED", "testrgbm_chunkplan_packbits_big_mt.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, NUMFRAMES, TinyTIFFWriter_RGB, test_results, TinyTIFF_Chunky, TinyTIFF_Planar, WriteTestOptions().withFileFormat(TinyTIFFWriter_BigTIFF).withAsyncBuffers(3).withCompression(TinyTIFFWriter_PackBits).withRowsPerStrip(16).withCompressionThreads(3));
+    performSameFileTest("COMPARING MULTITHREADED PACKBITS ASYNC", "testrgbm_chunkplan_packbits_big_mt.tif", "testrgbm_chunkplan_packbits_big.tif", test_results);
+    if (TinyTIFFWriter_isCompressionAvailable(TinyTIFFWriter_Deflate)) {
+        performMultiFrameWriteTest("WRITING 8-Bit UINT GREY DEFLATE TIFF", "test8m_deflate.tif", image8.data(), image8i.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withCompression(TinyTIFFWriter_Deflate));
+        performMultiFrameWriteTest("WRITING 8-Bit UINT GREY DEFLATE TIFF", "test8m_deflate_level1.tif", image8.data(), image8i.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withCompression(TinyTIFFWriter_Deflate).withCompressionLevel(1));
+        performMultiFrameWriteTest("WRITING 16-Bit UINT GREY DEFLATE+PREDICTOR TIFF", "test16m_deflatepred_strips.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withCompression(TinyTIFFWriter_DeflatePredictor).withRowsPerStrip(5).withCompressionLevel(9));
+        performMultiFrameWriteTest("WRITING 32-Bit FLOAT GREY DEFLATE+PREDICTOR TIFF", "testfm_deflatepred.tif", imagef.data(), imagefi.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withCompression(TinyTIFFWriter_DeflatePredictor));
+        performMultiFrameWriteTest("WRITING 8-Bit UINT RGB DEFLATE BigTIFF ASYNC", "testrgbm_chunkplan_deflate_big.tif", imagergb.data(), imagergbi.data(), WIDTH, HEIGHT, 3, NUMFRAMES, TinyTIFFWriter_RGB, test_results, TinyTIFF_Chunky, TinyTIFF_Planar, WriteTestOptions().withFileFormat(TinyTIFFWriter_BigTIFF).withAsyncBuffers(3).withCompression(TinyTIFFWriter_Deflate).withRowsPerStrip(16));
+        performMultiFrameWriteTest("WRITING 16-Bit UINT GREY DEFLATE+PREDICTOR TIFF MULTITHREADED", "test16m_deflatepred_strips_mt.tif", image16.data(), image16i.data(), WIDTH, HEIGHT, 1, NUMFRAMES, TinyTIFFWriter_Greyscale, test_results, TinyTIFF_Chunky, TinyTIFF_Chunky, WriteTestOptions().withCompression(TinyTIFFWriter_DeflatePredictor).withRowsPerStrip(5).withCompressionLevel(9).withCompressionThreads(0));
+        performSameFileTest("COMPARING MULTITHREADED DEFLATE+PREDICTOR", "test16m_deflatepred_strips_mt.tif", "test16m_deflatepred_strips.tif", test_results);
+    }
 
     performWriteTest("WRITING 8-Bit UINT GREY+ALPHA  TIFF", "test_ga.tif", greyalpha.data(), WIDTH, HEIGHT, 2, TinyTIFFWriter_GreyscaleAndAlpha, test_results);
     if (quicktest==TINYTIFF_FALSE) performMultiFrameWriteTest("WRITING 8-Bit UINT GREY+ALPHA TIFF", "test_gam.tif", greyalpha.data(), greyalphai.data(), WIDTH, HEIGHT, 2, NUMFRAMES, TinyTIFFWriter_GreyscaleAndAlpha, test_results);